@@ -20,7 +20,8 @@ namespace CCodeZones
   enum  eCCodeZones : unsigned
   {
     FILE_IO = 0x1,
-    STORAGE = 0x2
+    STORAGE = 0x2,
+    TERRAIN = 0x4
   };
 }
 
@@ -5,7 +5,7 @@
 
 using namespace IO::ADT;
 
-ADTFile::ADTFile(std::uint32_t file_data_id)
+ADTFile::ADTFile([[maybe_unused]] std::uint32_t file_data_id)
 {
 
   //Common::ByteBuffer buf{};
@@ -0,0 +1,23 @@
+#include <IO/ADT/Obj/ADTObj.hpp>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+template class IO::ADT::ADTObj<ClientVersion::CATA, ADTObjLodLevel::NORMAL>;
+template class IO::ADT::ADTObj<ClientVersion::MOP, ADTObjLodLevel::NORMAL>;
+template class IO::ADT::ADTObj<ClientVersion::WOD, ADTObjLodLevel::NORMAL>;
+template class IO::ADT::ADTObj<ClientVersion::LEGION, ADTObjLodLevel::NORMAL>;
+template class IO::ADT::ADTObj<ClientVersion::BFA, ADTObjLodLevel::NORMAL>;
+template class IO::ADT::ADTObj<ClientVersion::SL, ADTObjLodLevel::NORMAL>;
+template class IO::ADT::ADTObj<ClientVersion::DF, ADTObjLodLevel::NORMAL>;
+template class IO::ADT::ADTObj<ClientVersion::CLASSIC_NEW, ADTObjLodLevel::NORMAL>;
+template class IO::ADT::ADTObj<ClientVersion::TBC_NEW, ADTObjLodLevel::NORMAL>;
+template class IO::ADT::ADTObj<ClientVersion::WOTLK_NEW, ADTObjLodLevel::NORMAL>;
+
+template class IO::ADT::ADTObj<ClientVersion::LEGION, ADTObjLodLevel::LOD>;
+template class IO::ADT::ADTObj<ClientVersion::BFA, ADTObjLodLevel::LOD>;
+template class IO::ADT::ADTObj<ClientVersion::SL, ADTObjLodLevel::LOD>;
+template class IO::ADT::ADTObj<ClientVersion::DF, ADTObjLodLevel::LOD>;
+template class IO::ADT::ADTObj<ClientVersion::CLASSIC_NEW, ADTObjLodLevel::LOD>;
+template class IO::ADT::ADTObj<ClientVersion::TBC_NEW, ADTObjLodLevel::LOD>;
+template class IO::ADT::ADTObj<ClientVersion::WOTLK_NEW, ADTObjLodLevel::LOD>;
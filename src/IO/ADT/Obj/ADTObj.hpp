@@ -24,112 +24,16 @@ namespace IO::ADT
     LOD = 1 ///> obj1 file.
   };
 
-  // forward decl traits
-  class ADTObj0ModelStorageFilepath;
-
-  template<Common::ClientVersion client_version>
-  class AdtObj0SpecificData;
-
-  template<Common::ClientVersion client_version>
-  class AdtObj1SpecificData;
-
-  class ADTLodMapObjectBatches;
-
-  class ADTDoodadsetOverrides;
-
-  /**
-   * Switches the implementation of ADTObj file based on lod level.
-   * @tparam client_version Version of the game client.
-   * @tparam lod_level Lod level.
-   */
-  template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
-  using LodLevelImpl = Common::Traits::SwitchableTrait
-    <
-      lod_level
-      , Common::Traits::TraitCase
-      <
-        ADTObjLodLevel::NORMAL
-        , AdtObj0SpecificData<client_version>
-      >
-      , Common::Traits::VersionedTraitCase
-      <
-        ADTObjLodLevel::LOD
-        , AdtObj1SpecificData<client_version>
-        , client_version
-        , Common::ClientVersion::LEGION
-      >
-    >;
-
-  /**
-   * Split ADT file containing data associated with object placements.
-   * @tparam client_version Version of the game client.
-   * @tparam lod_level Lod level.
-   */
-  template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
-  class ADTObj : public Common::Traits::AutoIOTraits
-                        <
-                          Common::Traits::IOTraits
-                          <
-                            Common::Traits::IOTrait<LodLevelImpl<client_version, lod_level>>
-                            , Common::Traits::IOTrait
-                              <
-                                Common::Traits::VersionTrait
-                                <
-                                  ADTLodMapObjectBatches
-                                  , client_version
-                                  , Common::ClientVersion::BFA
-                                >
-                              >
-                            , Common::Traits::IOTrait
-                              <
-                                Common::Traits::VersionTrait
-                                <
-                                  ADTDoodadsetOverrides
-                                  , client_version
-                                  , Common::ClientVersion::SL
-                                >
-                              >
-                          >
-                        >
-               , public Common::Traits::AutoIOTraitInterface
-                        <
-                          ADTObj<client_version, lod_level>
-                          , Common::Traits::DefaultTraitContext
-                          , Common::Traits::DefaultTraitContext
-                          , Common::Traits::TraitType::File
-                        >
-  {
-  static_assert(client_version >= Common::ClientVersion::CATA && "Split files did not exist before Cataclysm.");
-  public:
-    explicit ADTObj(std::uint32_t file_data_id)
-        : _file_data_id(file_data_id)
-    {
-    };
-
-  private:
-    // This method converts MODF/MDDF references to filename offsets into filename indices.
-    void PatchObjectFilenameReferences() requires (lod_level == ADTObjLodLevel::NORMAL);
-
-    template
-    <
-      Common::Concepts::DataArrayChunkProtocol FilepathOffsetStorage
-      , Common::Concepts::StringBlockChunkProtocol FilepathStorage
-      , Common::Concepts::DataArrayChunkProtocol InstanceStorage
-    >
-    void PatchObjectFilenameReferences_detail(FilepathOffsetStorage& offset_storage
-                                              , FilepathStorage& filepath_storage
-                                              , InstanceStorage& instance_storage)
-    requires (lod_level == ADTObjLodLevel::NORMAL);
-
-    std::uint32_t _file_data_id;
-
-  };
-
   // ADT obj0-specific
 
-  // Enables storing textures by filepath
-  class ADTObj0ModelStorageFilepath : public Common::Traits::AutoIOTraitInterface<ADTObj0ModelStorageFilepath>
+  // Enables storing models by filepath
+  class ADTObj0ModelStorageFilepath : public Common::Traits::AutoIOTraitInterface
+                                             <
+                                               ADTObj0ModelStorageFilepath
+                                               , Common::Traits::TraitType::Component
+                                             >
   {
+    AutoIOTraitInterfaceUser;
   protected:
     Common::StringBlockChunk<Common::StringBlockChunkType::OFFSET
                               , ChunkIdentifiers::ADTObj0Chunks::MMDX
@@ -147,85 +51,75 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&ADTObj0ModelStorageFilepath::_model_filenames>
-        , Common::Traits::TraitEntry<&ADTObj0ModelStorageFilepath::_model_filename_offsets>
-        , Common::Traits::TraitEntry<&ADTObj0ModelStorageFilepath::_map_object_filenames>
-        , Common::Traits::TraitEntry<&ADTObj0ModelStorageFilepath::_map_object_filename_offsets>
-      >
+      Common::Traits::TraitEntry<&ADTObj0ModelStorageFilepath::_model_filenames>
+      , Common::Traits::TraitEntry<&ADTObj0ModelStorageFilepath::_model_filename_offsets>
+      , Common::Traits::TraitEntry<&ADTObj0ModelStorageFilepath::_map_object_filenames>
+      , Common::Traits::TraitEntry<&ADTObj0ModelStorageFilepath::_map_object_filename_offsets>
     > _auto_trait {};
   };
 
-  template<Common::ClientVersion client_version>
-  class AdtObj0SpecificData : public Common::Traits::AutoIOTraits
+  // Object placements and per-chunk object references of obj0
+  class AdtObj0SpecificData : public Common::Traits::AutoIOTraitInterface
                                      <
-                                       Common::Traits::IOTraits
-                                       <
-                                        Common::Traits::IOTrait
-                                        <
-                                          Common::Traits::VersionTrait
-                                          <
-                                            ADTObj0ModelStorageFilepath
-                                            , client_version
-                                            , Common::ClientVersion::CATA
-                                            , Common::ClientVersion::BFA
-                                          >
-                                        >
-                                       >
+                                       AdtObj0SpecificData
+                                       , Common::Traits::TraitType::Component
                                      >
   {
+    AutoIOTraitInterfaceUser;
   public:
     AdtObj0SpecificData();
 
   protected:
     Common::DataArrayChunk<DataStructures::MDDF, ChunkIdentifiers::ADTObj0Chunks::MDDF> _model_placements;
     Common::DataArrayChunk<DataStructures::MODF, ChunkIdentifiers::ADTObj0Chunks::MODF> _map_object_placements;
-    std::array<MCNKObj, Common::WorldConstants::CHUNKS_PER_TILE> _chunks;
+    Common::SparseChunkArray
+    <
+      MCNKObj
+      , Common::WorldConstants::CHUNKS_PER_TILE
+      , Common::WorldConstants::CHUNKS_PER_TILE
+    > _chunks;
+
+  private:
+    static constexpr
+    Common::Traits::AutoIOTrait
+    <
+      Common::Traits::TraitEntry<&AdtObj0SpecificData::_model_placements>
+      , Common::Traits::TraitEntry<&AdtObj0SpecificData::_map_object_placements>
+      , Common::Traits::TraitEntry<&AdtObj0SpecificData::_chunks>
+    > _auto_trait {};
   };
 
   // ADT obj-1 specific
 
   // Enables support for model lod batches in obj1
-  class LodModelBatches : public Common::Traits::AutoIOTraitInterface<LodModelBatches>
+  class LodModelBatches : public Common::Traits::AutoIOTraitInterface
+                                 <
+                                   LodModelBatches
+                                   , Common::Traits::TraitType::Component
+                                 >
   {
+    AutoIOTraitInterfaceUser;
   protected:
     Common::DataArrayChunk<char, ChunkIdentifiers::ADTObj1Chunks::MLDB> _lod_model_batches;
 
   private:
     static constexpr Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&LodModelBatches::_lod_model_batches>
-      >
+      Common::Traits::TraitEntry<&LodModelBatches::_lod_model_batches>
     > _auto_trait {};
-  } IMPLEMENTS_IO_TRAIT(LodModelBatches);
+  };
 
-  template<Common::ClientVersion client_version>
-  class AdtObj1SpecificData : public Common::Traits::AutoIOTraits
+  // Lod object placements of obj1
+  class AdtObj1SpecificData : public Common::Traits::AutoIOTraitInterface
                                      <
-                                       Common::Traits::IOTraits
-                                       <
-                                         Common::Traits::IOTrait
-                                         <
-                                           Common::Traits::VersionTrait
-                                             <
-                                               LodModelBatches
-                                               , client_version
-                                               , Common::ClientVersion::SL
-                                             >
-                                         >
-                                       >
+                                       AdtObj1SpecificData
+                                       , Common::Traits::TraitType::Component
                                      >
-                              , public Common::Traits::AutoIOTraitInterface<AdtObj1SpecificData<client_version>>
   {
+    AutoIOTraitInterfaceUser;
   public:
     AdtObj1SpecificData();
 
-    template<Common::ClientVersion client_v>
-    void GenerateLod(ADTObj<client_v, ADTObjLodLevel::NORMAL> const& tile_obj);
-
   protected:
     Common::DataArrayChunk<DataStructures::MLMD, ChunkIdentifiers::ADTObj1Chunks::MLMD> _lod_map_object_placements;
     Common::DataArrayChunk<DataStructures::MLMX, ChunkIdentifiers::ADTObj1Chunks::MLMX> _lod_map_object_extents;
@@ -234,25 +128,27 @@ namespace IO::ADT
     Common::DataArrayChunk<std::uint32_t, ChunkIdentifiers::ADTObj1Chunks::MLDL> _lod_model_unknown;
     Common::DataArrayChunk<DataStructures::MLFD, ChunkIdentifiers::ADTObj1Chunks::MLFD> _lod_mapping;
 
-  public:
+  private:
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_map_object_placements>
-        , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_map_object_extents>
-        , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_model_placements>
-        , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_model_extents>
-        , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_model_unknown>
-        , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_mapping>
-      >
+      Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_map_object_placements>
+      , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_map_object_extents>
+      , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_model_placements>
+      , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_model_extents>
+      , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_model_unknown>
+      , Common::Traits::TraitEntry<&AdtObj1SpecificData::_lod_mapping>
     > _auto_trait {};
   };
 
   // Enables support for LOD map object batches (BfA+).
-  class ADTLodMapObjectBatches : public Common::Traits::AutoIOTraitInterface<ADTLodMapObjectBatches>
+  class ADTLodMapObjectBatches : public Common::Traits::AutoIOTraitInterface
+                                        <
+                                          ADTLodMapObjectBatches
+                                          , Common::Traits::TraitType::Component
+                                        >
   {
+    AutoIOTraitInterfaceUser;
   protected:
     Common::DataArrayChunk<char, ChunkIdentifiers::ADTObjCommonChunks::MLMB> _lod_map_object_batches;
 
@@ -260,15 +156,17 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&ADTLodMapObjectBatches::_lod_map_object_batches>
-      >
+      Common::Traits::TraitEntry<&ADTLodMapObjectBatches::_lod_map_object_batches>
     > _auto_trait = {};
   };
 
-  class ADTDoodadsetOverrides : public Common::Traits::AutoIOTraitInterface<ADTDoodadsetOverrides>
+  class ADTDoodadsetOverrides : public Common::Traits::AutoIOTraitInterface
+                                       <
+                                         ADTDoodadsetOverrides
+                                         , Common::Traits::TraitType::Component
+                                       >
   {
+    AutoIOTraitInterfaceUser;
   protected:
     Common::DataArrayChunk<std::int16_t, ChunkIdentifiers::ADTObjCommonChunks::MWDS> _wmo_doodadset_overrides;
     Common::DataArrayChunk<DataStructures::MWDR
@@ -278,17 +176,188 @@ namespace IO::ADT
    static constexpr
    Common::Traits::AutoIOTrait
    <
-    Common::Traits::TraitEntries
+     Common::Traits::TraitEntry<&ADTDoodadsetOverrides::_wmo_doodadset_overrides>
+     , Common::Traits::TraitEntry<&ADTDoodadsetOverrides::_wmo_doodadset_overrides_ranges>
+   > _auto_trait = {};
+
+  };
+
+  /**
+   * Switches the lod level specific data of ADTObj file.
+   * @tparam client_version Version of the game client.
+   * @tparam lod_level Lod level.
+   */
+  template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
+  using LodLevelImpl = Common::Traits::SwitchableTrait
+    <
+      lod_level
+      , Common::Traits::TraitCase
+      <
+        ADTObjLodLevel::NORMAL
+        , AdtObj0SpecificData
+      >
+      , Common::Traits::VersionedTraitCase
+      <
+        ADTObjLodLevel::LOD
+        , AdtObj1SpecificData
+        , client_version
+        , Common::ClientVersion::LEGION
+      >
+    >;
+
+  /**
+   * Split ADT file containing data associated with object placements.
+   * Explicitly instantiated for all supported client versions and lod levels in ADTObj.cpp.
+   * @tparam client_version Version of the game client.
+   * @tparam lod_level Lod level.
+   */
+  template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
+  class ADTObj : public Common::Traits::AutoIOTraitInterface
+                        <
+                          ADTObj<client_version, lod_level>
+                          , Common::Traits::TraitType::File
+                        >
+               , public Common::Traits::AutoIOTraits
+                        <
+                          Common::Traits::IOTrait
+                          <
+                            Common::Traits::ConditionalTrait
+                            <
+                              ADTObj0ModelStorageFilepath
+                              , lod_level == ADTObjLodLevel::NORMAL && client_version <= Common::ClientVersion::BFA
+                            >
+                          >
+                          , Common::Traits::IOTrait<LodLevelImpl<client_version, lod_level>>
+                          , Common::Traits::IOTrait
+                            <
+                              Common::Traits::ConditionalTrait
+                              <
+                                LodModelBatches
+                                , lod_level == ADTObjLodLevel::LOD && client_version >= Common::ClientVersion::SL
+                              >
+                            >
+                          , Common::Traits::IOTrait
+                            <
+                              Common::Traits::VersionTrait
+                              <
+                                ADTLodMapObjectBatches
+                                , client_version
+                                , Common::ClientVersion::BFA
+                              >
+                            >
+                          , Common::Traits::IOTrait
+                            <
+                              Common::Traits::VersionTrait
+                              <
+                                ADTDoodadsetOverrides
+                                , client_version
+                                , Common::ClientVersion::SL
+                              >
+                            >
+                        >
+  {
+    AutoIOTraitInterfaceUser;
+    static_assert(client_version >= Common::ClientVersion::CATA && "Split files did not exist before Cataclysm.");
+    static_assert((lod_level == ADTObjLodLevel::NORMAL || client_version >= Common::ClientVersion::LEGION)
+                  && "Lod files did not exist before Legion.");
+
+    using FileInterfaceT = Common::Traits::AutoIOTraitInterface<ADTObj, Common::Traits::TraitType::File>;
+
+  public:
+    explicit ADTObj(std::uint32_t file_data_id);
+    ADTObj(std::uint32_t file_data_id, Common::ByteBuffer const& buf);
+
+    using FileInterfaceT::Read;
+    using FileInterfaceT::Write;
+    using FileInterfaceT::ByteSize;
+
+    /**
+     * Reads the file. Instantiated once in the library, see ADTObj.cpp.
+     * @param buf Buffer containing the file.
+     */
+    void Read(Common::ByteBuffer const& buf);
+
+    /**
+     * Writes the file. Instantiated once in the library, see ADTObj.cpp.
+     * @param buf Buffer to write into.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+    /**
+     * Computes the exact size of the file in bytes, as it would be written with Write().
+     * @return Size of the file in bytes.
+     */
+    [[nodiscard]]
+    std::size_t ByteSize() const;
+
+    [[nodiscard]]
+    std::uint32_t FileDataID() const { return _file_data_id; };
+
+  private:
+    // This method converts MODF/MDDF references to filename offsets into filename indices.
+    void PatchObjectFilenameReferences()
+    requires (lod_level == ADTObjLodLevel::NORMAL && client_version <= Common::ClientVersion::BFA);
+
+    template
     <
-      Common::Traits::TraitEntry<&ADTDoodadsetOverrides::_wmo_doodadset_overrides>
-      , Common::Traits::TraitEntry<&ADTDoodadsetOverrides::_wmo_doodadset_overrides_ranges>
+      Common::Concepts::DataArrayChunkProtocol FilepathOffsetStorage
+      , Common::Concepts::StringBlockChunkProtocol FilepathStorage
+      , Common::Concepts::DataArrayChunkProtocol InstanceStorage
     >
-   > _auto_trait = {};
+    void PatchObjectFilenameReferences_detail(FilepathOffsetStorage& offset_storage
+                                              , FilepathStorage& filepath_storage
+                                              , InstanceStorage& instance_storage)
+    requires (lod_level == ADTObjLodLevel::NORMAL && client_version <= Common::ClientVersion::BFA);
+
+    std::uint32_t _file_data_id;
+
+    Common::DataChunk<std::uint32_t, ChunkIdentifiers::ADTCommonChunks::MVER> _version;
+
+    static constexpr
+    Common::Traits::AutoIOTrait
+    <
+      Common::Traits::TraitEntry
+      <
+        &ADTObj::_version
+        , Common::Traits::IOHandlerRead
+          <
+            nullptr
+            , []([[maybe_unused]] auto const* self, [[maybe_unused]] auto& ctx, [[maybe_unused]] auto& version
+                 , [[maybe_unused]] Common::ByteBuffer const& buf
+                 , [[maybe_unused]] Common::ChunkHeader const& chunk_header) -> void
+            {
+              InvariantF(CCodeZones::FILE_IO, version.data == 18, "Version must be 18.");
+            }
+          >
+      >
+    > _auto_trait {};
 
   };
 
 }
+
 #include <IO/ADT/Obj/ADTObj.inl>
-#endif // IO_ADT_OBJ_ADTOBJ_HPP
 
+namespace IO::ADT
+{
+  extern template class ADTObj<Common::ClientVersion::CATA, ADTObjLodLevel::NORMAL>;
+  extern template class ADTObj<Common::ClientVersion::MOP, ADTObjLodLevel::NORMAL>;
+  extern template class ADTObj<Common::ClientVersion::WOD, ADTObjLodLevel::NORMAL>;
+  extern template class ADTObj<Common::ClientVersion::LEGION, ADTObjLodLevel::NORMAL>;
+  extern template class ADTObj<Common::ClientVersion::BFA, ADTObjLodLevel::NORMAL>;
+  extern template class ADTObj<Common::ClientVersion::SL, ADTObjLodLevel::NORMAL>;
+  extern template class ADTObj<Common::ClientVersion::DF, ADTObjLodLevel::NORMAL>;
+  extern template class ADTObj<Common::ClientVersion::CLASSIC_NEW, ADTObjLodLevel::NORMAL>;
+  extern template class ADTObj<Common::ClientVersion::TBC_NEW, ADTObjLodLevel::NORMAL>;
+  extern template class ADTObj<Common::ClientVersion::WOTLK_NEW, ADTObjLodLevel::NORMAL>;
+
+  extern template class ADTObj<Common::ClientVersion::LEGION, ADTObjLodLevel::LOD>;
+  extern template class ADTObj<Common::ClientVersion::BFA, ADTObjLodLevel::LOD>;
+  extern template class ADTObj<Common::ClientVersion::SL, ADTObjLodLevel::LOD>;
+  extern template class ADTObj<Common::ClientVersion::DF, ADTObjLodLevel::LOD>;
+  extern template class ADTObj<Common::ClientVersion::CLASSIC_NEW, ADTObjLodLevel::LOD>;
+  extern template class ADTObj<Common::ClientVersion::TBC_NEW, ADTObjLodLevel::LOD>;
+  extern template class ADTObj<Common::ClientVersion::WOTLK_NEW, ADTObjLodLevel::LOD>;
+}
 
+#endif // IO_ADT_OBJ_ADTOBJ_HPP
@@ -4,9 +4,50 @@
 
 namespace IO::ADT
 {
+  template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
+  ADTObj<client_version, lod_level>::ADTObj(std::uint32_t file_data_id)
+  : _file_data_id(file_data_id)
+  {
+    _version.Initialize(18);
+  }
+
+  template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
+  ADTObj<client_version, lod_level>::ADTObj(std::uint32_t file_data_id, Common::ByteBuffer const& buf)
+  : _file_data_id(file_data_id)
+  {
+    Read(buf);
+  }
+
+  template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
+  void ADTObj<client_version, lod_level>::Read(Common::ByteBuffer const& buf)
+  {
+    LogDebugF(LCodeZones::FILE_IO, "Reading ADT Obj. Filedata ID: %d.", _file_data_id);
+    LogIndentScoped;
+
+    Common::Traits::DefaultTraitContext read_ctx {};
+    FileInterfaceT::Read(read_ctx, buf);
+  }
+
+  template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
+  void ADTObj<client_version, lod_level>::Write(Common::ByteBuffer& buf) const
+  {
+    LogDebugF(LCodeZones::FILE_IO, "Writing ADT Obj. Filedata ID: %d.", _file_data_id);
+    LogIndentScoped;
+
+    Common::Traits::DefaultTraitContext write_ctx {};
+    FileInterfaceT::Write(write_ctx, buf);
+  }
+
+  template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
+  std::size_t ADTObj<client_version, lod_level>::ByteSize() const
+  {
+    Common::Traits::DefaultTraitContext write_ctx {};
+    return FileInterfaceT::ByteSize(write_ctx);
+  }
+
   template<Common::ClientVersion client_version, ADTObjLodLevel lod_level>
   void ADTObj<client_version, lod_level>::PatchObjectFilenameReferences()
-  requires (lod_level == ADTObjLodLevel::NORMAL)
+  requires (lod_level == ADTObjLodLevel::NORMAL && client_version <= Common::ClientVersion::BFA)
   {
     InvariantF(CCodeZones::FILE_IO, this->_model_filename_offsets.IsInitialized()
                                     && this->_model_filenames.IsInitialized()
@@ -35,7 +76,7 @@ namespace IO::ADT
   void ADTObj<client_version, lod_level>::PatchObjectFilenameReferences_detail(FilepathOffsetStorage& offset_storage
                                                                                , FilepathStorage& filepath_storage
                                                                                , InstanceStorage& instance_storage)
-  requires (lod_level == ADTObjLodLevel::NORMAL)
+  requires (lod_level == ADTObjLodLevel::NORMAL && client_version <= Common::ClientVersion::BFA)
   {
     for (auto&& [i, model_placement]: future::enumerate(instance_storage))
     {
@@ -57,15 +98,17 @@ namespace IO::ADT
     }
   }
 
-  template<Common::ClientVersion client_version>
-  inline AdtObj0SpecificData<client_version>::AdtObj0SpecificData()
+  inline AdtObj0SpecificData::AdtObj0SpecificData()
   {
     _model_placements.Initialize();
     _map_object_placements.Initialize();
+    _chunks.Initialize(MCNKObj{}, Common::WorldConstants::CHUNKS_PER_TILE);
+
+    for (auto& chunk : _chunks)
+      chunk.Initialize();
   }
 
-  template<Common::ClientVersion client_version>
-  inline AdtObj1SpecificData<client_version>::AdtObj1SpecificData()
+  inline AdtObj1SpecificData::AdtObj1SpecificData()
   {
     _lod_map_object_placements.Initialize();
     _lod_map_object_extents.Initialize();
@@ -73,4 +116,4 @@ namespace IO::ADT
     _lod_mapping.Initialize();
   }
 
-}
\ No newline at end of file
+}
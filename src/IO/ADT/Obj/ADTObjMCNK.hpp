@@ -7,14 +7,21 @@
 
 namespace IO::ADT
 {
-  class MCNKObj : public Common::Traits::AutoIOTraitInterface
-                         <
-                           MCNKObj
-                           , Common::Traits::DefaultTraitContext
-                           , Common::Traits::DefaultTraitContext
-                           , Common::Traits::TraitType::Chunk
-                         >
+  /**
+   * Object related part of ADT MCNK, stored in obj0 split files.
+   */
+  class MCNKObj : public Common::ChunkCommon<ChunkIdentifiers::ADTObj0Chunks::MCNK>
+                , public Common::Traits::AutoIOTraitInterface<MCNKObj, Common::Traits::TraitType::Chunk>
   {
+    AutoIOTraitInterfaceUser;
+
+  public:
+    [[nodiscard]] auto& ModelReferences() { return _model_references; };
+    [[nodiscard]] auto const& ModelReferences() const { return _model_references; };
+
+    [[nodiscard]] auto& MapObjectReferences() { return _map_object_references; };
+    [[nodiscard]] auto const& MapObjectReferences() const { return _map_object_references; };
+
   private:
     Common::DataArrayChunk<std::uint32_t, ChunkIdentifiers::ADTObj0MCNKSubchunks::MCRD> _model_references;
     Common::DataArrayChunk<std::uint32_t, ChunkIdentifiers::ADTObj0MCNKSubchunks::MCRW> _map_object_references;
@@ -22,11 +29,8 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&MCNKObj::_model_references>
-        , Common::Traits::TraitEntry<&MCNKObj::_map_object_references>
-      >
-    > _auto_traits {};
+      Common::Traits::TraitEntry<&MCNKObj::_model_references>
+      , Common::Traits::TraitEntry<&MCNKObj::_map_object_references>
+    > _auto_trait {};
   };
-}
\ No newline at end of file
+}
@@ -0,0 +1,15 @@
+#include <IO/ADT/Root/ADTRoot.hpp>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+template class IO::ADT::ADTRoot<ClientVersion::CATA>;
+template class IO::ADT::ADTRoot<ClientVersion::MOP>;
+template class IO::ADT::ADTRoot<ClientVersion::WOD>;
+template class IO::ADT::ADTRoot<ClientVersion::LEGION>;
+template class IO::ADT::ADTRoot<ClientVersion::BFA>;
+template class IO::ADT::ADTRoot<ClientVersion::SL>;
+template class IO::ADT::ADTRoot<ClientVersion::DF>;
+template class IO::ADT::ADTRoot<ClientVersion::CLASSIC_NEW>;
+template class IO::ADT::ADTRoot<ClientVersion::TBC_NEW>;
+template class IO::ADT::ADTRoot<ClientVersion::WOTLK_NEW>;
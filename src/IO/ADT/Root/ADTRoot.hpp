@@ -5,27 +5,37 @@
 #include <IO/ADT/DataStructures.hpp>
 #include <IO/ADT/Root/ADTRootMCNK.hpp>
 #include <IO/ADT/Root/MH2O.hpp>
+#include <Utils/Misc/ForceInline.hpp>
 
 #include <array>
 #include <cstdint>
-#include <concepts>
 
 namespace IO::ADT
 {
   /**
-   * Implements a VersionTrait enabling terrain blend batches support for ADTRoot.
-   * Blend batches are responsible for seamlessly blending WMOs with terrain.
-   * @tparam ReadContext Any default constructible used as read context.
-   * @tparam WriteContext Any default constructible used as write context.
+   * Enables terrain blend meshes support for ADTRoot.
+   * Blend meshes are responsible for seamlessly blending WMOs with terrain.
    */
-  template<std::default_initializable ReadContext, std::default_initializable WriteContext>
   class BlendMeshes : public Common::Traits::AutoIOTraitInterface
                              <
-                               BlendMeshes<ReadContext, WriteContext>
-                               , ReadContext
-                               , WriteContext
+                               BlendMeshes
+                               , Common::Traits::TraitType::Component
                              >
   {
+    AutoIOTraitInterfaceUser;
+  public:
+    [[nodiscard]] FORCEINLINE auto& BlendMeshHeaders() { return _blend_mesh_headers; };
+    [[nodiscard]] FORCEINLINE auto const& BlendMeshHeaders() const { return _blend_mesh_headers; };
+
+    [[nodiscard]] FORCEINLINE auto& BlendMeshBoundingBoxes() { return _blend_mesh_bounding_boxes; };
+    [[nodiscard]] FORCEINLINE auto const& BlendMeshBoundingBoxes() const { return _blend_mesh_bounding_boxes; };
+
+    [[nodiscard]] FORCEINLINE auto& BlendMeshVertices() { return _blend_mesh_vertices; };
+    [[nodiscard]] FORCEINLINE auto const& BlendMeshVertices() const { return _blend_mesh_vertices; };
+
+    [[nodiscard]] FORCEINLINE auto& BlendMeshIndices() { return _blend_mesh_indices; };
+    [[nodiscard]] FORCEINLINE auto const& BlendMeshIndices() const { return _blend_mesh_indices; };
+
   protected:
     Common::DataArrayChunk<DataStructures::MBMH, ChunkIdentifiers::ADTRootChunks::MBMH> _blend_mesh_headers;
     Common::DataArrayChunk<DataStructures::MBBB, ChunkIdentifiers::ADTRootChunks::MBBB> _blend_mesh_bounding_boxes;
@@ -37,83 +47,130 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&BlendMeshes::_blend_mesh_headers>
-        , Common::Traits::TraitEntry<&BlendMeshes::_blend_mesh_bounding_boxes>
-        , Common::Traits::TraitEntry<&BlendMeshes::_blend_mesh_vertices>
-        , Common::Traits::TraitEntry<&BlendMeshes::_blend_mesh_indices>
-      >
-      , ReadContext
-      , WriteContext
+      Common::Traits::TraitEntry<&BlendMeshes::_blend_mesh_headers>
+      , Common::Traits::TraitEntry<&BlendMeshes::_blend_mesh_bounding_boxes>
+      , Common::Traits::TraitEntry<&BlendMeshes::_blend_mesh_vertices>
+      , Common::Traits::TraitEntry<&BlendMeshes::_blend_mesh_indices>
     > _auto_trait{};
   };
 
-  namespace details
-  {
-    struct ADTRootWriteContext
-    {
-      std::size_t header_pos = 0;
-      std::size_t liquid_pos = 0;
-      std::size_t mfbo_pos = 0;
-      std::uint32_t header_flags = 0;
-    };
-
-  }
-
+  /**
+   * Split ADT file containing terrain data (root).
+   * MVER and MHDR are handled manually, as MHDR offsets depend on the layout of the rest of the file.
+   * Explicitly instantiated for all supported client versions in ADTRoot.cpp.
+   * @tparam client_version Version of the game client.
+   */
   template<Common::ClientVersion client_version>
-  class ADTRoot : public Common::Traits::AutoIOTraits
+  class ADTRoot : public Common::Traits::AutoIOTraitInterface<ADTRoot<client_version>, Common::Traits::TraitType::File>
+                , public Common::Traits::AutoIOTraits
                          <
-                           Common::Traits::IOTraits
+                           Common::Traits::IOTrait
                            <
-                             Common::Traits::IOTrait
+                             Common::Traits::VersionTrait
                              <
-                               Common::Traits::VersionTrait
-                               <
-                                 BlendMeshes<Common::Traits::DefaultTraitContext, details::ADTRootWriteContext>
-                                 , client_version
-                                 , Common::ClientVersion::MOP
-                               >
+                               BlendMeshes
+                               , client_version
+                               , Common::ClientVersion::MOP
                              >
                            >
-                           , Common::Traits::DefaultTraitContext
-                           , details::ADTRootWriteContext
-                         >
-                , public Common::Traits::AutoIOTraitInterface
-                         <
-                           ADTRoot<client_version>
-                           , Common::Traits::DefaultTraitContext
-                           , details::ADTRootWriteContext
-                           , Common::Traits::TraitType::File
                          >
   {
+    AutoIOTraitInterfaceUser;
+    static_assert(client_version >= Common::ClientVersion::CATA && "Split files did not exist before Cataclysm.");
+
+    using FileInterfaceT = Common::Traits::AutoIOTraitInterface<ADTRoot, Common::Traits::TraitType::File>;
 
   public:
     explicit ADTRoot(std::uint32_t file_data_id);
     ADTRoot(std::uint32_t file_data_id, Common::ByteBuffer const& buf);
 
+    using FileInterfaceT::Read;
+    using FileInterfaceT::Write;
+    using FileInterfaceT::ByteSize;
+
+    /**
+     * Reads the file. Instantiated once in the library, see ADTRoot.cpp.
+     * @param buf Buffer containing the file.
+     */
+    void Read(Common::ByteBuffer const& buf);
+
+    /**
+     * Writes the file. Instantiated once in the library, see ADTRoot.cpp.
+     * @param buf Buffer to write into.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+    /**
+     * Computes the exact size of the file in bytes, as it would be written with Write().
+     * @return Size of the file in bytes.
+     */
+    [[nodiscard]]
+    std::size_t ByteSize() const;
+
     [[nodiscard]]
     std::uint32_t FileDataID() const { return _file_data_id; };
 
+    [[nodiscard]]
+    auto& Header() { return _header; };
+
+    [[nodiscard]]
+    auto const& Header() const { return _header; };
+
+    [[nodiscard]]
+    auto& Chunks() { return _chunks; };
+
+    [[nodiscard]]
+    auto const& Chunks() const { return _chunks; };
+
+    [[nodiscard]]
+    auto& Liquids() { return _liquids; };
+
+    [[nodiscard]]
+    auto const& Liquids() const { return _liquids; };
+
+    [[nodiscard]]
+    auto& FlightBounds() { return _flight_bounds; };
+
+    [[nodiscard]]
+    auto const& FlightBounds() const { return _flight_bounds; };
+
   private:
-    void WriteExtraPost(details::ADTRootWriteContext& ctx, Common::ByteBuffer& buf) const;
+    template<typename ReadContext>
+    bool ReadExtraPre(ReadContext& read_ctx, Common::ByteBuffer const& buf, Common::ChunkHeader const& chunk_header);
+
+    template<typename WriteContext>
+    void WriteExtraPre(WriteContext& write_ctx, Common::ByteBuffer& buf) const;
+
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSizeExtra(WriteContext& write_ctx) const;
+
+    [[nodiscard]]
+    std::uint64_t HashExtra(std::uint64_t seed) const;
+
+    void SaveStateExtra(Common::ByteBuffer& buf) const { _header.SaveState(buf); };
+
+    void LoadStateExtra(Common::ByteBuffer const& buf) { _header.LoadState(buf); };
+
+    /**
+     * Total size of unknown chunks written before the given write slots.
+     * @param first First write slot to account for (see Common::RawChunk::Position()).
+     * @param last Last write slot to account for.
+     * @return Number of bytes.
+     */
+    [[nodiscard]]
+    std::size_t UnknownChunksSizeBetween(std::size_t first, std::size_t last) const;
 
   private:
     std::uint32_t _file_data_id;
 
-    Common::DataChunk<DataStructures::MVER, ChunkIdentifiers::ADTCommonChunks::MVER> _version;
     Common::DataChunk<DataStructures::MHDR, ChunkIdentifiers::ADTRootChunks::MHDR> _header;
 
     Common::SparseChunkArray
     <
-      MCNKRoot
-      <
-        client_version
-        , Common::Traits::DefaultTraitContext
-        , details::ADTRootWriteContext
-      >
-      , 256
-      , 256
+      MCNKRoot<client_version>
+      , Common::WorldConstants::CHUNKS_PER_TILE
+      , Common::WorldConstants::CHUNKS_PER_TILE
     > _chunks;
 
     MH2O _liquids;
@@ -123,79 +180,10 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry
-        <
-          &ADTRoot::_version
-          , Common::Traits::IOHandlerRead
-            <
-              nullptr
-              , [](ADTRoot* self, auto& ctx, auto& version, Common::ByteBuffer const& buf, std::size_t size)
-              {
-                InvariantF(CCodeZones::FILE_IO, static_cast<std::uint32_t>(version) == 18, "Version must be 18");
-              }
-            >
-        >
-       , Common::Traits::TraitEntry
-         <
-           &ADTRoot::_header
-           , Common::Traits::IOHandlerRead<>
-           , Common::Traits::IOHandlerWrite
-           <
-             [](ADTRoot* self, details::ADTRootWriteContext& ctx, auto& version, Common::ByteBuffer& buf)
-             {
-                ctx.header_pos = buf.Tell();
-                return true;
-             }
-           >
-         >
-       , Common::Traits::TraitEntry
-         <
-          &ADTRoot::_chunks
-          , Common::Traits::IOHandlerRead
-            <
-              nullptr
-              , [](ADTRoot* self, auto& chunks, Common::ByteBuffer const& buf, std::size_t size)
-              {
-                InvariantF(CCodeZones::FILE_IO
-                           , std::all_of(chunks.begin(), chunks.end(), [](auto& chunk) { return chunk.IsInitialized(); })
-                           , "Expected to read exactly 256 chunks.");
-
-              }
-            >
-         >
-       , Common::Traits::TraitEntry
-         <
-           &ADTRoot::_liquids
-           , Common::Traits::IOHandlerRead<>
-           , Common::Traits::IOHandlerWrite
-             <
-               [](ADTRoot* self, details::ADTRootWriteContext& ctx, auto& liquids, Common::ByteBuffer& buf)
-               {
-                 ctx.liquid_pos = static_cast<std::uint32_t>(buf.Tell() - (ctx.header_pos + 8));
-                 return true;
-               }
-             >
-         >
-       , Common::Traits::TraitEntry
-         <
-           &ADTRoot::_flight_bounds
-           , Common::Traits::IOHandlerRead<>
-           , Common::Traits::IOHandlerWrite
-           <
-             [](ADTRoot* self, details::ADTRootWriteContext& ctx, auto& liquids, Common::ByteBuffer& buf)
-             {
-               ctx.mfbo_pos = static_cast<std::uint32_t>(buf.Tell() - (ctx.header_pos + 8));
-               ctx.header_flags += DataStructures::MHDRFlags::mhdr_MFBO;
-               return true;
-             }
-           >
-         >
-      >
-      , Common::Traits::DefaultTraitContext
-      , details::ADTRootWriteContext
-   > _auto_trait {};
+      Common::Traits::TraitEntry<&ADTRoot::_chunks>
+      , Common::Traits::TraitEntry<&ADTRoot::_liquids>
+      , Common::Traits::TraitEntry<&ADTRoot::_flight_bounds>
+    > _auto_trait {};
 
   };
 
@@ -203,4 +191,18 @@ namespace IO::ADT
 
 #include <IO/ADT/Root/ADTRoot.inl>
 
-#endif // IO_ADT_ROOT_ADTROOT_HPP
\ No newline at end of file
+namespace IO::ADT
+{
+  extern template class ADTRoot<Common::ClientVersion::CATA>;
+  extern template class ADTRoot<Common::ClientVersion::MOP>;
+  extern template class ADTRoot<Common::ClientVersion::WOD>;
+  extern template class ADTRoot<Common::ClientVersion::LEGION>;
+  extern template class ADTRoot<Common::ClientVersion::BFA>;
+  extern template class ADTRoot<Common::ClientVersion::SL>;
+  extern template class ADTRoot<Common::ClientVersion::DF>;
+  extern template class ADTRoot<Common::ClientVersion::CLASSIC_NEW>;
+  extern template class ADTRoot<Common::ClientVersion::TBC_NEW>;
+  extern template class ADTRoot<Common::ClientVersion::WOTLK_NEW>;
+}
+
+#endif // IO_ADT_ROOT_ADTROOT_HPP
@@ -4,6 +4,7 @@
 #include <Validation/Log.hpp>
 #include <Validation/Contracts.hpp>
 #include <Config/CodeZones.hpp>
+#include <Utils/Misc/Hash.hpp>
 
 namespace IO::ADT
 {
@@ -11,29 +12,145 @@ namespace IO::ADT
   ADTRoot<client_version>::ADTRoot(std::uint32_t file_data_id)
       : _file_data_id(file_data_id)
   {
+    _header.Initialize();
+    _chunks.Initialize(MCNKRoot<client_version>{}, Common::WorldConstants::CHUNKS_PER_TILE);
+
+    for (std::size_t i = 0; i < Common::WorldConstants::CHUNKS_PER_TILE; ++i)
+    {
+      auto& chunk = _chunks[i];
+      chunk.Initialize();
+      chunk.Header().IndexX = static_cast<std::uint32_t>(i % 16);
+      chunk.Header().IndexY = static_cast<std::uint32_t>(i / 16);
+    }
   }
 
   template<Common::ClientVersion client_version>
   ADTRoot<client_version>::ADTRoot(std::uint32_t file_data_id, Common::ByteBuffer const& buf)
       : _file_data_id(file_data_id)
   {
-    this->Read(buf);
+    Read(buf);
+  }
+
+  template<Common::ClientVersion client_version>
+  void ADTRoot<client_version>::Read(Common::ByteBuffer const& buf)
+  {
+    LogDebugF(LCodeZones::FILE_IO, "Reading ADT Root. Filedata ID: %d.", _file_data_id);
+    LogIndentScoped;
+
+    Common::Traits::DefaultTraitContext read_ctx {};
+    FileInterfaceT::Read(read_ctx, buf);
+
+    InvariantF(CCodeZones::FILE_IO, _header.IsInitialized(), "ADT Root file is missing MHDR.");
+  }
+
+  template<Common::ClientVersion client_version>
+  void ADTRoot<client_version>::Write(Common::ByteBuffer& buf) const
+  {
+    LogDebugF(LCodeZones::FILE_IO, "Writing ADT Root. Filedata ID: %d.", _file_data_id);
+    LogIndentScoped;
+
+    InvariantF(CCodeZones::FILE_IO, _header.IsInitialized(), "Attempted writing ADT Root without MHDR initialized.");
+
+    Common::Traits::DefaultTraitContext write_ctx {};
+    FileInterfaceT::Write(write_ctx, buf);
+  }
+
+  template<Common::ClientVersion client_version>
+  std::size_t ADTRoot<client_version>::ByteSize() const
+  {
+    Common::Traits::DefaultTraitContext write_ctx {};
+    return FileInterfaceT::ByteSize(write_ctx);
+  }
+
+  template<Common::ClientVersion client_version>
+  template<typename ReadContext>
+  inline bool ADTRoot<client_version>::ReadExtraPre(ReadContext& read_ctx
+                                                    , Common::ByteBuffer const& buf
+                                                    , Common::ChunkHeader const& chunk_header)
+  {
+    switch (chunk_header.fourcc)
+    {
+      case ChunkIdentifiers::ADTCommonChunks::MVER:
+      {
+        Common::DataChunk<std::uint32_t, ChunkIdentifiers::ADTCommonChunks::MVER> version{};
+        version.Read(read_ctx, buf, chunk_header.size);
+        InvariantF(CCodeZones::FILE_IO, version.data == 18, "Version must be 18.");
+        return true;
+      }
+      case ChunkIdentifiers::ADTRootChunks::MHDR:
+      {
+        _header.Read(read_ctx, buf, chunk_header.size);
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
+  template<Common::ClientVersion client_version>
+  template<typename WriteContext>
+  inline void ADTRoot<client_version>::WriteExtraPre(WriteContext& write_ctx, Common::ByteBuffer& buf) const
+  {
+    Common::DataChunk<std::uint32_t, ChunkIdentifiers::ADTCommonChunks::MVER> version{18};
+    version.Write(write_ctx, buf);
+
+    // offsets are relative to the start of MHDR data. Unknown chunks are written before their write slot:
+    // MVER and MHDR take slot 0, then _chunks, _liquids and _flight_bounds take slots 1 to 3.
+    std::size_t const n_liquids = _liquids.IsInitialized() ? 1 : 0;
+
+    std::size_t const liquids_offset = sizeof(DataStructures::MHDR) + _chunks.WriteSize(write_ctx)
+      + UnknownChunksSizeBetween(1, 2);
+
+    std::size_t const flight_bounds_offset = liquids_offset + _liquids.WriteSize(write_ctx)
+      + UnknownChunksSizeBetween(3, 3);
+
+    Common::DataChunk<DataStructures::MHDR, ChunkIdentifiers::ADTRootChunks::MHDR> header{_header.data};
+    header.data.mh2o = n_liquids ? static_cast<std::uint32_t>(liquids_offset) : 0;
+
+    if (_flight_bounds.IsInitialized())
+    {
+      header.data.flags |= DataStructures::MHDRFlags::mhdr_MFBO;
+      header.data.mfbo = static_cast<std::uint32_t>(flight_bounds_offset);
+    }
+    else
+    {
+      header.data.flags &= ~static_cast<std::uint32_t>(DataStructures::MHDRFlags::mhdr_MFBO);
+      header.data.mfbo = 0;
+    }
+
+    header.Write(write_ctx, buf);
+  }
+
+  template<Common::ClientVersion client_version>
+  template<typename WriteContext>
+  inline std::size_t ADTRoot<client_version>::WriteSizeExtra([[maybe_unused]] WriteContext& write_ctx) const
+  {
+    return 2 * sizeof(Common::ChunkHeader) + sizeof(std::uint32_t) + sizeof(DataStructures::MHDR);
+  }
+
+  template<Common::ClientVersion client_version>
+  inline std::uint64_t ADTRoot<client_version>::HashExtra(std::uint64_t seed) const
+  {
+    // offsets and the MFBO flag are derived from the layout on writing
+    DataStructures::MHDR header = _header.data;
+    header.flags &= ~static_cast<std::uint32_t>(DataStructures::MHDRFlags::mhdr_MFBO);
+    header.mh2o = 0;
+    header.mfbo = 0;
+
+    return Utils::Misc::HashCombine(seed, Utils::Misc::Hash64(&header, sizeof(header)));
   }
 
   template<Common::ClientVersion client_version>
-  void ADTRoot<client_version>::WriteExtraPost(details::ADTRootWriteContext& ctx, Common::ByteBuffer& buf) const
+  inline std::size_t ADTRoot<client_version>::UnknownChunksSizeBetween(std::size_t first, std::size_t last) const
   {
-    Common::DataChunk<DataStructures::MHDR, ChunkIdentifiers::ADTRootChunks::MHDR> header{};
-    header.Initialize();
-    header.data.flags |= ctx.header_flags;
-    header.data.mh2o = ctx.liquid_pos;
-    header.data.mfbo = ctx.mfbo_pos;
+    std::size_t size = 0;
 
-    std::size_t end_pos = buf.Tell();
+    for (auto& chunk : this->UnknownChunks())
+    {
+      if (chunk.Position() >= first && chunk.Position() <= last)
+        size += chunk.WriteSize();
+    }
 
-    // go back and write relevant header data
-    buf.Seek(ctx.header_pos);
-    header.Write(buf);
-    buf.Seek(end_pos);
+    return size;
   }
 }
@@ -6,25 +6,27 @@
 #include <IO/WorldConstants.hpp>
 #include <IO/Common.hpp>
 #include <IO/CommonTraits.hpp>
+#include <Utils/Misc/ForceInline.hpp>
 
-#include <concepts>
+#include <cstdint>
 
 namespace IO::ADT
 {
   /**
-   * Implements a VersionTrait enabling terrain blend batches support for MCNKRoot.
+   * Enables terrain blend batches support for MCNKRoot.
    * Blend batches are responsible for seamlessly blending WMOs with terrain.
-   * @tparam ReadContext Any default constructible used as read context.
-   * @tparam WriteContext Any default constructible used as write context.
    */
-  template<std::default_initializable ReadContext, std::default_initializable WriteContext>
   class MCNKRootBlendBatches : public Common::Traits::AutoIOTraitInterface
                                       <
-                                        MCNKRootBlendBatches<ReadContext, WriteContext>
-                                        , ReadContext
-                                        , WriteContext
+                                        MCNKRootBlendBatches
+                                        , Common::Traits::TraitType::Component
                                       >
   {
+    AutoIOTraitInterfaceUser;
+  public:
+    [[nodiscard]] FORCEINLINE auto& BlendBatches() { return _blend_batches; };
+    [[nodiscard]] FORCEINLINE auto const& BlendBatches() const { return _blend_batches; };
+
   protected:
     Common::DataArrayChunk
       <
@@ -39,44 +41,83 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&MCNKRootBlendBatches::_blend_batches>
-      >
-      , ReadContext
-      , WriteContext
+      Common::Traits::TraitEntry<&MCNKRootBlendBatches::_blend_batches>
     > _auto_trait{};
   };
 
-  template
-  <
-    Common::ClientVersion client_version
-    , std::default_initializable ReadContext
-    , std::default_initializable WriteContext
-  >
-  class MCNKRoot : public Common::Traits::AutoIOTraits
+  /**
+   * Terrain related part of ADT MCNK, stored in root files.
+   * The chunk header (SMChunk) precedes the sub-chunks and is handled as an inline header.
+   * @tparam client_version Version of the game client.
+   */
+  template<Common::ClientVersion client_version>
+  class MCNKRoot : public Common::ChunkCommon<ChunkIdentifiers::ADTRootChunks::MCNK>
+                 , public Common::Traits::AutoIOTraitInterface<MCNKRoot<client_version>, Common::Traits::TraitType::Chunk>
+                 , public Common::Traits::AutoIOTraits
                           <
-                            Common::Traits::IOTraits
+                            Common::Traits::IOTrait
                             <
-                              Common::Traits::IOTrait
+                              Common::Traits::VersionTrait
                               <
-                                Common::Traits::VersionTrait
-                                <
-                                  MCNKRootBlendBatches<ReadContext, WriteContext>
-                                  , client_version
-                                  , Common::ClientVersion::MOP
-                                >
+                                MCNKRootBlendBatches
+                                , client_version
+                                , Common::ClientVersion::MOP
                               >
                             >
-                            , ReadContext
-                            , WriteContext
                           >
   {
+    AutoIOTraitInterfaceUser;
+
   public:
     MCNKRoot();
 
+  // getters
+  public:
+    [[nodiscard]] FORCEINLINE auto& Header() { return _header; };
+    [[nodiscard]] FORCEINLINE auto const& Header() const { return _header; };
+
+    [[nodiscard]] FORCEINLINE auto& Heightmap() { return _heightmap; };
+    [[nodiscard]] FORCEINLINE auto const& Heightmap() const { return _heightmap; };
+
+    [[nodiscard]] FORCEINLINE auto& Normals() { return _normals; };
+    [[nodiscard]] FORCEINLINE auto const& Normals() const { return _normals; };
+
+    [[nodiscard]] FORCEINLINE auto& VertexLighting() { return _vertex_lighting; };
+    [[nodiscard]] FORCEINLINE auto const& VertexLighting() const { return _vertex_lighting; };
+
+    [[nodiscard]] FORCEINLINE auto& VertexColor() { return _vertex_color; };
+    [[nodiscard]] FORCEINLINE auto const& VertexColor() const { return _vertex_color; };
+
+    [[nodiscard]] FORCEINLINE auto& TBCWater() { return _tbc_water; };
+    [[nodiscard]] FORCEINLINE auto const& TBCWater() const { return _tbc_water; };
+
+    [[nodiscard]] FORCEINLINE auto& SoundEmitters() { return _sound_emitters; };
+    [[nodiscard]] FORCEINLINE auto const& SoundEmitters() const { return _sound_emitters; };
+
+    [[nodiscard]] FORCEINLINE auto& GroundEffectDisable() { return _groundeffect_disable; };
+    [[nodiscard]] FORCEINLINE auto const& GroundEffectDisable() const { return _groundeffect_disable; };
+
+  private:
+    template<typename ReadContext>
+    void ReadInlineHeader(ReadContext& read_ctx, Common::ByteBuffer const& buf);
+
+    template<typename WriteContext>
+    void WriteInlineHeader(WriteContext& write_ctx, Common::ByteBuffer& buf) const;
+
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSizeInlineHeader([[maybe_unused]] WriteContext& write_ctx) const { return sizeof(DataStructures::SMChunk); };
+
+    [[nodiscard]]
+    std::uint64_t HashExtra(std::uint64_t seed) const;
+
+    void SaveStateExtra(Common::ByteBuffer& buf) const { buf.Write(_header); };
+
+    void LoadStateExtra(Common::ByteBuffer const& buf) { buf.Read(_header); };
+
   private:
     DataStructures::SMChunk _header;
+
     Common::DataArrayChunk
     <
       float
@@ -104,15 +145,7 @@ namespace IO::ADT
       , Common::WorldConstants::CHUNK_BUF_SIZE
     > _vertex_color;
 
-    Common::DataArrayChunk
-    <
-      DataStructures::MCNREntry
-      , ChunkIdentifiers::ADTRootMCNKSubchunks::MCNR
-      , Common::FourCCEndian::Little
-      , Common::WorldConstants::CHUNK_BUF_SIZE
-      , Common::WorldConstants::CHUNK_BUF_SIZE
-    > _normals;
-
+    Common::DataChunk<DataStructures::MCNR, ChunkIdentifiers::ADTRootMCNKSubchunks::MCNR> _normals;
     Common::DataChunk<DataStructures::MCLQ, ChunkIdentifiers::ADTRootMCNKSubchunks::MCLQ> _tbc_water;
     Common::DataArrayChunk<DataStructures::MCSE, ChunkIdentifiers::ADTRootMCNKSubchunks::MCSE> _sound_emitters;
     Common::DataChunk<std::uint64_t, ChunkIdentifiers::ADTRootMCNKSubchunks::MCDD> _groundeffect_disable;
@@ -120,19 +153,13 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&MCNKRoot::_header>
-        , Common::Traits::TraitEntry<&MCNKRoot::_heightmap>
-        , Common::Traits::TraitEntry<&MCNKRoot::_vertex_lighting>
-        , Common::Traits::TraitEntry<&MCNKRoot::_vertex_color>
-        , Common::Traits::TraitEntry<&MCNKRoot::_normals>
-        , Common::Traits::TraitEntry<&MCNKRoot::_tbc_water>
-        , Common::Traits::TraitEntry<&MCNKRoot::_sound_emitters>
-        , Common::Traits::TraitEntry<&MCNKRoot::_groundeffect_disable>
-      >
-      , ReadContext
-      , WriteContext
+      Common::Traits::TraitEntry<&MCNKRoot::_heightmap>
+      , Common::Traits::TraitEntry<&MCNKRoot::_vertex_lighting>
+      , Common::Traits::TraitEntry<&MCNKRoot::_vertex_color>
+      , Common::Traits::TraitEntry<&MCNKRoot::_normals>
+      , Common::Traits::TraitEntry<&MCNKRoot::_tbc_water>
+      , Common::Traits::TraitEntry<&MCNKRoot::_sound_emitters>
+      , Common::Traits::TraitEntry<&MCNKRoot::_groundeffect_disable>
     > _auto_trait{};
 
   };
@@ -140,4 +167,4 @@ namespace IO::ADT
 
 #include <IO/ADT/Root/ADTRootMCNK.inl>
 
-#endif // IO_ADT_ROOT_ADTROOTMCNK_HPP
\ No newline at end of file
+#endif // IO_ADT_ROOT_ADTROOTMCNK_HPP
@@ -1,19 +1,56 @@
 #pragma once
 #include <IO/ADT/Root/ADTRootMCNK.hpp>
 #include <IO/ADT/ChunkIdentifiers.hpp>
+#include <Utils/Misc/Hash.hpp>
 
 namespace IO::ADT
 {
-  template
-  <
-    Common::ClientVersion client_version
-    , std::default_initializable ReadContext
-    , std::default_initializable WriteContext
-  >
-  MCNKRoot<client_version, ReadContext, WriteContext>::MCNKRoot()
+  template<Common::ClientVersion client_version>
+  MCNKRoot<client_version>::MCNKRoot()
+  : _header{}
   {
-    _heightmap.Initialize();
-    _normals.Initialize();
+    // heights and normals of a new chunk are zeroed, not left uninitialized
+    _heightmap.Initialize(0.f, Common::WorldConstants::CHUNK_BUF_SIZE);
+    _normals.Initialize(DataStructures::MCNR{});
+  }
+
+  template<Common::ClientVersion client_version>
+  template<typename ReadContext>
+  inline void MCNKRoot<client_version>::ReadInlineHeader([[maybe_unused]] ReadContext& read_ctx
+                                                         , Common::ByteBuffer const& buf)
+  {
+    buf.Read(_header);
   }
-}
 
+  template<Common::ClientVersion client_version>
+  template<typename WriteContext>
+  inline void MCNKRoot<client_version>::WriteInlineHeader([[maybe_unused]] WriteContext& write_ctx
+                                                          , Common::ByteBuffer& buf) const
+  {
+    buf.Write(_header);
+  }
+
+  template<Common::ClientVersion client_version>
+  inline std::uint64_t MCNKRoot<client_version>::HashExtra(std::uint64_t seed) const
+  {
+    // placement of the chunk and offsets derived from the layout are not content, so that identical chunks
+    // hash equal across tiles and maps
+    DataStructures::SMChunk header = _header;
+    header.IndexX = 0;
+    header.IndexY = 0;
+    header.position = {};
+    header.ofsLayer = 0;
+    header.ofsRefs = 0;
+    header.ofsAlpha = 0;
+    header.sizeAlpha = 0;
+    header.ofsShadow = 0;
+    header.sizeShadow = 0;
+    header.ofsSndEmitters = 0;
+    header.ofsLiquid = 0;
+    header.sizeLiquid = 0;
+    header.ofsMCCV = 0;
+    header.ofsMCLV = 0;
+
+    return Utils::Misc::HashCombine(seed, Utils::Misc::Hash64(&header, sizeof(header)));
+  }
+}
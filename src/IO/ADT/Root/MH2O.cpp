@@ -1,335 +1,517 @@
 #include <IO/ADT/Root/MH2O.hpp>
 #include <IO/ADT/ChunkIdentifiers.hpp>
 #include <Utils/Meta/Future.hpp>
+#include <Utils/Misc/Hash.hpp>
 
 #include <boost/range/combine.hpp>
 
 #include <cstdint>
 #include <cassert>
+#include <cstring>
 #include <algorithm>
+#include <limits>
+#include <unordered_map>
 
 using namespace IO::ADT;
 using namespace IO::ADT::ChunkIdentifiers;
 using namespace IO::Common;
 
 
+namespace IO::ADT
+{
+  namespace
+  {
+    constexpr std::size_t CHUNK_DIM = 8;
+
+    // true if [offset, offset + n_bytes) lies within MH2O data of the given size
+    constexpr bool InBounds(std::size_t offset, std::size_t n_bytes, std::size_t size)
+    {
+      return offset <= size && n_bytes <= size - offset;
+    }
+
+    struct VertexMembers
+    {
+      bool heights;
+      bool tex_coords;
+      bool depths;
+    };
+
+    constexpr VertexMembers Members(LiquidLayer::LiquidVertexFormat format)
+    {
+      switch (format)
+      {
+        case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH:
+          return { true, false, true };
+        case LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD:
+          return { true, true, false };
+        case LiquidLayer::LiquidVertexFormat::DEPTH:
+          return { false, false, true };
+        case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH_TEXCOORD:
+          return { true, true, true };
+      }
+
+      return {};
+    }
+
+    // byte offsets of the members within vertex data of n vertices
+    struct VertexOffsets
+    {
+      std::size_t tex_coords;
+      std::size_t depths;
+    };
+
+    constexpr VertexOffsets Offsets(LiquidLayer::LiquidVertexFormat format, std::size_t n)
+    {
+      VertexMembers const members = Members(format);
+      std::size_t const tex_coords = members.heights ? n * sizeof(float) : 0;
+      std::size_t const depths = tex_coords + (members.tex_coords ? n * sizeof(DataStructures::MH20UVMapEntry) : 0);
+
+      return { tex_coords, depths };
+    }
+
+    // bits of the exists bitmap used by a rectangle of n quads
+    constexpr std::uint64_t ExistsMask(std::size_t n)
+    {
+      return n >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << n) - 1;
+    }
+
+    /**
+     * Placement of liquid data in the file, shared by ByteSize() and Write().
+     * Blocks are deduplicated by content and written in order of their offsets, right after the chunk headers.
+     */
+    class LiquidDataLayout
+    {
+    public:
+      struct Block
+      {
+        char const* data;
+        std::size_t size;
+        std::uint32_t offset;
+      };
+
+      explicit LiquidDataLayout(std::array<LiquidChunk, 16 * 16> const& chunks)
+      {
+        std::size_t n_layers = 0;
+
+        for (auto& chunk : chunks)
+        {
+          n_layers += chunk.Layers().size();
+        }
+
+        // blocks point into these, they must not reallocate
+        _instances.reserve(n_layers);
+        _exists_bitmaps.reserve(n_layers);
+        _attributes.reserve(chunks.size());
+
+        for (auto&& [header, chunk] : boost::combine(headers, chunks))
+        {
+          if (chunk.Layers().empty())
+            continue;
+
+          std::size_t const first_instance = _instances.size();
+
+          for (auto& layer : chunk.Layers())
+          {
+            _instances.push_back(PlaceLayer(layer));
+          }
+
+          header.layer_count = static_cast<std::uint32_t>(chunk.Layers().size());
+          header.offset_instances = Place(_instances.data() + first_instance
+                                          , chunk.Layers().size() * sizeof(DataStructures::SMLiquidInstance));
+
+          if (chunk.Attributes().has_value())
+          {
+            _attributes.push_back({ chunk.Attributes()->fishable.to_ullong(), chunk.Attributes()->deep.to_ullong() });
+            header.offset_attributes = Place(&_attributes.back(), sizeof(DataStructures::SMLiquidChunkAttributes));
+          }
+        }
+      }
+
+      std::array<DataStructures::SMLiquidChunk, 16 * 16> headers {};
+      std::vector<Block> blocks;
+      std::size_t size = 16 * 16 * sizeof(DataStructures::SMLiquidChunk);
+
+    private:
+      DataStructures::SMLiquidInstance PlaceLayer(LiquidLayer const& layer)
+      {
+        std::uint64_t const mask = ExistsMask(layer.width * layer.height);
+        std::uint64_t const exists_bitmap = layer.exists_bitmap & mask;
+
+        EnsureF(CCodeZones::FILE_IO, exists_bitmap, "Attempted to write unused liquid layer. Editor code should clean those up.");
+
+        DataStructures::SMLiquidInstance instance {};
+        instance.liquid_type = layer.liquid_type;
+        instance.liquid_object_or_lvf = layer.GetLiquidObjectOrLVF();
+        instance.min_height_level = layer.min_height_level;
+        instance.max_height_level = layer.max_height_level;
+        instance.x_offset = layer.x_offset;
+        instance.y_offset = layer.y_offset;
+        instance.width = layer.width;
+        instance.height = layer.height;
+
+        // the bitmap can be omitted when all quads of the rectangle exist
+        if (exists_bitmap != mask)
+        {
+          _exists_bitmaps.push_back(exists_bitmap);
+          instance.offset_exists_bitmap = Place(&_exists_bitmaps.back(), (layer.width * layer.height + 7) / 8);
+        }
+
+        if (layer.HasVertexData())
+        {
+          std::size_t const vertex_data_size = layer.VertexCount() * LiquidLayer::VertexSize(layer.liquid_vertex_format);
+
+          EnsureF(CCodeZones::FILE_IO, layer.vertex_data.size() == vertex_data_size
+                  , "MH2O layer: vertex data is %d bytes, expected %d.", layer.vertex_data.size(), vertex_data_size);
+
+          instance.offset_vertex_data = Place(layer.vertex_data.data(), vertex_data_size);
+        }
+
+        return instance;
+      }
+
+      std::uint32_t Place(void const* data, std::size_t block_size)
+      {
+        auto const bytes = static_cast<char const*>(data);
+        auto const [it, is_new] = _index.try_emplace(Utils::Misc::Hash64(bytes, block_size), blocks.size());
+
+        if (!is_new)
+        {
+          Block const& block = blocks[it->second];
+
+          if (block.size == block_size && !std::memcmp(block.data, bytes, block_size))
+            return block.offset;
+        }
+
+        EnsureF(CCodeZones::FILE_IO, size + block_size <= std::numeric_limits<std::uint32_t>::max(), "Chunk size overflow.");
+
+        auto const offset = static_cast<std::uint32_t>(size);
+        blocks.push_back({ bytes, block_size, offset });
+        size += block_size;
+
+        return offset;
+      }
+
+      std::vector<DataStructures::SMLiquidInstance> _instances;
+      std::vector<std::uint64_t> _exists_bitmaps;
+      std::vector<DataStructures::SMLiquidChunkAttributes> _attributes;
+      std::unordered_map<std::uint64_t, std::size_t> _index;
+    };
+  }
+}
+
 void MH2O::Read(Common::ByteBuffer const& buf, std::size_t size)
 {
   LogDebugF(LCodeZones::FILE_IO, "Loading ADT root chunk MH2O.");
 
-  std::size_t data_pos = buf.Tell();
+  std::size_t const data_pos = buf.Tell();
 
   std::array<DataStructures::SMLiquidChunk, 16 * 16> header_chunks{};
+
+  // offsets are validated in release builds too, malformed liquids are skipped instead of being read out of bounds
+  if (!InBounds(0, sizeof(header_chunks), size)) [[unlikely]]
+  {
+    LogError("MH2O: chunk of %zu bytes is too small to hold its header, liquids are skipped.", size);
+    buf.Seek(data_pos + size);
+    return;
+  }
+
   buf.Read(header_chunks.begin(), header_chunks.end());
 
-  
-  for (auto&& [header_chunk, chunk] : boost::combine(header_chunks, _chunks))
+  for (std::size_t i = 0; i < header_chunks.size(); ++i)
   {
+    DataStructures::SMLiquidChunk const& header_chunk = header_chunks[i];
+    LiquidChunk& chunk = _chunks[i];
 
     if (!header_chunk.layer_count) [[unlikely]]
     {
        continue;
     }
-    
-    std::vector<DataStructures::SMLiquidInstance> layer_instances;
-
-    layer_instances.resize(header_chunk.layer_count);
-
-    buf.Seek(data_pos + header_chunk.offset_instances);
-    buf.Read(layer_instances.begin(), layer_instances.end());
-
-    bool has_attributes = header_chunk.offset_attributes;
 
     // attributes can be omitted for all-0 height liquids, in this case the offset is zero.
-    if (has_attributes) [[likely]]
+    if (header_chunk.offset_attributes) [[likely]]
     {
-      DataStructures::SMLiquidChunkAttributes attributes;
+      if (InBounds(header_chunk.offset_attributes, sizeof(DataStructures::SMLiquidChunkAttributes), size))
+      {
+        DataStructures::SMLiquidChunkAttributes attributes;
+        buf.Read(attributes, data_pos + header_chunk.offset_attributes);
+        chunk.AddAttributes(attributes);
+      }
+      else
+      {
+        LogError("MH2O: attributes of chunk %zu are out of bounds, skipped.", i);
+      }
+    }
 
-      buf.Seek(data_pos + header_chunk.offset_attributes);
-      buf.Read(attributes);
-      chunk.AddAttributes(attributes);
+    if (!InBounds(header_chunk.offset_instances
+                  , std::size_t{header_chunk.layer_count} * sizeof(DataStructures::SMLiquidInstance), size))
+    {
+      LogError("MH2O: layers of chunk %zu are out of bounds, skipped.", i);
+      continue;
     }
-    
-    chunk.Layers().resize(header_chunk.layer_count);
-    
-    for (auto&& [layer, instance] : boost::combine(chunk.Layers(), layer_instances))
+
+    chunk.Layers().clear();
+    chunk.Layers().reserve(header_chunk.layer_count);
+
+    for (std::size_t l = 0; l < header_chunk.layer_count; ++l)
     {
+      DataStructures::SMLiquidInstance instance;
+      buf.Read(instance, data_pos + header_chunk.offset_instances + l * sizeof(DataStructures::SMLiquidInstance));
+
+      LiquidLayer layer {};
       layer.min_height_level = instance.min_height_level;
       layer.max_height_level = instance.max_height_level;
-
-      // handle liquid instance
       layer.liquid_type = instance.liquid_type;
       layer.SetLiquidObjectOrLiquidVertexFormat(instance.liquid_object_or_lvf);
 
-      // handle exists map, we un-compress it to a 64-bit full bitset for convenience
-      std::uint8_t offset_index = instance.y_offset * 8 + instance.x_offset;
-      std::uint8_t n_used_bits = instance.width * instance.height;
+      layer.x_offset = instance.x_offset;
+      layer.y_offset = instance.y_offset;
+      layer.width = instance.width;
+      layer.height = instance.height;
 
-      layer.exists_map = std::bitset<64>(0);
+      std::size_t const n_quads = instance.width * instance.height;
+      std::size_t const n_bitmap_bytes = (n_quads + 7) / 8;
+      std::size_t const n_vertex_bytes = layer.VertexCount() * LiquidLayer::VertexSize(layer.liquid_vertex_format);
 
-      if (instance.offset_exists_bitmap)
+      if (!instance.width || !instance.height || instance.x_offset + instance.width > CHUNK_DIM
+          || instance.y_offset + instance.height > CHUNK_DIM) [[unlikely]]
       {
-        buf.Seek(data_pos + instance.offset_exists_bitmap);
+        LogError("MH2O: layer %zu of chunk %zu has a bad liquid rectangle, skipped.", l, i);
+        continue;
+      }
 
-        std::uint8_t n_bytes_to_read = (instance.width * instance.height + 7) / 8;
-        EnsureF(CCodeZones::FILE_IO, n_bytes_to_read <= 8, "MH2O: bad exists bitmap");
+      if ((instance.offset_exists_bitmap && !InBounds(instance.offset_exists_bitmap, n_bitmap_bytes, size))
+          || (instance.offset_vertex_data && !InBounds(instance.offset_vertex_data, n_vertex_bytes, size))) [[unlikely]]
+      {
+        LogError("MH2O: data of layer %zu of chunk %zu is out of bounds, skipped.", l, i);
+        continue;
+      }
 
-        std::uint64_t exists_bitmap = 0;
-        buf.Read(reinterpret_cast<char*>(&exists_bitmap), n_bytes_to_read);
+      layer.exists_bitmap = ExistsMask(n_quads);
 
-        if (!offset_index)
-        {
-          layer.exists_map = std::bitset<64>(exists_bitmap);
-        }
-        else
-        {
-          auto bitmap_no_offset = std::bitset<64>(exists_bitmap);
-          for (int i = 0; i < n_used_bits; ++i)
-          {
-            layer.exists_map[offset_index + i] = bitmap_no_offset[i];
-          }
-        }
+      if (instance.offset_exists_bitmap)
+      {
+        layer.exists_bitmap = 0;
+        buf.Read(reinterpret_cast<char*>(&layer.exists_bitmap), data_pos + instance.offset_exists_bitmap
+                 , n_bitmap_bytes);
+        layer.exists_bitmap &= ExistsMask(n_quads);
       }
 
-      // handle vertex data
-
       if (instance.offset_vertex_data)
       {
-        layer.has_vertex_data = true;
-        buf.Seek(data_pos + instance.offset_vertex_data);
+        layer.vertex_data.resize(n_vertex_bytes);
+        buf.Read(layer.vertex_data.data(), data_pos + instance.offset_vertex_data, layer.vertex_data.size());
+      }
 
-        std::uint8_t offset = instance.y_offset * 8 + instance.x_offset;
-        std::uint8_t end_offset = offset + (instance.width + 1) * (instance.height + 1);
+      chunk.Layers().push_back(std::move(layer));
+    }
+  }
 
-        switch (layer.liquid_vertex_format)
-        {
-          case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH:
-          {
-            auto& layer_data = layer.vertex_data.emplace<DataStructures::MH2OHeightDepth>();
-            buf.Read(layer_data.heightmap.begin() + offset, layer_data.heightmap.begin() + end_offset);
-            buf.Read(layer_data.depthmap.begin() + offset, layer_data.depthmap.begin() + end_offset);
-            break;
-          }
-          case LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD:
-          {
-            auto& layer_data = layer.vertex_data.emplace<DataStructures::MH2OHeightTexCoord>();
-            buf.Read(layer_data.heightmap.begin() + offset, layer_data.heightmap.begin() + end_offset);
-            buf.Read(layer_data.uvmap.begin() + offset, layer_data.uvmap.begin() + end_offset);
-            break;
-          }
-          case LiquidLayer::LiquidVertexFormat::DEPTH:
-          {
-            auto& layer_data = layer.vertex_data.emplace<DataStructures::MH2ODepth>();
-            buf.Read(layer_data.depthmap.begin() + offset, layer_data.depthmap.begin() + end_offset);
-            break;
-          }
-          case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH_TEXCOORD:
-          {
-            auto& layer_data = layer.vertex_data.emplace<DataStructures::MH2OHeightDepthTexCoord>();
-            buf.Read(layer_data.heightmap.begin() + offset, layer_data.heightmap.begin() + end_offset);
-            buf.Read(layer_data.depthmap.begin() + offset, layer_data.depthmap.begin() + end_offset);
-            buf.Read(layer_data.uvmap.begin() + offset, layer_data.uvmap.begin() + end_offset);
-            break;
-          }
+  // chunks without liquid are skipped, so the position has to be restored explicitly
+  buf.Seek(data_pos + size);
 
-        }
-      }
+  _is_initialized = true;
+}
 
-    }
+void MH2O::Write(Common::ByteBuffer& buf) const
+{
+  if (!_is_initialized) [[unlikely]]
+    return;
 
-    buf.Seek(data_pos + size);
+  LiquidDataLayout const layout {_chunks};
+
+  LogDebugF(LCodeZones::FILE_IO, "Writing chunk: MH20, size: %d.", layout.size);
+
+  EnsureF(CCodeZones::FILE_IO, layout.size <= std::numeric_limits<std::uint32_t>::max(), "Chunk size overflow.");
 
+  ChunkHeader chunk_header{ADTRootChunks::MH2O, static_cast<std::uint32_t>(layout.size)};
+  buf.Write(chunk_header);
+  buf.Write(layout.headers.begin(), layout.headers.end());
+
+  for (auto& block : layout.blocks)
+  {
+    buf.Write(block.data, block.size);
   }
+}
 
+std::size_t MH2O::ByteSize() const
+{
+  return LiquidDataLayout{_chunks}.size;
 }
 
-void MH2O::Write(Common::ByteBuffer& buf) const
+void LiquidLayer::AllocateVertexData()
 {
-  LogDebugF(LCodeZones::FILE_IO, "Writing chunk: MH20.");
+  vertex_data.assign(VertexCount() * VertexSize(liquid_vertex_format), 0);
+}
 
-  std::size_t pos = buf.Tell();
+std::span<float> LiquidLayer::Heights()
+{
+  if (vertex_data.empty() || !Members(liquid_vertex_format).heights)
+    return {};
 
-  // writing chunk header to just initialize buffer bytes
-  ChunkHeader chunk_header{};
-  buf.Write(chunk_header);
+  return { reinterpret_cast<float*>(vertex_data.data()), VertexCount() };
+}
 
-  std::size_t data_pos = buf.Tell();
+std::span<float const> LiquidLayer::Heights() const
+{
+  return const_cast<LiquidLayer*>(this)->Heights();
+}
 
-  std::array<DataStructures::SMLiquidChunk, 16 * 16> header_chunks{};
-  buf.Reserve(16 * 16 * sizeof(DataStructures::SMLiquidChunk));
+std::span<IO::ADT::DataStructures::MH20UVMapEntry> LiquidLayer::TexCoords()
+{
+  if (vertex_data.empty() || !Members(liquid_vertex_format).tex_coords)
+    return {};
 
-  for (auto&& [header_chunk, chunk] : boost::range::combine(header_chunks, _chunks))
-  {
-    header_chunk.layer_count = static_cast<std::uint32_t>(chunk.Layers().size());
+  std::size_t const offset = Offsets(liquid_vertex_format, VertexCount()).tex_coords;
+  return { reinterpret_cast<DataStructures::MH20UVMapEntry*>(vertex_data.data() + offset), VertexCount() };
+}
 
-    if (header_chunk.layer_count)
-    {
-      std::size_t instances_pos = buf.Tell();
-      header_chunk.offset_instances = static_cast<std::uint32_t>(buf.Tell() - data_pos);
+std::span<IO::ADT::DataStructures::MH20UVMapEntry const> LiquidLayer::TexCoords() const
+{
+  return const_cast<LiquidLayer*>(this)->TexCoords();
+}
 
-      std::vector<DataStructures::SMLiquidInstance> liquid_instances;
-      liquid_instances.resize(header_chunk.layer_count);
+std::span<std::uint8_t> LiquidLayer::Depths()
+{
+  if (vertex_data.empty() || !Members(liquid_vertex_format).depths)
+    return {};
 
-      // allocate space for all layers
-      buf.Reserve(header_chunk.layer_count * sizeof(DataStructures::SMLiquidInstance));
+  std::size_t const offset = Offsets(liquid_vertex_format, VertexCount()).depths;
+  return { reinterpret_cast<std::uint8_t*>(vertex_data.data() + offset), VertexCount() };
+}
 
-      // fill layers
-      for (auto&& [layer, instance] : boost::combine(chunk.Layers(), liquid_instances))
-      {
-        instance.liquid_object_or_lvf = layer.GetLiquidObjectOrLVF();
-        instance.liquid_type = layer.liquid_type;
+std::span<std::uint8_t const> LiquidLayer::Depths() const
+{
+  return const_cast<LiquidLayer*>(this)->Depths();
+}
 
-        EnsureF(CCodeZones::FILE_IO, layer.exists_map.to_ullong(), "Attempted to write unused liquid layer. Editor code should clean those up.");
+bool LiquidLayer::Exists(std::size_t x, std::size_t y) const
+{
+  RequireF(CCodeZones::FILE_IO, x < CHUNK_DIM && y < CHUNK_DIM, "Quad index out of bounds.");
 
-        bool all_exist = true;
-        for (std::uint8_t i = 0; i < 64; ++i)
-        {
-          if (!layer.exists_map[i])
-          {
-            all_exist = false;
-            break;
-          }
-        }
+  if (x < x_offset || y < y_offset || x >= x_offset + width || y >= y_offset + height)
+    return false;
 
-        if (all_exist)
-        {
-          instance.x_offset = 0;
-          instance.y_offset = 0;
-          instance.width = 8;
-          instance.height = 8;
-          instance.offset_exists_bitmap = 0;
-        }
-        else
-        {
+  return (exists_bitmap >> ((y - y_offset) * width + x - x_offset)) & 1;
+}
 
-          // identify the used rectangle
-          std::uint8_t begin = 0;
-          std::uint8_t end = 0;
+std::uint64_t LiquidLayer::ExistsMap() const
+{
+  std::uint64_t exists_map = 0;
 
-          for (std::uint8_t i = 0; i < 64; ++i)
-          {
-            if (layer.exists_map[i])
-            {
-              begin = i;
-              break;
-            }
-          }
+  for (std::size_t y = 0; y < height; ++y)
+  {
+    std::uint64_t const row = (exists_bitmap >> (y * width)) & ExistsMask(width);
+    exists_map |= row << ((y_offset + y) * CHUNK_DIM + x_offset);
+  }
 
-          for (std::int8_t i = 63; i >= 0; --i)
-          {
-            if (layer.exists_map[i])
-            {
-              end = i;
-              break;
-            }
-          }
+  return exists_map;
+}
 
-          instance.x_offset = begin % 8;
-          instance.y_offset = begin / 8;
+void LiquidLayer::SetExistsMap(std::uint64_t exists_map)
+{
+  RequireF(CCodeZones::FILE_IO, exists_map, "Liquid layer must have at least one quad.");
 
-          instance.width = (end % 8) - (begin % 8) + 1;
-          instance.height = (end / 8) - (begin / 8) + 1;
+  std::size_t x_min = CHUNK_DIM;
+  std::size_t y_min = CHUNK_DIM;
+  std::size_t x_max = 0;
+  std::size_t y_max = 0;
 
-          // identify the number of bytes required to store
+  for (std::size_t i = 0; i < CHUNK_DIM * CHUNK_DIM; ++i)
+  {
+    if ((exists_map >> i) & 1)
+    {
+      x_min = std::min(x_min, i % CHUNK_DIM);
+      y_min = std::min(y_min, i / CHUNK_DIM);
+      x_max = std::max(x_max, i % CHUNK_DIM);
+      y_max = std::max(y_max, i / CHUNK_DIM);
+    }
+  }
 
-          std::uint8_t n_exists_bitmap_bytes = (instance.width * instance.height + 7) / 8;
+  SetRect(static_cast<std::uint8_t>(x_min), static_cast<std::uint8_t>(y_min)
+          , static_cast<std::uint8_t>(x_max - x_min + 1), static_cast<std::uint8_t>(y_max - y_min + 1));
 
-          std::bitset<64> bitmap_temp{0};
-          std::uint8_t counter = 0;
-          for (std::uint8_t i = begin; i <= end; ++i)
-          {
-            bitmap_temp[counter] = layer.exists_map[i];
-            counter++;
-          }
+  exists_bitmap = 0;
 
-          std::uint64_t exists_bitmap = bitmap_temp.to_ullong();
+  for (std::size_t y = 0; y < height; ++y)
+  {
+    std::uint64_t const row = (exists_map >> ((y_offset + y) * CHUNK_DIM + x_offset)) & ExistsMask(width);
+    exists_bitmap |= row << (y * width);
+  }
+}
 
-          instance.offset_exists_bitmap = static_cast<std::uint32_t>(buf.Tell() - data_pos);
-          buf.Write(reinterpret_cast<char*>(&exists_bitmap), n_exists_bitmap_bytes);
-        }
+void LiquidLayer::SetRect(std::uint8_t new_x_offset, std::uint8_t new_y_offset, std::uint8_t new_width, std::uint8_t new_height)
+{
+  RequireF(CCodeZones::FILE_IO, new_width && new_height && new_x_offset + new_width <= CHUNK_DIM
+           && new_y_offset + new_height <= CHUNK_DIM, "Bad liquid rectangle.");
 
-        // write vertex data
-        if (layer.has_vertex_data)
-        {
-          instance.offset_vertex_data = static_cast<std::uint32_t>(buf.Tell() - data_pos);
+  LiquidLayer const old = *this;
 
-          EnsureF(CCodeZones::FILE_IO, layer.vertex_data.index() == static_cast<unsigned>(layer.liquid_vertex_format),
-                  "MH2O layer: wrong vertex format, expected %d, got %d.", static_cast<unsigned>(layer.liquid_vertex_format), layer.vertex_data.index());
+  x_offset = new_x_offset;
+  y_offset = new_y_offset;
+  width = new_width;
+  height = new_height;
 
-          std::uint8_t begin_offset = instance.y_offset * 8 + instance.x_offset;
-          std::uint8_t end_offset = begin_offset + (instance.width + 1) * (instance.height + 1);
-          switch (layer.liquid_vertex_format)
-          {
-            case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH:
-            {
-              auto& layer_data = std::get<DataStructures::MH2OHeightDepth>(layer.vertex_data);
-
-              buf.Write(layer_data.heightmap.begin() + begin_offset, layer_data.heightmap.begin() + end_offset);
-              buf.Write(layer_data.depthmap.begin() + begin_offset, layer_data.depthmap.begin() + end_offset);
-              break;
-            }
-            case LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD:
-            {
-              auto& layer_data = std::get<DataStructures::MH2OHeightTexCoord>(layer.vertex_data);
-              buf.Write(layer_data.heightmap.begin() + begin_offset, layer_data.heightmap.begin() + end_offset);
-              buf.Write(layer_data.uvmap.begin() + begin_offset, layer_data.uvmap.begin() + end_offset);
-              break;
-            }
-            case LiquidLayer::LiquidVertexFormat::DEPTH:
-            {
-              auto& layer_data = std::get<DataStructures::MH2ODepth>(layer.vertex_data);
-              buf.Write(layer_data.depthmap.begin() + begin_offset, layer_data.depthmap.begin() + end_offset);
-              break;
-            }
-            case LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH_TEXCOORD:
-            {
-              auto& layer_data = std::get<DataStructures::MH2OHeightDepthTexCoord>(layer.vertex_data);
-              buf.Write(layer_data.heightmap.begin() + begin_offset, layer_data.heightmap.begin() + end_offset);
-              buf.Write(layer_data.depthmap.begin() + begin_offset, layer_data.depthmap.begin() + end_offset);
-              buf.Write(layer_data.uvmap.begin() + begin_offset, layer_data.uvmap.begin() + end_offset);
-              break;
-            }
-          }
-        }
-        else
-        {
-          instance.offset_vertex_data = 0;
-        }
-      }
+  exists_bitmap = 0;
 
-      std::size_t end_pos = buf.Tell();
+  for (std::size_t y = 0; y < height; ++y)
+  {
+    for (std::size_t x = 0; x < width; ++x)
+    {
+      exists_bitmap |= std::uint64_t{old.Exists(x_offset + x, y_offset + y)} << (y * width + x);
+    }
+  }
 
-      // actually write instance data
-      buf.Seek(instances_pos);
-      buf.Write(liquid_instances.begin(), liquid_instances.end());
+  if (!old.HasVertexData())
+    return;
 
-      buf.Seek(end_pos);
+  AllocateVertexData();
 
-      // handle attributes
-      if (chunk.Attributes().has_value())
-      {
-        header_chunk.offset_attributes = static_cast<std::uint32_t>(buf.Tell() - data_pos);
-        DataStructures::SMLiquidChunkAttributes attrs{chunk.Attributes()->fishable.to_ullong(), chunk.Attributes()->deep.to_ullong()};
-        buf.Write(attrs);
-      }
-      else
+  [[maybe_unused]] std::size_t const vertex_size = VertexSize(liquid_vertex_format);
+  VertexOffsets const old_offsets = Offsets(liquid_vertex_format, old.VertexCount());
+  VertexOffsets const new_offsets = Offsets(liquid_vertex_format, VertexCount());
+  VertexMembers const members = Members(liquid_vertex_format);
+
+  // members are planar, each one is copied at its own offset and element size
+  auto const copy = [&](std::size_t old_offset, std::size_t new_offset, std::size_t element_size) -> void
+  {
+    for (std::size_t y = 0; y <= height; ++y)
+    {
+      for (std::size_t x = 0; x <= width; ++x)
       {
-        header_chunk.offset_attributes = 0;
+        std::size_t const vx = x_offset + x;
+        std::size_t const vy = y_offset + y;
+
+        if (vx < old.x_offset || vy < old.y_offset || vx > old.x_offset + old.width || vy > old.y_offset + old.height)
+          continue;
+
+        std::size_t const old_index = (vy - old.y_offset) * (old.width + 1u) + vx - old.x_offset;
+        std::size_t const new_index = y * (width + 1u) + x;
+
+        std::memcpy(vertex_data.data() + new_offset + new_index * element_size
+                    , old.vertex_data.data() + old_offset + old_index * element_size, element_size);
       }
     }
-    else
-    {
-      header_chunk.offset_attributes = 0;
-      header_chunk.offset_instances = 0;
-    }
+  };
 
-  }
+  if (members.heights)
+    copy(0, 0, sizeof(float));
 
-  // go back and write relevant header data
-  std::size_t end_pos = buf.Tell();
-  buf.Seek(pos);
-  buf.Write(header_chunks.begin(), header_chunks.end());
-  buf.Seek(end_pos);
+  if (members.tex_coords)
+    copy(old_offsets.tex_coords, new_offsets.tex_coords, sizeof(DataStructures::MH20UVMapEntry));
+
+  if (members.depths)
+    copy(old_offsets.depths, new_offsets.depths, sizeof(std::uint8_t));
+
+  EnsureF(CCodeZones::FILE_IO, vertex_data.size() == VertexCount() * vertex_size, "Vertex data size mismatch.");
+}
+
+std::size_t LiquidLayer::VertexSize(LiquidVertexFormat format)
+{
+  VertexMembers const members = Members(format);
+
+  return (members.heights ? sizeof(float) : 0)
+    + (members.tex_coords ? sizeof(DataStructures::MH20UVMapEntry) : 0)
+    + (members.depths ? sizeof(std::uint8_t) : 0);
 }
 
 void LiquidLayer::SetLiquidObjectOrLiquidVertexFormat(std::uint16_t liquid_object_or_lvf)
@@ -350,3 +532,127 @@ std::uint16_t IO::ADT::LiquidLayer::GetLiquidObjectOrLVF() const
   // TODO: get back here
   return static_cast<std::uint16_t>(this->liquid_vertex_format);
 }
+
+std::uint64_t MH2O::Hash() const
+{
+  using namespace Utils::Misc;
+
+  if (!_is_initialized) [[unlikely]]
+    return 0;
+
+  std::uint64_t hash = ADTRootChunks::MH2O;
+
+  for (auto& chunk : _chunks)
+  {
+    auto const& attributes = chunk.Attributes();
+    hash = HashCombine(hash, attributes.has_value());
+
+    if (attributes)
+    {
+      hash = HashCombine(hash, attributes->fishable.to_ullong());
+      hash = HashCombine(hash, attributes->deep.to_ullong());
+    }
+
+    hash = HashCombine(hash, chunk.Layers().size());
+
+    for (auto& layer : chunk.Layers())
+    {
+      hash = HashCombine(hash, layer.liquid_type);
+      hash = HashCombine(hash, static_cast<std::uint64_t>(layer.liquid_vertex_format));
+      hash = HashCombine(hash, Hash64(&layer.min_height_level, sizeof(float)));
+      hash = HashCombine(hash, Hash64(&layer.max_height_level, sizeof(float)));
+      hash = HashCombine(hash, layer.x_offset | layer.y_offset << 8 | layer.width << 16 | layer.height << 24);
+      hash = HashCombine(hash, layer.exists_bitmap & ExistsMask(layer.width * layer.height));
+      hash = HashCombine(hash, Hash64(layer.vertex_data.data(), layer.vertex_data.size()));
+    }
+  }
+
+  return hash;
+}
+
+void MH2O::SaveState(Common::ByteBuffer& buf) const
+{
+  buf.Write(_is_initialized);
+
+  if (!_is_initialized)
+    return;
+
+  for (auto& chunk : _chunks)
+  {
+    auto const& attributes = chunk.Attributes();
+    buf.Write(attributes.has_value());
+
+    if (attributes)
+    {
+      buf.Write(static_cast<std::uint64_t>(attributes->fishable.to_ullong()));
+      buf.Write(static_cast<std::uint64_t>(attributes->deep.to_ullong()));
+    }
+
+    buf.Write(static_cast<std::uint64_t>(chunk.Layers().size()));
+
+    for (auto& layer : chunk.Layers())
+    {
+      buf.Write(layer.liquid_type);
+      buf.Write(static_cast<std::uint32_t>(layer.liquid_vertex_format));
+      buf.Write(layer.min_height_level);
+      buf.Write(layer.max_height_level);
+      buf.Write(layer.x_offset);
+      buf.Write(layer.y_offset);
+      buf.Write(layer.width);
+      buf.Write(layer.height);
+      buf.Write(layer.exists_bitmap);
+      buf.Write(static_cast<std::uint64_t>(layer.vertex_data.size()));
+
+      if (layer.HasVertexData())
+      {
+        buf.Write(layer.vertex_data.begin(), layer.vertex_data.end());
+      }
+    }
+  }
+}
+
+void MH2O::LoadState(Common::ByteBuffer const& buf)
+{
+  buf.Read(_is_initialized);
+
+  for (auto& chunk : _chunks)
+  {
+    chunk.Attributes().reset();
+    chunk.Layers().clear();
+  }
+
+  if (!_is_initialized)
+    return;
+
+  for (auto& chunk : _chunks)
+  {
+    if (buf.Read<bool>())
+    {
+      auto const fishable = buf.Read<std::uint64_t>();
+      auto const deep = buf.Read<std::uint64_t>();
+      chunk.AddAttributes(fishable, deep);
+    }
+
+    auto const n_layers = static_cast<std::size_t>(buf.Read<std::uint64_t>());
+    chunk.Layers().resize(n_layers);
+
+    for (auto& layer : chunk.Layers())
+    {
+      buf.Read(layer.liquid_type);
+      layer.liquid_vertex_format = static_cast<LiquidLayer::LiquidVertexFormat>(buf.Read<std::uint32_t>());
+      buf.Read(layer.min_height_level);
+      buf.Read(layer.max_height_level);
+      buf.Read(layer.x_offset);
+      buf.Read(layer.y_offset);
+      buf.Read(layer.width);
+      buf.Read(layer.height);
+      buf.Read(layer.exists_bitmap);
+      layer.vertex_data.resize(static_cast<std::size_t>(buf.Read<std::uint64_t>()));
+
+      if (layer.HasVertexData())
+      {
+        buf.Read(layer.vertex_data.begin(), layer.vertex_data.end());
+      }
+    }
+  }
+}
@@ -1,14 +1,20 @@
 #pragma once
 #include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
 #include <IO/Common.hpp>
 
 #include <array>
-#include <variant>
 #include <bitset>
 #include <optional>
+#include <span>
+#include <vector>
 
 namespace IO::ADT
 {
+  /**
+   * Liquid instance of a chunk. Covers a rectangle of quads of the chunk, and only stores data of that rectangle.
+   * Exists bitmap and vertex data are row-major within the rectangle, as in the file.
+   */
   struct LiquidLayer
   {
     enum class LiquidVertexFormat
@@ -24,16 +30,81 @@ namespace IO::ADT
     float min_height_level;
     float max_height_level;
 
-    std::bitset<64> exists_map = {0};
+    std::uint8_t x_offset = 0;                ///> Horizontal index of the first quad of the rectangle (0-7).
+    std::uint8_t y_offset = 0;                ///> Vertical index of the first quad of the rectangle (0-7).
+    std::uint8_t width = 8;                   ///> Width of the rectangle in quads (1-8).
+    std::uint8_t height = 8;                  ///> Height of the rectangle in quads (1-8).
 
-    bool has_vertex_data = false;
+    std::uint64_t exists_bitmap = ~std::uint64_t{0};   ///> Bit y * width + x is set if quad (x, y) of the rectangle exists.
 
-    std::variant<DataStructures::MH2OHeightDepth, DataStructures::MH2OHeightTexCoord, DataStructures::MH2ODepth, DataStructures::MH2OHeightDepthTexCoord> vertex_data;
+    /**
+     * Vertex data in the file layout: heights, then texture coordinates, then depths, for the members present in
+     * the vertex format. Empty if the layer has no vertex data.
+     */
+    std::vector<char> vertex_data;
 
     void SetLiquidObjectOrLiquidVertexFormat(std::uint16_t liquid_object_or_lvf);
 
     [[nodiscard]]
     std::uint16_t GetLiquidObjectOrLVF() const;
+
+    /**
+     * @return Number of vertices of the rectangle, (width + 1) * (height + 1).
+     */
+    [[nodiscard]]
+    std::size_t VertexCount() const { return (width + 1u) * (height + 1u); };
+
+    [[nodiscard]]
+    bool HasVertexData() const { return !vertex_data.empty(); };
+
+    /**
+     * Allocates zero-initialized vertex data for the rectangle and the vertex format.
+     */
+    void AllocateVertexData();
+
+    [[nodiscard]] std::span<float> Heights();
+    [[nodiscard]] std::span<float const> Heights() const;
+
+    [[nodiscard]] std::span<DataStructures::MH20UVMapEntry> TexCoords();
+    [[nodiscard]] std::span<DataStructures::MH20UVMapEntry const> TexCoords() const;
+
+    [[nodiscard]] std::span<std::uint8_t> Depths();
+    [[nodiscard]] std::span<std::uint8_t const> Depths() const;
+
+    /**
+     * @param x Horizontal index of the quad in the chunk (0-7).
+     * @param y Vertical index of the quad in the chunk (0-7).
+     * @return True if the quad exists.
+     */
+    [[nodiscard]]
+    bool Exists(std::size_t x, std::size_t y) const;
+
+    /**
+     * @return Exists bitmap expanded to the whole chunk, bit y * 8 + x is set if quad (x, y) of the chunk exists.
+     */
+    [[nodiscard]]
+    std::uint64_t ExistsMap() const;
+
+    /**
+     * Sets existing quads of the chunk, shrinking the rectangle to the bounding box of existing quads.
+     * Vertex data of the new rectangle is kept where it overlaps the previous one, zero elsewhere.
+     * @param exists_map Bit y * 8 + x is set if quad (x, y) of the chunk exists, must not be 0.
+     */
+    void SetExistsMap(std::uint64_t exists_map);
+
+    /**
+     * Sets the rectangle covered by the layer. Quads outside of the previous rectangle do not exist. Vertex data is
+     * kept where the rectangles overlap, zero elsewhere.
+     */
+    void SetRect(std::uint8_t x_offset, std::uint8_t y_offset, std::uint8_t width, std::uint8_t height);
+
+    /**
+     * Size of a vertex in bytes.
+     * @param format Vertex format.
+     * @return Number of bytes.
+     */
+    [[nodiscard]]
+    static std::size_t VertexSize(LiquidVertexFormat format);
   };
 
   class LiquidChunk
@@ -80,15 +151,80 @@ namespace IO::ADT
   public:
     MH2O() = default;
 
+    /**
+     * Reads liquid data. Offsets are followed directly within the buffer, the position is moved past the chunk.
+     * @param buf Buffer positioned at the beginning of chunk data.
+     * @param size Size of chunk data in bytes.
+     */
     void Read(Common::ByteBuffer const& buf, std::size_t size);
+
+    /**
+     * Writes liquid data. Identical instance arrays, attributes, exists bitmaps and vertex data blocks are stored
+     * once and referenced by all their users, identified by a content hash and confirmed by comparison.
+     * @param buf Buffer to write to.
+     */
     void Write(Common::ByteBuffer& buf) const;
 
+    template<typename ReadContext>
+    void Read([[maybe_unused]] ReadContext& ctx, Common::ByteBuffer const& buf, std::size_t size) { Read(buf, size); };
+
+    template<typename WriteContext>
+    void Write([[maybe_unused]] WriteContext& ctx, Common::ByteBuffer& buf) const { Write(buf); };
+
+    /**
+     * Size of the liquid data in bytes, as it would be written with Write() (without header).
+     * Runs the same layout computation as Write(), without writing anything.
+     * @return Number of bytes.
+     */
+    [[nodiscard]]
+    std::size_t ByteSize() const;
+
+    /**
+     * Exact number of bytes written by Write() (with header). 0 for an uninitialized chunk.
+     * @tparam WriteContext Write context.
+     * @return Number of bytes.
+     */
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSize([[maybe_unused]] WriteContext& ctx) const
+    {
+      return _is_initialized ? sizeof(Common::ChunkHeader) + ByteSize() : 0;
+    };
+
     [[nodiscard]]
     bool IsInitialized() const { return _is_initialized; }
 
+    void Initialize() { _is_initialized = true; };
+
     [[nodiscard]]
     std::array<LiquidChunk, 16 * 16>& chunks() { return _chunks; }
 
+    [[nodiscard]]
+    std::array<LiquidChunk, 16 * 16> const& chunks() const { return _chunks; }
+
+    /**
+     * Structural hash of the liquid data of all 256 chunks. 0 for an uninitialized chunk. Not cached, computed on demand.
+     * @return Hash value.
+     */
+    [[nodiscard]]
+    std::uint64_t Hash() const;
+
+    /**
+     * Writes the in-memory state of the liquid data, see Traits::AutoIOTraitInterface SaveState(). Instances are
+     * written as they are held, without the deduplication of Write().
+     * @param buf Buffer to write into.
+     */
+    void SaveState(Common::ByteBuffer& buf) const;
+
+    /**
+     * Restores the in-memory state of the liquid data written by SaveState().
+     * @param buf Buffer to read from.
+     */
+    void LoadState(Common::ByteBuffer const& buf);
+
+    static constexpr std::uint32_t magic = ChunkIdentifiers::ADTRootChunks::MH2O;
+    static constexpr Common::FourCCEndian magic_endian = Common::FourCCEndian::Little;
+
   private:
     std::array<LiquidChunk, 16 * 16> _chunks;
     bool _is_initialized = false;
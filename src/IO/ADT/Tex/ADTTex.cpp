@@ -0,0 +1,15 @@
+#include <IO/ADT/Tex/ADTTex.hpp>
+
+using namespace IO::ADT;
+using namespace IO::Common;
+
+template class IO::ADT::ADTTex<ClientVersion::CATA>;
+template class IO::ADT::ADTTex<ClientVersion::MOP>;
+template class IO::ADT::ADTTex<ClientVersion::WOD>;
+template class IO::ADT::ADTTex<ClientVersion::LEGION>;
+template class IO::ADT::ADTTex<ClientVersion::BFA>;
+template class IO::ADT::ADTTex<ClientVersion::SL>;
+template class IO::ADT::ADTTex<ClientVersion::DF>;
+template class IO::ADT::ADTTex<ClientVersion::CLASSIC_NEW>;
+template class IO::ADT::ADTTex<ClientVersion::TBC_NEW>;
+template class IO::ADT::ADTTex<ClientVersion::WOTLK_NEW>;
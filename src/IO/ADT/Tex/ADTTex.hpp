@@ -2,6 +2,7 @@
 #define IO_ADT_TEX_ADTTEX_HPP
 
 #include <IO/Common.hpp>
+#include <IO/CommonTraits.hpp>
 #include <IO/ADT/DataStructures.hpp>
 #include <IO/ADT/Tex/ADTTexMCNK.hpp>
 #include <IO/ADT/Tex/MCAL.hpp>
@@ -12,17 +13,21 @@
 
 namespace IO::ADT
 {
-
+  /**
+   * Read context of ADTTex.
+   */
   struct ADTTexReadContext
   {
-    MCAL::AlphaFormat alpha_format;
-    bool fix_alphamap;
+    AlphaFormat alpha_format = AlphaFormat::HIGHRES; ///> Format of alpha maps (see WDT MPHD flags).
+    bool fix_alpha = false; ///> Restore the last row and column of lowres alpha and shadow maps.
   };
 
+  /**
+   * Write context of ADTTex.
+   */
   struct ADTTexWriteContext
   {
-    MCAL::AlphaFormat alpha_format;
-    bool fix_alphamap;
+    AlphaFormat alpha_format = AlphaFormat::HIGHRES; ///> Format of alpha maps (see WDT MPHD flags).
   };
 
   /**
@@ -31,10 +36,10 @@ namespace IO::ADT
   class ADTTexTextureStorageFDID : public Common::Traits::AutoIOTraitInterface
                                           <
                                             ADTTexTextureStorageFDID
-                                            , ADTTexReadContext
-                                            , ADTTexWriteContext
+                                            , Common::Traits::TraitType::Component
                                           >
   {
+    AutoIOTraitInterfaceUser;
   protected:
     Common::DataArrayChunk<std::uint32_t, ChunkIdentifiers::ADTTexChunks::MDID> _diffuse_textures;
     Common::DataArrayChunk<std::uint32_t, ChunkIdentifiers::ADTTexChunks::MHID> _height_textures;
@@ -43,13 +48,8 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&ADTTexTextureStorageFDID::_diffuse_textures>
-        , Common::Traits::TraitEntry<&ADTTexTextureStorageFDID::_height_textures>
-      >
-      , ADTTexReadContext
-      , ADTTexWriteContext
+      Common::Traits::TraitEntry<&ADTTexTextureStorageFDID::_diffuse_textures>
+      , Common::Traits::TraitEntry<&ADTTexTextureStorageFDID::_height_textures>
     > _auto_trait {};
   };
 
@@ -59,10 +59,10 @@ namespace IO::ADT
   class ADTTexTextureStorageFilepath : public Common::Traits::AutoIOTraitInterface
                                               <
                                                 ADTTexTextureStorageFilepath
-                                                , ADTTexReadContext
-                                                , ADTTexWriteContext
+                                                , Common::Traits::TraitType::Component
                                               >
   {
+    AutoIOTraitInterfaceUser;
   protected:
     Common::StringBlockChunk
     <
@@ -75,12 +75,7 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&ADTTexTextureStorageFilepath::_diffuse_textures>
-      >
-      , ADTTexReadContext
-      , ADTTexWriteContext
+      Common::Traits::TraitEntry<&ADTTexTextureStorageFilepath::_diffuse_textures>
     > _auto_trait {};
   };
 
@@ -90,10 +85,10 @@ namespace IO::ADT
   class ADTTexTextureParameters : public Common::Traits::AutoIOTraitInterface
                                          <
                                            ADTTexTextureParameters
-                                           , ADTTexReadContext
-                                           , ADTTexWriteContext
+                                           , Common::Traits::TraitType::Component
                                          >
   {
+    AutoIOTraitInterfaceUser;
   protected:
     Common::DataArrayChunk<DataStructures::SMTextureParams, ChunkIdentifiers::ADTTexChunks::MTXP> _texture_params;
 
@@ -101,12 +96,7 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&ADTTexTextureParameters::_texture_params>
-      >
-      , ADTTexReadContext
-      , ADTTexWriteContext
+      Common::Traits::TraitEntry<&ADTTexTextureParameters::_texture_params>
     > _auto_trait {};
   };
 
@@ -116,10 +106,10 @@ namespace IO::ADT
   class ADTTexColorGrading : public Common::Traits::AutoIOTraitInterface
                                     <
                                       ADTTexColorGrading
-                                      , ADTTexReadContext
-                                      , ADTTexWriteContext
+                                      , Common::Traits::TraitType::Component
                                     >
   {
+    AutoIOTraitInterfaceUser;
   protected:
     Common::DataArrayChunk<DataStructures::MTCG, ChunkIdentifiers::ADTTexChunks::MTCG> _color_grading;
 
@@ -127,76 +117,148 @@ namespace IO::ADT
     static constexpr
     Common::Traits::AutoIOTrait
     <
-      Common::Traits::TraitEntries
-      <
-        Common::Traits::TraitEntry<&ADTTexColorGrading::_color_grading>
-      >
+      Common::Traits::TraitEntry<&ADTTexColorGrading::_color_grading>
     > _auto_trait {};
   };
 
+  /**
+   * Split ADT file containing texturing data (tex0).
+   * Explicitly instantiated for all supported client versions in ADTTex.cpp.
+   * @tparam client_version Version of the game client.
+   */
   template<Common::ClientVersion client_version>
-  class ADTTex : public Common::Traits::AutoIOTraits
+  class ADTTex : public Common::Traits::AutoIOTraitInterface<ADTTex<client_version>, Common::Traits::TraitType::File>
+               , public Common::Traits::AutoIOTraits
                         <
-                          Common::Traits::IOTraits
+                          Common::Traits::IOTrait
                           <
-                            Common::Traits::IOTrait
+                            std::conditional_t
                             <
-                              std::conditional_t
+                              client_version < Common::ClientVersion::BFA
+                              , ADTTexTextureStorageFilepath
+                              , ADTTexTextureStorageFDID
+                            >
+                          >
+                          , Common::Traits::IOTrait
+                            <
+                              Common::Traits::VersionTrait
                               <
-                                client_version < Common::ClientVersion::BFA
-                                , ADTTexTextureStorageFilepath
-                                , ADTTexTextureStorageFDID
+                                ADTTexTextureParameters
+                                , client_version
+                                , Common::ClientVersion::MOP
                               >
                             >
-                            , Common::Traits::IOTrait
+                          , Common::Traits::IOTrait
+                            <
+                              Common::Traits::VersionTrait
                               <
-                                Common::Traits::VersionTrait
-                                <
-                                  ADTTexColorGrading,
-                                  Common::ClientVersion::SL
-                                >
+                                ADTTexColorGrading
+                                , client_version
+                                , Common::ClientVersion::SL
                               >
-                          >
-                          , ADTTexReadContext
-                          , ADTTexWriteContext
+                            >
                         >
-              , public Common::Traits::AutoIOTraitInterface
-                       <
-                         ADTTex<client_version>
-                         , ADTTexReadContext
-                         , ADTTexWriteContext
-                         , Common::Traits::TraitType::File
-                       >
   {
-  static_assert(client_version >= Common::ClientVersion::CATA && "Split files did not exist before Cataclysm.");
+    AutoIOTraitInterfaceUser;
+    static_assert(client_version >= Common::ClientVersion::CATA && "Split files did not exist before Cataclysm.");
+
+    using FileInterfaceT = Common::Traits::AutoIOTraitInterface<ADTTex, Common::Traits::TraitType::File>;
+
   public:
     explicit ADTTex(std::uint32_t file_data_id);
     ADTTex(std::uint32_t file_data_id
            , Common::ByteBuffer const& buf
-           , MCAL::AlphaFormat alpha_format
-           , bool fix_alphamap);
+           , AlphaFormat alpha_format
+           , bool fix_alpha);
 
-  private:
+    using FileInterfaceT::Read;
+    using FileInterfaceT::Write;
+    using FileInterfaceT::ByteSize;
+
+    /**
+     * Reads the file. Instantiated once in the library, see ADTTex.cpp.
+     * @param buf Buffer containing the file.
+     * @param alpha_format Format of alpha maps (see WDT MPHD flags).
+     * @param fix_alpha Restore the last row and column of lowres alpha and shadow maps.
+     */
+    void Read(Common::ByteBuffer const& buf, AlphaFormat alpha_format, bool fix_alpha);
+
+    /**
+     * Writes the file. Instantiated once in the library, see ADTTex.cpp.
+     * @param buf Buffer to write into.
+     * @param alpha_format Format of alpha maps (see WDT MPHD flags).
+     */
+    void Write(Common::ByteBuffer& buf, AlphaFormat alpha_format) const;
+
+    /**
+     * Computes the exact size of the file in bytes, as it would be written with Write().
+     * @param alpha_format Format of alpha maps (see WDT MPHD flags).
+     * @return Size of the file in bytes.
+     */
+    [[nodiscard]]
+    std::size_t ByteSize(AlphaFormat alpha_format) const;
+
+    [[nodiscard]]
+    std::uint32_t FileDataID() const { return _file_data_id; };
+
+    [[nodiscard]]
+    auto& Chunks() { return _chunks; };
+
+    [[nodiscard]]
+    auto const& Chunks() const { return _chunks; };
 
+  private:
     std::uint32_t _file_data_id;
 
-    std::array<MCNKTex, Common::WorldConstants::CHUNKS_PER_TILE> _chunks;
+    Common::DataChunk<std::uint32_t, ChunkIdentifiers::ADTCommonChunks::MVER> _version;
+    Common::SparseChunkArray
+    <
+      MCNKTex
+      , Common::WorldConstants::CHUNKS_PER_TILE
+      , Common::WorldConstants::CHUNKS_PER_TILE
+    > _chunks;
 
     Common::DataArrayChunk<DataStructures::SMTextureFlags, ChunkIdentifiers::ADTTexChunks::MTXF> _texture_flags;
     Common::DataChunk<std::uint8_t, ChunkIdentifiers::ADTTexChunks::MAMP> _texture_amplifier;
 
     static constexpr
     Common::Traits::AutoIOTrait
+    <
+      Common::Traits::TraitEntry
       <
-        Common::Traits::TraitEntries
+        &ADTTex::_version
+        , Common::Traits::IOHandlerRead
           <
-            Common::Traits::TraitEntry<&ADTTex::_chunks>
-            , Common::Traits::TraitEntry<&ADTTex::_texture_flags>
-            , Common::Traits::TraitEntry<&ADTTex::_texture_amplifier>
+            nullptr
+            , []([[maybe_unused]] auto const* self, [[maybe_unused]] auto& ctx, [[maybe_unused]] auto& version
+                 , [[maybe_unused]] Common::ByteBuffer const& buf
+                 , [[maybe_unused]] Common::ChunkHeader const& chunk_header) -> void
+            {
+              InvariantF(CCodeZones::FILE_IO, version.data == 18, "Version must be 18.");
+            }
           >
-      > _auto_trait {};
+      >
+      , Common::Traits::TraitEntry<&ADTTex::_chunks>
+      , Common::Traits::TraitEntry<&ADTTex::_texture_flags>
+      , Common::Traits::TraitEntry<&ADTTex::_texture_amplifier>
+    > _auto_trait {};
   };
 }
 
 #include <IO/ADT/Tex/ADTTex.inl>
-#endif
\ No newline at end of file
+
+namespace IO::ADT
+{
+  extern template class ADTTex<Common::ClientVersion::CATA>;
+  extern template class ADTTex<Common::ClientVersion::MOP>;
+  extern template class ADTTex<Common::ClientVersion::WOD>;
+  extern template class ADTTex<Common::ClientVersion::LEGION>;
+  extern template class ADTTex<Common::ClientVersion::BFA>;
+  extern template class ADTTex<Common::ClientVersion::SL>;
+  extern template class ADTTex<Common::ClientVersion::DF>;
+  extern template class ADTTex<Common::ClientVersion::CLASSIC_NEW>;
+  extern template class ADTTex<Common::ClientVersion::TBC_NEW>;
+  extern template class ADTTex<Common::ClientVersion::WOTLK_NEW>;
+}
+
+#endif // IO_ADT_TEX_ADTTEX_HPP
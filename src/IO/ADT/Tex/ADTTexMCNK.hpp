@@ -4,6 +4,7 @@
 #include <IO/ADT/ChunkIdentifiers.hpp>
 #include <IO/WorldConstants.hpp>
 #include <IO/Common.hpp>
+#include <IO/CommonTraits.hpp>
 #include <IO/ADT/Tex/MCSH.hpp>
 #include <IO/ADT/Tex/MCAL.hpp>
 #include <Utils/Misc/ForceInline.hpp>
@@ -13,43 +14,42 @@
 
 namespace IO::ADT
 {
-
+  /**
+   * Checks if type can be used as a read context of MCNKTex.
+   * @tparam T Any type.
+   */
   template<typename T>
-  concept MCNKTexReadContext = MCALReadContext<T>;
-
+  concept MCNKTexReadContext = requires (T t)
+                               {
+                                 { t.alpha_format } -> std::same_as<AlphaFormat&>;
+                                 { t.fix_alpha } -> std::same_as<bool&>;
+                               };
+
+  /**
+   * Checks if type can be used as a write context of MCNKTex.
+   * @tparam T Any type.
+   */
   template<typename T>
-  concept MCNKTexWriteContext = MCALWriteContext<T>;
-
-  template<MCNKTexReadContext ReadContext, MCNKTexWriteContext WriteContext>
-  class MCNKTex
+  concept MCNKTexWriteContext = requires (T t)
+                                {
+                                  { t.alpha_format } -> std::same_as<AlphaFormat&>;
+                                };
+
+  /**
+   * Texture related part of ADT MCNK, stored in tex0 split files.
+   * Alpha maps (MCAL) are interpreted using texture layers (MCLY), hence they are not processed automatically.
+   * Read context must satisfy MCNKTexReadContext, write context must satisfy MCNKTexWriteContext.
+   */
+  class MCNKTex : public Common::ChunkCommon<ChunkIdentifiers::ADTTexChunks::MCNK>
+                , public Common::Traits::AutoIOTraitInterface<MCNKTex, Common::Traits::TraitType::Chunk>
   {
-  public:
+    AutoIOTraitInterfaceUser;
 
   public:
     MCNKTex() = default;
 
-    void Read(ReadContext& read_ctx, Common::ByteBuffer const& buf, std::size_t size);
-
-    void  Write(WriteContext& write_ctx, Common::ByteBuffer& buf) const;
-
-    [[nodiscard]]
-    FORCEINLINE bool IsInitialized() const { return true; };
-
     void AddShadow() { _shadowmap.Initialize(); }
 
-    private:
-      Common::DataArrayChunk
-      <
-        DataStructures::SMLayer
-        , ChunkIdentifiers::ADTTexMCNKSubchunks::MCLY
-        , Common::FourCCEndian::Little
-        , 0
-        , 4
-      > _alpha_layers;
-
-      MCSH _shadowmap;
-      MCAL<ReadContext, WriteContext> _alphamaps;
-
   // getters
   public:
     [[nodiscard]] FORCEINLINE auto& AlphaLayers() { return _alpha_layers; };
@@ -60,5 +60,37 @@ namespace IO::ADT
 
     [[nodiscard]] FORCEINLINE auto& Alphamaps() { return _alphamaps; };
     [[nodiscard]] FORCEINLINE auto const& Alphamaps() const { return _alphamaps; };
+
+  private:
+    template<typename ReadContext>
+    bool ReadExtraPre(ReadContext& read_ctx, Common::ByteBuffer const& buf, Common::ChunkHeader const& chunk_header);
+
+    template<typename WriteContext>
+    void WriteExtraPost(WriteContext& write_ctx, Common::ByteBuffer& buf) const;
+
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSizeExtra(WriteContext& write_ctx) const;
+
+    [[nodiscard]]
+    std::uint64_t HashExtra(std::uint64_t seed) const;
+
+    void SaveStateExtra(Common::ByteBuffer& buf) const { _alphamaps.SaveState(buf); };
+
+    void LoadStateExtra(Common::ByteBuffer const& buf) { _alphamaps.LoadState(buf); };
+
+  private:
+    MCLYChunk _alpha_layers;
+    MCSH _shadowmap;
+    MCAL<MCALContext, MCALContext> _alphamaps;
+
+    static constexpr
+    Common::Traits::AutoIOTrait
+    <
+      Common::Traits::TraitEntry<&MCNKTex::_alpha_layers>
+      , Common::Traits::TraitEntry<&MCNKTex::_shadowmap>
+    > _auto_trait {};
   };
-}
\ No newline at end of file
+}
+
+#include <IO/ADT/Tex/ADTTexMCNK.inl>
@@ -0,0 +1,45 @@
+#pragma once
+#include <IO/ADT/Tex/ADTTexMCNK.hpp>
+#include <Utils/Misc/Hash.hpp>
+
+namespace IO::ADT
+{
+  template<typename ReadContext>
+  inline bool MCNKTex::ReadExtraPre(ReadContext& read_ctx
+                                    , Common::ByteBuffer const& buf
+                                    , Common::ChunkHeader const& chunk_header)
+  {
+    static_assert(MCNKTexReadContext<ReadContext> && "Invalid read context.");
+
+    if (chunk_header.fourcc != ChunkIdentifiers::ADTTexMCNKSubchunks::MCAL)
+      return false;
+
+    InvariantF(CCodeZones::FILE_IO, _alpha_layers.IsInitialized(), "MCAL encountered before MCLY.");
+
+    MCALContext mcal_ctx {_alpha_layers, read_ctx.alpha_format, read_ctx.fix_alpha};
+    _alphamaps.Read(mcal_ctx, buf, chunk_header.size);
+
+    return true;
+  }
+
+  template<typename WriteContext>
+  inline void MCNKTex::WriteExtraPost(WriteContext& write_ctx, Common::ByteBuffer& buf) const
+  {
+    static_assert(MCNKTexWriteContext<WriteContext> && "Invalid write context.");
+
+    MCALContext mcal_ctx {_alpha_layers, write_ctx.alpha_format, false};
+    _alphamaps.Write(mcal_ctx, buf);
+  }
+
+  template<typename WriteContext>
+  inline std::size_t MCNKTex::WriteSizeExtra(WriteContext& write_ctx) const
+  {
+    MCALContext mcal_ctx {_alpha_layers, write_ctx.alpha_format, false};
+    return _alphamaps.WriteSize(mcal_ctx);
+  }
+
+  inline std::uint64_t MCNKTex::HashExtra(std::uint64_t seed) const
+  {
+    return Utils::Misc::HashCombine(seed, _alphamaps.Hash());
+  }
+}
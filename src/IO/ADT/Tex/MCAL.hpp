@@ -39,7 +39,7 @@ namespace IO::ADT
 
   template<typename T>
   concept MCALReadContext = requires (T t) {
-                                             { t.alpha_layer_params } -> std::same_as<MCLYChunk&>;
+                                             { t.alpha_layer_params } -> std::convertible_to<MCLYChunk const&>;
                                              { t.fix_alpha } -> std::same_as<bool&>;
                                              { t.alpha_format } -> std::same_as<AlphaFormat&>;
                                            };
@@ -47,10 +47,20 @@ namespace IO::ADT
 
   template<typename T>
   concept MCALWriteContext = requires (T t) {
-                                              { t.alpha_layer_params } -> std::same_as<MCLYChunk&>;
+                                              { t.alpha_layer_params } -> std::convertible_to<MCLYChunk const&>;
                                               { t.alpha_format } -> std::same_as<AlphaFormat&>;
                                             };
 
+  /**
+   * Read / write context of MCAL, provided by the owning MCNK (tex) chunk for the duration of a single call.
+   */
+  struct MCALContext
+  {
+    MCLYChunk const& alpha_layer_params; ///> Texture layers of the chunk. Alpha of layers 1-3 is stored in MCAL.
+    AlphaFormat alpha_format; ///> Format of alpha maps, defined per map.
+    bool fix_alpha; ///> Restore the last row and column of lowres alpha maps on reading.
+  };
+
 
   template<MCALReadContext ReadContext, MCALWriteContext WriteContext>
   class MCAL : public Utils::Meta::Templates::ConstrainedArray<Alphamap, 0, 3>
@@ -60,10 +70,56 @@ namespace IO::ADT
 
     void Write(WriteContext& write_ctx, Common::ByteBuffer& buf) const;
 
+    /**
+     * Size of the alpha data in bytes, as it would be written with Write() (without header).
+     * Compressed layers are sized by scanning the compression runs, without encoding them.
+     * @param write_ctx Write context.
+     * @return Number of bytes.
+     */
+    [[nodiscard]]
+    std::size_t ByteSize(WriteContext& write_ctx) const;
+
+    /**
+     * Exact number of bytes written by Write() (with header). 0 when there are no alpha layers.
+     * @param write_ctx Write context.
+     * @return Number of bytes.
+     */
+    [[nodiscard]]
+    std::size_t WriteSize(WriteContext& write_ctx) const;
+
     [[nodiscard]]
     FORCEINLINE bool IsInitialized() const { return true; };
 
+    /**
+     * Structural hash of the decoded alpha maps. Not cached, computed on demand.
+     * @return Hash value.
+     */
+    [[nodiscard]]
+    std::uint64_t Hash() const;
+
+    /**
+     * Writes the decoded alpha maps, see Traits::AutoIOTraitInterface SaveState().
+     * @param buf Buffer to write into.
+     */
+    void SaveState(Common::ByteBuffer& buf) const;
+
+    /**
+     * Restores the alpha maps written by SaveState().
+     * @param buf Buffer to read from.
+     */
+    void LoadState(Common::ByteBuffer const& buf);
+
   private:
+    /**
+     * Splits a row of highres alpha into compression runs, so that the same splitting is used for sizing and writing.
+     * @tparam Visitor Callable with signature
+     * void(AlphaCompressionMode::eAlphaCompressionMode mode, std::uint8_t const* run, std::uint8_t length).
+     * @param row Pointer to the first pixel of the row.
+     * @param visitor Invoked for every run in order.
+     */
+    template<typename Visitor>
+    static void ForEachCompressionRun(std::uint8_t const* row, Visitor&& visitor);
+
     static std::uint8_t NormalizeLowresAlpha(std::uint8_t alpha)
     {
       return alpha / 255 + (alpha % 255 <= 127 ? 0 : 1);
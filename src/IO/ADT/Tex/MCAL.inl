@@ -18,7 +18,7 @@ namespace IO::ADT
   template<MCALReadContext ReadContext, MCALWriteContext WriteContext>
   inline void MCAL<ReadContext, WriteContext>::Read(ReadContext& read_ctx
                                                     , Common::ByteBuffer const& buf
-                                                    , std::size_t size)
+                                                    , [[maybe_unused]] std::size_t size)
   {
 
     RequireF(CCodeZones::FILE_IO
@@ -141,121 +141,57 @@ namespace IO::ADT
   template<MCALReadContext ReadContext, MCALWriteContext WriteContext>
   void MCAL<ReadContext, WriteContext>::Write(WriteContext& write_ctx, Common::ByteBuffer& buf) const
   {
-    RequireF(CCodeZones::FILE_IO
-             , !_data.empty() && _data.size() < Common::WorldConstants::CHUNK_MAX_TEXTURE_LAYERS
+    // single layer chunks do not have alpha
+    if (_data.empty())
+      return;
+
+    RequireF(CCodeZones::FILE_IO, _data.size() < Common::WorldConstants::CHUNK_MAX_TEXTURE_LAYERS
              , "Only 3 alpha layers is supported.");
 
     RequireF(CCodeZones::FILE_IO, _data.size() == (write_ctx.alpha_layer_params.Size() - 1)
              , "Layers params size mismatch.");
 
-    Common::ChunkHeader header {Common::FourCC<"MCAL">, 0};
-    std::size_t chunk_pos = buf.Tell();
+    std::size_t const byte_size = ByteSize(write_ctx);
+
+    LogDebugF(LCodeZones::FILE_IO, "Writing chunk: MCAL, size: %d.", byte_size);
+
+    Common::ChunkHeader header {ChunkIdentifiers::ADTTexMCNKSubchunks::MCAL, static_cast<std::uint32_t>(byte_size)};
     buf.Write(header);
 
     // highres 4096 alpha
     if (write_ctx.alpha_format == AlphaFormat::HIGHRES)
     {
       for (auto const&& [alphamap, layer_params]
-        : boost::combine(_data, boost::iterator_range(write_ctx.alpha_layer_params.begin() + 1
-                                                      , write_ctx.alpha_layer_params.end())))
+        : boost::combine(_data, boost::make_iterator_range(write_ctx.alpha_layer_params.begin() + 1
+                                                           , write_ctx.alpha_layer_params.end())))
       {
-        auto compression = layer_params.flags.alpha_map_compressed
-                           ? AlphaCompression::COMPRESSED : AlphaCompression::UNCOMPRESSED;
-
         // uncompressed
-        if (compression == AlphaCompression::UNCOMPRESSED)
+        if (!layer_params.flags.alpha_map_compressed)
         {
           buf.Write(alphamap.begin(), alphamap.end());
+          continue;
         }
-          // compressed
-        else
-        {
-          for (std::size_t i = 0; i < Common::WorldConstants::ALPHAMAP_DIM; ++i)
-          {
-            // we go line by line and identify contigious blocks in the current line of pixels
-            std::vector<std::pair<std::uint8_t, std::size_t>> compression_blocks {};
 
-            auto& cur_block = compression_blocks.emplace_back(
-              std::pair{alphamap[i * Common::WorldConstants::ALPHAMAP_DIM], 1});
-
-            for (std::size_t j = 1; j < Common::WorldConstants::ALPHAMAP_DIM; ++j)
+        // compressed, every run is preceded by a control byte holding its final length
+        for (std::size_t i = 0; i < Common::WorldConstants::ALPHAMAP_DIM; ++i)
+        {
+          MCAL::ForEachCompressionRun(alphamap.data() + i * Common::WorldConstants::ALPHAMAP_DIM
+            , [&buf](DataStructures::AlphaCompressionMode::eAlphaCompressionMode mode
+                     , std::uint8_t const* run
+                     , std::uint8_t length)
             {
-              std::uint8_t cur_pixel = alphamap[i * Common::WorldConstants::ALPHAMAP_DIM + j];
+              DataStructures::CompressedAlphaByte control_byte {length, mode};
+              buf.Write(control_byte);
 
-              if (cur_pixel != cur_block.first)
+              if (mode == DataStructures::AlphaCompressionMode::FILL)
               {
-                cur_block = compression_blocks.emplace_back(std::pair{cur_pixel, 1});
-              }
-              else
-              {
-                cur_block.second++;
-              }
-            }
-
-            bool is_copy_block_current = false;
-            std::size_t copy_control_byte_pos = 0;
-            std::uint8_t n_copy_bytes = 0;
-
-            for (auto& block : compression_blocks)
-            {
-              // write fill
-              if (block.second > 1)
-              {
-                // if breaking copy block, make sure to write the relevant control byte
-                if (is_copy_block_current)
-                {
-                  is_copy_block_current = false;
-                  std::size_t cur_pos = buf.Tell();
-
-                  DataStructures::CompressedAlphaByte control_byte {static_cast<std::uint8_t>(n_copy_bytes)
-                                                                    , DataStructures::AlphaCompressionMode::COPY};
-
-                  buf.Seek(copy_control_byte_pos);
-                  buf.Write(control_byte);
-                  buf.Seek(cur_pos);
-
-                  copy_control_byte_pos = 0;
-                  n_copy_bytes = 0;
-
-                }
-
-                DataStructures::CompressedAlphaByte control_byte {static_cast<std::uint8_t>(block.second)
-                                                                  , DataStructures::AlphaCompressionMode::FILL};
-
-                buf.Write(control_byte);
-                buf.WriteFill(block.first, block.second);
+                buf.Write(*run);
               }
               else
               {
-                // if last block was fill, make sure to start a new copy block
-                if (!is_copy_block_current)
-                {
-                  is_copy_block_current = true;
-                  copy_control_byte_pos = buf.Tell();
-
-                  // write dummy control byte to keep the layout, we return to it later
-                  DataStructures::CompressedAlphaByte control_byte {0, DataStructures::AlphaCompressionMode::FILL};
-                  buf.Write(control_byte);
-                }
-                n_copy_bytes++;
-                buf.Write(block.first);
-              }
-
-              // if we ended on copy block, make sure to write its control byte
-              if (is_copy_block_current)
-              {
-                std::size_t cur_pos = buf.Tell();
-
-                DataStructures::CompressedAlphaByte control_byte {static_cast<std::uint8_t>(n_copy_bytes)
-                                                                  , DataStructures::AlphaCompressionMode::COPY};
-
-                buf.Seek(copy_control_byte_pos);
-                buf.Write(control_byte);
-                buf.Seek(cur_pos);
-
+                buf.Write(run, run + length);
               }
-            }
-          }
+            });
         }
       }
     }
@@ -263,7 +199,7 @@ namespace IO::ADT
     {
       // convert alpha format from 4096 uncompressed to 2048 uncompressed
       std::vector<std::array<std::uint8_t, Common::WorldConstants::N_PIXELS_PER_ALPHAMAP>> temp_layers{};
-      temp_layers.resize(temp_layers.size());
+      temp_layers.resize(_data.size());
 
       for (std::size_t i = 0; i < Common::WorldConstants::N_PIXELS_PER_ALPHAMAP; ++i)
       {
@@ -299,13 +235,121 @@ namespace IO::ADT
         }
       }
     }
+  }
 
-    std::size_t end_pos = buf.Tell();
-    std::size_t chunk_size = end_pos - (chunk_pos + 8);
-    header.size = static_cast<std::uint32_t>(chunk_size);
-    buf.Seek(end_pos);
-    buf.Write(header);
+  template<MCALReadContext ReadContext, MCALWriteContext WriteContext>
+  inline std::size_t MCAL<ReadContext, WriteContext>::ByteSize(WriteContext& write_ctx) const
+  {
+    if (write_ctx.alpha_format == AlphaFormat::LOWRES)
+      return _data.size() * Common::WorldConstants::N_BYTES_PER_LOWRES_ALPHA;
+
+    RequireF(CCodeZones::FILE_IO, _data.size() == (write_ctx.alpha_layer_params.Size() - 1)
+             , "Layers params size mismatch.");
+
+    std::size_t size = 0;
+
+    for (auto const&& [alphamap, layer_params]
+      : boost::combine(_data, boost::make_iterator_range(write_ctx.alpha_layer_params.begin() + 1
+                                                         , write_ctx.alpha_layer_params.end())))
+    {
+      if (!layer_params.flags.alpha_map_compressed)
+      {
+        size += Common::WorldConstants::N_BYTES_PER_HIGHRES_ALPHA;
+        continue;
+      }
+
+      // sizing only scans the runs, nothing is allocated
+      for (std::size_t i = 0; i < Common::WorldConstants::ALPHAMAP_DIM; ++i)
+      {
+        MCAL::ForEachCompressionRun(alphamap.data() + i * Common::WorldConstants::ALPHAMAP_DIM
+          , [&size](DataStructures::AlphaCompressionMode::eAlphaCompressionMode mode
+                    , [[maybe_unused]] std::uint8_t const* run
+                    , std::uint8_t length)
+          {
+            size += sizeof(DataStructures::CompressedAlphaByte)
+              + (mode == DataStructures::AlphaCompressionMode::FILL ? 1 : length);
+          });
+      }
+    }
+
+    return size;
   }
-}
 
+  template<MCALReadContext ReadContext, MCALWriteContext WriteContext>
+  inline std::size_t MCAL<ReadContext, WriteContext>::WriteSize(WriteContext& write_ctx) const
+  {
+    if (_data.empty())
+      return 0;
+
+    return sizeof(Common::ChunkHeader) + ByteSize(write_ctx);
+  }
+
+  template<MCALReadContext ReadContext, MCALWriteContext WriteContext>
+  template<typename Visitor>
+  inline void MCAL<ReadContext, WriteContext>::ForEachCompressionRun(std::uint8_t const* row, Visitor&& visitor)
+  {
+    constexpr std::size_t max_run_length = 127;
+    constexpr std::size_t row_length = Common::WorldConstants::ALPHAMAP_DIM;
+
+    std::size_t i = 0;
+
+    while (i < row_length)
+    {
+      // fill run: at least two equal pixels
+      std::size_t length = 1;
+
+      while (i + length < row_length && length < max_run_length && row[i + length] == row[i])
+      {
+        length++;
+      }
+
+      if (length > 1)
+      {
+        visitor(DataStructures::AlphaCompressionMode::FILL, row + i, static_cast<std::uint8_t>(length));
+        i += length;
+        continue;
+      }
 
+      // copy run: up to the beginning of the next fill run
+      while (i + length < row_length && length < max_run_length
+             && (i + length + 1 == row_length || row[i + length] != row[i + length + 1]))
+      {
+        length++;
+      }
+
+      visitor(DataStructures::AlphaCompressionMode::COPY, row + i, static_cast<std::uint8_t>(length));
+      i += length;
+    }
+  }
+
+  template<MCALReadContext ReadContext, MCALWriteContext WriteContext>
+  inline std::uint64_t MCAL<ReadContext, WriteContext>::Hash() const
+  {
+    return Utils::Misc::Hash64(_data.data(), _data.size() * sizeof(Alphamap), ChunkIdentifiers::ADTTexMCNKSubchunks::MCAL);
+  }
+
+  template<MCALReadContext ReadContext, MCALWriteContext WriteContext>
+  inline void MCAL<ReadContext, WriteContext>::SaveState(Common::ByteBuffer& buf) const
+  {
+    buf.Write(static_cast<std::uint64_t>(_data.size()));
+
+    if (!_data.empty())
+    {
+      buf.Write(_data.begin(), _data.end());
+    }
+  }
+
+  template<MCALReadContext ReadContext, MCALWriteContext WriteContext>
+  inline void MCAL<ReadContext, WriteContext>::LoadState(Common::ByteBuffer const& buf)
+  {
+    auto const n_layers = static_cast<std::size_t>(buf.Read<std::uint64_t>());
+    RequireF(CCodeZones::FILE_IO, n_layers <= 3, "Too many alpha layers (%d).", n_layers);
+
+    _data.resize(n_layers);
+
+    if (n_layers)
+    {
+      buf.Read(_data.begin(), _data.end());
+    }
+  }
+}
@@ -1,5 +1,6 @@
 #include <IO/ADT/Tex/MCSH.hpp>
 #include <Validation/Log.hpp>
+#include <Utils/Misc/Hash.hpp>
 
 #include <array>
 
@@ -12,7 +13,7 @@ MCSH::MCSH()
 {
 }
 
-void MCSH::Read(Common::ByteBuffer const& buf, std::size_t size, bool fix_last_row_col)
+void MCSH::Read(Common::ByteBuffer const& buf, [[maybe_unused]] std::size_t size, bool fix_last_row_col)
 {
   LogDebugF(LCodeZones::FILE_IO, "Reading chunk: MCSH, size: %d", size);
 
@@ -44,12 +45,20 @@ void MCSH::Read(Common::ByteBuffer const& buf, std::size_t size, bool fix_last_r
     _shadowmap[last_pixel * Common::WorldConstants::SHADOWMAP_DIM + last_pixel]
       = _shadowmap[pre_last_pixel * Common::WorldConstants::SHADOWMAP_DIM + pre_last_pixel];
   }
+
+  _is_initialized = true;
 }
 
 void MCSH::Write(Common::ByteBuffer& buf) const
 {
+  if (!_is_initialized) [[unlikely]]
+    return;
+
   LogDebugF(LCodeZones::FILE_IO, "Writing chunk: MCSH");
 
+  Common::ChunkHeader header {ChunkIdentifiers::ADTTexMCNKSubchunks::MCSH, static_cast<std::uint32_t>(ByteSize())};
+  buf.Write(header);
+
   for (std::size_t i = 0; i < N_BYTES_PER_SHADOWMAP; ++i)
   {
     std::bitset<8> cur_byte {0};
@@ -62,4 +71,65 @@ void MCSH::Write(Common::ByteBuffer& buf) const
     buf.Write(static_cast<std::uint8_t>(cur_byte.to_ulong()));
   }
 
-}
\ No newline at end of file
+}
+
+std::uint64_t MCSH::Hash() const
+{
+  if (!_is_initialized) [[unlikely]]
+    return 0;
+
+  std::uint64_t hash = ChunkIdentifiers::ADTTexMCNKSubchunks::MCSH;
+
+  for (std::size_t i = 0; i < Common::WorldConstants::N_PIXELS_PER_SHADOWMAP; i += 64)
+  {
+    std::uint64_t word = 0;
+
+    for (std::size_t j = 0; j < 64; ++j)
+    {
+      word |= static_cast<std::uint64_t>(_shadowmap[i + j]) << j;
+    }
+
+    hash = Utils::Misc::HashCombine(hash, word);
+  }
+
+  return Utils::Misc::Hash64(&hash, sizeof(hash));
+}
+
+void MCSH::SaveState(Common::ByteBuffer& buf) const
+{
+  buf.Write(_is_initialized);
+
+  if (!_is_initialized)
+    return;
+
+  for (std::size_t i = 0; i < Common::WorldConstants::N_PIXELS_PER_SHADOWMAP; i += 64)
+  {
+    std::uint64_t word = 0;
+
+    for (std::size_t j = 0; j < 64; ++j)
+    {
+      word |= static_cast<std::uint64_t>(_shadowmap[i + j]) << j;
+    }
+
+    buf.Write(word);
+  }
+}
+
+void MCSH::LoadState(Common::ByteBuffer const& buf)
+{
+  _shadowmap.reset();
+  buf.Read(_is_initialized);
+
+  if (!_is_initialized)
+    return;
+
+  for (std::size_t i = 0; i < Common::WorldConstants::N_PIXELS_PER_SHADOWMAP; i += 64)
+  {
+    auto const word = buf.Read<std::uint64_t>();
+
+    for (std::size_t j = 0; j < 64; ++j)
+    {
+      _shadowmap[i + j] = (word >> j) & 1;
+    }
+  }
+}
@@ -17,6 +17,39 @@ namespace IO::ADT
     void Read(Common::ByteBuffer const& buf, std::size_t size, bool fix_last_row_col);
     void Write(Common::ByteBuffer& buf) const;
 
+    /**
+     * Read the shadow map from ByteBuffer.
+     * @tparam ReadContext Read context, must provide "fix_alpha" determining whether the last row and column
+     * have to be restored (same condition as for the lowres alpha maps).
+     * @param ctx Read context.
+     * @param buf ByteBuffer to read data from.
+     * @param size Number of bytes to read.
+     */
+    template<typename ReadContext>
+    void Read(ReadContext& ctx, Common::ByteBuffer const& buf, std::size_t size) { Read(buf, size, ctx.fix_alpha); };
+
+    template<typename WriteContext>
+    void Write([[maybe_unused]] WriteContext& ctx, Common::ByteBuffer& buf) const { Write(buf); };
+
+    /**
+     * Size of the shadow map in bytes, as it would be written with Write() (without header).
+     * @return Number of bytes.
+     */
+    [[nodiscard]]
+    std::size_t ByteSize() const { return Common::WorldConstants::N_PIXELS_PER_SHADOWMAP / 8; };
+
+    /**
+     * Exact number of bytes written by Write() (with header). 0 for an uninitialized chunk.
+     * @tparam WriteContext Write context.
+     * @return Number of bytes.
+     */
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSize([[maybe_unused]] WriteContext& ctx) const
+    {
+      return _is_initialized ? sizeof(Common::ChunkHeader) + ByteSize() : 0;
+    };
+
     [[nodiscard]]
     std::bitset<Common::WorldConstants::N_PIXELS_PER_SHADOWMAP>& Shadowmap() { return _shadowmap; };
 
@@ -26,8 +59,30 @@ namespace IO::ADT
     [[nodiscard]]
     bool IsInitialized() const { return _is_initialized; };
 
+    /**
+     * Structural hash of the shadow map. 0 for an uninitialized chunk. Not cached, computed on demand.
+     * @return Hash value.
+     */
+    [[nodiscard]]
+    std::uint64_t Hash() const;
+
+    /**
+     * Writes the in-memory state of the chunk, see Traits::AutoIOTraitInterface SaveState().
+     * @param buf Buffer to write into.
+     */
+    void SaveState(Common::ByteBuffer& buf) const;
+
+    /**
+     * Restores the in-memory state of the chunk written by SaveState().
+     * @param buf Buffer to read from.
+     */
+    void LoadState(Common::ByteBuffer const& buf);
+
     void Initialize() { _is_initialized = true; };
 
+    static constexpr std::uint32_t magic = ChunkIdentifiers::ADTTexMCNKSubchunks::MCSH;
+    static constexpr Common::FourCCEndian magic_endian = Common::FourCCEndian::Little;
+
   private:
     std::bitset<Common::WorldConstants::N_PIXELS_PER_SHADOWMAP> _shadowmap;
     bool _is_initialized = false;
@@ -59,7 +59,7 @@ ByteBuffer::ByteBuffer(ByteBuffer&& other) noexcept
 : _is_data_owned(other._is_data_owned)
 , _cur_pos(other._cur_pos)
 , _size(other._size)
-, _buf_size(other._size)
+, _buf_size(other._buf_size)
 {
   _data.reset(other._data.release());
 }
@@ -134,6 +134,19 @@ void IO::Common::ByteBuffer::Write(const char* src, std::size_t n)
   _cur_pos += n;
 }
 
+void ByteBuffer::ReserveCapacity(std::size_t capacity)
+{
+  if (_buf_size >= capacity)
+    return;
+
+  InvariantF(CCodeZones::FILE_IO, _is_data_owned, "Attempted reserve on a non-owned buffer.");
+
+  auto realloced_buffer = new char[capacity];
+  std::memcpy(realloced_buffer, _data.get(), _size);
+  _data.reset(realloced_buffer);
+  _buf_size = capacity;
+}
+
 void ByteBuffer::Flush(std::fstream& stream) const
 {
   stream.write(_data.get(), _size);
@@ -156,10 +169,10 @@ void ByteBuffer::WriteString(std::string const& data)
   }
 
   std::memcpy(_data.get() + _cur_pos, data.data(), data.size());
+  _cur_pos += data.size();
+
   char null_term = 0;
   Write(null_term);
-
-  _cur_pos += data.size() + sizeof(char);
 }
 
 std::string_view ByteBuffer::ReadString() const
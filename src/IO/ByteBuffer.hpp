@@ -129,6 +129,7 @@ namespace IO::Common
     /**
      * Checks if internal buffer is owned by this buffer. Owned buffers are self-destructible,
      * Borrowed buffers are simply released. User needs to take control of memory freeing.
+     * Borrowed buffers can be written to (e.g. a memory mapped file), as long as the write does not exceed Size().
      * @return true, if data is owned by ByteBuffer, else false.
      */
     [[nodiscard]]
@@ -290,6 +291,14 @@ namespace IO::Common
     template<ReservePolicy reserve_policy = ReservePolicy::Strict>
     void Reserve(std::size_t n);
 
+    /**
+     * Ensures that the allocated storage can hold at least the requested number of bytes without reallocation.
+     * Unlike Reserve(), does not change Size(). Intended to be used with an exact size precomputed for a write.
+     * Borrowed buffers can only be written within their existing size, so the capacity can't grow for them.
+     * @param capacity Total number of bytes to be available.
+     */
+    void ReserveCapacity(std::size_t capacity);
+
     /**
      * Flushes associated buffer into std::fstream
      * @param stream Stream to flush into.
@@ -148,12 +148,12 @@ inline void IO::Common::ByteBuffer::Reserve(std::size_t n)
 {
   RequireF(CCodeZones::FILE_IO, std::numeric_limits<std::size_t>::max() - _size >= n
            , "Buffer size overflow on attempt to alloc more memory.");
-  InvariantF(CCodeZones::FILE_IO, _is_data_owned, "Attempted reserve on a non-owned buffer.");
 
   if constexpr (reserve_policy == ReservePolicy::Strict)
   {
     if (_buf_size < _size + n)
     {
+      InvariantF(CCodeZones::FILE_IO, _is_data_owned, "Attempted reserve on a non-owned buffer.");
       _buf_size = _size + n;
       auto realloced_buffer = new char[_buf_size];
       std::memcpy(realloced_buffer, _data.get(), _size);
@@ -166,6 +166,8 @@ inline void IO::Common::ByteBuffer::Reserve(std::size_t n)
   {
     if (_buf_size < _size + n)
     {
+      InvariantF(CCodeZones::FILE_IO, _is_data_owned, "Attempted reserve on a non-owned buffer.");
+
       std::size_t required_at_least = _size + n;
       std::size_t new_size = _buf_size;
 
@@ -8,6 +8,7 @@
 #include <Validation/Contracts.hpp>
 #include <Validation/Log.hpp>
 #include <Config/CodeZones.hpp>
+#include <Utils/Misc/Hash.hpp>
 
 #include <unordered_map>
 #include <fstream>
@@ -17,6 +18,8 @@
 #include <cstdint>
 #include <algorithm>
 #include <limits>
+#include <memory>
+#include <atomic>
 
 namespace IO::Common
 {
@@ -124,6 +127,144 @@ namespace IO::Common
     std::uint32_t size; ///> Size of chunk data in bytes.
   };
 
+  namespace details
+  {
+    /**
+     * Lazily computed and cached hash value of a chunk-like primitive.
+     * The owner is responsible for invalidating it whenever the hashed data is mutated.
+     * Get() may be called concurrently (e.g. hashing chunks from several workers), the computation must then be
+     * deterministic since racing callers may each compute and publish the value. Invalidate() must not race with Get().
+     */
+    class LazyHash
+    {
+    public:
+      LazyHash() = default;
+
+      LazyHash(LazyHash const& other) noexcept
+      {
+        *this = other;
+      };
+
+      LazyHash& operator=(LazyHash const& other) noexcept
+      {
+        bool const is_valid = other._is_valid.load(std::memory_order_acquire);
+        _value.store(other._value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        _is_valid.store(is_valid, std::memory_order_release);
+        return *this;
+      };
+
+      /**
+       * Returns the cached hash value, computing it first if it was invalidated.
+       * @param compute Callable computing the hash value.
+       * @return Hash value.
+       */
+      template<std::invocable Compute>
+      [[nodiscard]]
+      std::uint64_t Get(Compute&& compute) const
+      {
+        if (_is_valid.load(std::memory_order_acquire))
+          return _value.load(std::memory_order_relaxed);
+
+        std::uint64_t const value = compute();
+        _value.store(value, std::memory_order_relaxed);
+        _is_valid.store(true, std::memory_order_release);
+
+        return value;
+      }
+
+      /**
+       * Marks the cached value as outdated.
+       */
+      void Invalidate() { _is_valid.store(false, std::memory_order_relaxed); };
+
+    private:
+      mutable std::atomic<std::uint64_t> _value = 0;
+      mutable std::atomic<bool> _is_valid = false;
+    };
+  }
+
+  /**
+   * RawChunk represents a chunk that is not recognized by the reader (e.g. introduced by a newer client, or custom).
+   * It is kept undecoded to be written back verbatim on save.
+   * By default the data is borrowed from the source buffer, so that no copy is performed on reading.
+   * In that case the source buffer must outlive the chunk, or Detach() must be called to take ownership of the data.
+   */
+  class RawChunk
+  {
+  public:
+    /**
+     * Constructs a raw chunk borrowing its data from the source buffer.
+     * @param header Header of the chunk.
+     * @param data Pointer to the chunk data (following the header) in the source buffer.
+     * @param position Write slot of the object the chunk preceded in the source,
+     * see Traits::details::UnknownChunkStorage.
+     */
+    RawChunk(ChunkHeader const& header, const char* data, std::size_t position);
+
+    /**
+     * Writes the chunk verbatim.
+     * @param buf ByteBuffer to write data into.
+     */
+    void Write(ByteBuffer& buf) const;
+
+    /**
+     * Copies the chunk data from the source buffer into storage owned by the chunk. No-op if already owned.
+     */
+    void Detach();
+
+    /**
+     * Exact number of bytes written by Write() (with header).
+     * @return Number of bytes.
+     */
+    [[nodiscard]]
+    std::size_t WriteSize() const { return sizeof(ChunkHeader) + _header.size; };
+
+    /**
+     * Hash of the raw chunk bytes.
+     * @return Hash value.
+     */
+    [[nodiscard]]
+    std::uint64_t Hash() const;
+
+    /**
+     * Writes the chunk and its position, see Traits::AutoIOTraitInterface SaveState().
+     * @param buf Buffer to write into.
+     */
+    void SaveState(ByteBuffer& buf) const;
+
+    /**
+     * Restores a chunk written by SaveState(). The data is copied, the returned chunk owns it.
+     * @param buf Buffer to read from.
+     * @return Chunk.
+     */
+    [[nodiscard]]
+    static RawChunk LoadState(ByteBuffer const& buf);
+
+    [[nodiscard]]
+    ChunkHeader const& Header() const { return _header; };
+
+    [[nodiscard]]
+    const char* Data() const { return _data; };
+
+    /**
+     * @return Write slot of the object the chunk preceded in the source. Used to place it back on writing.
+     */
+    [[nodiscard]]
+    std::size_t Position() const { return _position; };
+
+    /**
+     * @return true if data is borrowed from the source buffer, false if it is owned by the chunk.
+     */
+    [[nodiscard]]
+    bool IsBorrowed() const { return _data && !_storage; };
+
+  private:
+    ChunkHeader _header;
+    const char* _data;
+    std::size_t _position;
+    std::shared_ptr<const char[]> _storage;
+  };
+
   /**
    * ChunkCommon represents a commonly shared minimal interface used by other chunk-like primitives.
    * @tparam fourcc
@@ -210,6 +351,39 @@ namespace IO::Common
     [[nodiscard]]
     std::size_t ByteSize() const { return sizeof(T); };
 
+    /**
+     * Exact number of bytes written by Write() (with header). 0 for an uninitialized chunk.
+     * @tparam ctx Write context.
+     * @return Number of bytes.
+     */
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSize([[maybe_unused]] WriteContext& ctx) const
+    {
+      return this->_is_initialized ? sizeof(ChunkHeader) + ByteSize() : 0;
+    };
+
+    /**
+     * Structural hash of the chunk payload. 0 for an uninitialized chunk.
+     * Not cached: the payload is a small public field that can be mutated directly, hashing it is cheaper than
+     * tracking that.
+     * @return Hash value.
+     */
+    [[nodiscard]]
+    std::uint64_t Hash() const;
+
+    /**
+     * Writes the in-memory state of the chunk, see Traits::AutoIOTraitInterface SaveState().
+     * @param buf Buffer to write into.
+     */
+    void SaveState(ByteBuffer& buf) const;
+
+    /**
+     * Restores the in-memory state of the chunk written by SaveState().
+     * @param buf Buffer to read from.
+     */
+    void LoadState(ByteBuffer const& buf);
+
     // These operators are intended for supporting convenient conversions to underlying type
     [[nodiscard]]
     operator T&() { return data; };
@@ -303,8 +477,91 @@ namespace IO::Common
     [[nodiscard]]
     std::size_t ByteSize() const { return this->_data.size() * sizeof(T); };
 
+    /**
+     * Exact number of bytes written by Write() (with header). 0 for an uninitialized chunk.
+     * @tparam ctx Write context.
+     * @return Number of bytes.
+     */
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSize([[maybe_unused]] WriteContext& ctx) const
+    {
+      return this->_is_initialized ? sizeof(ChunkHeader) + ByteSize() : 0;
+    };
+
+    /**
+     * Structural hash of the chunk payload. 0 for an uninitialized chunk.
+     * Computed lazily and cached until the array is mutated through any of its non-const accessors.
+     * Non-const iterators or references obtained before calling Hash() must not be used to mutate the array after it.
+     * @return Hash value.
+     */
+    [[nodiscard]]
+    std::uint64_t Hash() const;
+
+    /**
+     * Writes the in-memory state of the chunk, see Traits::AutoIOTraitInterface SaveState().
+     * @param buf Buffer to write into.
+     */
+    void SaveState(ByteBuffer& buf) const;
+
+    /**
+     * Restores the in-memory state of the chunk written by SaveState().
+     * @param buf Buffer to read from.
+     */
+    void LoadState(ByteBuffer const& buf);
+
+    // Non-const accessors invalidating the cached hash.
+    using Utils::Meta::Templates::ConstrainedArray<T, size_min, size_max>::At;
+    using Utils::Meta::Templates::ConstrainedArray<T, size_min, size_max>::operator[];
+    using Utils::Meta::Templates::ConstrainedArray<T, size_min, size_max>::begin;
+    using Utils::Meta::Templates::ConstrainedArray<T, size_min, size_max>::end;
+
+    [[nodiscard]]
+    T& At(std::size_t index) { _hash.Invalidate(); return ConstrainedArrayT::At(index); };
+
+    [[nodiscard]]
+    T& operator[](std::size_t index) { _hash.Invalidate(); return ConstrainedArrayT::operator[](index); };
+
+    [[nodiscard]]
+    typename ArrayImplT::iterator begin() { _hash.Invalidate(); return ConstrainedArrayT::begin(); };
+
+    [[nodiscard]]
+    typename ArrayImplT::iterator end() { _hash.Invalidate(); return ConstrainedArrayT::end(); };
+
+    template<typename..., typename ArrayImplT_ = ArrayImplT>
+    T& Add() requires (std::is_same_v<ArrayImplT_, std::vector<T>>)
+    {
+      _hash.Invalidate();
+      return ConstrainedArrayT::Add();
+    };
+
+    template<typename..., typename ArrayImplT_ = ArrayImplT>
+    void Remove(std::size_t index) requires (std::is_same_v<ArrayImplT_, std::vector<T>>)
+    {
+      _hash.Invalidate();
+      ConstrainedArrayT::Remove(index);
+    };
+
+    template<typename..., typename ArrayImplT_ = ArrayImplT>
+    void Remove(typename ArrayImplT_::iterator it) requires (std::is_same_v<ArrayImplT_, std::vector<T>>)
+    {
+      _hash.Invalidate();
+      ConstrainedArrayT::Remove(it);
+    };
+
+    template<typename..., typename ArrayImplT_ = ArrayImplT>
+    void Clear() requires (std::is_same_v<ArrayImplT_, std::vector<T>>)
+    {
+      _hash.Invalidate();
+      ConstrainedArrayT::Clear();
+    };
+
     static constexpr std::uint32_t magic = fourcc;
 
+  private:
+    using ConstrainedArrayT = Utils::Meta::Templates::ConstrainedArray<T, size_min, size_max>;
+
+    details::LazyHash _hash;
   };
 
   // Interface validity checks
@@ -339,8 +596,49 @@ namespace IO::Common
     template<typename WriteContext>
     void Write(WriteContext& ctx, ByteBuffer& buf) const;
 
+    /**
+     * Exact number of bytes written by Write(), that is the sum of sizes of all chunks (with headers).
+     * 0 for an uninitialized array.
+     * @tparam ctx Write context.
+     * @return Number of bytes.
+     */
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSize(WriteContext& ctx) const;
+
+    /**
+     * Structural hash of the array, combined from the hashes of its elements in order.
+     * 0 for an uninitialized array.
+     * @return Hash value.
+     */
     [[nodiscard]]
-    std::size_t ByteSize() const;
+    std::uint64_t Hash() const;
+
+    /**
+     * Hashes of individual elements. Comparing two snapshots of these tells which elements changed,
+     * equal hashes across arrays identify duplicate elements.
+     * @return Vector of element hashes, in order of elements.
+     */
+    [[nodiscard]]
+    std::vector<std::uint64_t> ElementHashes() const;
+
+    /**
+     * Writes the in-memory state of the array and of its elements, see Traits::AutoIOTraitInterface SaveState().
+     * @param buf Buffer to write into.
+     */
+    void SaveState(ByteBuffer& buf) const;
+
+    /**
+     * Restores the in-memory state of the array written by SaveState().
+     * @param buf Buffer to read from.
+     */
+    void LoadState(ByteBuffer const& buf);
+
+    /**
+     * Detaches unknown sub-chunks of all elements from the source buffer, see Traits::AutoIOTraitInterface.
+     */
+    void DetachUnknownChunks()
+    requires requires (Chunk& chunk) { chunk.DetachUnknownChunks(); };
 
   private:
     std::size_t _sparse_counter = 0;
@@ -405,12 +703,44 @@ namespace IO::Common
     std::size_t Size() const { return _data.size(); };
 
     /**
-    * Returns the number of bytes that this array chunk would take in a file.
+    * Returns the number of bytes that this array chunk would take in a file (without header).
     * @return Number of bytes.
     */
     [[nodiscard]]
     std::size_t ByteSize() const;
 
+    /**
+     * Exact number of bytes written by Write() (with header). 0 for an uninitialized chunk.
+     * @tparam ctx Write context.
+     * @return Number of bytes.
+     */
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSize([[maybe_unused]] WriteContext& ctx) const
+    {
+      return this->_is_initialized ? sizeof(ChunkHeader) + ByteSize() : 0;
+    };
+
+    /**
+     * Structural hash of the stored strings. 0 for an uninitialized chunk.
+     * Computed lazily and cached until the chunk is mutated through any of its non-const accessors.
+     * @return Hash value.
+     */
+    [[nodiscard]]
+    std::uint64_t Hash() const;
+
+    /**
+     * Writes the in-memory state of the chunk, see Traits::AutoIOTraitInterface SaveState().
+     * @param buf Buffer to write into.
+     */
+    void SaveState(ByteBuffer& buf) const;
+
+    /**
+     * Restores the in-memory state of the chunk written by SaveState().
+     * @param buf Buffer to read from.
+     */
+    void LoadState(ByteBuffer const& buf);
+
     /**
      * Pushes a string to the end of the underlying vector.
      * Uniqueness for the offset map variant is ensured.
@@ -473,10 +803,10 @@ namespace IO::Common
     typename ArrayImplT::const_iterator end() const { return _data.cend(); };
 
     [[nodiscard]]
-    typename ArrayImplT::iterator begin() { return _data.begin(); };
+    typename ArrayImplT::iterator begin() { _hash.Invalidate(); return _data.begin(); };
 
     [[nodiscard]]
-    typename ArrayImplT::iterator end() { return _data.end(); };
+    typename ArrayImplT::iterator end() { _hash.Invalidate(); return _data.end(); };
 
     [[nodiscard]]
     typename ArrayImplT::const_iterator cbegin() const { return _data.cbegin(); };
@@ -494,6 +824,7 @@ namespace IO::Common
 
   private:
     ArrayImplT _data;
+    details::LazyHash _hash;
   };
 
   // Interface validity checks
@@ -7,6 +7,72 @@
 
 namespace IO::Common
 {
+  // RawChunk
+
+  inline RawChunk::RawChunk(ChunkHeader const& header, const char* data, std::size_t position)
+  : _header(header)
+  , _data(data)
+  , _position(position)
+  {
+    RequireF(CCodeZones::FILE_IO, data != nullptr || !header.size, "Data can't be null for a non-empty chunk.");
+  }
+
+  inline void RawChunk::Write(ByteBuffer& buf) const
+  {
+    LogDebugF(LCodeZones::FILE_IO, "Writing raw chunk: %s, size: %d."
+              , FourCCToStr(_header.fourcc).c_str()
+              , _header.size);
+
+    buf.Write(_header);
+
+    if (_header.size)
+    {
+      buf.Write(_data, _header.size);
+    }
+  }
+
+  inline void RawChunk::Detach()
+  {
+    if (_storage)
+      return;
+
+    // empty chunks have no data to own, just drop the reference to the source buffer
+    if (!_header.size)
+    {
+      _data = nullptr;
+      return;
+    }
+
+    std::shared_ptr<char[]> storage {new char[_header.size]};
+    std::memcpy(storage.get(), _data, _header.size);
+
+    _data = storage.get();
+    _storage = std::move(storage);
+  }
+
+  inline std::uint64_t RawChunk::Hash() const
+  {
+    return Utils::Misc::Hash64(_data, _header.size, _header.fourcc);
+  }
+
+  inline void RawChunk::SaveState(ByteBuffer& buf) const
+  {
+    buf.Write(static_cast<std::uint64_t>(_position));
+    Write(buf);
+  }
+
+  inline RawChunk RawChunk::LoadState(ByteBuffer const& buf)
+  {
+    auto const position = buf.Read<std::uint64_t>();
+    auto const header = buf.Read<ChunkHeader>();
+
+    RawChunk chunk {header, buf.Data() + buf.Tell(), static_cast<std::size_t>(position)};
+    chunk.Detach();
+
+    buf.Seek<ByteBuffer::SeekDir::Forward, ByteBuffer::SeekType::Relative>(header.size);
+    return chunk;
+  }
+
   // ChunkCommon
   template
   <
@@ -39,7 +105,7 @@ namespace IO::Common
   template<typename ReadContext>
   inline void DataChunk<T, fourcc, fourcc_endian>::Read([[maybe_unused]] ReadContext& ctx
                                                         , ByteBuffer const& buf
-                                                        , std::size_t size)
+                                                        , [[maybe_unused]] std::size_t size)
   {
     LogDebugF(LCodeZones::FILE_IO, "Reading chunk: %s, size: %d."
               , FourCCStr<fourcc, fourcc_endian>
@@ -73,6 +139,35 @@ namespace IO::Common
     buf.Write(data);
   }
 
+  template<Utils::Meta::Concepts::PODType T, std::uint32_t fourcc, FourCCEndian fourcc_endian>
+  inline std::uint64_t DataChunk<T, fourcc, fourcc_endian>::Hash() const
+  {
+    static_assert(Utils::Meta::Concepts::PaddingFreeType<T>, "Padding bytes of T would be hashed.");
+
+    if (!this->_is_initialized) [[unlikely]]
+      return 0;
+
+    return Utils::Misc::Hash64(&data, sizeof(T), fourcc);
+  }
+
+  template<Utils::Meta::Concepts::PODType T, std::uint32_t fourcc, FourCCEndian fourcc_endian>
+  inline void DataChunk<T, fourcc, fourcc_endian>::SaveState(ByteBuffer& buf) const
+  {
+    buf.Write(this->_is_initialized);
+
+    if (this->_is_initialized)
+      buf.Write(data);
+  }
+
+  template<Utils::Meta::Concepts::PODType T, std::uint32_t fourcc, FourCCEndian fourcc_endian>
+  inline void DataChunk<T, fourcc, fourcc_endian>::LoadState(ByteBuffer const& buf)
+  {
+    buf.Read(this->_is_initialized);
+
+    if (this->_is_initialized)
+      buf.Read(data);
+  }
+
   // DataArrayChunk
   template
   <
@@ -92,6 +187,7 @@ namespace IO::Common
         , n, size_min, size_max);
 
     this->_is_initialized = true;
+    _hash.Invalidate();
 
     // dynamic array
     if constexpr (std::is_same_v<ArrayImplT, std::vector<T>>)
@@ -122,6 +218,7 @@ namespace IO::Common
     InvariantF(LCodeZones::FILE_IO, !this->_is_initialized, "Attempted to initialize an already initialized chunk.");
     this->_data = data_array;
     this->_is_initialized = true;
+    _hash.Invalidate();
   }
 
   template
@@ -167,6 +264,7 @@ namespace IO::Common
     buf.Read(this->_data.begin(), this->_data.end());
 
     this->_is_initialized = true;
+    _hash.Invalidate();
   }
 
   template
@@ -201,11 +299,81 @@ namespace IO::Common
     header.size = static_cast<std::uint32_t>(this->_data.size() * sizeof(T));
 
     buf.Write(header);
+    buf.Write(this->_data.begin(), this->_data.end());
+  }
+
+  template
+  <
+    Utils::Meta::Concepts::PODType T
+    , std::uint32_t fourcc
+    , FourCCEndian fourcc_endian
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  inline std::uint64_t DataArrayChunk<T, fourcc, fourcc_endian, size_min, size_max>::Hash() const
+  {
+    static_assert(Utils::Meta::Concepts::PaddingFreeType<T>, "Padding bytes of T would be hashed.");
+
+    if (!this->_is_initialized) [[unlikely]]
+      return 0;
+
+    return _hash.Get([this]() -> std::uint64_t
+                     {
+                       return Utils::Misc::Hash64(this->_data.data(), this->_data.size() * sizeof(T), fourcc);
+                     });
+  }
 
-    for (auto& element : this->_data)
+  template
+  <
+    Utils::Meta::Concepts::PODType T
+    , std::uint32_t fourcc
+    , FourCCEndian fourcc_endian
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  inline void DataArrayChunk<T, fourcc, fourcc_endian, size_min, size_max>::SaveState(ByteBuffer& buf) const
+  {
+    buf.Write(this->_is_initialized);
+
+    if (!this->_is_initialized)
+      return;
+
+    buf.Write(static_cast<std::uint64_t>(this->_data.size()));
+
+    if (!this->_data.empty())
+      buf.Write(this->_data.begin(), this->_data.end());
+  }
+
+  template
+  <
+    Utils::Meta::Concepts::PODType T
+    , std::uint32_t fourcc
+    , FourCCEndian fourcc_endian
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  inline void DataArrayChunk<T, fourcc, fourcc_endian, size_min, size_max>::LoadState(ByteBuffer const& buf)
+  {
+    _hash.Invalidate();
+    buf.Read(this->_is_initialized);
+
+    auto const n_elements = this->_is_initialized ? static_cast<std::size_t>(buf.Read<std::uint64_t>()) : 0;
+
+    if constexpr (std::is_same_v<ArrayImplT, std::vector<T>>)
     {
-      buf.Write(element);
+      this->_data.resize(n_elements);
+    }
+    else if (!this->_is_initialized)
+    {
+      return;
     }
+    else
+    {
+      RequireF(CCodeZones::FILE_IO, n_elements == this->_data.size(), "Static array size mismatch (%d).", n_elements);
+    }
+
+    if (n_elements)
+      buf.Read(this->_data.begin(), this->_data.end());
   }
 
   // StringBlockChunk
@@ -223,6 +391,7 @@ namespace IO::Common
     RequireF(LCodeZones::FILE_IO, !this->_is_initialized, "Attempted to initialize an already initialized chunk.");
     _data = strings;
     this->_is_initialized = true;
+    _hash.Invalidate();
   }
 
   template
@@ -247,6 +416,7 @@ namespace IO::Common
     }
 
     this->_is_initialized = true;
+    _hash.Invalidate();
   }
 
   template
@@ -283,6 +453,7 @@ namespace IO::Common
                 , size_min, size_max, _data.size());
 
     this->_is_initialized = true;
+    _hash.Invalidate();
   }
 
   template
@@ -323,6 +494,7 @@ namespace IO::Common
     // make sure data is in ascending order
     std::sort(_data.begin(), _data.end(), [](auto const& a, auto const& b) -> bool { return a.first < b.first; });
     this->_is_initialized = true;
+    _hash.Invalidate();
   }
 
   template
@@ -349,8 +521,10 @@ namespace IO::Common
         "Expected to write chunk with size constraint (min: %d, max : %d), got size %d instead."
         , size_min, size_max, _data.size());
 
-    std::size_t start_pos = buf.Tell();
-    ChunkHeader header{fourcc, 0};
+    std::size_t byte_size = ByteSize();
+    EnsureF(CCodeZones::FILE_IO, byte_size <= std::numeric_limits<std::uint32_t>::max(), "Chunk size overflow.");
+
+    ChunkHeader header{fourcc, static_cast<std::uint32_t>(byte_size)};
     buf.Write(header);
 
     if constexpr (type == StringBlockChunkType::NORMAL)
@@ -367,12 +541,6 @@ namespace IO::Common
         buf.WriteString(string);
       }
     }
-
-    std::size_t end_pos = buf.Tell();
-    header.size = static_cast<std::uint32_t>(end_pos - start_pos - sizeof(ChunkHeader));
-    buf.Seek(start_pos);
-    buf.Write(header);
-    buf.Seek(end_pos);
   }
 
   template
@@ -405,6 +573,106 @@ namespace IO::Common
     return size;
   }
 
+  template
+  <
+    StringBlockChunkType type
+    , std::uint32_t fourcc
+    , FourCCEndian fourcc_endian
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  std::uint64_t StringBlockChunk<type, fourcc, fourcc_endian, size_min, size_max>::Hash() const
+  {
+    if (!this->_is_initialized) [[unlikely]]
+      return 0;
+
+    return _hash.Get([this]() -> std::uint64_t
+                     {
+                       std::uint64_t hash = fourcc;
+
+                       // offsets are derived from the strings, null-terminators keep the boundaries distinct
+                       for (auto& element : _data)
+                       {
+                         std::string const* string;
+
+                         if constexpr (type == StringBlockChunkType::NORMAL)
+                           string = &element;
+                         else
+                           string = &element.second;
+
+                         hash = Utils::Misc::HashCombine(hash, Utils::Misc::Hash64(string->c_str()
+                                                                                   , string->size() + 1));
+                       }
+
+                       return hash;
+                     });
+  }
+
+  template
+  <
+    StringBlockChunkType type
+    , std::uint32_t fourcc
+    , FourCCEndian fourcc_endian
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  void StringBlockChunk<type, fourcc, fourcc_endian, size_min, size_max>::SaveState(ByteBuffer& buf) const
+  {
+    buf.Write(this->_is_initialized);
+
+    if (!this->_is_initialized)
+      return;
+
+    buf.Write(static_cast<std::uint64_t>(_data.size()));
+
+    for (auto& element : _data)
+    {
+      if constexpr (type == StringBlockChunkType::NORMAL)
+      {
+        buf.WriteString(element);
+      }
+      else
+      {
+        buf.Write(element.first);
+        buf.WriteString(element.second);
+      }
+    }
+  }
+
+  template
+  <
+    StringBlockChunkType type
+    , std::uint32_t fourcc
+    , FourCCEndian fourcc_endian
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  void StringBlockChunk<type, fourcc, fourcc_endian, size_min, size_max>::LoadState(ByteBuffer const& buf)
+  {
+    _hash.Invalidate();
+    _data.clear();
+    buf.Read(this->_is_initialized);
+
+    if (!this->_is_initialized)
+      return;
+
+    auto const n_strings = static_cast<std::size_t>(buf.Read<std::uint64_t>());
+    _data.reserve(n_strings);
+
+    for (std::size_t i = 0; i < n_strings; ++i)
+    {
+      if constexpr (type == StringBlockChunkType::NORMAL)
+      {
+        _data.emplace_back(buf.ReadString());
+      }
+      else
+      {
+        auto const offset = buf.Read<std::uint32_t>();
+        _data.emplace_back(offset, buf.ReadString());
+      }
+    }
+  }
+
   template
   <
     StringBlockChunkType type
@@ -415,6 +683,8 @@ namespace IO::Common
   >
   void StringBlockChunk<type, fourcc, fourcc_endian, size_min, size_max>::Add(const std::string& string)
   {
+    _hash.Invalidate();
+
     if constexpr (type == StringBlockChunkType::NORMAL)
     {
       // ensure we do not add the same string more than once
@@ -458,6 +728,7 @@ namespace IO::Common
   void StringBlockChunk<type, fourcc, fourcc_endian, size_min, size_max>::Remove(std::size_t index)
   {
     RequireF(CCodeZones::FILE_IO, index < _data.size(), "Out of bounds remove.");
+    _hash.Invalidate();
     _data.erase(_data.begin() + index);
   }
 
@@ -473,6 +744,7 @@ namespace IO::Common
   void StringBlockChunk<type, fourcc, fourcc_endian, size_min, size_max>::Remove(typename ArrayImplT_::iterator it)
   {
     RequireF(CCodeZones::FILE_IO, it < _data.end(), "Out of bounds remove.");
+    _hash.Invalidate();
 
     if constexpr (type == StringBlockChunkType::NORMAL)
     {
@@ -509,6 +781,7 @@ namespace IO::Common
   void StringBlockChunk<type, fourcc, fourcc_endian, size_min, size_max>::Remove(typename ArrayImplT_::const_iterator it)
   {
     RequireF(CCodeZones::FILE_IO, it < _data.cend(), "Out of bounds remove.");
+    _hash.Invalidate();
 
     if constexpr (type == StringBlockChunkType::NORMAL)
     {
@@ -543,6 +816,7 @@ namespace IO::Common
   >
   void StringBlockChunk<type, fourcc, fourcc_endian, size_min, size_max>::Clear()
   {
+    _hash.Invalidate();
     _data.clear();
   }
 
@@ -575,6 +849,7 @@ namespace IO::Common
       std::size_t index)
   {
     RequireF(CCodeZones::FILE_IO, index < _data.size(), "Out of bounds removed.");
+    _hash.Invalidate();
     return _data[index];
   }
 
@@ -607,6 +882,7 @@ namespace IO::Common
       std::size_t index)
   {
     RequireF(CCodeZones::FILE_IO, index < _data.size(), "Out of bounds removed.");
+    _hash.Invalidate();
     return _data[index];
   }
 
@@ -681,7 +957,7 @@ namespace IO::Common
                 , _sparse_counter);
 
       auto& chunk = this->_data.emplace_back();
-      chunk.Read(buf, size);
+      chunk.Read(ctx, buf, size);
     }
     // static array
     else
@@ -692,7 +968,7 @@ namespace IO::Common
                 , _sparse_counter
                 , this->_data.size());
 
-      this->_data[_sparse_counter++].Read(buf, size);
+      this->_data[_sparse_counter++].Read(ctx, buf, size);
     }
   }
 
@@ -720,7 +996,7 @@ namespace IO::Common
                 , FourCCStr<Chunk::magic, Chunk::magic_endian>
                 , i
                 , this->_data.size());
-      chunk.Write(buf);
+      chunk.Write(ctx, buf);
     }
   }
 
@@ -730,20 +1006,132 @@ namespace IO::Common
     , std::size_t size_min
     , std::size_t size_max
   >
-  inline std::size_t SparseChunkArray<Chunk, size_min, size_max>::ByteSize() const
+  template<typename WriteContext>
+  inline std::size_t SparseChunkArray<Chunk, size_min, size_max>::WriteSize(WriteContext& ctx) const
   {
-    RequireF(CCodeZones::FILE_IO, this->_is_initialized
-             , "Attempt on getting byte size of an uninitialized sparse chunk array");
+    if (!this->_is_initialized) [[unlikely]]
+      return 0;
 
     std::size_t sum = 0;
     for (auto& chunk : this->_data)
     {
-      EnsureF(CCodeZones::FILE_IO, std::numeric_limits<std::size_t>::max() - sum >= chunk.ByteSize(), "Overflow");
-      sum += chunk.ByteSize();
+      std::size_t chunk_size = chunk.WriteSize(ctx);
+      EnsureF(CCodeZones::FILE_IO, std::numeric_limits<std::size_t>::max() - sum >= chunk_size, "Overflow");
+      sum += chunk_size;
     }
 
     return sum;
   }
 
+  template
+  <
+    Concepts::ChunkProtocolCommon Chunk
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  inline std::uint64_t SparseChunkArray<Chunk, size_min, size_max>::Hash() const
+  {
+    if (!this->_is_initialized) [[unlikely]]
+      return 0;
+
+    std::uint64_t hash = Chunk::magic;
+
+    for (auto& chunk : this->_data)
+    {
+      hash = Utils::Misc::HashCombine(hash, chunk.Hash());
+    }
+
+    return hash;
+  }
+
+  template
+  <
+    Concepts::ChunkProtocolCommon Chunk
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  inline std::vector<std::uint64_t> SparseChunkArray<Chunk, size_min, size_max>::ElementHashes() const
+  {
+    std::vector<std::uint64_t> hashes;
+    hashes.reserve(this->_data.size());
+
+    for (auto& chunk : this->_data)
+    {
+      hashes.push_back(chunk.Hash());
+    }
+
+    return hashes;
+  }
+
+  template
+  <
+    Concepts::ChunkProtocolCommon Chunk
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  inline void SparseChunkArray<Chunk, size_min, size_max>::SaveState(ByteBuffer& buf) const
+  {
+    buf.Write(this->_is_initialized);
+
+    if (!this->_is_initialized)
+      return;
+
+    buf.Write(static_cast<std::uint64_t>(_sparse_counter));
+    buf.Write(static_cast<std::uint64_t>(this->_data.size()));
+
+    for (auto& chunk : this->_data)
+    {
+      chunk.SaveState(buf);
+    }
+  }
+
+  template
+  <
+    Concepts::ChunkProtocolCommon Chunk
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  inline void SparseChunkArray<Chunk, size_min, size_max>::LoadState(ByteBuffer const& buf)
+  {
+    buf.Read(this->_is_initialized);
+
+    _sparse_counter = this->_is_initialized ? static_cast<std::size_t>(buf.Read<std::uint64_t>()) : 0;
+    auto const n_chunks = this->_is_initialized ? static_cast<std::size_t>(buf.Read<std::uint64_t>()) : 0;
+
+    if constexpr (std::is_same_v<ArrayImplT, std::vector<Chunk>>)
+    {
+      this->_data.clear();
+      this->_data.resize(n_chunks);
+    }
+    else if (!this->_is_initialized)
+    {
+      return;
+    }
+    else
+    {
+      RequireF(CCodeZones::FILE_IO, n_chunks == this->_data.size(), "Static array size mismatch (%d).", n_chunks);
+    }
+
+    for (auto& chunk : this->_data)
+    {
+      chunk.LoadState(buf);
+    }
+  }
+
+  template
+  <
+    Concepts::ChunkProtocolCommon Chunk
+    , std::size_t size_min
+    , std::size_t size_max
+  >
+  inline void SparseChunkArray<Chunk, size_min, size_max>::DetachUnknownChunks()
+  requires requires (Chunk& chunk) { chunk.DetachUnknownChunks(); }
+  {
+    for (auto& chunk : this->_data)
+    {
+      chunk.DetachUnknownChunks();
+    }
+  }
+
 
 }
@@ -44,8 +44,11 @@ namespace IO::Common::Concepts
     { static_cast<void(T::*)()>(&T::Initialize)};
     { t.Read(any, buf, size)} -> std::same_as<void>;
     { t.Write(any, buf) } -> std::same_as<void>;
-    //{ static_cast<std::size_t(T::*)() const>(&T::ByteSize) };
+    { t.WriteSize(any) } -> std::same_as<std::size_t>;
     { static_cast<bool(T::*)() const>(&T::IsInitialized) };
+    { static_cast<std::uint64_t(T::*)() const>(&T::Hash) };
+    { static_cast<void(T::*)(Common::ByteBuffer&) const>(&T::SaveState) };
+    { static_cast<void(T::*)(Common::ByteBuffer const&)>(&T::LoadState) };
     { &T::magic } ;
     { &T::magic_endian } ;
     { CheckFourCCEqual<T, fourcc_req>() };
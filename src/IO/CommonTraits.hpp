@@ -3,6 +3,7 @@
 #include <Utils/Meta/Templates.hpp>
 #include <Utils/Meta/Traits.hpp>
 #include <Utils/Misc/ForceInline.hpp>
+#include <Utils/Misc/Hash.hpp>
 #include <boost/callable_traits/return_type.hpp>
 
 #include <nameof.hpp>
@@ -10,6 +11,9 @@
 #include <functional>
 #include <type_traits>
 #include <concepts>
+#include <vector>
+#include <algorithm>
+#include <cstring>
 
 namespace IO::Common::Traits
 {
@@ -63,6 +67,9 @@ namespace IO::Common::Traits
 
             { static_cast<void(T::*)(Any&, ByteBuffer&) const>(
               &T::AutoIOTraitInterface_T::template WriteTrait<Any>) };
+
+            { static_cast<std::size_t(T::*)(Any&) const>(
+              &T::AutoIOTraitInterface_T::template WriteSizeTrait<Any>) };
           };
       }
 
@@ -112,6 +119,14 @@ namespace IO::Common::Traits
       , details::EmptyTrait<T>
     >;
 
+  /**
+   * Provides a type for the optional trait of a chunk / class, present based on an arbitrary compiletime condition.
+   * @tparam T Any type that satisfies named requirements of a trait (see associated concept).
+   * @tparam enabled True if the trait is present.
+   */
+  template<IsIOTraitImpl T, bool enabled>
+  using ConditionalTrait = std::conditional_t<enabled, T, details::EmptyTrait<T>>;
+
   /**
    * Represents one of the trait options to be used with IO::Common::Traits::SwitchableTrait
    * @tparam val Trait identifier to match against, e.g. an enum.
@@ -300,6 +315,10 @@ namespace IO::Common::Traits
    * (and chunk/trait was read).
    * Must match signature:
    * void(auto* self, auto& ctx, auto& chunk_or_trait, IO::Common::ByteBuffer& buf)
+   *
+   * Write callbacks must not write any data into the buffer, nor skip chunks or traits that report a non-zero
+   * WriteSize(): the layout of the file is computed before writing (see WriteSize()), and only then the data is written
+   * in a single forward pass. Use the callbacks to record positions into the context instead.
    */
   template<auto pre = nullptr, auto post = nullptr>
   requires
@@ -393,6 +412,40 @@ namespace IO::Common::Traits
       if constexpr (WriteHandler::has_post)
         WriteHandler::callback_post(self, write_ctx, self->*chunk, buf);
     }
+
+    template<typename Self, typename WriteContext>
+    static std::size_t WriteSize(Self const* self, WriteContext& write_ctx)
+    {
+      return (self->*chunk).WriteSize(write_ctx);
+    }
+
+    template<typename Self>
+    static std::uint64_t Hash(Self const* self, std::uint64_t seed)
+    {
+      return Utils::Misc::HashCombine(seed, (self->*chunk).Hash());
+    }
+
+    template<typename Self>
+    static void SaveState(Self const* self, ByteBuffer& buf)
+    {
+      (self->*chunk).SaveState(buf);
+    }
+
+    template<typename Self>
+    static void LoadState(Self* self, ByteBuffer const& buf)
+    {
+      (self->*chunk).LoadState(buf);
+    }
+
+    template<typename Self>
+    static void DetachUnknownChunks(Self* self)
+    {
+      // only chunks using the traits system (or arrays of them) keep unknown sub-chunks
+      if constexpr (requires { (self->*chunk).DetachUnknownChunks(); })
+      {
+        (self->*chunk).DetachUnknownChunks();
+      }
+    }
   };
 
   namespace details
@@ -459,6 +512,39 @@ namespace IO::Common::Traits
       if constexpr (WriteHandler::has_post)
         WriteHandler::callback_post(self, write_ctx, *static_cast<Trait*>(self), buf);
     }
+
+    template<typename Self, typename WriteContext>
+    static std::size_t WriteSize(Self const* self, WriteContext& write_ctx)
+    {
+      return static_cast<const Trait*>(self)->WriteSizeTrait(write_ctx);
+    }
+
+    template<typename Self>
+    static std::uint64_t Hash(Self const* self, std::uint64_t seed)
+    {
+      return Utils::Misc::HashCombine(seed, static_cast<const Trait*>(self)->HashTrait());
+    }
+
+    template<typename Self>
+    static void SaveState(Self const* self, ByteBuffer& buf)
+    {
+      static_cast<const Trait*>(self)->SaveStateTrait(buf);
+    }
+
+    template<typename Self>
+    static void LoadState(Self* self, ByteBuffer const& buf)
+    {
+      static_cast<Trait*>(self)->LoadStateTrait(buf);
+    }
+
+    template<typename Self>
+    static void DetachUnknownChunks(Self* self)
+    {
+      if constexpr (requires { static_cast<Trait*>(self)->DetachUnknownChunksTrait(); })
+      {
+        static_cast<Trait*>(self)->DetachUnknownChunksTrait();
+      }
+    }
   };
 
   namespace details
@@ -477,6 +563,31 @@ namespace IO::Common::Traits
   template<typename T>
   concept IsIOTrait = details::IsIOTraitImpl<T>::value;
 
+  namespace details
+  {
+    class UnknownChunkStorage;
+
+    /**
+     * Writes unknown chunks back in between the known ones, see UnknownChunkStorage.
+     * Slots are counted from first_slot, so that nested entries (auto-trait entries, traits) can be numbered locally.
+     */
+    struct UnknownChunkWriter
+    {
+      UnknownChunkStorage const* storage = nullptr;
+      std::size_t first_slot = 0;
+
+      /**
+       * Writes the unknown chunks that preceded the given slot on reading. No-op without storage (e.g. components).
+       * @param buf Buffer to write into.
+       * @param slot Write slot, relative to first_slot.
+       */
+      void operator()(Common::ByteBuffer& buf, std::size_t slot) const;
+
+      [[nodiscard]]
+      UnknownChunkWriter Offset(std::size_t n_slots) const { return {storage, first_slot + n_slots}; };
+    };
+  }
+
 
   /**
    * Adapter class accepting all traits of class, and providing a common interface to invoke them.
@@ -495,23 +606,145 @@ namespace IO::Common::Traits
 
   // interface
   protected:
+    static constexpr std::size_t n_traits = sizeof...(Traits);
+
     template<typename ReadContext>
-    bool TraitsRead(ReadContext& ctx, Common::ByteBuffer const& buf, Common::ChunkHeader const& chunk_header)
+    bool TraitsRead(ReadContext& ctx
+                    , Common::ByteBuffer const& buf
+                    , Common::ChunkHeader const& chunk_header
+                    , std::size_t& trait_index)
     {
-      return RecurseRead(ctx, buf, chunk_header, TypePack<Traits...>());
+      return RecurseRead(ctx, buf, chunk_header, trait_index, TypePack<Traits...>());
     };
 
     template<typename WriteContext>
-    void TraitsWrite(WriteContext& ctx, Common::ByteBuffer& buf) const
+    void TraitsWrite(WriteContext& ctx, Common::ByteBuffer& buf, details::UnknownChunkWriter const& unknown) const
+    {
+      RecurseWrite(ctx, buf, unknown, TypePack<Traits...>());
+    }
+
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t TraitsWriteSize(WriteContext& ctx) const
+    {
+      return RecurseWriteSize(ctx, TypePack<Traits...>());
+    }
+
+    [[nodiscard]]
+    std::uint64_t TraitsHash(std::uint64_t seed) const
+    {
+      return RecurseHash(seed, TypePack<Traits...>());
+    }
+
+    void TraitsSaveState(Common::ByteBuffer& buf) const
+    {
+      RecurseSaveState(buf, TypePack<Traits...>());
+    }
+
+    void TraitsLoadState(Common::ByteBuffer const& buf)
+    {
+      RecurseLoadState(buf, TypePack<Traits...>());
+    }
+
+    void TraitsDetachUnknownChunks()
     {
-      RecurseWrite(ctx, buf, TypePack<Traits...>());
+      RecurseDetachUnknownChunks(TypePack<Traits...>());
     }
 
   // impl
   private:
     template<typename T, typename WriteContext, typename... Ts>
-    void RecurseWrite(WriteContext& ctx, Common::ByteBuffer& buf, TypePack<T, Ts...>) const
+    [[nodiscard]]
+    std::size_t RecurseWriteSize(WriteContext& ctx, TypePack<T, Ts...>) const
+    {
+      std::size_t size = 0;
+
+      // check if trait is enabled
+      if constexpr (!std::is_empty_v<typename T::TraitT> && HasTraitEnabled<AutoIOTraits, typename T::TraitT>)
+      {
+        size += T::WriteSize(this, ctx);
+      }
+
+      if constexpr (sizeof...(Ts))
+      {
+        size += RecurseWriteSize(ctx, TypePack<Ts...>());
+      }
+
+      return size;
+    }
+
+    template<typename T, typename... Ts>
+    [[nodiscard]]
+    std::uint64_t RecurseHash(std::uint64_t seed, TypePack<T, Ts...>) const
+    {
+      // check if trait is enabled
+      if constexpr (!std::is_empty_v<typename T::TraitT> && HasTraitEnabled<AutoIOTraits, typename T::TraitT>)
+      {
+        seed = T::Hash(this, seed);
+      }
+
+      if constexpr (sizeof...(Ts))
+      {
+        seed = RecurseHash(seed, TypePack<Ts...>());
+      }
+
+      return seed;
+    }
+
+    template<typename T, typename... Ts>
+    void RecurseSaveState(Common::ByteBuffer& buf, TypePack<T, Ts...>) const
+    {
+      // check if trait is enabled
+      if constexpr (!std::is_empty_v<typename T::TraitT> && HasTraitEnabled<AutoIOTraits, typename T::TraitT>)
+      {
+        T::SaveState(this, buf);
+      }
+
+      if constexpr (sizeof...(Ts))
+      {
+        RecurseSaveState(buf, TypePack<Ts...>());
+      }
+    }
+
+    template<typename T, typename... Ts>
+    void RecurseLoadState(Common::ByteBuffer const& buf, TypePack<T, Ts...>)
     {
+      // check if trait is enabled
+      if constexpr (!std::is_empty_v<typename T::TraitT> && HasTraitEnabled<AutoIOTraits, typename T::TraitT>)
+      {
+        T::LoadState(this, buf);
+      }
+
+      if constexpr (sizeof...(Ts))
+      {
+        RecurseLoadState(buf, TypePack<Ts...>());
+      }
+    }
+
+    template<typename T, typename... Ts>
+    void RecurseDetachUnknownChunks(TypePack<T, Ts...>)
+    {
+      // check if trait is enabled
+      if constexpr (!std::is_empty_v<typename T::TraitT> && HasTraitEnabled<AutoIOTraits, typename T::TraitT>)
+      {
+        T::DetachUnknownChunks(this);
+      }
+
+      if constexpr (sizeof...(Ts))
+      {
+        RecurseDetachUnknownChunks(TypePack<Ts...>());
+      }
+    }
+
+    template<typename T, typename WriteContext, typename... Ts>
+    void RecurseWrite(WriteContext& ctx
+                      , Common::ByteBuffer& buf
+                      , details::UnknownChunkWriter const& unknown
+                      , TypePack<T, Ts...>) const
+    {
+      // unknown chunks are kept even if the trait is disabled
+      unknown(buf, n_traits - sizeof...(Ts) - 1);
+
       // check if trait is enabled
       if constexpr (!std::is_empty_v<typename T::TraitT> && HasTraitEnabled<AutoIOTraits, typename T::TraitT>)
       {
@@ -520,7 +753,7 @@ namespace IO::Common::Traits
 
       if constexpr (sizeof...(Ts))
       {
-        RecurseWrite(ctx, buf, TypePack<Ts...>());
+        RecurseWrite(ctx, buf, unknown, TypePack<Ts...>());
       }
     }
 
@@ -529,6 +762,7 @@ namespace IO::Common::Traits
     bool RecurseRead(ReadContext& ctx
                      , Common::ByteBuffer const& buf
                      , Common::ChunkHeader const& chunk_header
+                     , std::size_t& trait_index
                      , TypePack<T, Ts...>)
     {
       // check if trait is enabled
@@ -536,12 +770,15 @@ namespace IO::Common::Traits
         && HasTraitEnabled<AutoIOTraits, typename T::TraitT>)
       {
         if (T::Read(this, ctx, buf, chunk_header))
+        {
+          trait_index = n_traits - sizeof...(Ts) - 1;
           return true;
+        }
       }
 
       if constexpr (sizeof...(Ts))
       {
-        if (RecurseRead(ctx, buf, chunk_header, TypePack<Ts...>()))
+        if (RecurseRead(ctx, buf, chunk_header, trait_index, TypePack<Ts...>()))
           return true;
       }
 
@@ -551,8 +788,117 @@ namespace IO::Common::Traits
 
   namespace details
   {
+    /**
+     * Keeps the chunks not recognized on reading a file or a chunk, so that they can be written back verbatim.
+     * Each unknown chunk is anchored to the write slot of the object that preceded it on reading: 0 for
+     * WriteExtraPre(), then one slot per auto-trait entry, one per trait, one for WriteExtraPost(), and a last one
+     * for chunks following everything. Unknown chunks are written inline right before their slot, so the object is
+     * still written in a single forward pass. Chunks found in between the elements of a multi-chunk slot
+     * (e.g. ADT MCNKs) are written after the whole slot.
+     */
+    class UnknownChunkStorage
+    {
+      friend struct UnknownChunkWriter;
+
+    public:
+      /**
+       * @return Chunks that were not recognized on reading, in their order in the source.
+       */
+      [[nodiscard]]
+      std::vector<Common::RawChunk> const& UnknownChunks() const { return _unknown_chunks; };
+
+      /**
+       * Drops unknown chunks, they won't be written.
+       */
+      void ClearUnknownChunks() { _unknown_chunks.clear(); };
+
+    protected:
+      void AddUnknownChunk(Common::ChunkHeader const& chunk_header
+                           , Common::ByteBuffer const& buf
+                           , std::size_t slot)
+      {
+        LogDebugF(LCodeZones::FILE_IO, "Keeping unknown chunk %s, size: %d as raw data."
+                  , Common::FourCCToStr(chunk_header.fourcc).c_str(), chunk_header.size);
+
+        _unknown_chunks.emplace_back(chunk_header, buf.Data() + buf.Tell(), slot);
+      }
+
+      void UnknownChunksDetach()
+      {
+        for (auto& chunk : _unknown_chunks)
+        {
+          chunk.Detach();
+        }
+      }
+
+      [[nodiscard]]
+      std::size_t UnknownChunksWriteSize() const
+      {
+        std::size_t size = 0;
+
+        for (auto& chunk : _unknown_chunks)
+        {
+          size += chunk.WriteSize();
+        }
+
+        return size;
+      }
+
+      [[nodiscard]]
+      std::uint64_t UnknownChunksHash(std::uint64_t seed) const
+      {
+        for (auto& chunk : _unknown_chunks)
+        {
+          seed = Utils::Misc::HashCombine(seed, chunk.Hash());
+        }
+
+        return seed;
+      }
+
+      void UnknownChunksSaveState(Common::ByteBuffer& buf) const
+      {
+        buf.Write(static_cast<std::uint64_t>(_unknown_chunks.size()));
+
+        for (auto& chunk : _unknown_chunks)
+        {
+          chunk.SaveState(buf);
+        }
+      }
+
+      void UnknownChunksLoadState(Common::ByteBuffer const& buf)
+      {
+        auto const n_chunks = static_cast<std::size_t>(buf.Read<std::uint64_t>());
+
+        ClearUnknownChunks();
+        _unknown_chunks.reserve(n_chunks);
+
+        for (std::size_t i = 0; i < n_chunks; ++i)
+        {
+          _unknown_chunks.push_back(Common::RawChunk::LoadState(buf));
+        }
+      }
+
+      void WriteUnknownChunks(Common::ByteBuffer& buf, std::size_t slot) const
+      {
+        for (auto& chunk : _unknown_chunks)
+        {
+          if (chunk.Position() == slot)
+            chunk.Write(buf);
+        }
+      }
+
+    private:
+      std::vector<Common::RawChunk> _unknown_chunks;
+    };
+
+    inline void UnknownChunkWriter::operator()(Common::ByteBuffer& buf, std::size_t slot) const
+    {
+      if (storage)
+        storage->WriteUnknownChunks(buf, first_slot + slot);
+    }
+
     template<typename CRTP>
-    class AutoIOTraitInterfaceFileImpl
+    class AutoIOTraitInterfaceFileImpl : public UnknownChunkStorage
     {
     private:
       CRTP* GetThis() { return static_cast<CRTP*>(this); };
@@ -578,15 +924,21 @@ namespace IO::Common::Traits
           RequireF(CCodeZones::FILE_IO, !buf.Tell(), "Attempted to read ByteBuffer from non-zero adress.");
           RequireF(CCodeZones::FILE_IO, !buf.IsEof(), "Attempted to read ByteBuffer past EOF.");
 
+          ClearUnknownChunks();
+          std::size_t next_slot = 0;
+
           while (!buf.IsEof())
           {
             auto const& chunk_header = buf.ReadView<Common::ChunkHeader>();
 
-            if (GetThis()->ReadCommon(read_ctx, buf, chunk_header))
+            if (std::size_t slot = 0; GetThis()->ReadCommon(read_ctx, buf, chunk_header, slot))
+            {
+              next_slot = slot + 1;
               continue;
+            }
 
+            AddUnknownChunk(chunk_header, buf, next_slot);
             buf.Seek<Common::ByteBuffer::SeekDir::Forward, Common::ByteBuffer::SeekType::Relative>(chunk_header.size);
-            LogError("Encountered unknown or unhandled chunk %s.", Common::FourCCToStr(chunk_header.fourcc));
           }
 
           EnsureF(CCodeZones::FILE_IO, buf.IsEof(), "Not all chunks have been parsed in the file. "
@@ -605,16 +957,113 @@ namespace IO::Common::Traits
         Write(write_ctx, buf);
       };
 
+      /**
+       * Writes the file into the buffer at its current position.
+       * The exact size of the file is computed first (see ByteSize()), the buffer is grown once to fit it, and then
+       * all chunks are written in a single forward pass. Borrowed buffers (e.g. a memory mapped output file) can be
+       * written to, as long as they are large enough to fit the file.
+       * @tparam WriteContext Write context.
+       * @param write_ctx Write context.
+       * @param buf Buffer to write into.
+       */
       template<typename WriteContext>
       void Write(WriteContext& write_ctx, Common::ByteBuffer& buf) const
       {
         GetThis()->ValidateDependentInterfaces();
-        RequireF(CCodeZones::FILE_IO, buf.IsDataOnwed(), "Attempt to write into read-only buffer.");
 
-        LogDebugF(LCodeZones::FILE_IO, "Writing %s file...", NAMEOF_SHORT_TYPE(typename CRTP::Derived));
+        std::size_t const file_size = GetThis()->WriteSizeCommon(write_ctx) + UnknownChunksWriteSize();
+        std::size_t const start_pos = buf.Tell();
+
+        RequireF(CCodeZones::FILE_IO, buf.IsDataOnwed() || buf.Size() - start_pos >= file_size
+                 , "Attempt to write into read-only buffer or a borrowed buffer that is too small.");
+
+        LogDebugF(LCodeZones::FILE_IO, "Writing %s file, size: %d..."
+                  , NAMEOF_SHORT_TYPE(typename CRTP::Derived), file_size);
         LogIndentScoped;
 
-        GetThis()->WriteCommon(write_ctx, buf);
+        if (buf.IsDataOnwed())
+        {
+          buf.ReserveCapacity(start_pos + file_size);
+        }
+
+        GetThis()->WriteCommon(write_ctx, buf, {this});
+
+        EnsureF(CCodeZones::FILE_IO, buf.Tell() - start_pos == file_size
+                , "Written %d bytes, while %d bytes were expected. WriteSize() of some chunk is not exact."
+                , buf.Tell() - start_pos, file_size);
+      }
+
+      /**
+       * Computes the exact size of the file in bytes, as it would be written with Write().
+       * @tparam WriteContext Write context.
+       * @return Size of the file in bytes.
+       */
+      template<std::default_initializable WriteContext = DefaultTraitContext>
+      [[nodiscard]]
+      std::size_t ByteSize() const
+      {
+        WriteContext write_ctx {};
+
+        return ByteSize(write_ctx);
+      }
+
+      /**
+       * Computes the exact size of the file in bytes, as it would be written with Write().
+       * @tparam WriteContext Write context.
+       * @param write_ctx Write context.
+       * @return Size of the file in bytes.
+       */
+      template<typename WriteContext>
+      [[nodiscard]]
+      std::size_t ByteSize(WriteContext& write_ctx) const
+      {
+        GetThis()->ValidateDependentInterfaces();
+
+        return GetThis()->WriteSizeCommon(write_ctx) + UnknownChunksWriteSize();
+      }
+
+      /**
+       * Structural hash of the file, combined from the hashes of all its chunks and traits in writing order.
+       * Chunk hashes are cached by the chunks themselves, so re-hashing a file after a local edit is cheap.
+       * @return Hash value.
+       */
+      [[nodiscard]]
+      std::uint64_t Hash() const
+      {
+        return UnknownChunksHash(GetThis()->HashCommon());
+      }
+
+      /**
+       * Writes the decoded in-memory state of the file: chunks and traits in writing order, then unknown chunks.
+       * Nothing is encoded (e.g. alpha maps are kept as decoded), and no offsets or sizes are computed, so that
+       * LoadState() restores the object without parsing. The layout is native and only meant to be read back by the
+       * same build of the library, e.g. by a cache.
+       * @param buf Buffer to write into.
+       */
+      void SaveState(Common::ByteBuffer& buf) const
+      {
+        GetThis()->SaveStateCommon(buf);
+        UnknownChunksSaveState(buf);
+      }
+
+      /**
+       * Restores the state written by SaveState(), replacing the contents of the object. Unknown chunks own their data.
+       * @param buf Buffer to read from.
+       */
+      void LoadState(Common::ByteBuffer const& buf)
+      {
+        GetThis()->LoadStateCommon(buf);
+        UnknownChunksLoadState(buf);
+      }
+
+      /**
+       * Copies the data of all unknown chunks, including those kept by sub-chunks and traits, from the source buffer,
+       * so that it is no longer required to outlive this object.
+       */
+      void DetachUnknownChunks()
+      {
+        UnknownChunksDetach();
+        GetThis()->DetachUnknownChunksCommon();
       }
     };
 
@@ -632,22 +1081,50 @@ namespace IO::Common::Traits
       {
         GetThis()->ValidateDependentInterfaces();
 
-        return GetThis()->ReadCommon(read_ctx, buf, chunk_header);
+        std::size_t slot = 0;
+        return GetThis()->ReadCommon(read_ctx, buf, chunk_header, slot);
       };
 
       template<typename WriteContext>
       void WriteTrait(WriteContext& write_ctx, Common::ByteBuffer& buf) const
       {
         GetThis()->ValidateDependentInterfaces();
-        RequireF(CCodeZones::FILE_IO, buf.IsDataOnwed(), "Attempt to write into read-only buffer.");
 
         GetThis()->WriteCommon(write_ctx, buf);
       };
+
+      template<typename WriteContext>
+      [[nodiscard]]
+      std::size_t WriteSizeTrait(WriteContext& write_ctx) const
+      {
+        return GetThis()->WriteSizeCommon(write_ctx);
+      };
+
+      [[nodiscard]]
+      std::uint64_t HashTrait() const
+      {
+        return GetThis()->HashCommon();
+      };
+
+      void SaveStateTrait(Common::ByteBuffer& buf) const
+      {
+        GetThis()->SaveStateCommon(buf);
+      };
+
+      void LoadStateTrait(Common::ByteBuffer const& buf)
+      {
+        GetThis()->LoadStateCommon(buf);
+      };
+
+      void DetachUnknownChunksTrait()
+      {
+        GetThis()->DetachUnknownChunksCommon();
+      };
     };
 
 
     template<typename CRTP>
-    class AutoIOTraitInterfaceChunkImpl
+    class AutoIOTraitInterfaceChunkImpl : public UnknownChunkStorage
     {
     private:
       CRTP* GetThis() { return static_cast<CRTP*>(this); };
@@ -666,17 +1143,25 @@ namespace IO::Common::Traits
 
         std::size_t end_pos = buf.Tell() + size;
 
+        GetThis()->ReadInlineHeaderCommon(read_ctx, buf);
+
+        ClearUnknownChunks();
+        std::size_t next_slot = 0;
+
         while(buf.Tell() != end_pos)
         {
           EnsureF(CCodeZones::FILE_IO, buf.Tell() < end_pos, "Disproportional read attempt. Read past expected end.");
 
           auto const& chunk_header = buf.ReadView<Common::ChunkHeader>();
 
-          if (GetThis()->ReadCommon(read_ctx, buf, chunk_header))
+          if (std::size_t slot = 0; GetThis()->ReadCommon(read_ctx, buf, chunk_header, slot))
+          {
+            next_slot = slot + 1;
             continue;
+          }
 
+          AddUnknownChunk(chunk_header, buf, next_slot);
           buf.Seek<Common::ByteBuffer::SeekDir::Forward, Common::ByteBuffer::SeekType::Relative>(chunk_header.size);
-          LogError("Encountered unknown or unhandled chunk %s.", Common::FourCCToStr(chunk_header.fourcc));
         }
 
         GetThis()->SetChunkInitialized();
@@ -689,30 +1174,111 @@ namespace IO::Common::Traits
           return;
 
         GetThis()->ValidateDependentInterfaces();
-        RequireF(CCodeZones::FILE_IO, buf.IsDataOnwed(), "Attempt to write into read-only buffer.");
 
-        LogDebugF(LCodeZones::FILE_IO, "Writing chunk: %s."
-                  , FourCCStr<CRTP::Derived::magic, CRTP::Derived::magic_endian>);
+        std::size_t const byte_size = ByteSize(write_ctx);
+
+        LogDebugF(LCodeZones::FILE_IO, "Writing chunk: %s, size: %d."
+                  , FourCCStr<CRTP::Derived::magic, CRTP::Derived::magic_endian>
+                  , byte_size);
         LogIndentScoped;
 
-        std::size_t pos = buf.Tell();
+        EnsureF(CCodeZones::FILE_IO, byte_size <= std::numeric_limits<std::uint32_t>::max(), "Chunk size overflow.");
 
-        Common::ChunkHeader chunk_header {CRTP::Derived::magic, 0};
+        Common::ChunkHeader chunk_header {CRTP::Derived::magic, static_cast<std::uint32_t>(byte_size)};
         buf.Write(chunk_header);
 
-        GetThis()->WriteCommon(write_ctx, buf);
+        GetThis()->WriteInlineHeaderCommon(write_ctx, buf);
+        GetThis()->WriteCommon(write_ctx, buf, {this});
+      }
+
+      /**
+       * Size of the chunk data in bytes, as it would be written with Write() (without header).
+       * @tparam WriteContext Write context.
+       * @param write_ctx Write context.
+       * @return Number of bytes.
+       */
+      template<typename WriteContext>
+      [[nodiscard]]
+      std::size_t ByteSize(WriteContext& write_ctx) const
+      {
+        return GetThis()->WriteSizeInlineHeaderCommon(write_ctx) + GetThis()->WriteSizeCommon(write_ctx)
+          + UnknownChunksWriteSize();
+      }
 
-        std::size_t end_pos = buf.Tell();
-        buf.Seek(pos);
+      /**
+       * Exact number of bytes written by Write() (with header). 0 for an uninitialized chunk.
+       * @tparam WriteContext Write context.
+       * @param write_ctx Write context.
+       * @return Number of bytes.
+       */
+      template<typename WriteContext>
+      [[nodiscard]]
+      std::size_t WriteSize(WriteContext& write_ctx) const
+      {
+        if (!GetThis()->IsChunkInitialized()) [[unlikely]]
+          return 0;
 
-        EnsureF(CCodeZones::FILE_IO, (end_pos - pos - sizeof(Common::ChunkHeader)) <= std::numeric_limits<std::uint32_t>::max()
-                , "Chunk size overflow.");
+        return sizeof(Common::ChunkHeader) + ByteSize(write_ctx);
+      }
 
-        chunk_header.size = static_cast<std::uint32_t>(end_pos - pos - sizeof(Common::ChunkHeader));
-        buf.Write(chunk_header);
-        buf.Seek(end_pos);
+      /**
+       * Structural hash of the chunk, combined from the hashes of all its sub-chunks and traits in writing order.
+       * 0 for an uninitialized chunk.
+       * @return Hash value.
+       */
+      [[nodiscard]]
+      std::uint64_t Hash() const
+      {
+        if (!GetThis()->IsChunkInitialized()) [[unlikely]]
+          return 0;
+
+        return UnknownChunksHash(GetThis()->HashCommon());
+      }
+
+      /**
+       * Writes the decoded in-memory state of the chunk, see AutoIOTraitInterfaceFileImpl::SaveState().
+       * @param buf Buffer to write into.
+       */
+      void SaveState(Common::ByteBuffer& buf) const
+      {
+        bool const is_initialized = GetThis()->IsChunkInitialized();
+        buf.Write(is_initialized);
+
+        if (!is_initialized)
+          return;
+
+        GetThis()->SaveStateCommon(buf);
+        UnknownChunksSaveState(buf);
+      }
+
+      /**
+       * Restores the state written by SaveState(), replacing the contents of the chunk.
+       * @param buf Buffer to read from.
+       */
+      void LoadState(Common::ByteBuffer const& buf)
+      {
+        auto const is_initialized = buf.Read<bool>();
+        GetThis()->SetChunkInitialized(is_initialized);
+
+        if (!is_initialized)
+        {
+          ClearUnknownChunks();
+          return;
+        }
+
+        GetThis()->LoadStateCommon(buf);
+        UnknownChunksLoadState(buf);
       }
 
+      /**
+       * Copies the data of all unknown chunks of the chunk and of its sub-chunks from the source buffer,
+       * see AutoIOTraitInterfaceFileImpl::DetachUnknownChunks().
+       */
+      void DetachUnknownChunks()
+      {
+        UnknownChunksDetach();
+        GetThis()->DetachUnknownChunksCommon();
+      }
     };
 
     struct AutoIOTraitInterfaceEmptyImpl{};
@@ -799,16 +1365,96 @@ namespace IO::Common::Traits
       return GetThis()->_is_initialized;
     }
 
-    void SetChunkInitialized()
+    void SetChunkInitialized(bool is_initialized = true)
     requires (trait_type == TraitType::Chunk)
     {
-      GetThis()->_is_initialized = true;
+      GetThis()->_is_initialized = is_initialized;
     }
 
   private:
+    template<typename ReadContext>
+    void ReadInlineHeaderCommon(ReadContext& read_ctx, Common::ByteBuffer const& buf)
+    requires (trait_type == TraitType::Chunk)
+    {
+      // invoke optional method to handle fixed-size data preceding the sub-chunks (e.g. ADT MCNK header)
+      if constexpr (requires (CRTP crtp){ { crtp.ReadInlineHeader(read_ctx, buf) } -> std::same_as<void>; })
+      {
+        GetThis()->ReadInlineHeader(read_ctx, buf);
+      }
+    }
+
+    template<typename WriteContext>
+    void WriteInlineHeaderCommon(WriteContext& write_ctx, Common::ByteBuffer& buf) const
+    requires (trait_type == TraitType::Chunk)
+    {
+      if constexpr (requires (CRTP crtp){ { crtp.WriteInlineHeader(write_ctx, buf) } -> std::same_as<void>; })
+      {
+        GetThis()->WriteInlineHeader(write_ctx, buf);
+      }
+    }
+
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSizeInlineHeaderCommon(WriteContext& write_ctx) const
+    requires (trait_type == TraitType::Chunk)
+    {
+      constexpr bool has_inline_header = requires (CRTP crtp, Common::ByteBuffer& buf)
+      {
+        { crtp.WriteInlineHeader(write_ctx, buf) } -> std::same_as<void>;
+      };
+
+      if constexpr (requires (CRTP const crtp){ { crtp.WriteSizeInlineHeader(write_ctx) } -> std::same_as<std::size_t>; })
+      {
+        return GetThis()->WriteSizeInlineHeader(write_ctx);
+      }
+      else
+      {
+        static_assert(!has_inline_header && "WriteInlineHeader requires WriteSizeInlineHeader to be implemented.");
+        return 0;
+      }
+    }
+
+    /**
+     * @return Number of write slots taken by auto-trait entries, see details::UnknownChunkStorage.
+     */
+    [[nodiscard]]
+    static constexpr std::size_t EntrySlotCount()
+    {
+      if constexpr (requires { { &CRTP::_auto_trait }; })
+      {
+        return decltype(CRTP::_auto_trait)::n_entries;
+      }
+      else
+      {
+        return 0;
+      }
+    }
+
+    /**
+     * @return Number of write slots taken by traits, see details::UnknownChunkStorage.
+     */
+    [[nodiscard]]
+    static constexpr std::size_t TraitSlotCount()
+    {
+      if constexpr (requires { { CRTP::n_traits }; })
+      {
+        return CRTP::n_traits;
+      }
+      else
+      {
+        return 0;
+      }
+    }
+
     template<typename WriteContext>
-    void WriteCommon(WriteContext& write_ctx, Common::ByteBuffer& buf) const
+    void WriteCommon(WriteContext& write_ctx
+                     , Common::ByteBuffer& buf
+                     , details::UnknownChunkWriter const& unknown = {}) const
     {
+      constexpr std::size_t extra_post_slot = 1 + EntrySlotCount() + TraitSlotCount();
+
+      unknown(buf, 0);
+
       // invoke optional method to handle unlisted chunks that cannot be processed automatically
       if constexpr (requires (CRTP crtp){ { crtp.WriteExtraPre(write_ctx, buf) } -> std::same_as<void>; })
       {
@@ -818,56 +1464,208 @@ namespace IO::Common::Traits
       // Use auto-trait if present in type
       if constexpr (requires { { &CRTP::_auto_trait }; })
       {
-        decltype(CRTP::_auto_trait)::template WriteChunks(GetThis(), write_ctx, buf);
+        decltype(CRTP::_auto_trait)::template WriteChunks(GetThis(), write_ctx, buf, unknown.Offset(1));
       }
 
       // check if derived class also inherits from traits
       if constexpr (requires { { &CRTP::template TraitsWrite<WriteContext> }; })
       {
-        GetThis()->TraitsWrite(write_ctx, buf);
+        GetThis()->TraitsWrite(write_ctx, buf, unknown.Offset(1 + EntrySlotCount()));
       }
 
+      unknown(buf, extra_post_slot);
+
       // invoke optional method to handle unlisted chunks that cannot be processed automatically
       if constexpr (requires (CRTP crtp){ { crtp.WriteExtraPost(write_ctx, buf) } -> std::same_as<void>; })
       {
         GetThis()->WriteExtraPost(write_ctx, buf);
       }
+
+      unknown(buf, extra_post_slot + 1);
+    }
+
+    template<typename WriteContext>
+    [[nodiscard]]
+    std::size_t WriteSizeCommon(WriteContext& write_ctx) const
+    {
+      std::size_t size = 0;
+
+      // unlisted chunks written by the optional methods must be accounted for by the optional sizing method
+      constexpr bool has_write_extra = requires (CRTP crtp, Common::ByteBuffer& buf)
+      {
+        { crtp.WriteExtraPre(write_ctx, buf) } -> std::same_as<void>;
+      } || requires (CRTP crtp, Common::ByteBuffer& buf)
+      {
+        { crtp.WriteExtraPost(write_ctx, buf) } -> std::same_as<void>;
+      };
+
+      if constexpr (requires (CRTP const crtp){ { crtp.WriteSizeExtra(write_ctx) } -> std::same_as<std::size_t>; })
+      {
+        size += GetThis()->WriteSizeExtra(write_ctx);
+      }
+      else
+      {
+        static_assert(!has_write_extra && "WriteExtraPre / WriteExtraPost require WriteSizeExtra to be implemented.");
+      }
+
+      // Use auto-trait if present in type
+      if constexpr (requires { { &CRTP::_auto_trait }; })
+      {
+        size += decltype(CRTP::_auto_trait)::ChunksWriteSize(GetThis(), write_ctx);
+      }
+
+      // check if derived class also inherits from traits
+      if constexpr (requires { { &CRTP::template TraitsWriteSize<WriteContext> }; })
+      {
+        size += GetThis()->TraitsWriteSize(write_ctx);
+      }
+
+      return size;
+    }
+
+    [[nodiscard]]
+    std::uint64_t HashCommon() const
+    {
+      std::uint64_t hash = 0;
+
+      if constexpr (trait_type == TraitType::Chunk)
+      {
+        hash = CRTP::magic;
+      }
+
+      // Use auto-trait if present in type
+      if constexpr (requires { { &CRTP::_auto_trait }; })
+      {
+        hash = decltype(CRTP::_auto_trait)::HashChunks(GetThis(), hash);
+      }
+
+      // check if derived class also inherits from traits
+      if constexpr (requires { { &CRTP::TraitsHash }; })
+      {
+        hash = GetThis()->TraitsHash(hash);
+      }
+
+      // invoke optional method to hash unlisted chunks that cannot be processed automatically
+      if constexpr (requires (CRTP const crtp){ { crtp.HashExtra(hash) } -> std::same_as<std::uint64_t>; })
+      {
+        hash = GetThis()->HashExtra(hash);
+      }
+
+      return hash;
     }
 
+    void SaveStateCommon(Common::ByteBuffer& buf) const
+    {
+      // Use auto-trait if present in type
+      if constexpr (requires { { &CRTP::_auto_trait }; })
+      {
+        decltype(CRTP::_auto_trait)::SaveStateChunks(GetThis(), buf);
+      }
+
+      // check if derived class also inherits from traits
+      if constexpr (requires { { &CRTP::TraitsSaveState }; })
+      {
+        GetThis()->TraitsSaveState(buf);
+      }
+
+      // invoke optional method to save state that is not held by the listed chunks (e.g. read by ReadExtraPre)
+      if constexpr (requires (CRTP const crtp){ { crtp.SaveStateExtra(buf) } -> std::same_as<void>; })
+      {
+        GetThis()->SaveStateExtra(buf);
+      }
+    }
+
+    void LoadStateCommon(Common::ByteBuffer const& buf)
+    {
+      // Use auto-trait if present in type
+      if constexpr (requires { { &CRTP::_auto_trait }; })
+      {
+        decltype(CRTP::_auto_trait)::LoadStateChunks(GetThis(), buf);
+      }
+
+      // check if derived class also inherits from traits
+      if constexpr (requires { { &CRTP::TraitsLoadState }; })
+      {
+        GetThis()->TraitsLoadState(buf);
+      }
+
+      // invoke optional method to restore state saved by SaveStateExtra
+      if constexpr (requires (CRTP crtp){ { crtp.LoadStateExtra(buf) } -> std::same_as<void>; })
+      {
+        GetThis()->LoadStateExtra(buf);
+      }
+    }
+
+    /**
+     * Reads a known chunk.
+     * @param slot Set to the write slot of the object that read the chunk, see details::UnknownChunkStorage.
+     * @return true if the chunk was recognized and read.
+     */
     template<typename ReadContext>
-    bool ReadCommon(ReadContext& read_ctx, Common::ByteBuffer const& buf, Common::ChunkHeader const& chunk_header)
+    bool ReadCommon(ReadContext& read_ctx
+                    , Common::ByteBuffer const& buf
+                    , Common::ChunkHeader const& chunk_header
+                    , std::size_t& slot)
     {
       // invoke optional method to handle unlisted chunks that cannot be processed automatically
       if constexpr (requires (CRTP crtp){ { crtp.ReadExtraPre(read_ctx, buf, chunk_header) } -> std::same_as<bool>; })
       {
         if (GetThis()->ReadExtraPre(read_ctx, buf, chunk_header))
+        {
+          slot = 0;
           return true;
+        }
       }
 
       // Use auto-trait if present in type
       if constexpr (requires { { &CRTP::_auto_trait }; })
       {
-        if (decltype(CRTP::_auto_trait)::template ReadChunk(GetThis(), read_ctx, buf, chunk_header))
+        if (std::size_t entry_index = 0;
+            decltype(CRTP::_auto_trait)::template ReadChunk(GetThis(), read_ctx, buf, chunk_header, entry_index))
+        {
+          slot = 1 + entry_index;
           return true;
+        }
       }
 
       // check if derived class also inherits from traits
       if constexpr (requires { { &CRTP::template TraitsRead<ReadContext> }; })
       {
-        if(GetThis()->TraitsRead(read_ctx, buf, chunk_header))
+        if (std::size_t trait_index = 0; GetThis()->TraitsRead(read_ctx, buf, chunk_header, trait_index))
+        {
+          slot = 1 + EntrySlotCount() + trait_index;
           return true;
+        }
       }
 
       // invoke optional method to handle unlisted chunks that cannot be processed automatically
       if constexpr (requires (CRTP crtp){ { crtp.ReadExtraPost(read_ctx, buf, chunk_header) } -> std::same_as<bool>; })
       {
         if (GetThis()->ReadExtraPost(read_ctx, buf, chunk_header))
+        {
+          slot = 1 + EntrySlotCount() + TraitSlotCount();
           return true;
+        }
       }
 
       return false;
     }
 
+    void DetachUnknownChunksCommon()
+    {
+      // Use auto-trait if present in type
+      if constexpr (requires { { &CRTP::_auto_trait }; })
+      {
+        decltype(CRTP::_auto_trait)::DetachUnknownChunks(GetThis());
+      }
+
+      // check if derived class also inherits from traits
+      if constexpr (requires { { &CRTP::TraitsDetachUnknownChunks }; })
+      {
+        GetThis()->TraitsDetachUnknownChunks();
+      }
+    }
+
     constexpr void ValidateDependentInterfaces() const
     {
 //      // AutoIOTrait
@@ -930,17 +1728,19 @@ namespace IO::Common::Traits
                                  , ReadContext& read_ctx
                                  , Common::ByteBuffer const& buf
                                  , ChunkHeader const& chunk_header
+                                 , std::size_t& entry_index
                                  , Pack<CurEntry, TEntries...>)
     {
       if (CurEntry::magic == chunk_header.fourcc)
       {
         CurEntry::Read(self, read_ctx, buf, chunk_header);
+        entry_index = n_entries - sizeof...(TEntries) - 1;
         return true;
       }
 
       if constexpr (sizeof...(TEntries) > 0)
       {
-        if (ReadChunkRecurse(self, read_ctx, buf, chunk_header, Pack<TEntries...>{}))
+        if (ReadChunkRecurse(self, read_ctx, buf, chunk_header, entry_index, Pack<TEntries...>{}))
           return true;
       }
 
@@ -949,17 +1749,57 @@ namespace IO::Common::Traits
 
   // interface
   private:
+    static constexpr std::size_t n_entries = sizeof...(Entries);
 
     template<typename Self, typename ReadContext>
-    static bool ReadChunk(Self* self, ReadContext& read_ctx, Common::ByteBuffer const& buf, ChunkHeader const& chunk_header)
+    static bool ReadChunk(Self* self
+                          , ReadContext& read_ctx
+                          , Common::ByteBuffer const& buf
+                          , ChunkHeader const& chunk_header
+                          , std::size_t& entry_index)
     {
-      return ReadChunkRecurse(self, read_ctx, buf, chunk_header, Pack<Entries...>{});
+      return ReadChunkRecurse(self, read_ctx, buf, chunk_header, entry_index, Pack<Entries...>{});
     };
 
     template<typename Self, typename WriteContext>
-    static void WriteChunks(Self* self, WriteContext& write_ctx, Common::ByteBuffer& buf)
+    static void WriteChunks(Self* self
+                            , WriteContext& write_ctx
+                            , Common::ByteBuffer& buf
+                            , details::UnknownChunkWriter const& unknown)
+    {
+      std::size_t entry_index = 0;
+      ((unknown(buf, entry_index++), Entries::Write(self, write_ctx, buf)), ...);
+    }
+
+    template<typename Self, typename WriteContext>
+    static std::size_t ChunksWriteSize(Self const* self, WriteContext& write_ctx)
+    {
+      return (std::size_t{0} + ... + Entries::WriteSize(self, write_ctx));
+    }
+
+    template<typename Self>
+    static std::uint64_t HashChunks(Self const* self, std::uint64_t seed)
+    {
+      ((seed = Entries::Hash(self, seed)), ...);
+      return seed;
+    }
+
+    template<typename Self>
+    static void SaveStateChunks(Self const* self, Common::ByteBuffer& buf)
+    {
+      (Entries::SaveState(self, buf), ...);
+    }
+
+    template<typename Self>
+    static void LoadStateChunks(Self* self, Common::ByteBuffer const& buf)
+    {
+      (Entries::LoadState(self, buf), ...);
+    }
+
+    template<typename Self>
+    static void DetachUnknownChunks(Self* self)
     {
-      (Entries::Write(self, write_ctx, buf), ...);
+      (Entries::DetachUnknownChunks(self), ...);
     }
 
   };
@@ -1,4 +1,5 @@
 #include <IO/Storage/Archives/CASCArchive.hpp>
+#include <Utils/Misc/Hash.hpp>
 #include <CascLib.h>
 
 #include <filesystem>
@@ -129,6 +130,33 @@ IO::Storage::FileKey::FileReadStatus CASCArchive::ReadFile(IO::Storage::FileKey
   }
 }
 
+IO::Storage::FileKey::FileReadStatus CASCArchive::IdentifyFile(IO::Storage::FileKey const& file_key
+                                                               , IO::Storage::FileIdentity& identity) const
+{
+  RequireF(CCodeZones::STORAGE, file_key.FileDataID(), "Invalid FileDataID.");
+
+  HANDLE file;
+  if (!CascOpenFile(_handle, CASC_FILE_DATA_ID(file_key.FileDataID()), 0, CASC_OPEN_BY_FILEID, &file))
+  {
+    return GetCascError() == ERROR_FILE_NOT_FOUND ? FileKey::FileReadStatus::FILE_NOT_FOUND
+                                                  : FileKey::FileReadStatus::FILE_OPEN_FAILED_CLIENT;
+  }
+
+  // content key is the MD5 of the decoded file, taken from the index
+  CASC_FILE_FULL_INFO info;
+  bool const success = CascGetFileInfo(file, CascFileFullInfo, &info, sizeof(info), nullptr);
+  CascCloseFile(file);
+
+  if (!success)
+  {
+    return FileKey::FileReadStatus::FILE_OPEN_FAILED_CLIENT;
+  }
+
+  identity.size = info.ContentSize;
+  identity.hash = Utils::Misc::Hash64(info.CKey, sizeof(info.CKey));
+  return FileKey::FileReadStatus::SUCCESS;
+}
+
 bool CASCArchive::Exists(IO::Storage::FileKey const& file_key) const
 {
   RequireF(CCodeZones::STORAGE, file_key.FileDataID(), "Invalid FileDataID.");
@@ -55,6 +55,15 @@ namespace IO::Storage::Archives
     [[nodiscard]]
     FileKey::FileReadStatus ReadFile(FileKey const& file_key, Common::ByteBuffer& buf) const override;
 
+    /**
+     * Identify file content from the CASC encoding index, without reading it.
+     * @param file_key File key.
+     * @param identity Identity of the file content.
+     * @return Status of operation.
+     */
+    [[nodiscard]]
+    FileKey::FileReadStatus IdentifyFile(FileKey const& file_key, FileIdentity& identity) const override;
+
     /**
      * Check if file exists in CASC archive.
      * @param file_key File key.
@@ -27,6 +27,14 @@ namespace IO::Storage::Archives
     [[nodiscard]]
     virtual FileKey::FileReadStatus ReadFile(FileKey const& file_key, Common::ByteBuffer& buf) const = 0;
 
+    /**
+     * Identify file content from the archive index, without reading it.
+     * @param file_key File key.
+     * @param identity Identity of the file content.
+     * @return Status of operation.
+     */
+    [[nodiscard]]
+    virtual FileKey::FileReadStatus IdentifyFile(FileKey const& file_key, FileIdentity& identity) const = 0;
 
     /**
      * Check if file exists in an archive
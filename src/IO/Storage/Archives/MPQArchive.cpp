@@ -2,6 +2,7 @@
 #include <IO/Storage/FileKey.hpp>
 #include <IO/ByteBuffer.hpp>
 #include <Utils/PathUtils.hpp>
+#include <Utils/Misc/Hash.hpp>
 #include <StormLib.h>
 
 #include <filesystem>
@@ -124,6 +125,64 @@ FileKey::FileReadStatus MPQArchive::ReadFile(FileKey const& file_key, IO::Common
   }
 }
 
+FileKey::FileReadStatus MPQArchive::IdentifyFile(FileKey const& file_key, FileIdentity& identity) const
+{
+  // identity of the archive itself, so that replacing or patching it in place invalidates its files
+  std::error_code error;
+  auto const archive_time = fs::last_write_time(_path, error).time_since_epoch().count();
+  std::uint64_t hash = Utils::Misc::Hash64(&archive_time, sizeof(archive_time), Utils::Misc::Hash64(_path));
+
+  // MPQ archive
+  if (_handle) [[likely]]
+  {
+    HANDLE handle;
+    if (!SFileOpenFileEx(_handle, file_key.FilePath().c_str(), 0, &handle))
+    {
+      return GetLastError() == ERROR_FILE_NOT_FOUND ? FileKey::FileReadStatus::FILE_NOT_FOUND
+                                                    : FileKey::FileReadStatus::FILE_OPEN_FAILED_CLIENT;
+    }
+
+    // block table entry of the file: position and time stamp within the archive
+    DWORD size = SFileGetFileSize(handle, nullptr);
+    ULONGLONG byte_offset = 0;
+    ULONGLONG file_time = 0;
+    SFileGetFileInfo(handle, SFileInfoByteOffset, &byte_offset, sizeof(byte_offset), nullptr);
+    SFileGetFileInfo(handle, SFileInfoFileTime, &file_time, sizeof(file_time), nullptr);
+    SFileCloseFile(handle);
+
+    if (size == SFILE_INVALID_SIZE)
+    {
+      return FileKey::FileReadStatus::FILE_OPEN_FAILED_CLIENT;
+    }
+
+    identity.size = size;
+    identity.hash = Utils::Misc::HashCombine(Utils::Misc::HashCombine(hash, byte_offset), file_time);
+    return FileKey::FileReadStatus::SUCCESS;
+  }
+  // MPQ-like directory
+  else
+  {
+    std::string normalized_path = Utils::PathUtils::NormalizeFilepathUnixLower(file_key.FilePath());
+
+    fs::path local_filepath = fs::path(_path) / fs::path(normalized_path);
+
+    std::error_code size_error;
+    std::error_code time_error;
+    std::uintmax_t size = fs::file_size(local_filepath, size_error);
+    auto const write_time = fs::last_write_time(local_filepath, time_error).time_since_epoch().count();
+
+    if (size_error || time_error)
+    {
+      return fs::exists(local_filepath) ? FileKey::FileReadStatus::FILE_OPEN_FAILED_OS
+                                        : FileKey::FileReadStatus::FILE_NOT_FOUND;
+    }
+
+    identity.size = size;
+    identity.hash = Utils::Misc::Hash64(&write_time, sizeof(write_time), Utils::Misc::Hash64(normalized_path, hash));
+    return FileKey::FileReadStatus::SUCCESS;
+  }
+}
+
 bool MPQArchive::Exists(FileKey const& file_key) const
 {
   // MPQ archive
@@ -23,6 +23,26 @@ IO::Storage::FileKey::FileReadStatus BaseLoader::ReadFile(IO::Storage::FileKey c
   return FileKey::FileReadStatus::FILE_NOT_FOUND;
 }
 
+IO::Storage::FileKey::FileReadStatus BaseLoader::IdentifyFile(IO::Storage::FileKey const& file_key
+                                                              , IO::Storage::FileIdentity& identity) const
+{
+  for (auto it = _archives.rbegin(); it != _archives.rend(); ++it)
+  {
+    FileKey::FileReadStatus status = (*it)->IdentifyFile(file_key, identity);
+
+    if (status == FileKey::FileReadStatus::FILE_NOT_FOUND)
+    {
+      continue;
+    }
+    else
+    {
+      return status;
+    }
+  }
+
+  return FileKey::FileReadStatus::FILE_NOT_FOUND;
+}
+
 bool BaseLoader::Exists(IO::Storage::FileKey const& file_key) const
 {
   for (auto it = _archives.rbegin(); it != _archives.rend(); ++it)
@@ -71,6 +71,15 @@ namespace IO::Storage::ClientLoaders
     [[nodiscard]]
     FileKey::FileReadStatus ReadFile(FileKey const& file_key, Common::ByteBuffer& buf);
 
+    /**
+     * Identifies the file content in the archive that ReadFile() would read from, without reading it.
+     * @param file_key File key.
+     * @param identity Identity of the file content.
+     * @return Status of operation.
+     */
+    [[nodiscard]]
+    FileKey::FileReadStatus IdentifyFile(FileKey const& file_key, FileIdentity& identity) const;
+
     /**
      * Check if file exists in loaded archives.
      * @param file_key File key.
@@ -3,6 +3,7 @@
 #include <IO/Storage/ClientLoaders/WotLKLoader.hpp>
 #include <IO/Storage/ClientLoaders/CASCLoader.hpp>
 #include <Utils/PathUtils.hpp>
+#include <Utils/Misc/Hash.hpp>
 
 #include <system_error>
 #include <fstream>
@@ -120,6 +121,31 @@ FileKey::FileReadStatus ClientStorage::ReadFile(FileKey const& file_key, Common:
   return _loader->ReadFile(file_key, buf);
 }
 
+FileKey::FileReadStatus ClientStorage::IdentifyFile(FileKey const& file_key, FileIdentity& identity) const
+{
+  fs::path filepath = _project_path / Utils::PathUtils::NormalizeFilepathUnixLower(file_key.FilePath());
+
+  // project directory overrides the client, same as ReadFile()
+  if (fs::exists(filepath))
+  {
+    std::error_code size_error;
+    std::error_code time_error;
+    std::uintmax_t size = fs::file_size(filepath, size_error);
+    auto const write_time = fs::last_write_time(filepath, time_error).time_since_epoch().count();
+
+    if (size_error || time_error)
+    {
+      return FileKey::FileReadStatus::FILE_OPEN_FAILED_OS;
+    }
+
+    identity.size = size;
+    identity.hash = Utils::Misc::Hash64(&write_time, sizeof(write_time), Utils::Misc::Hash64(filepath.string()));
+    return FileKey::FileReadStatus::SUCCESS;
+  }
+
+  return _loader->IdentifyFile(file_key, identity);
+}
+
 FileKey::FileWriteStatus ClientStorage::WriteFile(FileKey const& file_key, Common::ByteBuffer const& buf) const
 {
   fs::path filepath = _project_path / Utils::PathUtils::NormalizeFilepathUnixLower(file_key.FilePath());
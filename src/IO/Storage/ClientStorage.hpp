@@ -121,6 +121,15 @@ namespace IO::Storage
     [[nodiscard]]
     FileKey::FileReadStatus ReadFile(FileKey const& file_key, Common::ByteBuffer& buf) const;
 
+    /**
+     * Identifies the file content that ReadFile() would return, without reading it.
+     * @param file_key File key.
+     * @param identity Identity of the file content.
+     * @return Status of the operation.
+     */
+    [[nodiscard]]
+    FileKey::FileReadStatus IdentifyFile(FileKey const& file_key, FileIdentity& identity) const;
+
     /**
      * Writes the file content from the provided buffer into project dir.
      * @param file_key File key.
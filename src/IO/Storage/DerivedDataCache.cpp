@@ -0,0 +1,205 @@
+#include <IO/Storage/DerivedDataCache.hpp>
+#include <IO/Storage/ClientStorage.hpp>
+#include <Utils/Misc/Hash.hpp>
+
+#include <system_error>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+
+using namespace IO::Storage;
+namespace fs = std::filesystem;
+
+DerivedDataCache::DerivedDataCache(fs::path const& cache_path)
+: _cache_path(cache_path)
+{
+  std::error_code error;
+  fs::create_directories(_cache_path, error);
+
+  if (error)
+  {
+    LogError("Creating derived data cache directory \"%s\" failed. OS error code: %d. msg: %s."
+             , _cache_path.string().c_str(), error.value(), error.message().c_str());
+  }
+}
+
+DerivedDataCache::DerivedDataCache(ClientStorage const& storage)
+: DerivedDataCache(storage.ProjectPath() / "cache")
+{
+}
+
+void DerivedDataCache::Invalidate(std::uint32_t file_data_id) const
+{
+  std::error_code error;
+  fs::remove_all(_cache_path / std::to_string(file_data_id), error);
+}
+
+void DerivedDataCache::Clear() const
+{
+  std::error_code error;
+
+  for (auto const& entry : fs::directory_iterator(_cache_path, error))
+  {
+    fs::remove_all(entry.path(), error);
+  }
+}
+
+fs::path DerivedDataCache::_EntryPath(DerivedDataKey const& key) const
+{
+  char filename[96];
+  std::snprintf(filename, sizeof(filename), "%016llx_%u_%llu_%016llx%s"
+                , static_cast<unsigned long long>(key.type_hash)
+                , static_cast<unsigned>(key.client_version)
+                , static_cast<unsigned long long>(key.source.size)
+                , static_cast<unsigned long long>(key.source.hash)
+                , ENTRY_EXTENSION.data());
+
+  return _cache_path / std::to_string(key.file_data_id) / filename;
+}
+
+std::uint64_t DerivedDataCache::_TypeHash(std::string_view type_name, std::string_view read_context_name)
+{
+  return Utils::Misc::Hash64(read_context_name, Utils::Misc::Hash64(type_name, LAYOUT_VERSION));
+}
+
+DerivedDataCache::CacheReadStatus DerivedDataCache::_ReadEntry(DerivedDataKey const& key
+                                                               , Common::ByteBuffer& buf) const
+{
+  fs::path entry_path = _EntryPath(key);
+
+  std::error_code error;
+  std::uintmax_t size = fs::file_size(entry_path, error);
+
+  if (error)
+    return CacheReadStatus::NOT_CACHED;
+
+  if (size < sizeof(EntryHeader)) [[unlikely]]
+    return CacheReadStatus::CORRUPT;
+
+  std::ifstream istrm(entry_path, std::ios::binary);
+
+  if (!istrm.is_open()) [[unlikely]]
+    return CacheReadStatus::READ_FAILED;
+
+  buf.Reserve(static_cast<std::size_t>(size));
+
+  if (!istrm.read(buf.Data(), static_cast<std::streamsize>(size))) [[unlikely]]
+    return CacheReadStatus::READ_FAILED;
+
+  auto const& header = buf.Peek<EntryHeader>(0);
+
+  if (header.magic != ENTRY_MAGIC
+      || header.layout_version != LAYOUT_VERSION
+      || header.file_data_id != key.file_data_id
+      || header.client_version != static_cast<std::uint32_t>(key.client_version)
+      || header.source_size != key.source.size
+      || header.source_hash != key.source.hash
+      || header.type_hash != key.type_hash
+      || header.payload_size != size - sizeof(EntryHeader)
+      || header.payload_hash != Utils::Misc::Hash64(buf.Data() + sizeof(EntryHeader), header.payload_size)) [[unlikely]]
+  {
+    LogError("Derived data cache entry \"%s\" is corrupt.", entry_path.string().c_str());
+    return CacheReadStatus::CORRUPT;
+  }
+
+  return CacheReadStatus::SUCCESS;
+}
+
+void DerivedDataCache::_RemoveEntry(DerivedDataKey const& key) const
+{
+  std::error_code error;
+  fs::remove(_EntryPath(key), error);
+}
+
+DerivedDataCache::CacheWriteStatus DerivedDataCache::_WriteEntry(DerivedDataKey const& key
+                                                                 , Common::ByteBuffer const& payload) const
+{
+  fs::path entry_path = _EntryPath(key);
+  fs::path dir_path = entry_path.parent_path();
+
+  std::error_code error;
+  fs::create_directories(dir_path, error);
+
+  if (error)
+  {
+    LogError("Creating directory \"%s\" failed. OS error code: %d. msg: %s.", dir_path.string().c_str()
+             , error.value(), error.message().c_str());
+    return CacheWriteStatus::WRITE_FAILED;
+  }
+
+  // entries produced from other versions of the source file for the same client version and type are never going
+  // to be hit again, entries of other client versions and types are still valid
+  std::vector<fs::path> stale_entries;
+
+  for (auto const& entry : fs::directory_iterator(dir_path, error))
+  {
+    if (entry.path().extension() != ENTRY_EXTENSION || entry.path() == entry_path)
+      continue;
+
+    unsigned long long type_hash = 0;
+    unsigned client_version = 0;
+    unsigned long long source_size = 0;
+    unsigned long long source_hash = 0;
+
+    if (std::sscanf(entry.path().filename().string().c_str(), "%16llx_%u_%llu_%16llx"
+                    , &type_hash, &client_version, &source_size, &source_hash) != 4)
+      continue;
+
+    if (type_hash == key.type_hash && client_version == static_cast<unsigned>(key.client_version))
+    {
+      stale_entries.push_back(entry.path());
+    }
+  }
+
+  for (auto const& stale_entry : stale_entries)
+  {
+    fs::remove(stale_entry, error);
+  }
+
+  EntryHeader header { ENTRY_MAGIC
+                       , LAYOUT_VERSION
+                       , key.file_data_id
+                       , static_cast<std::uint32_t>(key.client_version)
+                       , key.source.size
+                       , key.source.hash
+                       , key.type_hash
+                       , payload.Size()
+                       , Utils::Misc::Hash64(payload.Data(), payload.Size()) };
+
+  fs::path temp_path = entry_path;
+  temp_path += ".tmp";
+
+  {
+    std::fstream strm{temp_path, std::fstream::binary | std::fstream::out | std::fstream::trunc};
+
+    if (!strm.is_open())
+    {
+      LogError("Writing derived data cache entry \"%s\" failed. Unknown OS error.", temp_path.string().c_str());
+      return CacheWriteStatus::WRITE_FAILED;
+    }
+
+    strm.write(reinterpret_cast<const char*>(&header), sizeof(EntryHeader));
+    payload.Flush(strm);
+
+    if (!strm)
+    {
+      LogError("Writing derived data cache entry \"%s\" failed. Unknown OS error.", temp_path.string().c_str());
+      strm.close();
+      fs::remove(temp_path, error);
+      return CacheWriteStatus::WRITE_FAILED;
+    }
+  }
+
+  // readers never observe a partially written entry
+  fs::rename(temp_path, entry_path, error);
+
+  if (error)
+  {
+    LogError("Renaming \"%s\" failed. OS error code: %d. msg: %s.", temp_path.string().c_str()
+             , error.value(), error.message().c_str());
+    fs::remove(temp_path, error);
+    return CacheWriteStatus::WRITE_FAILED;
+  }
+
+  return CacheWriteStatus::SUCCESS;
+}
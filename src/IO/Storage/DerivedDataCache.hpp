@@ -0,0 +1,208 @@
+#pragma once
+#include <IO/Common.hpp>
+#include <IO/CommonTraits.hpp>
+#include <IO/Storage/FileKey.hpp>
+
+#include <filesystem>
+#include <cstdint>
+#include <string>
+
+namespace IO::Storage
+{
+  /**
+   * Identifies a derived (parsed) representation of a file in the DerivedDataCache.
+   * An entry is only valid for the exact source file content (as identified by the storage index), client version
+   * and in-memory type it was produced from.
+   */
+  struct DerivedDataKey
+  {
+    std::uint32_t file_data_id = 0; ///> FileDataID of the source file.
+    Common::ClientVersion client_version = Common::ClientVersion::ANY; ///> Client version the file was parsed for.
+    FileIdentity source; ///> Identity of the source file content, see FileKey::Identify().
+    std::uint64_t type_hash = 0; ///> Hash identifying the parsed type, the read context and the cache layout version.
+
+    [[nodiscard]]
+    bool operator==(DerivedDataKey const& other) const = default;
+  };
+
+  /**
+   * Persistent on-disk cache of parsed file objects (e.g. ADT and WDT files).
+   * Entries hold the decoded in-memory state of the object (see AutoIOTraitInterface SaveState()), prefixed with a
+   * header repeating the key. Loading an entry is a single file read followed by LoadState(), which restores the
+   * object without parsing, decompression or fix-ups.
+   * An entry is keyed by the identity of the source file in the storage index (e.g. CASC content key), so the source
+   * file is never read on a hit, and any change of the source file misses the cache. The stale entry is discarded on
+   * the next Store() of the same FileDataID, client version and type; entries of other client versions or types are
+   * kept.
+   *
+   * Layout on disk: <cache_path>/<FileDataID>/<type_hash>_<client_version>_<source_size>_<source_hash>.ddc
+   *
+   * All operations are safe to be used concurrently for different FileDataIDs.
+   */
+  class DerivedDataCache
+  {
+  public:
+    /**
+     * Version of the on-disk entry layout. Bump whenever the serialized form of any cached type changes
+     * in a way that is not reflected by its type name.
+     */
+    static constexpr std::uint32_t LAYOUT_VERSION = 5;
+
+    /**
+     * Defines possible states of the cache lookup.
+     */
+    enum class CacheReadStatus
+    {
+      SUCCESS, ///< Object was loaded from the cache.
+      NOT_CACHED, ///< No entry exists for the key.
+      CORRUPT, ///< Entry exists, but its header does not match the key, or its payload is damaged.
+      READ_FAILED ///< Entry exists, but could not be opened or read.
+    };
+
+    /**
+     * Defines possible states of the cache store operation.
+     */
+    enum class CacheWriteStatus
+    {
+      SUCCESS, ///< Entry was written.
+      WRITE_FAILED ///< Entry could not be written.
+    };
+
+    /**
+     * Constructs the cache operating on the provided directory. The directory is created if it does not exist.
+     * @param cache_path Path to the cache directory.
+     */
+    explicit DerivedDataCache(std::filesystem::path const& cache_path);
+
+    /**
+     * Constructs the cache in the "cache" sub-directory of the storage project path.
+     * @param storage Client storage.
+     */
+    explicit DerivedDataCache(ClientStorage const& storage);
+
+    /**
+     * Builds a cache key for the parsed type T. The source file is not read.
+     * @tparam T Parsed type.
+     * @tparam ReadContext Read context the object is parsed with.
+     * @param file_data_id FileDataID of the source file.
+     * @param client_version Client version the file is parsed for.
+     * @param source Identity of the source file content (see FileKey::Identify()).
+     * @return Cache key.
+     */
+    template<typename T, std::default_initializable ReadContext = Common::Traits::DefaultTraitContext>
+    [[nodiscard]]
+    static DerivedDataKey MakeKey(std::uint32_t file_data_id
+                                  , Common::ClientVersion client_version
+                                  , FileIdentity const& source);
+
+    /**
+     * Loads the object from the cache.
+     * @tparam T Parsed type (File type of the traits system).
+     * @param key Cache key (see MakeKey()).
+     * @param object Object to restore the state into. Left untouched unless the entry is loaded successfully.
+     * @return Status of the operation. Entries found CORRUPT are removed from the cache.
+     */
+    template<typename T>
+    [[nodiscard]]
+    CacheReadStatus Load(DerivedDataKey const& key, T& object) const;
+
+    /**
+     * Stores the object in the cache. Entries of other source file contents for the same FileDataID, client version
+     * and type are removed.
+     * @tparam T Parsed type (File type of the traits system).
+     * @param key Cache key (see MakeKey()).
+     * @param object Object to store.
+     * @return Status of the operation.
+     */
+    template<typename T>
+    CacheWriteStatus Store(DerivedDataKey const& key, T const& object) const;
+
+    /**
+     * Reads the object either from the cache, or from the storage when the cache misses. The cache is looked up by
+     * the identity of the file in the storage index, the file itself is only read on a miss. In the latter case the
+     * parsed object is stored into the cache.
+     * @tparam T Parsed type (File type of the traits system).
+     * @tparam ReadContext Read context passed to T::Read.
+     * @param object Freshly constructed object to read data into.
+     * @param file_key Key of the source file.
+     * @param client_version Client version the file is parsed for.
+     * @return SUCCESS if the object was loaded from the cache, otherwise the reason of the miss. READ_FAILED if the
+     * source file could not be read either, the object is left untouched then.
+     */
+    template<typename T, std::default_initializable ReadContext = Common::Traits::DefaultTraitContext>
+    CacheReadStatus Read(T& object, FileKey const& file_key, Common::ClientVersion client_version) const;
+
+    /**
+     * Removes all entries associated with a FileDataID.
+     * @param file_data_id FileDataID.
+     */
+    void Invalidate(std::uint32_t file_data_id) const;
+
+    /**
+     * Removes all entries from the cache.
+     */
+    void Clear() const;
+
+    /**
+     * @return Path to the cache directory.
+     */
+    [[nodiscard]]
+    std::filesystem::path const& Path() const { return _cache_path; };
+
+  private:
+    /**
+     * On-disk header preceding the serialized object.
+     */
+    struct EntryHeader
+    {
+      std::uint32_t magic;
+      std::uint32_t layout_version;
+      std::uint32_t file_data_id;
+      std::uint32_t client_version;
+      std::uint64_t source_size;
+      std::uint64_t source_hash;
+      std::uint64_t type_hash;
+      std::uint64_t payload_size;
+      std::uint64_t payload_hash;
+    };
+
+    static constexpr std::uint32_t ENTRY_MAGIC = Common::FourCC<"DDC0">;
+    static constexpr std::string_view ENTRY_EXTENSION = ".ddc";
+
+    [[nodiscard]]
+    std::filesystem::path _EntryPath(DerivedDataKey const& key) const;
+
+    [[nodiscard]]
+    static std::uint64_t _TypeHash(std::string_view type_name, std::string_view read_context_name);
+
+    /**
+     * Reads an entry and validates its header against the key.
+     * @param key Cache key.
+     * @param buf Buffer receiving the whole entry (header included).
+     * @return Status of the operation.
+     */
+    [[nodiscard]]
+    CacheReadStatus _ReadEntry(DerivedDataKey const& key, Common::ByteBuffer& buf) const;
+
+    /**
+     * Writes an entry atomically (write to a temporary file, then rename) and prunes stale siblings, i.e. entries
+     * with the same FileDataID, client version and type hash, but another source file identity.
+     * @param key Cache key.
+     * @param payload Serialized object.
+     * @return Status of the operation.
+     */
+    [[nodiscard]]
+    CacheWriteStatus _WriteEntry(DerivedDataKey const& key, Common::ByteBuffer const& payload) const;
+
+    /**
+     * Removes an entry, e.g. a corrupt one, so that later lookups miss instead of failing again.
+     * @param key Cache key.
+     */
+    void _RemoveEntry(DerivedDataKey const& key) const;
+
+  private:
+    std::filesystem::path _cache_path;
+  };
+}
+
+#include <IO/Storage/DerivedDataCache.inl>
@@ -0,0 +1,106 @@
+#pragma once
+#include <IO/Storage/DerivedDataCache.hpp>
+#include <Utils/Misc/Hash.hpp>
+
+#include <nameof.hpp>
+
+#include <utility>
+
+namespace IO::Storage
+{
+  template<typename T, std::default_initializable ReadContext>
+  inline DerivedDataKey DerivedDataCache::MakeKey(std::uint32_t file_data_id
+                                                  , Common::ClientVersion client_version
+                                                  , FileIdentity const& source)
+  {
+    RequireF(CCodeZones::STORAGE, file_data_id, "Invalid FileDataID.");
+
+    return DerivedDataKey{ file_data_id
+                           , client_version
+                           , source
+                           , _TypeHash(NAMEOF_TYPE(T), NAMEOF_TYPE(ReadContext)) };
+  }
+
+  template<typename T>
+  inline DerivedDataCache::CacheReadStatus DerivedDataCache::Load(DerivedDataKey const& key, T& object) const
+  {
+    Common::ByteBuffer entry_buf {};
+
+    if (auto status = _ReadEntry(key, entry_buf); status != CacheReadStatus::SUCCESS)
+    {
+      if (status == CacheReadStatus::CORRUPT)
+      {
+        _RemoveEntry(key);
+      }
+
+      return status;
+    }
+
+    // borrowed view over the payload, restored without parsing
+    Common::ByteBuffer payload_buf {entry_buf.Data() + sizeof(EntryHeader), entry_buf.Size() - sizeof(EntryHeader)};
+
+    // restored into a copy, so that a payload of the wrong type never leaves the object half-loaded
+    T loaded {object};
+    loaded.LoadState(payload_buf);
+
+    if (payload_buf.Tell() != payload_buf.Size()) [[unlikely]]
+    {
+      LogError("Derived data cache entry of FileDataID %d does not match the type.", key.file_data_id);
+      _RemoveEntry(key);
+      return CacheReadStatus::CORRUPT;
+    }
+
+    object = std::move(loaded);
+    return CacheReadStatus::SUCCESS;
+  }
+
+  template<typename T>
+  inline DerivedDataCache::CacheWriteStatus DerivedDataCache::Store(DerivedDataKey const& key, T const& object) const
+  {
+    Common::ByteBuffer payload_buf {};
+    object.SaveState(payload_buf);
+
+    return _WriteEntry(key, payload_buf);
+  }
+
+  template<typename T, std::default_initializable ReadContext>
+  inline DerivedDataCache::CacheReadStatus DerivedDataCache::Read(T& object
+                                                                  , FileKey const& file_key
+                                                                  , Common::ClientVersion client_version) const
+  {
+    FileIdentity source {};
+
+    if (file_key.Identify(source) != FileKey::FileReadStatus::SUCCESS) [[unlikely]]
+    {
+      LogError("Failed to identify FileDataID %d in storage.", file_key.FileDataID());
+      return CacheReadStatus::READ_FAILED;
+    }
+
+    DerivedDataKey key = MakeKey<T, ReadContext>(file_key.FileDataID(), client_version, source);
+
+    auto status = Load(key, object);
+
+    if (status == CacheReadStatus::SUCCESS)
+      return status;
+
+    LogDebugF(LCodeZones::FILE_IO, "Derived data cache miss for FileDataID %d.", file_key.FileDataID());
+
+    Common::ByteBuffer source_buf {};
+
+    if (file_key.Read(source_buf) != FileKey::FileReadStatus::SUCCESS) [[unlikely]]
+    {
+      LogError("Failed to read FileDataID %d from storage.", file_key.FileDataID());
+      return CacheReadStatus::READ_FAILED;
+    }
+
+    ReadContext read_ctx {};
+    object.Read(read_ctx, source_buf);
+
+    // unknown chunks borrow from the source buffer, which does not outlive this call
+    object.DetachUnknownChunks();
+
+    [[maybe_unused]] auto write_status = Store(key, object);
+
+    return status;
+  }
+}
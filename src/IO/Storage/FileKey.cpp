@@ -8,7 +8,8 @@
 using namespace IO::Storage;
 
 FileKey::FileKey(ClientStorage& storage, std::uint32_t file_data_id, FileExistPolicy file_exist_policy)
-: _storage(&storage)
+: _file_data_id(file_data_id)
+, _storage(&storage)
 {
   RequireF(CCodeZones::STORAGE, file_exist_policy != FileExistPolicy::CREATE, "Adding by FDID is not supported.");
   if (file_exist_policy == FileExistPolicy::CHECKEXISTS)
@@ -101,6 +102,16 @@ FileKey::FileReadStatus FileKey::Read(IO::Common::ByteBuffer& buf) const
   return _storage->ReadFile(*this, buf);
 }
 
+FileKey::FileReadStatus FileKey::Identify(FileIdentity& identity) const
+{
+  if (!_file_data_id) [[unlikely]]
+  {
+    return FileKey::FileReadStatus::INVALID_FILEDATAID;
+  }
+
+  return _storage->IdentifyFile(*this, identity);
+}
+
 FileKey::FileWriteStatus FileKey::Write(IO::Common::ByteBuffer const& buf) const
 {
   return _storage->WriteFile(*this, buf);
@@ -8,6 +8,19 @@ namespace IO::Storage
 {
   class ClientStorage;
 
+  /**
+   * Identity of the content of a file, as recorded by the storage index. Obtained without reading the file, and
+   * changes whenever a different content is served for the file (patched archive, overriding project file, etc.).
+   */
+  struct FileIdentity
+  {
+    std::uint64_t size = 0; ///< Size of the file in bytes.
+    std::uint64_t hash = 0; ///< Hash of the storage specific identity of the content (e.g. CASC content key).
+
+    [[nodiscard]]
+    bool operator==(FileIdentity const& other) const = default;
+  };
+
   /**
    * FileKey class provides a generalized way to adress files within WoW formats.
    * file can be requested by FileDataID (real CASC one or runtime-generated for pre-CASC clients)
@@ -97,6 +110,14 @@ namespace IO::Storage
     [[nodiscard]]
     FileReadStatus Read(Common::ByteBuffer& buf) const;
 
+    /**
+     * Identify the content of the file in associated storage, without reading it.
+     * @param identity Identity of the file content, left untouched on failure.
+     * @return Status of operation.
+     */
+    [[nodiscard]]
+    FileReadStatus Identify(FileIdentity& identity) const;
+
     /**
      * Write file into project directory.
      * @param buf Self-owned ByteBuffer instance.
@@ -0,0 +1,18 @@
+#include <IO/WDT/WDTRoot.hpp>
+
+using namespace IO::WDT;
+using namespace IO::Common;
+
+template class IO::WDT::WDTRoot<ClientVersion::CLASSIC>;
+template class IO::WDT::WDTRoot<ClientVersion::TBC>;
+template class IO::WDT::WDTRoot<ClientVersion::WOTLK>;
+template class IO::WDT::WDTRoot<ClientVersion::CATA>;
+template class IO::WDT::WDTRoot<ClientVersion::MOP>;
+template class IO::WDT::WDTRoot<ClientVersion::WOD>;
+template class IO::WDT::WDTRoot<ClientVersion::LEGION>;
+template class IO::WDT::WDTRoot<ClientVersion::BFA>;
+template class IO::WDT::WDTRoot<ClientVersion::SL>;
+template class IO::WDT::WDTRoot<ClientVersion::DF>;
+template class IO::WDT::WDTRoot<ClientVersion::CLASSIC_NEW>;
+template class IO::WDT::WDTRoot<ClientVersion::TBC_NEW>;
+template class IO::WDT::WDTRoot<ClientVersion::WOTLK_NEW>;
@@ -103,6 +103,32 @@ namespace IO::WDT
                          >
   {
     AutoIOTraitInterfaceUser;
+    using FileInterfaceT = Common::Traits::AutoIOTraitInterface<WDTRoot, Common::Traits::TraitType::File>;
+
+  public:
+    using FileInterfaceT::Read;
+    using FileInterfaceT::Write;
+    using FileInterfaceT::ByteSize;
+
+    /**
+     * Reads the file. Instantiated once in the library, see WDTRoot.cpp.
+     * @param buf Buffer containing the file.
+     */
+    void Read(Common::ByteBuffer const& buf);
+
+    /**
+     * Writes the file. Instantiated once in the library, see WDTRoot.cpp.
+     * @param buf Buffer to write into.
+     */
+    void Write(Common::ByteBuffer& buf) const;
+
+    /**
+     * Computes the exact size of the file in bytes, as it would be written with Write().
+     * @return Size of the file in bytes.
+     */
+    [[nodiscard]]
+    std::size_t ByteSize() const;
+
   private:
     Common::DataChunk
     <
@@ -136,3 +162,22 @@ namespace IO::WDT
     > _auto_trait {};
   };
 }
+
+#include <IO/WDT/WDTRoot.inl>
+
+namespace IO::WDT
+{
+  extern template class WDTRoot<Common::ClientVersion::CLASSIC>;
+  extern template class WDTRoot<Common::ClientVersion::TBC>;
+  extern template class WDTRoot<Common::ClientVersion::WOTLK>;
+  extern template class WDTRoot<Common::ClientVersion::CATA>;
+  extern template class WDTRoot<Common::ClientVersion::MOP>;
+  extern template class WDTRoot<Common::ClientVersion::WOD>;
+  extern template class WDTRoot<Common::ClientVersion::LEGION>;
+  extern template class WDTRoot<Common::ClientVersion::BFA>;
+  extern template class WDTRoot<Common::ClientVersion::SL>;
+  extern template class WDTRoot<Common::ClientVersion::DF>;
+  extern template class WDTRoot<Common::ClientVersion::CLASSIC_NEW>;
+  extern template class WDTRoot<Common::ClientVersion::TBC_NEW>;
+  extern template class WDTRoot<Common::ClientVersion::WOTLK_NEW>;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <IO/WDT/WDTRoot.hpp>
+
+namespace IO::WDT
+{
+  template<Common::ClientVersion client_version>
+  void WDTRoot<client_version>::Read(Common::ByteBuffer const& buf)
+  {
+    Common::Traits::DefaultTraitContext read_ctx {};
+    FileInterfaceT::Read(read_ctx, buf);
+  }
+
+  template<Common::ClientVersion client_version>
+  void WDTRoot<client_version>::Write(Common::ByteBuffer& buf) const
+  {
+    Common::Traits::DefaultTraitContext write_ctx {};
+    FileInterfaceT::Write(write_ctx, buf);
+  }
+
+  template<Common::ClientVersion client_version>
+  std::size_t WDTRoot<client_version>::ByteSize() const
+  {
+    Common::Traits::DefaultTraitContext write_ctx {};
+    return FileInterfaceT::ByteSize(write_ctx);
+  }
+}
@@ -83,8 +83,11 @@ namespace IO::Common::WorldConstants
    // Number of chunks (ADT::MCNK) per one map tile.
    constexpr unsigned CHUNKS_PER_TILE = 16 * 16;
 
+   // Number of tiles (ADT) per row and per column of a map (WDT).
+   constexpr unsigned MAP_DIM = 64;
+
    // Maximum number of tiles per map
-   constexpr unsigned MAX_TILES_PER_MAP = 64 * 64;
+   constexpr unsigned MAX_TILES_PER_MAP = MAP_DIM * MAP_DIM;
 
    // Number of bytes per high resolution alphamap (ADT::MCNK::MCAL).
    constexpr unsigned N_BYTES_PER_HIGHRES_ALPHA = 4096;
@@ -0,0 +1,435 @@
+#include <Terrain/BlendMeshIndex.hpp>
+#include <Terrain/Common.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Contracts.hpp>
+#include <Validation/Log.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace Terrain;
+using namespace IO::Common::DataStructures;
+using namespace IO::ADT::DataStructures;
+
+namespace
+{
+  constexpr std::size_t CHUNKS_PER_ROW = TileHeightfield::CHUNKS_PER_ROW;
+  constexpr std::uint32_t MAX_LEAF_SIZE = 2;
+  constexpr std::size_t MAX_BATCHES_PER_CHUNK = 256;
+
+  struct Vec3
+  {
+    float x;
+    float y;
+    float z;
+  };
+
+  FORCEINLINE Vec3 ToVec3(C3Vector const& v) { return {v.x, v.y, v.z}; }
+  FORCEINLINE Vec3 operator-(Vec3 const& lhs, Vec3 const& rhs) { return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z}; }
+  FORCEINLINE float Dot(Vec3 const& lhs, Vec3 const& rhs) { return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z; }
+
+  FORCEINLINE Vec3 Cross(Vec3 const& lhs, Vec3 const& rhs)
+  {
+    return {lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x};
+  }
+
+  FORCEINLINE float Axis(C3Vector const& v, std::size_t axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+
+  FORCEINLINE bool Overlaps(CAaBox const& lhs, CAaBox const& rhs)
+  {
+    return lhs.min.x <= rhs.max.x && lhs.max.x >= rhs.min.x
+      && lhs.min.y <= rhs.max.y && lhs.max.y >= rhs.min.y
+      && lhs.min.z <= rhs.max.z && lhs.max.z >= rhs.min.z;
+  }
+
+  // avoids NaN in slab tests for axis-parallel rays
+  FORCEINLINE float SafeInverse(float value)
+  {
+    constexpr float epsilon = 1e-30f;
+    return 1.f / (std::abs(value) > epsilon ? value : std::copysign(epsilon, value));
+  }
+
+  FORCEINLINE bool IntersectBox(Vec3 const& origin, Vec3 const& inv_dir, CAaBox const& box, float t_max)
+  {
+    float const tx0 = (box.min.x - origin.x) * inv_dir.x;
+    float const tx1 = (box.max.x - origin.x) * inv_dir.x;
+    float const ty0 = (box.min.y - origin.y) * inv_dir.y;
+    float const ty1 = (box.max.y - origin.y) * inv_dir.y;
+    float const tz0 = (box.min.z - origin.z) * inv_dir.z;
+    float const tz1 = (box.max.z - origin.z) * inv_dir.z;
+
+    float const t_near = std::max({std::min(tx0, tx1), std::min(ty0, ty1), std::min(tz0, tz1), 0.f});
+    float const t_far = std::min({std::max(tx0, tx1), std::max(ty0, ty1), std::max(tz0, tz1), t_max});
+
+    return t_near <= t_far;
+  }
+
+  // Möller-Trumbore, both sides
+  FORCEINLINE std::optional<float> IntersectTriangle(Vec3 const& origin, Vec3 const& dir
+                                                     , Vec3 const& v0, Vec3 const& v1, Vec3 const& v2)
+  {
+    Vec3 const e1 = v1 - v0;
+    Vec3 const e2 = v2 - v0;
+    Vec3 const p = Cross(dir, e2);
+    float const det = Dot(e1, p);
+
+    if (std::abs(det) < 1e-12f)
+      return std::nullopt;
+
+    float const inv_det = 1.f / det;
+    Vec3 const s = origin - v0;
+    float const u = Dot(s, p) * inv_det;
+
+    if (u < 0.f || u > 1.f)
+      return std::nullopt;
+
+    Vec3 const q = Cross(s, e1);
+    float const v = Dot(dir, q) * inv_det;
+
+    if (v < 0.f || u + v > 1.f)
+      return std::nullopt;
+
+    return Dot(e2, q) * inv_det;
+  }
+
+  // contiguous triangles of a mesh lying in a chunk
+  struct ChunkRun
+  {
+    std::uint32_t chunk;
+    std::uint32_t index_first;
+    std::uint32_t index_count;
+    std::uint32_t vertex_first;
+    std::uint32_t vertex_count;
+  };
+}
+
+BlendMeshIndex::BlendMeshIndex()
+: _origin{0.f, 0.f}
+{
+}
+
+void BlendMeshIndex::Build(std::span<MBMH const> headers
+                           , std::span<MBBB const> boxes
+                           , std::span<MBNV const> vertices
+                           , std::span<std::uint16_t const> indices
+                           , C2Vector origin)
+{
+  _origin = origin;
+  _meshes.clear();
+  _nodes.clear();
+
+  _positions.resize(vertices.size());
+  std::transform(vertices.begin(), vertices.end(), _positions.begin(), [](MBNV const& v) { return v.pos; });
+  _indices.assign(indices.begin(), indices.end());
+
+  _meshes.reserve(headers.size());
+
+  for (MBMH const& header : headers)
+  {
+    RequireF(CCodeZones::TERRAIN, std::size_t{header.mbmi_start} + header.mbmi_count <= indices.size()
+             && std::size_t{header.mbnv_start} + header.mbnv_count <= vertices.size()
+             , "Blend mesh ranges out of bounds.");
+
+    Mesh& mesh = _meshes.emplace_back(Mesh{EMPTY_BOX, header.mbmi_start, header.mbmi_count
+                                           , header.mbnv_start, header.mbnv_count});
+
+    auto const box = std::find_if(boxes.begin(), boxes.end()
+                                  , [&](MBBB const& b) { return b.mapObjectID == header.mapObjectID; });
+
+    if (box != boxes.end())
+    {
+      mesh.bounds = box->bounding;
+      continue;
+    }
+
+    for (std::size_t i = 0; i < header.mbnv_count; ++i)
+    {
+      Extend(mesh.bounds, _positions[header.mbnv_start + i]);
+    }
+  }
+
+  _order.resize(_meshes.size());
+  std::iota(_order.begin(), _order.end(), 0);
+
+  if (!_meshes.empty())
+  {
+    _nodes.reserve(2 * _meshes.size());
+    _nodes.emplace_back();
+    BuildNode(0, 0, static_cast<std::uint32_t>(_meshes.size()));
+  }
+}
+
+void BlendMeshIndex::BuildNode(std::uint32_t node, std::uint32_t begin, std::uint32_t end)
+{
+  CAaBox bounds = EMPTY_BOX;
+  CAaBox centers = EMPTY_BOX;
+
+  for (std::uint32_t i = begin; i < end; ++i)
+  {
+    CAaBox const& mesh_bounds = _meshes[_order[i]].bounds;
+    Extend(bounds, mesh_bounds);
+    Extend(centers, C3Vector{(mesh_bounds.min.x + mesh_bounds.max.x) * 0.5f
+                             , (mesh_bounds.min.y + mesh_bounds.max.y) * 0.5f
+                             , (mesh_bounds.min.z + mesh_bounds.max.z) * 0.5f});
+  }
+
+  _nodes[node].bounds = bounds;
+
+  if (end - begin <= MAX_LEAF_SIZE)
+  {
+    _nodes[node].first = begin;
+    _nodes[node].count = end - begin;
+    return;
+  }
+
+  // median split along the longest axis of the centers
+  float const extents[3] = {centers.max.x - centers.min.x, centers.max.y - centers.min.y
+                            , centers.max.z - centers.min.z};
+  std::size_t const axis = std::max_element(extents, extents + 3) - extents;
+  std::uint32_t const middle = begin + (end - begin) / 2;
+
+  std::nth_element(_order.begin() + begin, _order.begin() + middle, _order.begin() + end
+                   , [&](std::uint32_t lhs, std::uint32_t rhs)
+                   {
+                     CAaBox const& l = _meshes[lhs].bounds;
+                     CAaBox const& r = _meshes[rhs].bounds;
+                     return Axis(l.min, axis) + Axis(l.max, axis) < Axis(r.min, axis) + Axis(r.max, axis);
+                   });
+
+  // children are allocated as a pair, their own children after them
+  auto const children = static_cast<std::uint32_t>(_nodes.size());
+  _nodes[node].first = children;
+  _nodes[node].count = 0;
+
+  _nodes.emplace_back();
+  _nodes.emplace_back();
+
+  BuildNode(children, begin, middle);
+  BuildNode(children + 1, middle, end);
+}
+
+template<typename Overlaps>
+void BlendMeshIndex::Traverse(Overlaps&& overlaps, std::vector<std::uint32_t>& meshes) const
+{
+  meshes.clear();
+
+  if (_nodes.empty())
+    return;
+
+  std::uint32_t stack[64];
+  std::size_t stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size)
+  {
+    Node const& node = _nodes[stack[--stack_size]];
+
+    if (!overlaps(node.bounds))
+      continue;
+
+    if (!node.count)
+    {
+      stack[stack_size++] = node.first;
+      stack[stack_size++] = node.first + 1;
+      continue;
+    }
+
+    for (std::uint32_t i = node.first; i < node.first + node.count; ++i)
+    {
+      if (overlaps(_meshes[_order[i]].bounds))
+      {
+        meshes.push_back(_order[i]);
+      }
+    }
+  }
+
+  std::sort(meshes.begin(), meshes.end());
+}
+
+void BlendMeshIndex::Query(CAaBox const& box, std::vector<std::uint32_t>& meshes) const
+{
+  Traverse([&](CAaBox const& bounds) { return Overlaps(bounds, box); }, meshes);
+}
+
+void BlendMeshIndex::QueryChunk(std::size_t chunk_x, std::size_t chunk_y, std::vector<std::uint32_t>& meshes) const
+{
+  RequireF(CCodeZones::TERRAIN, chunk_x < CHUNKS_PER_ROW && chunk_y < CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+  constexpr float size = IO::Common::WorldConstants::CHUNK_SIZE;
+  constexpr float inf = std::numeric_limits<float>::infinity();
+
+  // grid x runs along world -Y, grid y runs along world -X
+  CAaBox const footprint {{_origin.x - static_cast<float>(chunk_y + 1) * size
+                           , _origin.y - static_cast<float>(chunk_x + 1) * size, -inf}
+                          , {_origin.x - static_cast<float>(chunk_y) * size
+                             , _origin.y - static_cast<float>(chunk_x) * size, inf}};
+
+  Query(footprint, meshes);
+}
+
+std::optional<BlendMeshHit> BlendMeshIndex::Cast(Ray const& ray) const
+{
+  Vec3 const origin = ToVec3(ray.origin);
+  Vec3 const dir = ToVec3(ray.direction);
+  Vec3 const inv_dir {SafeInverse(dir.x), SafeInverse(dir.y), SafeInverse(dir.z)};
+
+  std::optional<BlendMeshHit> hit;
+  float t_max = ray.t_max;
+
+  std::vector<std::uint32_t> candidates;
+  Traverse([&](CAaBox const& bounds) { return IntersectBox(origin, inv_dir, bounds, t_max); }, candidates);
+
+  for (std::uint32_t mesh_index : candidates)
+  {
+    Mesh const& mesh = _meshes[mesh_index];
+    C3Vector const* positions = _positions.data() + mesh.vertex_start;
+
+    for (std::uint32_t i = 0; i + 2 < mesh.index_count; i += 3)
+    {
+      std::uint16_t const* triangle = _indices.data() + mesh.index_start + i;
+
+      if (std::max({triangle[0], triangle[1], triangle[2]}) >= mesh.vertex_count)
+        continue;
+
+      auto const t = IntersectTriangle(origin, dir, ToVec3(positions[triangle[0]]), ToVec3(positions[triangle[1]])
+                                       , ToVec3(positions[triangle[2]]));
+
+      if (!t || *t < 0.f || *t > t_max)
+        continue;
+
+      t_max = *t;
+      hit = BlendMeshHit{*t, {origin.x + dir.x * *t, origin.y + dir.y * *t, origin.z + dir.z * *t}, mesh_index};
+    }
+  }
+
+  return hit;
+}
+
+void BlendMeshIndex::ComputeBatches(std::span<std::vector<MCBB>, IO::Common::WorldConstants::CHUNKS_PER_TILE> batches
+                                    , std::size_t n_threads)
+{
+  std::vector<std::vector<ChunkRun>> runs(_meshes.size());
+
+  // meshes are reordered in parallel, a mesh sharing indices with a mesh starting before it is rejected
+  std::vector<std::uint32_t> by_start(_meshes.size());
+  std::iota(by_start.begin(), by_start.end(), 0);
+  std::stable_sort(by_start.begin(), by_start.end(), [this](std::uint32_t lhs, std::uint32_t rhs)
+  {
+    return _meshes[lhs].index_start < _meshes[rhs].index_start;
+  });
+
+  std::vector<std::uint8_t> rejected(_meshes.size(), false);
+  std::size_t range_end = 0;
+
+  for (std::uint32_t mesh_index : by_start)
+  {
+    Mesh const& mesh = _meshes[mesh_index];
+
+    if (!mesh.index_count)
+      continue;
+
+    if (mesh.index_start < range_end)
+    {
+      LogError("Blend mesh %u shares indices with another mesh, it gets no batches.", mesh_index);
+      rejected[mesh_index] = true;
+      continue;
+    }
+
+    range_end = std::size_t{mesh.index_start} + mesh.index_count;
+  }
+
+  // sort triangles of each mesh by the chunk containing their centroid
+  Utils::Misc::ParallelFor(0, _meshes.size(), [&](std::size_t mesh_index) -> void
+  {
+    Mesh const& mesh = _meshes[mesh_index];
+    std::uint32_t const n_triangles = mesh.index_count / 3;
+
+    if (rejected[mesh_index] || !n_triangles || !mesh.vertex_count)
+      return;
+    C3Vector const* positions = _positions.data() + mesh.vertex_start;
+    std::uint16_t* indices = _indices.data() + mesh.index_start;
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> keys(n_triangles);
+
+    for (std::uint32_t i = 0; i < n_triangles; ++i)
+    {
+      float x = 0.f;
+      float y = 0.f;
+
+      for (std::size_t corner = 0; corner < 3; ++corner)
+      {
+        std::uint16_t const vertex = std::min<std::uint16_t>(indices[i * 3 + corner], mesh.vertex_count - 1);
+        x += positions[vertex].x / 3.f;
+        y += positions[vertex].y / 3.f;
+      }
+
+      auto const cell = [](float offset) -> std::uint32_t
+      {
+        float const cell = std::floor(offset / IO::Common::WorldConstants::CHUNK_SIZE);
+        return static_cast<std::uint32_t>(std::clamp(cell, 0.f, static_cast<float>(CHUNKS_PER_ROW - 1)));
+      };
+
+      keys[i] = {cell(_origin.x - x) * CHUNKS_PER_ROW + cell(_origin.y - y), i};
+    }
+
+    std::stable_sort(keys.begin(), keys.end()
+                     , [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+
+    std::vector<std::uint16_t> sorted(indices, indices + n_triangles * 3);
+
+    for (std::uint32_t i = 0; i < n_triangles; ++i)
+    {
+      std::copy_n(sorted.begin() + keys[i].second * 3, 3, indices + i * 3);
+    }
+
+    for (std::uint32_t i = 0; i < n_triangles;)
+    {
+      std::uint32_t end = i;
+      std::uint16_t vertex_min = std::numeric_limits<std::uint16_t>::max();
+      std::uint16_t vertex_max = 0;
+
+      for (; end < n_triangles && keys[end].first == keys[i].first; ++end)
+      {
+        for (std::size_t corner = 0; corner < 3; ++corner)
+        {
+          vertex_min = std::min(vertex_min, indices[end * 3 + corner]);
+          vertex_max = std::max(vertex_max, indices[end * 3 + corner]);
+        }
+      }
+
+      runs[mesh_index].push_back({keys[i].first, i * 3, (end - i) * 3, vertex_min
+                                  , static_cast<std::uint32_t>(vertex_max - vertex_min + 1)});
+      i = end;
+    }
+  }, 1, n_threads);
+
+  // gather batches of each chunk, meshes in ascending order
+  Utils::Misc::ParallelFor(0, IO::Common::WorldConstants::CHUNKS_PER_TILE, [&](std::size_t chunk) -> void
+  {
+    std::vector<MCBB>& chunk_batches = batches[chunk];
+    chunk_batches.clear();
+
+    for (std::size_t mesh_index = 0; mesh_index < runs.size(); ++mesh_index)
+    {
+      auto const& mesh_runs = runs[mesh_index];
+      auto const run = std::lower_bound(mesh_runs.begin(), mesh_runs.end(), chunk
+                                        , [](ChunkRun const& lhs, std::size_t rhs) { return lhs.chunk < rhs; });
+
+      if (run == mesh_runs.end() || run->chunk != chunk)
+        continue;
+
+      if (chunk_batches.size() == MAX_BATCHES_PER_CHUNK)
+      {
+        LogError("Chunk %zu is touched by more than %zu blend meshes, extra batches are dropped.", chunk
+                 , MAX_BATCHES_PER_CHUNK);
+        break;
+      }
+
+      chunk_batches.push_back({static_cast<std::uint32_t>(mesh_index), run->index_count, run->index_first
+                               , run->vertex_count, run->vertex_first});
+    }
+  }, 1, n_threads);
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <Terrain/TileRaycaster.hpp>
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Terrain
+{
+  /**
+   * Intersection of a ray with a blend mesh.
+   */
+  struct BlendMeshHit
+  {
+    float t;                                          ///> Distance along the ray in units of direction.
+    IO::Common::DataStructures::C3Vector position;    ///> Intersection point in world coordinates.
+    std::uint32_t mesh;                               ///> Index of the blend mesh (MBMH entry).
+  };
+
+  /**
+   * Spatial index over the blend meshes of a tile (MBMH, MBBB, MBNV, MBMI).
+   * Meshes are organized in an AABB tree built over the bounding boxes of their map objects (MBBB), falling back to
+   * the bounds of their vertices for map objects without one. MBMI entries of a mesh are relative to its first MBNV
+   * entry, MCBB ranges are relative to the first MBMI and MBNV entries of their mesh.
+   */
+  class BlendMeshIndex
+  {
+  public:
+    /**
+     * Constructs an empty index at origin 0.
+     */
+    BlendMeshIndex();
+
+    /**
+     * Constructs an index from an ADT root file.
+     * @tparam client_version Version of the game client, blend meshes exist since MoP.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    explicit BlendMeshIndex(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Builds the index from an ADT root file. Origin of the tile is taken from the first chunk.
+     * @tparam client_version Version of the game client, blend meshes exist since MoP.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Build(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Builds the index from blend mesh data.
+     * @param headers Blend mesh headers (MBMH).
+     * @param boxes Bounding boxes of map objects (MBBB).
+     * @param vertices Blend mesh vertices (MBNV).
+     * @param indices Blend mesh indices (MBMI).
+     * @param origin World position of the first outer vertex of the tile (MCNK position of the first chunk).
+     */
+    void Build(std::span<IO::ADT::DataStructures::MBMH const> headers
+               , std::span<IO::ADT::DataStructures::MBBB const> boxes
+               , std::span<IO::ADT::DataStructures::MBNV const> vertices
+               , std::span<std::uint16_t const> indices
+               , IO::Common::DataStructures::C2Vector origin);
+
+    /**
+     * Finds blend meshes whose bounds overlap a box.
+     * @param box Box in world coordinates.
+     * @param meshes Receives indices of the meshes in ascending order, cleared first.
+     */
+    void Query(IO::Common::DataStructures::CAaBox const& box, std::vector<std::uint32_t>& meshes) const;
+
+    /**
+     * Finds blend meshes whose bounds overlap the horizontal footprint of a chunk, at any height.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param meshes Receives indices of the meshes in ascending order, cleared first.
+     */
+    void QueryChunk(std::size_t chunk_x, std::size_t chunk_y, std::vector<std::uint32_t>& meshes) const;
+
+    /**
+     * Finds the closest intersection of a ray with the triangles of the blend meshes.
+     * @param ray Ray to cast.
+     * @return Closest intersection within ray.t_max, if any.
+     */
+    [[nodiscard]]
+    std::optional<BlendMeshHit> Cast(Ray const& ray) const;
+
+    /**
+     * Regenerates blend batches (MCBB) of all chunks after blend meshes were edited, in parallel across chunks.
+     * Triangles of each mesh are assigned to the chunk containing their centroid and reordered so that those of a
+     * chunk are contiguous, MBMI of the root file is rewritten accordingly. The index must have been built from the
+     * same root file. Meshes without vertices or triangles, and meshes whose MBMI range overlaps the range of a mesh
+     * starting before them, are left untouched and get no batches.
+     * @tparam client_version Version of the game client, blend meshes exist since MoP.
+     * @param root ADT root file.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void RegenerateBatches(IO::ADT::ADTRoot<client_version>& root, std::size_t n_threads = 0);
+
+    /**
+     * Computes blend batches of all chunks, reordering triangles of each mesh by chunk.
+     * @param batches Receives blend batches of each chunk, at most 256 per chunk.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     */
+    void ComputeBatches(std::span<std::vector<IO::ADT::DataStructures::MCBB>
+                                  , IO::Common::WorldConstants::CHUNKS_PER_TILE> batches
+                        , std::size_t n_threads = 0);
+
+  // accessors
+  public:
+    [[nodiscard]]
+    std::size_t NumMeshes() const { return _meshes.size(); };
+
+    [[nodiscard]]
+    std::span<std::uint16_t const> Indices() const { return _indices; };
+
+  private:
+    struct Mesh
+    {
+      IO::Common::DataStructures::CAaBox bounds;
+      std::uint32_t index_start;
+      std::uint32_t index_count;
+      std::uint32_t vertex_start;
+      std::uint32_t vertex_count;
+    };
+
+    // leaves hold count > 0 meshes starting at first in _order, inner nodes have their children at first, first + 1
+    struct Node
+    {
+      IO::Common::DataStructures::CAaBox bounds;
+      std::uint32_t first;
+      std::uint32_t count;
+    };
+
+    void BuildNode(std::uint32_t node, std::uint32_t begin, std::uint32_t end);
+
+    template<typename Overlaps>
+    void Traverse(Overlaps&& overlaps, std::vector<std::uint32_t>& meshes) const;
+
+    IO::Common::DataStructures::C2Vector _origin;
+    std::vector<Mesh> _meshes;
+    std::vector<IO::Common::DataStructures::C3Vector> _positions;
+    std::vector<std::uint16_t> _indices;
+    std::vector<std::uint32_t> _order;
+    std::vector<Node> _nodes;
+  };
+}
+
+#include <Terrain/BlendMeshIndex.inl>
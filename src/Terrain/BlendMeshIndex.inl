@@ -0,0 +1,72 @@
+#pragma once
+#include <Terrain/BlendMeshIndex.hpp>
+#include <Terrain/Common.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline BlendMeshIndex::BlendMeshIndex(IO::ADT::ADTRoot<client_version> const& root)
+  : BlendMeshIndex()
+  {
+    Build(root);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void BlendMeshIndex::Build(IO::ADT::ADTRoot<client_version> const& root)
+  {
+    static_assert(client_version >= IO::Common::ClientVersion::MOP && "Blend meshes did not exist before MoP.");
+
+    auto const& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    auto const span = [](auto const& chunk) -> std::span<typename std::decay_t<decltype(*chunk.cbegin())> const>
+    {
+      if (!chunk.IsInitialized() || !chunk.Size())
+        return {};
+
+      return {&*chunk.cbegin(), chunk.Size()};
+    };
+
+    auto const& position = chunks[0].Header().position;
+    Build(span(root.BlendMeshHeaders()), span(root.BlendMeshBoundingBoxes()), span(root.BlendMeshVertices())
+          , span(root.BlendMeshIndices()), {position.x, position.y});
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void BlendMeshIndex::RegenerateBatches(IO::ADT::ADTRoot<client_version>& root, std::size_t n_threads)
+  {
+    static_assert(client_version >= IO::Common::ClientVersion::MOP && "Blend meshes did not exist before MoP.");
+
+    auto& indices = root.BlendMeshIndices();
+
+    RequireF(CCodeZones::TERRAIN, (indices.IsInitialized() ? indices.Size() : 0) == _indices.size()
+             , "Index was not built from this ADT.");
+
+    std::array<std::vector<IO::ADT::DataStructures::MCBB>, IO::Common::WorldConstants::CHUNKS_PER_TILE> batches {};
+    ComputeBatches(batches, n_threads);
+
+    // triangles were only reordered, the number of indices is unchanged
+    if (!_indices.empty())
+    {
+      std::copy(_indices.begin(), _indices.end(), indices.begin());
+    }
+
+    auto& chunks = root.Chunks();
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      chunks[i].BlendBatches() = {};
+
+      if (!batches[i].empty())
+      {
+        chunks[i].BlendBatches().Initialize(batches[i]);
+      }
+    }
+  }
+}
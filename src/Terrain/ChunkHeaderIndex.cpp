@@ -0,0 +1,380 @@
+#include <Terrain/ChunkHeaderIndex.hpp>
+#include <Terrain/Common.hpp>
+#include <Terrain/TileHoles.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Contracts.hpp>
+#include <Validation/Log.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+
+using namespace Terrain;
+using namespace IO::Common;
+using WorldConstants::MAP_DIM;
+using IO::ADT::DataStructures::SMChunk;
+using IO::ADT::DataStructures::SMChunkFlags;
+
+static_assert(sizeof(SMChunkFlags) == sizeof(std::uint32_t));
+
+struct ChunkHeaderIndex::TileColumns
+{
+  std::array<std::uint32_t, WorldConstants::CHUNKS_PER_TILE> area_ids;
+  std::array<std::uint32_t, WorldConstants::CHUNKS_PER_TILE> flags;
+  std::array<std::uint64_t, WorldConstants::CHUNKS_PER_TILE> holes;
+  std::array<std::uint8_t, WorldConstants::CHUNKS_PER_TILE> n_layers;
+  std::array<std::uint32_t, WorldConstants::CHUNKS_PER_TILE> header_offsets;
+};
+
+namespace
+{
+  constexpr std::size_t AREA_ID_OFFSET = offsetof(SMChunk, areaid);
+
+  // heterogeneous comparison of entries by area ID, for searches in the area order
+  struct AreaKey
+  {
+    std::uint32_t area_id;
+  };
+
+  struct AreaLess
+  {
+    std::vector<std::uint32_t> const& area_ids;
+
+    bool operator()(std::uint32_t entry, AreaKey key) const { return area_ids[entry] < key.area_id; }
+    bool operator()(AreaKey key, std::uint32_t entry) const { return key.area_id < area_ids[entry]; }
+  };
+}
+
+ChunkHeaderIndex::ChunkHeaderIndex()
+{
+  _slots.fill(-1);
+}
+
+std::size_t ChunkHeaderIndex::Build(TileReadFunc const& read, std::size_t n_threads)
+{
+  std::vector<std::unique_ptr<TileColumns>> tiles (WorldConstants::MAX_TILES_PER_MAP);
+
+  Utils::Misc::ParallelFor(0, WorldConstants::MAX_TILES_PER_MAP, [&](std::size_t tile) -> void
+  {
+    if (std::optional<ByteBuffer> buf = read(tile % MAP_DIM, tile / MAP_DIM))
+    {
+      auto columns = std::make_unique<TileColumns>();
+
+      if (!Scan(*buf, *columns))
+      {
+        LogError("Indexing tile %zu_%zu failed. Malformed root ADT.", tile % MAP_DIM, tile / MAP_DIM);
+        return;
+      }
+
+      tiles[tile] = std::move(columns);
+    }
+  }, 1, n_threads);
+
+  *this = ChunkHeaderIndex{};
+
+  for (std::size_t tile = 0; tile < tiles.size(); ++tile)
+  {
+    if (tiles[tile])
+    {
+      Assign(Slot(tile), *tiles[tile]);
+    }
+  }
+
+  SortAreas();
+  return NumTiles();
+}
+
+bool ChunkHeaderIndex::AddTile(std::size_t tile_x, std::size_t tile_y, ByteBuffer const& buf)
+{
+  RequireF(CCodeZones::TERRAIN, tile_x < MAP_DIM && tile_y < MAP_DIM, "Tile index out of bounds.");
+
+  auto columns = std::make_unique<TileColumns>();
+
+  if (!Scan(buf, *columns))
+  {
+    LogError("Indexing tile %zu_%zu failed. Malformed root ADT.", tile_x, tile_y);
+    return false;
+  }
+
+  std::size_t const slot = Slot(tile_y * MAP_DIM + tile_x);
+  Assign(slot, *columns);
+  _dirty[slot].reset();
+
+  SortAreas();
+  return true;
+}
+
+std::span<std::uint32_t const> ChunkHeaderIndex::FindArea(std::uint32_t area_id) const
+{
+  auto const range = std::equal_range(_area_order.begin(), _area_order.end(), AreaKey{area_id}, AreaLess{_area_ids});
+  return { range.first, range.second };
+}
+
+std::vector<std::uint32_t> ChunkHeaderIndex::FindFlags(std::uint32_t mask) const
+{
+  std::vector<std::uint32_t> entries;
+
+  for (std::size_t i = 0; i < _flags.size(); ++i)
+  {
+    if ((_flags[i] & mask) == mask)
+    {
+      entries.push_back(static_cast<std::uint32_t>(i));
+    }
+  }
+
+  return entries;
+}
+
+std::optional<std::uint32_t> ChunkHeaderIndex::Entry(MapChunkRef ref) const
+{
+  RequireF(CCodeZones::TERRAIN, ref.tile_x < MAP_DIM && ref.tile_y < MAP_DIM
+           && ref.chunk_x < TileHeightfield::CHUNKS_PER_ROW && ref.chunk_y < TileHeightfield::CHUNKS_PER_ROW
+           , "Chunk location out of bounds.");
+
+  std::int16_t const slot = _slots[ref.tile_y * MAP_DIM + ref.tile_x];
+
+  if (slot < 0)
+    return std::nullopt;
+
+  return static_cast<std::uint32_t>(slot * WorldConstants::CHUNKS_PER_TILE
+                                    + ref.chunk_y * TileHeightfield::CHUNKS_PER_ROW + ref.chunk_x);
+}
+
+std::size_t ChunkHeaderIndex::RetagArea(std::uint32_t from, std::uint32_t to)
+{
+  auto const order_begin = _area_order.begin();
+  auto const order_end = _area_order.end();
+  auto const [from_begin, from_end] = std::equal_range(order_begin, order_end, AreaKey{from}, AreaLess{_area_ids});
+  auto const n_retagged = static_cast<std::size_t>(from_end - from_begin);
+
+  if (from == to || !n_retagged)
+    return 0;
+
+  for (auto it = from_begin; it != from_end; ++it)
+  {
+    _area_ids[*it] = to;
+    MarkDirty(*it);
+  }
+
+  // both runs are sorted by entry, move the retagged run next to the run of the target area and merge them
+  auto const entry_less = [](std::uint32_t lhs, std::uint32_t rhs) { return lhs < rhs; };
+
+  if (to > from)
+  {
+    auto const to_begin = std::lower_bound(from_end, order_end, AreaKey{to}, AreaLess{_area_ids});
+    auto const to_end = std::upper_bound(to_begin, order_end, AreaKey{to}, AreaLess{_area_ids});
+    auto const moved_begin = std::rotate(from_begin, from_end, to_begin);
+
+    std::inplace_merge(moved_begin, to_begin, to_end, entry_less);
+  }
+  else
+  {
+    auto const to_begin = std::lower_bound(order_begin, from_begin, AreaKey{to}, AreaLess{_area_ids});
+    auto const to_end = std::upper_bound(to_begin, from_begin, AreaKey{to}, AreaLess{_area_ids});
+    auto const moved_end = std::rotate(to_end, from_begin, from_end);
+
+    std::inplace_merge(to_begin, to_end, moved_end, entry_less);
+  }
+
+  return n_retagged;
+}
+
+std::size_t ChunkHeaderIndex::Retag(std::span<std::uint32_t const> entries, std::uint32_t to)
+{
+  std::size_t n_retagged = 0;
+
+  for (std::uint32_t entry : entries)
+  {
+    RequireF(CCodeZones::TERRAIN, entry < Size(), "Chunk entry out of bounds.");
+
+    if (_area_ids[entry] == to)
+      continue;
+
+    _area_ids[entry] = to;
+    MarkDirty(entry);
+    ++n_retagged;
+  }
+
+  if (n_retagged)
+  {
+    SortAreas();
+  }
+
+  return n_retagged;
+}
+
+std::optional<std::size_t> ChunkHeaderIndex::PatchTile(std::size_t tile_x, std::size_t tile_y, ByteBuffer& buf)
+{
+  RequireF(CCodeZones::TERRAIN, tile_x < MAP_DIM && tile_y < MAP_DIM, "Tile index out of bounds.");
+
+  std::int16_t const slot = _slots[tile_y * MAP_DIM + tile_x];
+  RequireF(CCodeZones::TERRAIN, slot >= 0, "Tile is not indexed.");
+
+  TileDirty& dirty = _dirty[static_cast<std::size_t>(slot)];
+  std::size_t const first = static_cast<std::size_t>(slot) * WorldConstants::CHUNKS_PER_TILE;
+
+  // offsets are trusted only if every dirty chunk still has an MCNK header there, nothing is written otherwise
+  for (std::size_t chunk = 0; dirty.any() && chunk < WorldConstants::CHUNKS_PER_TILE; ++chunk)
+  {
+    if (!dirty.test(chunk))
+      continue;
+
+    std::size_t const offset = _header_offsets[first + chunk];
+
+    if (offset < sizeof(ChunkHeader) || offset + sizeof(SMChunk) > buf.Size())
+      return std::nullopt;
+
+    ChunkHeader chunk_header {};
+    buf.Read(chunk_header, offset - sizeof(ChunkHeader));
+
+    if (chunk_header.fourcc != IO::ADT::ChunkIdentifiers::ADTRootChunks::MCNK || chunk_header.size < sizeof(SMChunk))
+      return std::nullopt;
+  }
+
+  std::size_t const n_patched = dirty.count();
+
+  for (std::size_t chunk = 0; n_patched && chunk < WorldConstants::CHUNKS_PER_TILE; ++chunk)
+  {
+    if (dirty.test(chunk))
+    {
+      buf.Write(_area_ids[first + chunk], _header_offsets[first + chunk] + AREA_ID_OFFSET);
+    }
+  }
+
+  dirty.reset();
+  return n_patched;
+}
+
+std::size_t ChunkHeaderIndex::PatchMap(TileReadFunc const& read, TileWriteFunc const& write, std::size_t n_threads)
+{
+  std::vector<std::size_t> slots;
+
+  for (std::size_t slot = 0; slot < _dirty.size(); ++slot)
+  {
+    if (_dirty[slot].any())
+    {
+      slots.push_back(slot);
+    }
+  }
+
+  std::atomic<std::size_t> n_patched = 0;
+
+  // each task patches a single slot, dirty bits of distinct slots are distinct objects
+  Utils::Misc::ParallelFor(0, slots.size(), [&](std::size_t i) -> void
+  {
+    std::size_t const tile = _tiles[slots[i]];
+    std::optional<ByteBuffer> buf = read(tile % MAP_DIM, tile / MAP_DIM);
+
+    if (!buf)
+      return;
+
+    if (!PatchTile(tile % MAP_DIM, tile / MAP_DIM, *buf))
+    {
+      LogError("Patching tile %zu_%zu failed. Root ADT does not match the index.", tile % MAP_DIM, tile / MAP_DIM);
+      return;
+    }
+
+    write(tile % MAP_DIM, tile / MAP_DIM, *buf);
+    n_patched.fetch_add(1, std::memory_order_relaxed);
+  }, 1, n_threads);
+
+  return n_patched.load();
+}
+
+std::size_t ChunkHeaderIndex::NumDirtyChunks() const
+{
+  std::size_t n_dirty = 0;
+
+  for (TileDirty const& dirty : _dirty)
+  {
+    n_dirty += dirty.count();
+  }
+
+  return n_dirty;
+}
+
+bool ChunkHeaderIndex::Scan(ByteBuffer const& buf, TileColumns& columns)
+{
+  std::size_t n_chunks = 0;
+  bool valid = true;
+
+  auto const visit = [&](ChunkHeader const& chunk_header, std::size_t pos) -> void
+  {
+    if (!valid || chunk_header.fourcc != IO::ADT::ChunkIdentifiers::ADTRootChunks::MCNK)
+      return;
+
+    // columns are fixed-size, the chunk count must be checked in release builds too
+    if (n_chunks == WorldConstants::CHUNKS_PER_TILE || chunk_header.size < sizeof(SMChunk))
+    {
+      valid = false;
+      return;
+    }
+
+    SMChunk header {};
+    buf.Read(header, pos);
+
+    columns.area_ids[n_chunks] = header.areaid;
+    columns.flags[n_chunks] = std::bit_cast<std::uint32_t>(header.flags);
+    columns.holes[n_chunks] = TileHoles::Decode(header);
+    columns.n_layers[n_chunks] = static_cast<std::uint8_t>(header.nLayers);
+    columns.header_offsets[n_chunks] = static_cast<std::uint32_t>(pos);
+    ++n_chunks;
+  };
+
+  bool const complete = ScanChunks(buf, 0, buf.Size(), visit);
+  return complete && valid && n_chunks == WorldConstants::CHUNKS_PER_TILE;
+}
+
+std::size_t ChunkHeaderIndex::Slot(std::size_t tile)
+{
+  if (_slots[tile] >= 0)
+    return static_cast<std::size_t>(_slots[tile]);
+
+  std::size_t const slot = _tiles.size();
+  std::size_t const size = (slot + 1) * WorldConstants::CHUNKS_PER_TILE;
+
+  _slots[tile] = static_cast<std::int16_t>(slot);
+  _tiles.push_back(static_cast<std::uint16_t>(tile));
+  _dirty.emplace_back();
+
+  _area_ids.resize(size);
+  _flags.resize(size);
+  _holes.resize(size);
+  _n_layers.resize(size);
+  _header_offsets.resize(size);
+
+  return slot;
+}
+
+void ChunkHeaderIndex::Assign(std::size_t slot, TileColumns const& columns)
+{
+  std::size_t const first = slot * WorldConstants::CHUNKS_PER_TILE;
+
+  std::copy(columns.area_ids.begin(), columns.area_ids.end(), _area_ids.begin() + first);
+  std::copy(columns.flags.begin(), columns.flags.end(), _flags.begin() + first);
+  std::copy(columns.holes.begin(), columns.holes.end(), _holes.begin() + first);
+  std::copy(columns.n_layers.begin(), columns.n_layers.end(), _n_layers.begin() + first);
+  std::copy(columns.header_offsets.begin(), columns.header_offsets.end(), _header_offsets.begin() + first);
+}
+
+void ChunkHeaderIndex::SortAreas()
+{
+  _area_order.resize(_area_ids.size());
+  std::iota(_area_order.begin(), _area_order.end(), 0);
+
+  // stable, so that entries of an area stay ascending
+  std::stable_sort(_area_order.begin(), _area_order.end(), [this](std::uint32_t lhs, std::uint32_t rhs)
+  {
+    return _area_ids[lhs] < _area_ids[rhs];
+  });
+}
+
+void ChunkHeaderIndex::MarkDirty(std::uint32_t entry)
+{
+  _dirty[entry / WorldConstants::CHUNKS_PER_TILE].set(entry % WorldConstants::CHUNKS_PER_TILE);
+}
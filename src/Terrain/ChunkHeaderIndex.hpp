@@ -0,0 +1,186 @@
+#pragma once
+
+#include <IO/ByteBuffer.hpp>
+#include <IO/Common.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <Terrain/TileHeightfield.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Terrain
+{
+  /**
+   * Location of a chunk (MCNK) in a map.
+   */
+  struct MapChunkRef
+  {
+    std::uint8_t tile_x;
+    std::uint8_t tile_y;
+    std::uint8_t chunk_x;
+    std::uint8_t chunk_y;
+  };
+
+  /**
+   * Map-wide columnar index of MCNK header attributes: area ID, flags, holes (high resolution, see TileHoles::Decode())
+   * and number of texture layers.
+   * The index is built from raw root ADT buffers by walking top-level chunk headers and copying MCNK headers only,
+   * without parsing tiles. Each attribute is stored in its own column, entry slot * 256 + chunk, slots following the
+   * order in which tiles were added. Entries are additionally sorted by area ID, so that area lookups are a binary
+   * search returning a contiguous range of entries.
+   * Retagging updates the columns and marks the affected chunks dirty. Dirty chunks are later patched in place into
+   * the raw buffers at the header offsets recorded on build, leaving the rest of the buffers untouched. Buffers must
+   * therefore not be re-serialized between building the index and patching them.
+   */
+  class ChunkHeaderIndex
+  {
+  public:
+    using TileReadFunc = std::function<std::optional<IO::Common::ByteBuffer>(std::size_t tile_x, std::size_t tile_y)>;
+    using TileWriteFunc = std::function<void(std::size_t tile_x, std::size_t tile_y, IO::Common::ByteBuffer const& buf)>;
+
+
+    ChunkHeaderIndex();
+
+    /**
+     * Builds the index from all tiles of a map in parallel, replacing its contents. Slots follow tile order.
+     * Malformed tiles are logged and skipped. Callbacks are invoked concurrently from worker threads.
+     * @param read Reads the raw root ADT of a tile, returns nothing if the tile does not exist.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return Number of tiles indexed.
+     */
+    std::size_t Build(TileReadFunc const& read, std::size_t n_threads = 0);
+
+    /**
+     * Adds a tile to the index, or replaces it if already indexed. Dirty chunks of a replaced tile are discarded.
+     * @param tile_x Horizontal index of the tile in the map.
+     * @param tile_y Vertical index of the tile in the map.
+     * @param buf Raw root ADT of the tile.
+     * @return False if the tile is malformed (not exactly 256 complete MCNK), the index is left unchanged.
+     */
+    bool AddTile(std::size_t tile_x, std::size_t tile_y, IO::Common::ByteBuffer const& buf);
+
+    /**
+     * Finds all chunks of an area.
+     * @param area_id Area ID.
+     * @return Entries of the chunks, ascending. Invalidated by retagging and adding tiles.
+     */
+    [[nodiscard]]
+    std::span<std::uint32_t const> FindArea(std::uint32_t area_id) const;
+
+    /**
+     * Finds all chunks whose flags contain all bits of a mask.
+     * @param mask Raw bits of SMChunkFlags.
+     * @return Entries of the chunks, ascending.
+     */
+    [[nodiscard]]
+    std::vector<std::uint32_t> FindFlags(std::uint32_t mask) const;
+
+    /**
+     * Locates the entry of a chunk.
+     * @param ref Location of the chunk.
+     * @return Entry of the chunk, nothing if its tile is not indexed.
+     */
+    [[nodiscard]]
+    std::optional<std::uint32_t> Entry(MapChunkRef ref) const;
+
+    /**
+     * Moves all chunks of an area to another area, e.g. to rename an area across a map.
+     * @param from Area ID to replace.
+     * @param to New area ID.
+     * @return Number of chunks retagged.
+     */
+    std::size_t RetagArea(std::uint32_t from, std::uint32_t to);
+
+    /**
+     * Moves chunks to an area.
+     * @param entries Entries of the chunks.
+     * @param to New area ID.
+     * @return Number of chunks whose area changed.
+     */
+    std::size_t Retag(std::span<std::uint32_t const> entries, std::uint32_t to);
+
+    /**
+     * Patches the headers of the dirty chunks of a tile in place and clears them.
+     * @param tile_x Horizontal index of the tile in the map.
+     * @param tile_y Vertical index of the tile in the map.
+     * @param buf Raw root ADT of the tile, the one the index was built from.
+     * @return Number of chunk headers patched, nothing if the buffer does not match the indexed tile. The buffer is
+     * then left untouched and the chunks stay dirty.
+     */
+    std::optional<std::size_t> PatchTile(std::size_t tile_x, std::size_t tile_y, IO::Common::ByteBuffer& buf);
+
+    /**
+     * Patches all tiles with dirty chunks in parallel, other tiles are neither read nor written. Tiles that no longer
+     * match the index are logged and not written. Callbacks are invoked concurrently from worker threads.
+     * @param read Reads the raw root ADT of a tile.
+     * @param write Receives each patched tile, typically writes it back.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return Number of tiles patched.
+     */
+    std::size_t PatchMap(TileReadFunc const& read, TileWriteFunc const& write, std::size_t n_threads = 0);
+
+  // accessors
+  public:
+    [[nodiscard]] FORCEINLINE std::size_t Size() const { return _area_ids.size(); };
+    [[nodiscard]] FORCEINLINE std::size_t NumTiles() const { return _tiles.size(); };
+
+    [[nodiscard]] FORCEINLINE MapChunkRef Ref(std::uint32_t entry) const
+    {
+      std::uint16_t const tile = _tiles[entry / IO::Common::WorldConstants::CHUNKS_PER_TILE];
+      std::uint32_t const chunk = entry % IO::Common::WorldConstants::CHUNKS_PER_TILE;
+
+      return { static_cast<std::uint8_t>(tile % IO::Common::WorldConstants::MAP_DIM)
+               , static_cast<std::uint8_t>(tile / IO::Common::WorldConstants::MAP_DIM)
+               , static_cast<std::uint8_t>(chunk % TileHeightfield::CHUNKS_PER_ROW)
+               , static_cast<std::uint8_t>(chunk / TileHeightfield::CHUNKS_PER_ROW) };
+    };
+
+    [[nodiscard]] FORCEINLINE std::span<std::uint32_t const> AreaIds() const { return _area_ids; };
+    [[nodiscard]] FORCEINLINE std::span<std::uint32_t const> Flags() const { return _flags; };
+    [[nodiscard]] FORCEINLINE std::span<std::uint64_t const> Holes() const { return _holes; };
+    [[nodiscard]] FORCEINLINE std::span<std::uint8_t const> NumLayers() const { return _n_layers; };
+
+    /**
+     * Number of chunks retagged since they were indexed or last patched.
+     */
+    [[nodiscard]] std::size_t NumDirtyChunks() const;
+
+  private:
+    using TileDirty = std::bitset<IO::Common::WorldConstants::CHUNKS_PER_TILE>;
+
+    // attributes of the chunks of a single tile, scanned before slots are allocated
+    struct TileColumns;
+
+    // walks top-level chunks of a tile and copies MCNK headers only, chunk data is skipped,
+    // false if the tile is not exactly 256 complete MCNK
+    static bool Scan(IO::Common::ByteBuffer const& buf, TileColumns& columns);
+
+    // allocates a slot for a tile, or returns its existing one
+    std::size_t Slot(std::size_t tile);
+
+    void Assign(std::size_t slot, TileColumns const& columns);
+
+    void SortAreas();
+
+    void MarkDirty(std::uint32_t entry);
+
+    std::array<std::int16_t, IO::Common::WorldConstants::MAX_TILES_PER_MAP> _slots;
+    std::vector<std::uint16_t> _tiles;
+    std::vector<TileDirty> _dirty;
+
+    std::vector<std::uint32_t> _area_ids;
+    std::vector<std::uint32_t> _flags;
+    std::vector<std::uint64_t> _holes;
+    std::vector<std::uint8_t> _n_layers;
+    std::vector<std::uint32_t> _header_offsets;     ///> Offsets of the SMChunk headers in the raw buffers.
+
+    std::vector<std::uint32_t> _area_order;         ///> Entries sorted by area ID, then entry.
+  };
+}
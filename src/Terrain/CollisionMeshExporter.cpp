@@ -0,0 +1,661 @@
+#include <Terrain/CollisionMeshExporter.hpp>
+#include <Terrain/TerrainMeshBuilder.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Contracts.hpp>
+#include <Validation/Log.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+
+using namespace Terrain;
+using namespace IO::Common::DataStructures;
+using IO::Common::WorldConstants::MAP_DIM;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  constexpr std::size_t QUADS_PER_ROW = IO::Common::WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+  constexpr std::size_t OUTER_DIM = IO::Common::WorldConstants::N_VERTS_CHUNK_ROW_OUTER;
+  constexpr std::size_t ROW_STRIDE = OUTER_DIM + QUADS_PER_ROW;
+  constexpr float VERTEX_SPACING = IO::Common::WorldConstants::CHUNK_SIZE / QUADS_PER_ROW;
+
+  constexpr std::size_t MAX_LIQUID_VERTICES = OUTER_DIM * OUTER_DIM;
+  constexpr std::size_t MAX_LIQUID_INDICES = QUADS_PER_ROW * QUADS_PER_ROW * 6;
+
+  // uchar vertex count, 3 uint indices, ushort surface
+  constexpr std::size_t PLY_FACE_SIZE = 1 + 3 * sizeof(std::uint32_t) + sizeof(std::uint16_t);
+
+  static_assert(std::endian::native == std::endian::little, "PLY export assumes a little endian host.");
+  static_assert(sizeof(C3Vector) == 3 * sizeof(float));
+
+  // serialized tile, either a complete record or file, or the vertices and faces of a tile of a PLY map
+  struct TileBlob
+  {
+    std::size_t tile_x = 0;
+    std::size_t tile_y = 0;
+    std::uint32_t n_vertices = 0;
+    std::uint32_t n_triangles = 0;
+    std::string data;
+    std::string faces;    ///> PLY maps only, indices are relative to the tile.
+
+    [[nodiscard]]
+    std::size_t Size() const { return data.size() + faces.size(); };
+  };
+
+  /**
+   * Queue of serialized tiles between worker threads and the writer thread, bounded in bytes.
+   * A blob larger than the bound is still accepted once the queue is empty.
+   */
+  class WriteBehindBuffer
+  {
+  public:
+    explicit WriteBehindBuffer(std::size_t max_bytes)
+    : _max_bytes{max_bytes}
+    {
+    }
+
+    // blocks while the buffer is full
+    void Push(TileBlob&& blob)
+    {
+      std::unique_lock lock {_mutex};
+
+      _not_full.wait(lock, [&] { return _blobs.empty() || _pending_bytes + blob.Size() <= _max_bytes; });
+
+      _pending_bytes += blob.Size();
+      _blobs.push_back(std::move(blob));
+      _not_empty.notify_one();
+    }
+
+    // blocks until a blob is available, returns false once the buffer is closed and drained
+    bool Pop(TileBlob& blob)
+    {
+      std::unique_lock lock {_mutex};
+
+      _not_empty.wait(lock, [&] { return !_blobs.empty() || _closed; });
+
+      if (_blobs.empty())
+        return false;
+
+      blob = std::move(_blobs.front());
+      _blobs.pop_front();
+      _pending_bytes -= blob.Size();
+      _not_full.notify_all();
+      return true;
+    }
+
+    void Close()
+    {
+      std::lock_guard const lock {_mutex};
+
+      _closed = true;
+      _not_empty.notify_all();
+    }
+
+  private:
+    std::mutex _mutex;
+    std::condition_variable _not_full;
+    std::condition_variable _not_empty;
+    std::deque<TileBlob> _blobs;
+    std::size_t _pending_bytes = 0;
+    std::size_t _max_bytes;
+    bool _closed = false;
+  };
+
+  // appends triangles of a chunk, only referenced vertices are kept
+  template<std::size_t max_vertices>
+  void AppendCompacted(std::span<C3Vector const> positions
+                       , std::span<std::uint16_t const> indices
+                       , std::uint16_t surface
+                       , CollisionMesh& mesh)
+  {
+    constexpr std::uint32_t unused = std::numeric_limits<std::uint32_t>::max();
+
+    std::array<std::uint32_t, max_vertices> remap;
+    std::fill_n(remap.begin(), positions.size(), unused);
+
+    for (std::uint16_t index : indices)
+    {
+      if (remap[index] == unused)
+      {
+        remap[index] = static_cast<std::uint32_t>(mesh.vertices.size());
+        mesh.vertices.push_back(positions[index]);
+      }
+
+      mesh.indices.push_back(remap[index]);
+    }
+
+    mesh.surfaces.insert(mesh.surfaces.end(), indices.size() / 3, surface);
+  }
+
+  template<typename T>
+  FORCEINLINE void Append(std::string& out, T const& value)
+  {
+    out.append(reinterpret_cast<char const*>(&value), sizeof(T));
+  }
+
+  template<typename T>
+  FORCEINLINE void Append(std::string& out, std::vector<T> const& values)
+  {
+    out.append(reinterpret_cast<char const*>(values.data()), values.size() * sizeof(T));
+  }
+
+  // counts are zero padded to a fixed width, so the header of a streamed map can be patched in place
+  std::string PlyHeader(std::uint32_t n_vertices, std::uint32_t n_triangles)
+  {
+    char header[256];
+    int const size = std::snprintf(header, sizeof(header)
+                                   , "ply\n"
+                                     "format binary_little_endian 1.0\n"
+                                     "element vertex %010u\n"
+                                     "property float x\n"
+                                     "property float y\n"
+                                     "property float z\n"
+                                     "element face %010u\n"
+                                     "property list uchar uint vertex_indices\n"
+                                     "property ushort surface\n"
+                                     "end_header\n"
+                                   , n_vertices, n_triangles);
+
+    return {header, static_cast<std::size_t>(size)};
+  }
+
+  void AppendPlyFaces(CollisionMesh const& mesh, std::string& out)
+  {
+    std::size_t const offset = out.size();
+    out.resize(offset + mesh.NumTriangles() * PLY_FACE_SIZE);
+
+    char* face = out.data() + offset;
+
+    for (std::size_t i = 0; i < mesh.NumTriangles(); ++i, face += PLY_FACE_SIZE)
+    {
+      face[0] = 3;
+      std::memcpy(face + 1, mesh.indices.data() + i * 3, 3 * sizeof(std::uint32_t));
+      std::memcpy(face + 1 + 3 * sizeof(std::uint32_t), &mesh.surfaces[i], sizeof(std::uint16_t));
+    }
+  }
+
+  // adds base to the indices of serialized PLY faces
+  void RebasePlyFaces(std::string& faces, std::uint32_t base)
+  {
+    for (std::size_t offset = 1; offset < faces.size(); offset += PLY_FACE_SIZE)
+    {
+      std::uint32_t indices[3];
+      std::memcpy(indices, faces.data() + offset, sizeof(indices));
+
+      for (std::uint32_t& index : indices)
+      {
+        index += base;
+      }
+
+      std::memcpy(faces.data() + offset, indices, sizeof(indices));
+    }
+  }
+
+  template<typename T>
+  FORCEINLINE void AppendNumber(std::string& out, T value)
+  {
+    char buf[32];
+    auto const result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+  }
+
+  // faces use negative indices relative to the end of the tile's vertices, so tiles can be written in any order
+  void AppendObj(std::size_t tile_x, std::size_t tile_y, CollisionMesh const& mesh, std::string& out)
+  {
+    out += "o tile_";
+    AppendNumber(out, tile_x);
+    out += '_';
+    AppendNumber(out, tile_y);
+    out += '\n';
+
+    for (C3Vector const& vertex : mesh.vertices)
+    {
+      out += "v ";
+      AppendNumber(out, vertex.x);
+      out += ' ';
+      AppendNumber(out, vertex.y);
+      out += ' ';
+      AppendNumber(out, vertex.z);
+      out += '\n';
+    }
+
+    auto const n_vertices = static_cast<std::int64_t>(mesh.vertices.size());
+    std::uint32_t surface = std::numeric_limits<std::uint32_t>::max();
+
+    for (std::size_t i = 0; i < mesh.NumTriangles(); ++i)
+    {
+      if (mesh.surfaces[i] != surface)
+      {
+        surface = mesh.surfaces[i];
+
+        if (surface == CollisionMeshExporter::TERRAIN_SURFACE)
+        {
+          out += "g terrain\n";
+        }
+        else
+        {
+          out += "g liquid_";
+          AppendNumber(out, surface);
+          out += '\n';
+        }
+      }
+
+      out += 'f';
+
+      for (std::size_t j = 0; j < 3; ++j)
+      {
+        out += ' ';
+        AppendNumber(out, static_cast<std::int64_t>(mesh.indices[i * 3 + j]) - n_vertices);
+      }
+
+      out += '\n';
+    }
+  }
+
+  TileBlob Serialize(std::size_t tile_x
+                     , std::size_t tile_y
+                     , CollisionMesh const& mesh
+                     , CollisionMeshFormat format
+                     , bool whole_map)
+  {
+    RequireF(CCodeZones::TERRAIN, mesh.vertices.size() <= std::numeric_limits<std::uint32_t>::max()
+             && mesh.indices.size() == mesh.NumTriangles() * 3, "Malformed collision mesh.");
+
+    TileBlob blob {};
+    blob.tile_x = tile_x;
+    blob.tile_y = tile_y;
+    blob.n_vertices = static_cast<std::uint32_t>(mesh.vertices.size());
+    blob.n_triangles = static_cast<std::uint32_t>(mesh.NumTriangles());
+
+    switch (format)
+    {
+      case CollisionMeshFormat::Binary:
+      {
+        if (!whole_map)
+        {
+          Append(blob.data, CollisionFileHeader{CollisionMeshExporter::FILE_MAGIC, CollisionMeshExporter::FILE_VERSION, 1});
+        }
+
+        Append(blob.data, CollisionTileHeader{ static_cast<std::uint8_t>(tile_x), static_cast<std::uint8_t>(tile_y), 0
+                                               , blob.n_vertices, blob.n_triangles });
+        Append(blob.data, mesh.vertices);
+        Append(blob.data, mesh.indices);
+        Append(blob.data, mesh.surfaces);
+        break;
+      }
+      case CollisionMeshFormat::PLY:
+      {
+        if (!whole_map)
+        {
+          blob.data = PlyHeader(blob.n_vertices, blob.n_triangles);
+        }
+
+        Append(blob.data, mesh.vertices);
+        AppendPlyFaces(mesh, whole_map ? blob.faces : blob.data);
+        break;
+      }
+      case CollisionMeshFormat::OBJ:
+      {
+        AppendObj(tile_x, tile_y, mesh, blob.data);
+        break;
+      }
+    }
+
+    return blob;
+  }
+
+  std::string_view Extension(CollisionMeshFormat format)
+  {
+    switch (format)
+    {
+      case CollisionMeshFormat::Binary:
+        return ".wcol";
+      case CollisionMeshFormat::PLY:
+        return ".ply";
+      case CollisionMeshFormat::OBJ:
+        return ".obj";
+    }
+
+    return {};
+  }
+
+  /**
+   * Builds and serializes tiles in parallel and hands them to write on a dedicated writer thread, in completion order.
+   * Once write fails, remaining tiles are skipped and pending ones are discarded.
+   */
+  bool Stream(CollisionMeshExporter::TileBuildFunc const& build
+              , CollisionMeshFormat format
+              , bool whole_map
+              , std::size_t n_threads
+              , std::size_t max_pending_bytes
+              , std::function<bool(TileBlob& blob)> const& write)
+  {
+    WriteBehindBuffer buffer {max_pending_bytes};
+    std::atomic<bool> failed = false;
+
+    std::thread writer {[&]() -> void
+    {
+      TileBlob blob {};
+
+      while (buffer.Pop(blob))
+      {
+        if (!failed.load(std::memory_order_relaxed) && !write(blob))
+        {
+          failed = true;
+        }
+      }
+    }};
+
+    try
+    {
+      Utils::Misc::ParallelFor(0, IO::Common::WorldConstants::MAX_TILES_PER_MAP, [&](std::size_t tile) -> void
+      {
+        if (failed.load(std::memory_order_relaxed))
+          return;
+
+        CollisionMesh mesh {};
+
+        if (!build(tile % MAP_DIM, tile / MAP_DIM, mesh))
+          return;
+
+        buffer.Push(Serialize(tile % MAP_DIM, tile / MAP_DIM, mesh, format, whole_map));
+      }, 1, n_threads);
+    }
+    catch (...)
+    {
+      buffer.Close();
+      writer.join();
+      throw;
+    }
+
+    buffer.Close();
+    writer.join();
+
+    return !failed;
+  }
+
+  bool CheckStream(std::ios const& strm, fs::path const& path)
+  {
+    if (!strm)
+    {
+      LogError("Writing collision mesh \"%s\" failed. Unknown OS error.", path.string().c_str());
+      return false;
+    }
+
+    return true;
+  }
+}
+
+void CollisionMeshExporter::AppendTerrain(IO::ADT::DataStructures::SMChunk const& header
+                                          , float const* heights
+                                          , std::uint64_t holes
+                                          , CollisionMesh& mesh)
+{
+  std::array<std::uint16_t, TerrainMeshBuilder::MAX_INDICES_PER_CHUNK> indices;
+  std::size_t const n_indices = TerrainMeshBuilder::BuildIndices(holes, indices);
+
+  if (!n_indices)
+    return;
+
+  // rows of 9 outer vertices, followed by 8 inner vertices offset by half a quad
+  std::array<C3Vector, TerrainMeshBuilder::VERTICES_PER_CHUNK> positions;
+  auto const& position = header.position;
+
+  for (std::size_t i = 0; i < positions.size(); ++i)
+  {
+    std::size_t const row = i / ROW_STRIDE;
+    std::size_t const column = i % ROW_STRIDE;
+    bool const inner = column >= OUTER_DIM;
+
+    float const x = inner ? static_cast<float>(column - OUTER_DIM) + 0.5f : static_cast<float>(column);
+    float const y = inner ? static_cast<float>(row) + 0.5f : static_cast<float>(row);
+
+    positions[i] = { position.x - y * VERTEX_SPACING, position.y - x * VERTEX_SPACING, position.z + heights[i] };
+  }
+
+  AppendCompacted<TerrainMeshBuilder::VERTICES_PER_CHUNK>(positions, {indices.data(), n_indices}, TERRAIN_SURFACE
+                                                          , mesh);
+}
+
+void CollisionMeshExporter::AppendLiquids(IO::ADT::LiquidChunk const& chunk, C2Vector origin, CollisionMesh& mesh)
+{
+  std::array<C3Vector, MAX_LIQUID_VERTICES> positions;
+  std::array<std::uint16_t, MAX_LIQUID_INDICES> indices;
+
+  for (IO::ADT::LiquidLayer const& layer : chunk.Layers())
+  {
+    std::uint64_t const exists = layer.ExistsMap();
+
+    if (!exists)
+      continue;
+
+    // vertex data covers the liquid rectangle only
+    auto const heights = layer.Heights();
+    std::size_t const row_size = layer.width + 1u;
+
+    for (std::size_t y = 0; y <= layer.height; ++y)
+    {
+      for (std::size_t x = 0; x < row_size; ++x)
+      {
+        std::size_t const i = y * row_size + x;
+        auto const grid_x = static_cast<float>(layer.x_offset + x);
+        auto const grid_y = static_cast<float>(layer.y_offset + y);
+
+        positions[i] = { origin.x - grid_y * VERTEX_SPACING, origin.y - grid_x * VERTEX_SPACING
+                         , heights.empty() ? layer.min_height_level : heights[i] };
+      }
+    }
+
+    std::size_t n_indices = 0;
+
+    for (std::size_t y = 0; y < layer.height; ++y)
+    {
+      for (std::size_t x = 0; x < layer.width; ++x)
+      {
+        if (!((exists >> ((layer.y_offset + y) * QUADS_PER_ROW + layer.x_offset + x)) & 1))
+          continue;
+
+        auto const nw = static_cast<std::uint16_t>(y * row_size + x);
+        auto const ne = static_cast<std::uint16_t>(nw + 1);
+        auto const sw = static_cast<std::uint16_t>(nw + row_size);
+        auto const se = static_cast<std::uint16_t>(sw + 1);
+
+        // counter-clockwise seen from above: grid x runs along world -Y, grid y along world -X
+        std::uint16_t const quad_indices[6] = {nw, sw, se, nw, se, ne};
+        std::copy_n(quad_indices, 6, indices.data() + n_indices);
+        n_indices += 6;
+      }
+    }
+
+    AppendCompacted<MAX_LIQUID_VERTICES>({positions.data(), layer.VertexCount()}, {indices.data(), n_indices}
+                                         , layer.liquid_type, mesh);
+  }
+}
+
+bool CollisionMeshExporter::ExportMap(fs::path const& path
+                                      , CollisionMeshFormat format
+                                      , TileBuildFunc const& build
+                                      , std::size_t n_threads
+                                      , std::size_t max_pending_bytes)
+{
+  std::ofstream strm {path, std::ofstream::binary | std::ofstream::out | std::ofstream::trunc};
+
+  if (!strm.is_open())
+  {
+    LogError("Creating collision mesh \"%s\" failed. Unknown OS error.", path.string().c_str());
+    return false;
+  }
+
+  // PLY needs all vertices before all faces, faces are spilled to a temporary file and appended at the end
+  fs::path faces_path = path;
+  faces_path += ".faces.tmp";
+
+  std::ofstream faces_strm {};
+
+  // removes the temporary faces and, on failure, the truncated mesh
+  auto const cleanup = [&](bool success) -> void
+  {
+    std::error_code error;
+
+    if (format == CollisionMeshFormat::PLY)
+    {
+      faces_strm.close();
+      fs::remove(faces_path, error);
+    }
+
+    if (!success)
+    {
+      strm.close();
+      fs::remove(path, error);
+    }
+  };
+
+  if (format == CollisionMeshFormat::PLY)
+  {
+    faces_strm.open(faces_path, std::ofstream::binary | std::ofstream::out | std::ofstream::trunc);
+
+    if (!faces_strm.is_open())
+    {
+      LogError("Creating collision mesh \"%s\" failed. Unknown OS error.", faces_path.string().c_str());
+      cleanup(false);
+      return false;
+    }
+  }
+
+  std::uint32_t n_tiles = 0;
+  std::uint32_t n_vertices = 0;
+  std::uint32_t n_triangles = 0;
+
+  auto const write_header = [&]() -> void
+  {
+    if (format == CollisionMeshFormat::Binary)
+    {
+      CollisionFileHeader const header {FILE_MAGIC, FILE_VERSION, n_tiles};
+      strm.write(reinterpret_cast<char const*>(&header), sizeof(CollisionFileHeader));
+    }
+    else if (format == CollisionMeshFormat::PLY)
+    {
+      std::string const header = PlyHeader(n_vertices, n_triangles);
+      strm.write(header.data(), static_cast<std::streamsize>(header.size()));
+    }
+  };
+
+  write_header();
+
+  bool streamed = false;
+
+  try
+  {
+    streamed = Stream(build, format, true, n_threads, max_pending_bytes, [&](TileBlob& blob) -> bool
+    {
+      // counts are checked before anything of the tile is written
+      if (format == CollisionMeshFormat::PLY
+          && (n_vertices > std::numeric_limits<std::uint32_t>::max() - blob.n_vertices
+              || n_triangles > std::numeric_limits<std::uint32_t>::max() - blob.n_triangles))
+      {
+        LogError("Collision mesh \"%s\" has too many elements for PLY.", path.string().c_str());
+        return false;
+      }
+
+      strm.write(blob.data.data(), static_cast<std::streamsize>(blob.data.size()));
+
+      if (format == CollisionMeshFormat::PLY)
+      {
+        RebasePlyFaces(blob.faces, n_vertices);
+        faces_strm.write(blob.faces.data(), static_cast<std::streamsize>(blob.faces.size()));
+
+        if (!CheckStream(faces_strm, faces_path))
+          return false;
+      }
+
+      ++n_tiles;
+      n_vertices += blob.n_vertices;
+      n_triangles += blob.n_triangles;
+
+      return CheckStream(strm, path);
+    });
+  }
+  catch (...)
+  {
+    cleanup(false);
+    throw;
+  }
+
+  bool success = streamed;
+
+  if (success && format == CollisionMeshFormat::PLY)
+  {
+    faces_strm.close();
+
+    std::ifstream faces_in {faces_path, std::ifstream::binary};
+
+    // an empty stream buffer sets failbit, no faces is not an error
+    if (n_triangles)
+    {
+      strm << faces_in.rdbuf();
+    }
+
+    success = CheckStream(strm, path);
+  }
+
+  if (success)
+  {
+    strm.seekp(0);
+    write_header();
+    strm.close();
+
+    success = CheckStream(strm, path);
+  }
+
+  cleanup(success);
+  return success;
+}
+
+bool CollisionMeshExporter::ExportTiles(fs::path const& directory
+                                        , CollisionMeshFormat format
+                                        , TileBuildFunc const& build
+                                        , std::size_t n_threads
+                                        , std::size_t max_pending_bytes)
+{
+  return Stream(build, format, false, n_threads, max_pending_bytes, [&](TileBlob& blob) -> bool
+  {
+    fs::path path = directory / (std::to_string(blob.tile_x) + "_" + std::to_string(blob.tile_y));
+    path += Extension(format);
+
+    std::ofstream strm {path, std::ofstream::binary | std::ofstream::out | std::ofstream::trunc};
+
+    if (!strm.is_open())
+    {
+      LogError("Creating collision mesh \"%s\" failed. Unknown OS error.", path.string().c_str());
+      return false;
+    }
+
+    strm.write(blob.data.data(), static_cast<std::streamsize>(blob.data.size()));
+    strm.close();
+
+    if (!CheckStream(strm, path))
+    {
+      std::error_code error;
+      fs::remove(path, error);
+      return false;
+    }
+
+    return true;
+  });
+}
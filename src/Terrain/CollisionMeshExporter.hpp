@@ -0,0 +1,198 @@
+#pragma once
+
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace Terrain
+{
+  enum class CollisionMeshFormat
+  {
+    Binary = 0,     ///> Compact native endian format, see CollisionFileHeader.
+    PLY = 1,        ///> Binary little endian PLY, faces carry a ushort surface property.
+    OBJ = 2         ///> Wavefront OBJ, faces use relative indices and are grouped by surface.
+  };
+
+  /**
+   * Triangle soup of a tile in world coordinates, only vertices referenced by triangles are stored.
+   */
+  struct CollisionMesh
+  {
+    std::vector<IO::Common::DataStructures::C3Vector> vertices;
+    std::vector<std::uint32_t> indices;     ///> 3 per triangle, counter-clockwise seen from above.
+    std::vector<std::uint16_t> surfaces;    ///> Per triangle, 0 for terrain, LiquidType.dbc ID for liquid surfaces.
+
+    void Clear()
+    {
+      vertices.clear();
+      indices.clear();
+      surfaces.clear();
+    };
+
+    [[nodiscard]]
+    std::size_t NumTriangles() const { return surfaces.size(); };
+  };
+
+  /**
+   * Header of Binary collision files, followed by n_tiles tile records in no particular order.
+   */
+  struct CollisionFileHeader
+  {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t n_tiles;
+  };
+
+  /**
+   * Header of a tile record of Binary collision files. It is followed by n_vertices C3Vector, n_triangles * 3
+   * std::uint32_t indices relative to the record, and n_triangles std::uint16_t surfaces.
+   */
+  struct CollisionTileHeader
+  {
+    std::uint8_t tile_x;
+    std::uint8_t tile_y;
+    std::uint16_t padding;
+    std::uint32_t n_vertices;
+    std::uint32_t n_triangles;
+  };
+
+  /**
+   * Exports walkable terrain and liquid surfaces of maps as triangle soups, for server side collision and physics
+   * tools. Terrain quads are split into the same 4 triangles as TerrainMeshBuilder and holes are skipped, liquid
+   * quads of every layer (LiquidLayer exists map and heights) are split into 2 triangles.
+   * Exports are streamed: tiles are built and serialized in parallel, then handed to a single writer thread through
+   * a write-behind buffer bounded in bytes. Workers wait while the buffer is full, so memory use depends on the
+   * number of threads and the size of the buffer, not on the size of the map.
+   */
+  class CollisionMeshExporter
+  {
+  public:
+    template<IO::Common::ClientVersion client_version>
+    using TileLoadFunc = std::function<std::optional<IO::ADT::ADTRoot<client_version>>(std::size_t tile_x
+                                                                                        , std::size_t tile_y)>;
+
+    /**
+     * Builds the mesh of a tile.
+     * @return False if the tile does not exist.
+     */
+    using TileBuildFunc = std::function<bool(std::size_t tile_x, std::size_t tile_y, CollisionMesh& mesh)>;
+
+    static constexpr std::uint32_t FILE_MAGIC = IO::Common::FourCC<"WCOL">;
+    static constexpr std::uint32_t FILE_VERSION = 1;
+    static constexpr std::uint16_t TERRAIN_SURFACE = 0;
+    static constexpr std::size_t DEFAULT_MAX_PENDING_BYTES = 64 * 1024 * 1024;
+
+    /**
+     * Builds the mesh of a tile, replacing contents of the mesh.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param mesh Output mesh.
+     */
+    template<IO::Common::ClientVersion client_version>
+    static void BuildTile(IO::ADT::ADTRoot<client_version> const& root, CollisionMesh& mesh);
+
+    /**
+     * Appends the terrain of a chunk to a mesh. Quads of the high resolution hole mask are skipped.
+     * @param header Chunk header (position).
+     * @param heights MCVT heights, relative to the chunk position.
+     * @param holes High resolution hole mask (bit row * 8 + column is set for a hole quad).
+     * @param mesh Output mesh.
+     */
+    static void AppendTerrain(IO::ADT::DataStructures::SMChunk const& header
+                              , float const* heights
+                              , std::uint64_t holes
+                              , CollisionMesh& mesh);
+
+    /**
+     * Appends liquid surfaces of all layers of a chunk to a mesh. Layers without heights are flat at their minimum
+     * height level.
+     * @param chunk Liquids of the chunk.
+     * @param origin World position of the first vertex of the chunk (MCNK position).
+     * @param mesh Output mesh.
+     */
+    static void AppendLiquids(IO::ADT::LiquidChunk const& chunk
+                              , IO::Common::DataStructures::C2Vector origin
+                              , CollisionMesh& mesh);
+
+    /**
+     * Exports all tiles of a map into a single file.
+     * @tparam client_version Version of the game client.
+     * @param path Path of the file, overwritten if it exists.
+     * @param format Format of the file.
+     * @param load Loads a tile, returns nothing if the tile does not exist. Invoked concurrently.
+     * @param n_threads Maximum number of worker threads, 0 for all hardware threads.
+     * @param max_pending_bytes Size of the write-behind buffer.
+     * @return True on success.
+     */
+    template<IO::Common::ClientVersion client_version>
+    static bool ExportMap(std::filesystem::path const& path
+                          , CollisionMeshFormat format
+                          , TileLoadFunc<client_version> const& load
+                          , std::size_t n_threads = 0
+                          , std::size_t max_pending_bytes = DEFAULT_MAX_PENDING_BYTES);
+
+    /**
+     * Exports all tiles of a map into a single file.
+     * @param path Path of the file, overwritten if it exists.
+     * @param format Format of the file.
+     * @param build Builds the mesh of a tile. Invoked concurrently.
+     * @param n_threads Maximum number of worker threads, 0 for all hardware threads.
+     * @param max_pending_bytes Size of the write-behind buffer.
+     * @return True on success.
+     */
+    static bool ExportMap(std::filesystem::path const& path
+                          , CollisionMeshFormat format
+                          , TileBuildFunc const& build
+                          , std::size_t n_threads = 0
+                          , std::size_t max_pending_bytes = DEFAULT_MAX_PENDING_BYTES);
+
+    /**
+     * Exports every tile of a map into its own file named "<tile_x>_<tile_y>" with the extension of the format
+     * (.wcol, .ply, .obj).
+     * @tparam client_version Version of the game client.
+     * @param directory Existing directory receiving the files, existing files are overwritten.
+     * @param format Format of the files.
+     * @param load Loads a tile, returns nothing if the tile does not exist. Invoked concurrently.
+     * @param n_threads Maximum number of worker threads, 0 for all hardware threads.
+     * @param max_pending_bytes Size of the write-behind buffer.
+     * @return True on success.
+     */
+    template<IO::Common::ClientVersion client_version>
+    static bool ExportTiles(std::filesystem::path const& directory
+                            , CollisionMeshFormat format
+                            , TileLoadFunc<client_version> const& load
+                            , std::size_t n_threads = 0
+                            , std::size_t max_pending_bytes = DEFAULT_MAX_PENDING_BYTES);
+
+    /**
+     * Exports every tile of a map into its own file, see above.
+     * @param directory Existing directory receiving the files, existing files are overwritten.
+     * @param format Format of the files.
+     * @param build Builds the mesh of a tile. Invoked concurrently.
+     * @param n_threads Maximum number of worker threads, 0 for all hardware threads.
+     * @param max_pending_bytes Size of the write-behind buffer.
+     * @return True on success.
+     */
+    static bool ExportTiles(std::filesystem::path const& directory
+                            , CollisionMeshFormat format
+                            , TileBuildFunc const& build
+                            , std::size_t n_threads = 0
+                            , std::size_t max_pending_bytes = DEFAULT_MAX_PENDING_BYTES);
+
+  private:
+    template<IO::Common::ClientVersion client_version>
+    static TileBuildFunc MakeBuildFunc(TileLoadFunc<client_version> const& load);
+  };
+}
+
+#include <Terrain/CollisionMeshExporter.inl>
@@ -0,0 +1,75 @@
+#pragma once
+#include <Terrain/CollisionMeshExporter.hpp>
+#include <Terrain/Common.hpp>
+#include <Terrain/TileHoles.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline void CollisionMeshExporter::BuildTile(IO::ADT::ADTRoot<client_version> const& root, CollisionMesh& mesh)
+  {
+    auto const& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    mesh.Clear();
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      auto const& chunk = chunks[i];
+
+      if (!chunk.Heightmap().IsInitialized())
+        continue;
+
+      AppendTerrain(chunk.Header(), &*chunk.Heightmap().cbegin(), TileHoles::Decode(chunk.Header()), mesh);
+    }
+
+    auto const& liquids = root.Liquids();
+
+    if (!liquids.IsInitialized())
+      return;
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      auto const& position = chunks[i].Header().position;
+      AppendLiquids(liquids.chunks()[i], {position.x, position.y}, mesh);
+    }
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline bool CollisionMeshExporter::ExportMap(std::filesystem::path const& path
+                                               , CollisionMeshFormat format
+                                               , TileLoadFunc<client_version> const& load
+                                               , std::size_t n_threads
+                                               , std::size_t max_pending_bytes)
+  {
+    return ExportMap(path, format, MakeBuildFunc(load), n_threads, max_pending_bytes);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline bool CollisionMeshExporter::ExportTiles(std::filesystem::path const& directory
+                                                 , CollisionMeshFormat format
+                                                 , TileLoadFunc<client_version> const& load
+                                                 , std::size_t n_threads
+                                                 , std::size_t max_pending_bytes)
+  {
+    return ExportTiles(directory, format, MakeBuildFunc(load), n_threads, max_pending_bytes);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline CollisionMeshExporter::TileBuildFunc CollisionMeshExporter::MakeBuildFunc(TileLoadFunc<client_version> const& load)
+  {
+    return [&load](std::size_t tile_x, std::size_t tile_y, CollisionMesh& mesh) -> bool
+    {
+      std::optional<IO::ADT::ADTRoot<client_version>> root = load(tile_x, tile_y);
+
+      if (!root)
+        return false;
+
+      BuildTile(*root, mesh);
+      return true;
+    };
+  }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <IO/ByteBuffer.hpp>
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace Terrain
+{
+  /**
+   * Box containing nothing. Its min is above its max, so extending it by a point or a box yields that point or box.
+   */
+  inline constexpr IO::Common::DataStructures::CAaBox EMPTY_BOX
+  {
+    { std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()
+      , std::numeric_limits<float>::infinity() },
+    { -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()
+      , -std::numeric_limits<float>::infinity() }
+  };
+
+  /**
+   * @return True if the box contains nothing, e.g. EMPTY_BOX.
+   */
+  [[nodiscard]]
+  FORCEINLINE bool IsEmpty(IO::Common::DataStructures::CAaBox const& box)
+  {
+    return box.min.x > box.max.x || box.min.y > box.max.y || box.min.z > box.max.z;
+  }
+
+  /**
+   * Grows a box to contain a point.
+   */
+  FORCEINLINE void Extend(IO::Common::DataStructures::CAaBox& box, IO::Common::DataStructures::C3Vector const& point)
+  {
+    box.min = {std::min(box.min.x, point.x), std::min(box.min.y, point.y), std::min(box.min.z, point.z)};
+    box.max = {std::max(box.max.x, point.x), std::max(box.max.y, point.y), std::max(box.max.z, point.z)};
+  }
+
+  /**
+   * Grows a box to contain another box. Extending by an empty box leaves the box unchanged.
+   */
+  FORCEINLINE void Extend(IO::Common::DataStructures::CAaBox& box, IO::Common::DataStructures::CAaBox const& other)
+  {
+    box.min = {std::min(box.min.x, other.min.x), std::min(box.min.y, other.min.y), std::min(box.min.z, other.min.z)};
+    box.max = {std::max(box.max.x, other.max.x), std::max(box.max.y, other.max.y), std::max(box.max.z, other.max.z)};
+  }
+
+  /**
+   * Precondition of tile-wide operations on ADT files: the file holds a chunk (MCNK) for every cell of the tile.
+   * @tparam Chunks Chunk array of an ADT file, e.g. ADTRoot::Chunks().
+   * @param chunks Chunks of the file.
+   */
+  template<typename Chunks>
+  FORCEINLINE void RequireTileChunks([[maybe_unused]] Chunks const& chunks)
+  {
+    RequireF(CCodeZones::TERRAIN, chunks.IsInitialized()
+             && chunks.Size() == IO::Common::WorldConstants::CHUNKS_PER_TILE
+             , "Expected ADT with 256 chunks, got %d.", chunks.Size());
+  }
+
+  /**
+   * Walks the chunks of a range of a raw buffer (top-level chunks of a file, or subchunks of a chunk). Chunk data is
+   * skipped by size and never read.
+   * @tparam F Callable of signature void(IO::Common::ChunkHeader const& chunk_header, std::size_t data_pos).
+   * @param buf Raw buffer, its position is left unchanged.
+   * @param begin Position of the first chunk header.
+   * @param end End of the range, at most buf.Size().
+   * @param visit Invoked for every chunk that fits into the range.
+   * @return False if a chunk crosses the end of the range, the walk stops there.
+   */
+  template<typename F>
+  bool ScanChunks(IO::Common::ByteBuffer const& buf, std::size_t begin, std::size_t end, F&& visit)
+  {
+    for (std::size_t pos = begin; pos + sizeof(IO::Common::ChunkHeader) <= end;)
+    {
+      IO::Common::ChunkHeader chunk_header {};
+      buf.Read(chunk_header, pos);
+      pos += sizeof(IO::Common::ChunkHeader);
+
+      if (chunk_header.size > end - pos)
+        return false;
+
+      visit(chunk_header, pos);
+      pos += chunk_header.size;
+    }
+
+    return true;
+  }
+}
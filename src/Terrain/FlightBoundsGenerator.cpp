@@ -0,0 +1,111 @@
+#include <Terrain/FlightBoundsGenerator.hpp>
+#include <Utils/Misc/SIMD.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+using namespace Terrain;
+using namespace Utils::Misc::SIMD;
+
+namespace
+{
+  // the tile is split in 2x2 quarters, each point of the planes touches up to 4 of them
+  constexpr std::size_t QUARTER_DIM = TileHeightfield::INNER_DIM / 2;
+  constexpr std::size_t CHUNKS_PER_QUARTER = TileHeightfield::CHUNKS_PER_ROW / 2;
+
+  struct HeightRange
+  {
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+  };
+
+  // extremes of a rectangle of a row-major grid
+  HeightRange Reduce(float const* grid, std::size_t dim, std::size_t x_min, std::size_t y_min, std::size_t n)
+  {
+    HeightRange range {};
+
+    for (std::size_t y = y_min; y < y_min + n; ++y)
+    {
+      MinMax(grid + y * dim + x_min, n, range.min, range.max);
+    }
+
+    return range;
+  }
+
+  std::int16_t ToPlaneHeight(float height)
+  {
+    constexpr auto lowest = static_cast<float>(std::numeric_limits<std::int16_t>::lowest());
+    constexpr auto highest = static_cast<float>(std::numeric_limits<std::int16_t>::max());
+
+    return static_cast<std::int16_t>(std::clamp(height, lowest, highest));
+  }
+}
+
+FlightBoundsGenerator::FlightBoundsGenerator(FlightBoundsSettings const& settings)
+: _settings(settings)
+{
+}
+
+IO::ADT::DataStructures::MFBO FlightBoundsGenerator::Generate(TileHeightfield const& heightfield
+                                                              , IO::ADT::MH2O const& liquids) const
+{
+  std::array<std::array<HeightRange, 2>, 2> quarters {};
+
+  for (std::size_t qy = 0; qy < 2; ++qy)
+  {
+    for (std::size_t qx = 0; qx < 2; ++qx)
+    {
+      HeightRange& range = quarters[qy][qx];
+
+      // outer vertices on the border between quarters belong to both
+      HeightRange const outer = Reduce(heightfield.OuterGrid().data(), TileHeightfield::OUTER_DIM
+                                       , qx * QUARTER_DIM, qy * QUARTER_DIM, QUARTER_DIM + 1);
+      HeightRange const inner = Reduce(heightfield.InnerGrid().data(), TileHeightfield::INNER_DIM
+                                       , qx * QUARTER_DIM, qy * QUARTER_DIM, QUARTER_DIM);
+
+      range.min = std::min(outer.min, inner.min);
+      range.max = std::max(outer.max, inner.max);
+
+      if (!_settings.include_liquids || !liquids.IsInitialized())
+        continue;
+
+      for (std::size_t cy = qy * CHUNKS_PER_QUARTER; cy < (qy + 1) * CHUNKS_PER_QUARTER; ++cy)
+      {
+        for (std::size_t cx = qx * CHUNKS_PER_QUARTER; cx < (qx + 1) * CHUNKS_PER_QUARTER; ++cx)
+        {
+          for (IO::ADT::LiquidLayer const& layer : liquids.chunks()[cy * TileHeightfield::CHUNKS_PER_ROW + cx].Layers())
+          {
+            range.max = std::max(range.max, layer.max_height_level);
+          }
+        }
+      }
+    }
+  }
+
+  IO::ADT::DataStructures::MFBO bounds {};
+
+  for (std::size_t row = 0; row < 3; ++row)
+  {
+    for (std::size_t column = 0; column < 3; ++column)
+    {
+      HeightRange range {};
+
+      // quarters touching the point
+      for (std::size_t qy = row ? row - 1 : 0; qy < std::min<std::size_t>(row + 1, 2); ++qy)
+      {
+        for (std::size_t qx = column ? column - 1 : 0; qx < std::min<std::size_t>(column + 1, 2); ++qx)
+        {
+          range.min = std::min(range.min, quarters[qy][qx].min);
+          range.max = std::max(range.max, quarters[qy][qx].max);
+        }
+      }
+
+      bounds.maximum.height[row][column] = ToPlaneHeight(std::ceil(range.max + _settings.ceiling_margin));
+      bounds.minimum.height[row][column] = ToPlaneHeight(std::floor(range.min - _settings.floor_margin));
+    }
+  }
+
+  return bounds;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+#include <IO/Common.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+namespace Terrain
+{
+  struct FlightBoundsSettings
+  {
+    float ceiling_margin = 400.f;     ///> Height of the maximum plane above the highest terrain or liquid, in yards.
+    float floor_margin = 100.f;       ///> Depth of the minimum plane below the lowest terrain, in yards.
+    bool include_liquids = true;      ///> Raise the maximum plane above liquid surfaces as well.
+  };
+
+  /**
+   * Derives flight bounds (MFBO) of a tile from its terrain.
+   * Both planes are 3x3 grids of points at the corners, edge midpoints and center of the tile, height[row][column]
+   * with rows along grid y (world -X) and columns along grid x (world -Y). Each point takes the extreme height of the
+   * quarters of the tile it touches, so the planes interpolated between points bound every vertex of the tile.
+   * Extremes of quarters are computed with a SIMD min / max reduction over rows of both vertex grids.
+   */
+  class FlightBoundsGenerator
+  {
+  public:
+    template<IO::Common::ClientVersion client_version>
+    using TileLoadFunc = std::function<std::optional<IO::ADT::ADTRoot<client_version>>(std::size_t tile_x
+                                                                                        , std::size_t tile_y)>;
+
+    template<IO::Common::ClientVersion client_version>
+    using TileStoreFunc = std::function<void(std::size_t tile_x
+                                             , std::size_t tile_y
+                                             , IO::ADT::ADTRoot<client_version> const& root)>;
+
+    explicit FlightBoundsGenerator(FlightBoundsSettings const& settings = {});
+
+    /**
+     * Computes flight bounds of a tile.
+     * @param heightfield Heightfield of the tile.
+     * @param liquids Liquids of the tile, only used if settings.include_liquids is set.
+     * @return Flight bounds.
+     */
+    [[nodiscard]]
+    IO::ADT::DataStructures::MFBO Generate(TileHeightfield const& heightfield, IO::ADT::MH2O const& liquids) const;
+
+    /**
+     * Regenerates flight bounds of a tile, meant to be called on save for tiles whose heights changed.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file, its MFBO chunk is initialized if it was not.
+     * @param heightfield Heightfield of the tile, if already at hand. Loaded from root otherwise.
+     * @return True if flight bounds changed.
+     */
+    template<IO::Common::ClientVersion client_version>
+    bool Update(IO::ADT::ADTRoot<client_version>& root, TileHeightfield const* heightfield = nullptr) const;
+
+    /**
+     * Writes an ADT root file, regenerating its flight bounds first if it has an MFBO chunk and any of its chunks
+     * changed. Meant to be used as the save path of edited tiles. Tiles without MFBO, and unchanged tiles, are written
+     * with their flight bounds as they are, so hand-authored bounds survive saves that do not touch terrain.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param buf Buffer to write into.
+     * @param dirty_chunks Chunks whose heights or liquids changed since the tile was loaded, e.g. accumulated
+     * BrushDirtyRegion::chunks.
+     * @param heightfield Heightfield of the tile, if already at hand. Loaded from root otherwise.
+     * @return True if flight bounds changed.
+     */
+    template<IO::Common::ClientVersion client_version>
+    bool Write(IO::ADT::ADTRoot<client_version>& root
+               , IO::Common::ByteBuffer& buf
+               , std::bitset<IO::Common::WorldConstants::CHUNKS_PER_TILE> const& dirty_chunks
+               , TileHeightfield const* heightfield = nullptr) const;
+
+    /**
+     * Regenerates flight bounds of all tiles of a map in parallel, each thread holding a single tile at a time.
+     * Callbacks are invoked concurrently from worker threads.
+     * @tparam client_version Version of the game client.
+     * @param load Loads a tile, returns nothing if the tile does not exist.
+     * @param store Receives each tile whose flight bounds changed, typically writes it back.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return Number of tiles whose flight bounds changed.
+     */
+    template<IO::Common::ClientVersion client_version>
+    std::size_t UpdateMap(TileLoadFunc<client_version> const& load
+                          , TileStoreFunc<client_version> const& store
+                          , std::size_t n_threads = 0) const;
+
+  // accessors
+  public:
+    [[nodiscard]]
+    FlightBoundsSettings const& Settings() const { return _settings; };
+
+    [[nodiscard]]
+    FlightBoundsSettings& Settings() { return _settings; };
+
+  private:
+    FlightBoundsSettings _settings;
+  };
+}
+
+#include <Terrain/FlightBoundsGenerator.inl>
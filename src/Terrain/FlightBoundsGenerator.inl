@@ -0,0 +1,59 @@
+#pragma once
+#include <Terrain/FlightBoundsGenerator.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <IO/WorldConstants.hpp>
+
+#include <atomic>
+#include <cstring>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline bool FlightBoundsGenerator::Update(IO::ADT::ADTRoot<client_version>& root
+                                            , TileHeightfield const* heightfield) const
+  {
+    IO::ADT::DataStructures::MFBO const bounds = heightfield ? Generate(*heightfield, root.Liquids())
+                                                             : Generate(TileHeightfield{root}, root.Liquids());
+
+    auto& flight_bounds = root.FlightBounds();
+
+    if (flight_bounds.IsInitialized() && !std::memcmp(&flight_bounds.data, &bounds, sizeof(bounds)))
+      return false;
+
+    flight_bounds.Initialize(bounds);
+    return true;
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline bool FlightBoundsGenerator::Write(IO::ADT::ADTRoot<client_version>& root
+                                           , IO::Common::ByteBuffer& buf
+                                           , std::bitset<IO::Common::WorldConstants::CHUNKS_PER_TILE> const& dirty_chunks
+                                           , TileHeightfield const* heightfield) const
+  {
+    bool const changed = dirty_chunks.any() && root.FlightBounds().IsInitialized() && Update(root, heightfield);
+    root.Write(buf);
+    return changed;
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline std::size_t FlightBoundsGenerator::UpdateMap(TileLoadFunc<client_version> const& load
+                                                      , TileStoreFunc<client_version> const& store
+                                                      , std::size_t n_threads) const
+  {
+    using IO::Common::WorldConstants::MAP_DIM;
+    std::atomic<std::size_t> n_updated = 0;
+
+    Utils::Misc::ParallelFor(0, IO::Common::WorldConstants::MAX_TILES_PER_MAP, [&](std::size_t tile) -> void
+    {
+      std::optional<IO::ADT::ADTRoot<client_version>> root = load(tile % MAP_DIM, tile / MAP_DIM);
+
+      if (!root || !Update(*root))
+        return;
+
+      store(tile % MAP_DIM, tile / MAP_DIM, *root);
+      n_updated.fetch_add(1, std::memory_order_relaxed);
+    }, 1, n_threads);
+
+    return n_updated.load();
+  }
+}
@@ -0,0 +1,266 @@
+#include <Terrain/HeightBrush.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+using namespace Terrain;
+using namespace Utils::Misc::SIMD;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr float VERTEX_SPACING = IO::Common::WorldConstants::CHUNK_SIZE / TileHeightfield::CHUNK_INNER_DIM;
+
+  // snapshot of a tile taken before editing, only used for smoothing
+  struct PaddedTile
+  {
+    std::vector<float> outer;
+    std::vector<float> inner;
+  };
+
+  FORCEINLINE float Hash(std::int32_t x, std::int32_t y, std::uint32_t seed)
+  {
+    std::uint32_t h = static_cast<std::uint32_t>(x) * 374761393u
+      + static_cast<std::uint32_t>(y) * 668265263u
+      + seed * 2246822519u;
+
+    h = (h ^ (h >> 13)) * 1274126177u;
+    h ^= h >> 16;
+
+    return static_cast<float>(h & 0xFFFFFF) / static_cast<float>(0xFFFFFF) * 2.f - 1.f;
+  }
+
+  // smooth value noise in [-1, 1]
+  float ValueNoise(float x, float y, float scale, std::uint32_t seed)
+  {
+    float const fx = x / scale;
+    float const fy = y / scale;
+    float const x0 = std::floor(fx);
+    float const y0 = std::floor(fy);
+
+    auto const smooth = [](float t) { return t * t * (3.f - 2.f * t); };
+    float const tx = smooth(fx - x0);
+    float const ty = smooth(fy - y0);
+
+    auto const ix = static_cast<std::int32_t>(x0);
+    auto const iy = static_cast<std::int32_t>(y0);
+
+    float const top = Hash(ix, iy, seed) + (Hash(ix + 1, iy, seed) - Hash(ix, iy, seed)) * tx;
+    float const bottom = Hash(ix, iy + 1, seed) + (Hash(ix + 1, iy + 1, seed) - Hash(ix, iy + 1, seed)) * tx;
+
+    return top + (bottom - top) * ty;
+  }
+
+  // average of the 8 nearest vertices of an outer vertex: 4 outer along the axes, 4 inner diagonals
+  template<typename V>
+  FORCEINLINE V OuterAverage(float const* o_n, float const* o_c, float const* o_s
+                             , float const* i_n, float const* i_s, std::size_t i)
+  {
+    V const sum = (Load<V>(o_c + i - 1) + Load<V>(o_c + i + 1)) + (Load<V>(o_n + i) + Load<V>(o_s + i))
+      + (Load<V>(i_n + i - 1) + Load<V>(i_n + i)) + (Load<V>(i_s + i - 1) + Load<V>(i_s + i));
+
+    return sum * Broadcast<V>(0.125f);
+  }
+
+  // average of the 8 nearest vertices of an inner vertex: 4 outer diagonals, 4 inner along the axes
+  template<typename V>
+  FORCEINLINE V InnerAverage(float const* o_n, float const* o_s
+                             , float const* i_n, float const* i_c, float const* i_s, std::size_t i)
+  {
+    V const sum = (Load<V>(o_n + i) + Load<V>(o_n + i + 1)) + (Load<V>(o_s + i) + Load<V>(o_s + i + 1))
+      + (Load<V>(i_c + i - 1) + Load<V>(i_c + i + 1)) + (Load<V>(i_n + i) + Load<V>(i_s + i));
+
+    return sum * Broadcast<V>(0.125f);
+  }
+
+  void MarkDirty(BrushDirtyRegion& dirty, bool outer, std::size_t y, std::size_t x_min, std::size_t x_max)
+  {
+    constexpr std::size_t chunk_dim = TileHeightfield::CHUNK_INNER_DIM;
+    constexpr std::size_t last_chunk = TileHeightfield::CHUNKS_PER_ROW - 1;
+
+    if (!dirty.touched)
+    {
+      dirty.touched = true;
+      dirty.vertices = {x_min, y, x_max, y};
+    }
+    else
+    {
+      dirty.vertices.x_min = std::min(dirty.vertices.x_min, x_min);
+      dirty.vertices.y_min = std::min(dirty.vertices.y_min, y);
+      dirty.vertices.x_max = std::max(dirty.vertices.x_max, x_max);
+      dirty.vertices.y_max = std::max(dirty.vertices.y_max, y);
+    }
+
+    // outer vertices on chunk borders belong to both chunks
+    std::size_t const chunk_x_min = outer && x_min ? (x_min - 1) / chunk_dim : x_min / chunk_dim;
+    std::size_t const chunk_y_min = outer && y ? (y - 1) / chunk_dim : y / chunk_dim;
+    std::size_t const chunk_x_max = std::min(x_max / chunk_dim, last_chunk);
+    std::size_t const chunk_y_max = std::min(y / chunk_dim, last_chunk);
+
+    for (std::size_t cy = chunk_y_min; cy <= chunk_y_max; ++cy)
+    {
+      for (std::size_t cx = chunk_x_min; cx <= chunk_x_max; ++cx)
+      {
+        dirty.chunks.set(cy * TileHeightfield::CHUNKS_PER_ROW + cx);
+      }
+    }
+  }
+
+  void ApplyToTile(BrushSettings const& settings
+                   , BrushTile const& tile
+                   , C2Vector center
+                   , PaddedTile const* snapshot
+                   , BrushDirtyRegion& dirty)
+  {
+    RequireF(CCodeZones::TERRAIN, tile.heightfield, "Brush tile has no heightfield.");
+
+    TileHeightfield& heightfield = *tile.heightfield;
+
+    // grid space: x along grid columns (world -Y), y along grid rows (world -X), one unit per vertex
+    float const center_x = (tile.origin.y - center.y) / VERTEX_SPACING;
+    float const center_y = (tile.origin.x - center.x) / VERTEX_SPACING;
+    float const radius = settings.radius / VERTEX_SPACING;
+
+    bool const additive = settings.mode == BrushMode::Raise
+      || settings.mode == BrushMode::Lower
+      || settings.mode == BrushMode::Noise;
+
+    std::array<float, TileHeightfield::OUTER_DIM> aux {};
+
+    if (settings.mode == BrushMode::Raise || settings.mode == BrushMode::Lower || settings.mode == BrushMode::Flatten)
+    {
+      float const value = settings.mode == BrushMode::Raise ? 1.f
+        : (settings.mode == BrushMode::Lower ? -1.f : settings.target_height);
+
+      aux.fill(value);
+    }
+
+    auto const apply_grid = [&](bool outer) -> void
+    {
+      std::size_t const dim = outer ? TileHeightfield::OUTER_DIM : TileHeightfield::INNER_DIM;
+      float const offset = outer ? 0.f : 0.5f;
+      auto const last = static_cast<float>(dim - 1);
+
+      float const y_lo = std::max(std::ceil(center_y - radius - offset), 0.f);
+      float const y_hi = std::min(std::floor(center_y + radius - offset), last);
+
+      for (float fy = y_lo; fy <= y_hi; fy += 1.f)
+      {
+        float const dy = fy + offset - center_y;
+        float const half_width_sq = radius * radius - dy * dy;
+
+        if (half_width_sq <= 0.f)
+          continue;
+
+        float const half_width = std::sqrt(half_width_sq);
+        float const x_lo = std::max(std::ceil(center_x - half_width - offset), 0.f);
+        float const x_hi = std::min(std::floor(center_x + half_width - offset), last);
+
+        if (x_lo > x_hi)
+          continue;
+
+        auto const y = static_cast<std::size_t>(fy);
+        auto const x_min = static_cast<std::size_t>(x_lo);
+        auto const x_max = static_cast<std::size_t>(x_hi);
+
+        float* row = outer ? heightfield.OuterRow(y) : heightfield.InnerRow(y);
+
+        if (settings.mode == BrushMode::Noise)
+        {
+          for (std::size_t x = x_min; x <= x_max; ++x)
+          {
+            aux[x] = ValueNoise(tile.origin.x - (fy + offset) * VERTEX_SPACING
+                                , tile.origin.y - (static_cast<float>(x) + offset) * VERTEX_SPACING
+                                , settings.noise_scale, settings.noise_seed);
+          }
+        }
+        else if (settings.mode == BrushMode::Smooth)
+        {
+          // rows of the padded grids, offset so that index x addresses vertex x of the same grid
+          constexpr std::size_t po_dim = TileHeightfield::OUTER_DIM + 2;
+          constexpr std::size_t pi_dim = TileHeightfield::INNER_DIM + 2;
+
+          float const* po = snapshot->outer.data() + (y + 1) * po_dim + 1;
+          float const* pi = snapshot->inner.data() + (y + 1) * pi_dim + 1;
+
+          if (outer)
+          {
+            ForRange(x_min, x_max + 1, [&]<typename V>(V, std::size_t i) -> void
+            {
+              Store(aux.data() + i, OuterAverage<V>(po - po_dim, po, po + po_dim, pi - pi_dim, pi, i));
+            });
+          }
+          else
+          {
+            ForRange(x_min, x_max + 1, [&]<typename V>(V, std::size_t i) -> void
+            {
+              Store(aux.data() + i, InnerAverage<V>(po, po + po_dim, pi - pi_dim, pi, pi + pi_dim, i));
+            });
+          }
+        }
+
+        ForRange(x_min, x_max + 1, [&]<typename V>(V, std::size_t i) -> void
+        {
+          V const weight = BrushWeight<V>(Ramp<V>(static_cast<float>(i) + offset), Broadcast<V>(dy * dy)
+                                     , Broadcast<V>(center_x), Broadcast<V>(1.f / radius), settings.falloff)
+            * Broadcast<V>(settings.strength);
+
+          V const height = Load<V>(row + i);
+          V const value = Load<V>(aux.data() + i);
+
+          if (additive)
+            Store(row + i, height + value * weight);
+          else
+            Store(row + i, height + (value - height) * Min(weight, Broadcast<V>(1.f)));
+        });
+
+        MarkDirty(dirty, outer, y, x_min, x_max);
+      }
+    };
+
+    apply_grid(true);
+    apply_grid(false);
+  }
+}
+
+HeightBrush::HeightBrush(BrushSettings const& settings)
+: _settings(settings)
+{
+  RequireF(CCodeZones::TERRAIN, settings.radius > 0.f, "Brush radius must be positive.");
+}
+
+BrushDirtyRegion HeightBrush::Apply(BrushTile const& tile, C2Vector center) const
+{
+  BrushDirtyRegion dirty {};
+  Apply(std::span<BrushTile const>{&tile, 1}, center, std::span<BrushDirtyRegion>{&dirty, 1});
+  return dirty;
+}
+
+void HeightBrush::Apply(std::span<BrushTile const> tiles, C2Vector center, std::span<BrushDirtyRegion> dirty) const
+{
+  RequireF(CCodeZones::TERRAIN, tiles.size() == dirty.size(), "Number of tiles and dirty regions mismatch.");
+  RequireF(CCodeZones::TERRAIN, _settings.radius > 0.f, "Brush radius must be positive.");
+
+  std::vector<PaddedTile> snapshots {};
+
+  if (_settings.mode == BrushMode::Smooth)
+  {
+    snapshots.resize(tiles.size());
+
+    for (std::size_t i = 0; i < tiles.size(); ++i)
+    {
+      tiles[i].heightfield->Pad(tiles[i].neighbours, snapshots[i].outer, snapshots[i].inner);
+    }
+  }
+
+  for (std::size_t i = 0; i < tiles.size(); ++i)
+  {
+    dirty[i] = {};
+    ApplyToTile(_settings, tiles[i], center, snapshots.empty() ? nullptr : &snapshots[i], dirty[i]);
+  }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+#include <Utils/Misc/SIMD.hpp>
+
+#include <bitset>
+#include <cstdint>
+#include <span>
+
+namespace Terrain
+{
+  enum class BrushMode
+  {
+    Raise = 0,        ///> Adds strength yards at the center.
+    Lower = 1,        ///> Subtracts strength yards at the center.
+    Flatten = 2,      ///> Moves heights toward the target height, strength is the blend factor at the center.
+    Smooth = 3,       ///> Moves heights toward the average of their neighbours, strength is the blend factor.
+    Noise = 4         ///> Adds value noise of amplitude strength yards.
+  };
+
+  enum class BrushFalloff
+  {
+    Linear = 0,
+    Smooth = 1,       ///> Smoothstep.
+    Spherical = 2
+  };
+
+  /**
+   * Weight of vertices at a horizontal distance from the center of a radial brush, 1 at the center down to 0 at the
+   * radius. Coordinates are in grid units.
+   * @tparam V Lane type (float or Utils::Misc::SIMD::Float4).
+   * @param x Horizontal coordinates of the vertices.
+   * @param dy2 Squared vertical distance of the vertices from the center.
+   * @param center_x Horizontal coordinate of the center.
+   * @param inv_radius Inverse of the radius.
+   * @param falloff Falloff curve.
+   * @return Weights of the vertices.
+   */
+  template<typename V>
+  FORCEINLINE V BrushWeight(V x, V dy2, V center_x, V inv_radius, BrushFalloff falloff)
+  {
+    using namespace Utils::Misc::SIMD;
+
+    V const one = Broadcast<V>(1.f);
+    V const dx = x - center_x;
+    V const t = Min(Sqrt(dx * dx + dy2) * inv_radius, one);
+
+    switch (falloff)
+    {
+      case BrushFalloff::Linear:
+        return one - t;
+      case BrushFalloff::Smooth:
+        return one - t * t * (Broadcast<V>(3.f) - Broadcast<V>(2.f) * t);
+      case BrushFalloff::Spherical:
+        return Sqrt(Max(one - t * t, Broadcast<V>(0.f)));
+    }
+
+    return one - t;
+  }
+
+  struct BrushSettings
+  {
+    BrushMode mode = BrushMode::Raise;
+    BrushFalloff falloff = BrushFalloff::Smooth;
+    float radius = 10.f;                          ///> Radius in yards.
+    float strength = 1.f;
+    float target_height = 0.f;                    ///> Flatten only.
+    float noise_scale = 4.f;                      ///> Noise only. Size of a noise cell in yards.
+    std::uint32_t noise_seed = 0;                 ///> Noise only.
+  };
+
+  /**
+   * Tile edited by a brush.
+   */
+  struct BrushTile
+  {
+    TileHeightfield* heightfield;
+    IO::Common::DataStructures::C2Vector origin;  ///> World position of the first outer vertex (MCNK position of the first chunk).
+    TileNeighbours neighbours;                    ///> Only sampled by BrushMode::Smooth.
+  };
+
+  /**
+   * Part of a tile modified by a brush. Normals, bounds and chunks are only to be updated within it.
+   */
+  struct BrushDirtyRegion
+  {
+    bool touched = false;
+    VertexRect vertices;                                                           ///> Valid if touched.
+    std::bitset<IO::Common::WorldConstants::CHUNKS_PER_TILE> chunks;              ///> Chunks with modified vertices.
+  };
+
+  /**
+   * Radial heightmap brush.
+   * Weights of vertices fall off with their horizontal distance from the brush center down to 0 at the radius.
+   * Vertices are processed row by row with SIMD, visiting only the span of each row that lies within the radius.
+   * Weights depend on world positions only, so vertices shared by neighbouring tiles receive the same edit (up to
+   * rounding of the tile origins) when a brush is applied to all of them in one call.
+   */
+  class HeightBrush
+  {
+  public:
+    explicit HeightBrush(BrushSettings const& settings);
+
+    /**
+     * Applies the brush to a single tile.
+     * @param tile Tile to edit.
+     * @param center World position of the brush center.
+     * @return Modified part of the tile.
+     */
+    BrushDirtyRegion Apply(BrushTile const& tile, IO::Common::DataStructures::C2Vector center) const;
+
+    /**
+     * Applies the brush to a set of tiles, usually the tiles around the brush center.
+     * Tiles are sampled before any of them is modified, hence neighbours of the tiles may be tiles of the set.
+     * @param tiles Tiles to edit.
+     * @param center World position of the brush center.
+     * @param dirty Modified part of each tile, must be the same size as tiles.
+     */
+    void Apply(std::span<BrushTile const> tiles
+               , IO::Common::DataStructures::C2Vector center
+               , std::span<BrushDirtyRegion> dirty) const;
+
+    [[nodiscard]]
+    BrushSettings const& Settings() const { return _settings; };
+
+    [[nodiscard]]
+    BrushSettings& Settings() { return _settings; };
+
+  private:
+    BrushSettings _settings;
+  };
+}
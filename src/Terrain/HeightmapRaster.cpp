@@ -0,0 +1,396 @@
+#include <Terrain/HeightmapRaster.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Contracts.hpp>
+#include <Validation/Log.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+using namespace Terrain;
+using namespace Utils::Misc::SIMD;
+using IO::Common::WorldConstants::MAP_DIM;
+
+namespace fs = std::filesystem;
+namespace bip = boost::interprocess;
+
+namespace
+{
+  constexpr std::size_t LAST = TileHeightfield::OUTER_DIM - 1;
+  constexpr std::size_t N_TAPS = 4;
+  constexpr float UINT16_MAX_F = std::numeric_limits<std::uint16_t>::max();
+
+  // samples of the source contributing to an output vertex, along one axis
+  struct Taps
+  {
+    std::ptrdiff_t first;
+    std::array<float, N_TAPS> weights;
+  };
+
+  Taps MakeTaps(float coordinate, RasterFilter filter)
+  {
+    float const floor = std::floor(coordinate);
+    float const t = coordinate - floor;
+    auto const i = static_cast<std::ptrdiff_t>(floor);
+
+    if (filter == RasterFilter::Bilinear)
+      return { i, { 1.f - t, t, 0.f, 0.f } };
+
+    float const t2 = t * t;
+    float const t3 = t2 * t;
+
+    return { i - 1, { -0.5f * t3 + t2 - 0.5f * t
+                      , 1.5f * t3 - 2.5f * t2 + 1.f
+                      , -1.5f * t3 + 2.f * t2 + 0.5f * t
+                      , 0.5f * t3 - 0.5f * t2 } };
+  }
+
+  FORCEINLINE float ToHeight(float sample, RasterLayout const&) { return sample; }
+
+  FORCEINLINE float ToHeight(std::uint16_t sample, RasterLayout const& layout)
+  {
+    return layout.height_min + static_cast<float>(sample) / UINT16_MAX_F * (layout.height_max - layout.height_min);
+  }
+
+  // copies a block of the raster into a float grid, clamping coordinates at the border of the raster
+  template<typename T>
+  void ExtractBlock(T const* samples
+                    , RasterLayout const& layout
+                    , std::ptrdiff_t col_begin
+                    , std::ptrdiff_t row_begin
+                    , std::size_t block_width
+                    , std::size_t block_height
+                    , std::vector<float>& block)
+  {
+    auto const max_col = static_cast<std::ptrdiff_t>(layout.Width() - 1);
+    auto const max_row = static_cast<std::ptrdiff_t>(layout.Height() - 1);
+
+    block.resize(block_width * block_height);
+
+    for (std::size_t y = 0; y < block_height; ++y)
+    {
+      std::ptrdiff_t const row = std::clamp(row_begin + static_cast<std::ptrdiff_t>(y), std::ptrdiff_t{0}, max_row);
+      T const* src = samples + row * static_cast<std::ptrdiff_t>(layout.Width());
+      float* dst = block.data() + y * block_width;
+
+      for (std::size_t x = 0; x < block_width; ++x)
+      {
+        std::ptrdiff_t const col = std::clamp(col_begin + static_cast<std::ptrdiff_t>(x), std::ptrdiff_t{0}, max_col);
+        dst[x] = ToHeight(src[col], layout);
+      }
+    }
+  }
+
+  /*
+   * Separable filtering of a grid of vertices: source rows are first combined vertically into a single row (SIMD,
+   * along contiguous samples of the block), which is then filtered horizontally for each vertex of the output row.
+   */
+  void FilterGrid(std::vector<float> const& block
+                  , std::size_t block_width
+                  , std::ptrdiff_t col_begin
+                  , std::ptrdiff_t row_begin
+                  , std::span<Taps const> col_taps
+                  , std::span<Taps const> row_taps
+                  , std::size_t n_taps
+                  , std::vector<float>& row
+                  , float* dst)
+  {
+    row.resize(block_width);
+
+    for (std::size_t y = 0; y < row_taps.size(); ++y)
+    {
+      Taps const& taps = row_taps[y];
+      float const* src = block.data() + (taps.first - row_begin) * static_cast<std::ptrdiff_t>(block_width);
+
+      if (n_taps == 2)
+      {
+        float const* r0 = src;
+        float const* r1 = src + block_width;
+
+        ForRange(0, block_width, [&]<typename V>(V, std::size_t i) -> void
+        {
+          Store(row.data() + i, Load<V>(r0 + i) * Broadcast<V>(taps.weights[0])
+                                + Load<V>(r1 + i) * Broadcast<V>(taps.weights[1]));
+        });
+      }
+      else
+      {
+        float const* r0 = src;
+        float const* r1 = r0 + block_width;
+        float const* r2 = r1 + block_width;
+        float const* r3 = r2 + block_width;
+
+        ForRange(0, block_width, [&]<typename V>(V, std::size_t i) -> void
+        {
+          Store(row.data() + i, Load<V>(r0 + i) * Broadcast<V>(taps.weights[0])
+                                + Load<V>(r1 + i) * Broadcast<V>(taps.weights[1])
+                                + Load<V>(r2 + i) * Broadcast<V>(taps.weights[2])
+                                + Load<V>(r3 + i) * Broadcast<V>(taps.weights[3]));
+        });
+      }
+
+      float* dst_row = dst + y * col_taps.size();
+
+      for (std::size_t x = 0; x < col_taps.size(); ++x)
+      {
+        float const* taps_src = row.data() + (col_taps[x].first - col_begin);
+        float value = 0.f;
+
+        for (std::size_t k = 0; k < n_taps; ++k)
+        {
+          value += taps_src[k] * col_taps[x].weights[k];
+        }
+
+        dst_row[x] = value;
+      }
+    }
+  }
+
+  void WriteSamples(float const* heights, std::size_t count, RasterLayout const& layout, std::byte* dst)
+  {
+    if (layout.format == RasterFormat::Float32)
+    {
+      std::memcpy(dst, heights, count * sizeof(float));
+      return;
+    }
+
+    float const scale = UINT16_MAX_F / (layout.height_max - layout.height_min);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      float const value = std::clamp((heights[i] - layout.height_min) * scale, 0.f, UINT16_MAX_F);
+      auto const sample = static_cast<std::uint16_t>(std::lround(value));
+      std::memcpy(dst + i * sizeof(std::uint16_t), &sample, sizeof(std::uint16_t));
+    }
+  }
+}
+
+bool HeightmapRaster::Export(fs::path const& path
+                             , RasterLayout const& layout
+                             , TileExistsFunc const& exists
+                             , TileLoadFunc const& load
+                             , std::size_t n_threads)
+{
+  RequireF(CCodeZones::TERRAIN, !layout.samples_x && !layout.samples_y, "Rasters are exported at the native resolution.");
+  RequireF(CCodeZones::TERRAIN, layout.n_tiles_x && layout.n_tiles_y && layout.tile_x + layout.n_tiles_x <= MAP_DIM
+           && layout.tile_y + layout.n_tiles_y <= MAP_DIM, "Invalid raster layout.");
+  RequireF(CCodeZones::TERRAIN, layout.format != RasterFormat::UInt16 || layout.height_max > layout.height_min
+           , "Invalid height range.");
+
+  std::size_t const n_tiles = layout.n_tiles_x * layout.n_tiles_y;
+  std::vector<std::uint8_t> present (n_tiles);
+
+  for (std::size_t i = 0; i < n_tiles; ++i)
+  {
+    present[i] = exists(layout.tile_x + i % layout.n_tiles_x, layout.tile_y + i / layout.n_tiles_x);
+  }
+
+  // local tile coordinates, tiles outside of the raster do not exist
+  auto const is_present = [&](std::ptrdiff_t x, std::ptrdiff_t y) -> bool
+  {
+    return x >= 0 && y >= 0 && x < static_cast<std::ptrdiff_t>(layout.n_tiles_x)
+      && y < static_cast<std::ptrdiff_t>(layout.n_tiles_y) && present[y * layout.n_tiles_x + x];
+  };
+
+  {
+    std::ofstream strm {path, std::ofstream::binary | std::ofstream::out | std::ofstream::trunc};
+
+    if (!strm.is_open())
+    {
+      LogError("Creating raster \"%s\" failed. Unknown OS error.", path.string().c_str());
+      return false;
+    }
+  }
+
+  // samples of missing tiles are never written, resizing fills them with zeros
+  std::error_code error;
+  fs::resize_file(path, layout.FileSize(), error);
+
+  if (error)
+  {
+    LogError("Resizing raster \"%s\" failed. OS error code: %d. msg: %s.", path.string().c_str(), error.value()
+             , error.message().c_str());
+    return false;
+  }
+
+  try
+  {
+    bip::file_mapping const mapping {path.string().c_str(), bip::read_write};
+    bip::mapped_region region {mapping, bip::read_write};
+
+    auto* const samples = static_cast<std::byte*>(region.get_address());
+    std::size_t const row_size = layout.Width() * layout.SampleSize();
+
+    Utils::Misc::ParallelFor(0, n_tiles, [&](std::size_t i) -> void
+    {
+      if (!present[i])
+        return;
+
+      std::size_t const local_x = i % layout.n_tiles_x;
+      std::size_t const local_y = i / layout.n_tiles_x;
+
+      TileHeightfield heightfield {};
+      load(layout.tile_x + local_x, layout.tile_y + local_y, heightfield);
+
+      auto const x = static_cast<std::ptrdiff_t>(local_x);
+      auto const y = static_cast<std::ptrdiff_t>(local_y);
+
+      // shared samples belong to the south-most, then east-most existing tile
+      bool const east = is_present(x + 1, y);
+      bool const south = is_present(x, y + 1);
+      bool const south_west = is_present(x - 1, y + 1);
+      bool const south_east = is_present(x + 1, y + 1);
+
+      std::byte* const tile_samples = samples + local_y * LAST * row_size
+        + local_x * LAST * layout.SampleSize();
+
+      for (std::size_t row = 0; row < LAST; ++row)
+      {
+        WriteSamples(heightfield.OuterRow(row), east ? LAST : LAST + 1, layout, tile_samples + row * row_size);
+      }
+
+      if (!south)
+      {
+        std::size_t const first = south_west ? 1 : 0;
+        std::size_t const last = east || south_east ? LAST : LAST + 1;
+
+        WriteSamples(heightfield.OuterRow(LAST) + first, last - first, layout
+                     , tile_samples + LAST * row_size + first * layout.SampleSize());
+      }
+    }, 1, n_threads);
+
+    region.flush();
+  }
+  catch (bip::interprocess_exception const& e)
+  {
+    LogError("Mapping raster \"%s\" failed. msg: %s.", path.string().c_str(), e.what());
+    return false;
+  }
+
+  return true;
+}
+
+bool HeightmapRaster::Import(fs::path const& path
+                             , RasterLayout const& layout
+                             , RasterFilter filter
+                             , TileStoreFunc const& store
+                             , std::size_t n_threads)
+{
+  RequireF(CCodeZones::TERRAIN, layout.n_tiles_x && layout.n_tiles_y && layout.tile_x + layout.n_tiles_x <= MAP_DIM
+           && layout.tile_y + layout.n_tiles_y <= MAP_DIM, "Invalid raster layout.");
+
+  std::error_code error;
+  std::uintmax_t const size = fs::file_size(path, error);
+
+  if (error)
+  {
+    LogError("Reading raster \"%s\" failed. OS error code: %d. msg: %s.", path.string().c_str(), error.value()
+             , error.message().c_str());
+    return false;
+  }
+
+  if (size != layout.FileSize())
+  {
+    LogError("Raster \"%s\" is %ju bytes, expected %ju bytes for %zux%zu samples.", path.string().c_str(), size
+             , layout.FileSize(), layout.Width(), layout.Height());
+    return false;
+  }
+
+  try
+  {
+    bip::file_mapping const mapping {path.string().c_str(), bip::read_only};
+    bip::mapped_region const region {mapping, bip::read_only};
+
+    Utils::Misc::ParallelFor(0, layout.n_tiles_x * layout.n_tiles_y, [&](std::size_t i) -> void
+    {
+      std::size_t const tile_x = layout.tile_x + i % layout.n_tiles_x;
+      std::size_t const tile_y = layout.tile_y + i / layout.n_tiles_x;
+
+      TileHeightfield heightfield {};
+      ResampleTile(region.get_address(), layout, filter, tile_x, tile_y, heightfield);
+      store(tile_x, tile_y, heightfield);
+    }, 1, n_threads);
+  }
+  catch (bip::interprocess_exception const& e)
+  {
+    LogError("Mapping raster \"%s\" failed. msg: %s.", path.string().c_str(), e.what());
+    return false;
+  }
+
+  return true;
+}
+
+void HeightmapRaster::ResampleTile(void const* samples
+                                   , RasterLayout const& layout
+                                   , RasterFilter filter
+                                   , std::size_t tile_x
+                                   , std::size_t tile_y
+                                   , TileHeightfield& heightfield)
+{
+  RequireF(CCodeZones::TERRAIN, layout.Width() > 1 && layout.Height() > 1, "Raster must be at least 2x2 samples.");
+  RequireF(CCodeZones::TERRAIN, tile_x >= layout.tile_x && tile_y >= layout.tile_y
+           && tile_x < layout.tile_x + layout.n_tiles_x && tile_y < layout.tile_y + layout.n_tiles_y
+           , "Tile is not covered by the raster.");
+
+  constexpr std::size_t outer_dim = TileHeightfield::OUTER_DIM;
+  constexpr std::size_t inner_dim = TileHeightfield::INNER_DIM;
+
+  // vertex coordinates relative to the raster, in units of vertices, to sample coordinates
+  float const scale_x = static_cast<float>(layout.Width() - 1) / static_cast<float>(layout.n_tiles_x * inner_dim);
+  float const scale_y = static_cast<float>(layout.Height() - 1) / static_cast<float>(layout.n_tiles_y * inner_dim);
+  auto const base_x = static_cast<float>((tile_x - layout.tile_x) * inner_dim);
+  auto const base_y = static_cast<float>((tile_y - layout.tile_y) * inner_dim);
+
+  std::array<Taps, outer_dim> outer_cols {};
+  std::array<Taps, outer_dim> outer_rows {};
+  std::array<Taps, inner_dim> inner_cols {};
+  std::array<Taps, inner_dim> inner_rows {};
+
+  for (std::size_t i = 0; i < outer_dim; ++i)
+  {
+    auto const offset = static_cast<float>(i);
+    outer_cols[i] = MakeTaps((base_x + offset) * scale_x, filter);
+    outer_rows[i] = MakeTaps((base_y + offset) * scale_y, filter);
+
+    if (i < inner_dim)
+    {
+      inner_cols[i] = MakeTaps((base_x + offset + 0.5f) * scale_x, filter);
+      inner_rows[i] = MakeTaps((base_y + offset + 0.5f) * scale_y, filter);
+    }
+  }
+
+  // outer vertices span the inner ones, so the block covering the former covers both grids
+  std::ptrdiff_t const col_begin = outer_cols.front().first;
+  std::ptrdiff_t const row_begin = outer_rows.front().first;
+  auto const block_width = static_cast<std::size_t>(outer_cols.back().first + N_TAPS - col_begin);
+  auto const block_height = static_cast<std::size_t>(outer_rows.back().first + N_TAPS - row_begin);
+
+  std::vector<float> block {};
+  std::vector<float> row {};
+
+  if (layout.format == RasterFormat::Float32)
+  {
+    ExtractBlock(static_cast<float const*>(samples), layout, col_begin, row_begin, block_width, block_height, block);
+  }
+  else
+  {
+    ExtractBlock(static_cast<std::uint16_t const*>(samples), layout, col_begin, row_begin, block_width, block_height
+                 , block);
+  }
+
+  std::size_t const n_taps = filter == RasterFilter::Bilinear ? 2 : N_TAPS;
+
+  FilterGrid(block, block_width, col_begin, row_begin, outer_cols, outer_rows, n_taps, row
+             , heightfield.OuterGrid().data());
+  FilterGrid(block, block_width, col_begin, row_begin, inner_cols, inner_rows, n_taps, row
+             , heightfield.InnerGrid().data());
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+
+namespace Terrain
+{
+  enum class RasterFormat
+  {
+    Float32 = 0,    ///> Native endian 32-bit floats, absolute heights.
+    UInt16 = 1      ///> Native endian 16-bit unsigned integers, heights mapped linearly from [height_min, height_max].
+  };
+
+  enum class RasterFilter
+  {
+    Bilinear = 0,
+    Bicubic = 1     ///> Catmull-Rom spline.
+  };
+
+  /**
+   * Layout of a map-wide height raster: a headerless row-major grid of samples covering a rectangle of tiles.
+   * Rows run along grid y of tiles (world -X), columns along grid x (world -Y). At the native resolution, sample
+   * (x, y) is the outer vertex x % 128, y % 128 of tile (x / 128, y / 128), and tiles share their border samples.
+   */
+  struct RasterLayout
+  {
+    std::size_t tile_x = 0;                       ///> Horizontal index of the first tile in the map.
+    std::size_t tile_y = 0;                       ///> Vertical index of the first tile in the map.
+    std::size_t n_tiles_x = 64;                   ///> Number of tiles along rows of the raster.
+    std::size_t n_tiles_y = 64;                   ///> Number of tiles along columns of the raster.
+    RasterFormat format = RasterFormat::Float32;
+    float height_min = 0.f;                       ///> UInt16 only, height of sample value 0.
+    float height_max = 1000.f;                    ///> UInt16 only, height of sample value 65535.
+    std::size_t samples_x = 0;                    ///> Import only, samples per row, 0 for the native resolution.
+    std::size_t samples_y = 0;                    ///> Import only, number of rows, 0 for the native resolution.
+
+    /**
+     * @return Number of samples per row.
+     */
+    [[nodiscard]]
+    std::size_t Width() const { return samples_x ? samples_x : n_tiles_x * TileHeightfield::INNER_DIM + 1; };
+
+    /**
+     * @return Number of rows.
+     */
+    [[nodiscard]]
+    std::size_t Height() const { return samples_y ? samples_y : n_tiles_y * TileHeightfield::INNER_DIM + 1; };
+
+    /**
+     * @return Size of a sample in bytes.
+     */
+    [[nodiscard]]
+    std::size_t SampleSize() const { return format == RasterFormat::Float32 ? sizeof(float) : sizeof(std::uint16_t); };
+
+    /**
+     * @return Size of the raster in bytes.
+     */
+    [[nodiscard]]
+    std::uintmax_t FileSize() const { return static_cast<std::uintmax_t>(Width()) * Height() * SampleSize(); };
+  };
+
+  /**
+   * Converts heights of whole maps from and to raw rasters, as used by external terrain tools.
+   * Rasters are memory mapped and tiles are processed in parallel, each thread holding a single tile at a time,
+   * so memory use does not depend on the size of the map. Tile indices passed to callbacks are indices in the map,
+   * callbacks are invoked concurrently from worker threads.
+   */
+  class HeightmapRaster
+  {
+  public:
+    using TileExistsFunc = std::function<bool(std::size_t tile_x, std::size_t tile_y)>;
+    using TileLoadFunc = std::function<void(std::size_t tile_x, std::size_t tile_y, TileHeightfield& heightfield)>;
+    using TileStoreFunc = std::function<void(std::size_t tile_x, std::size_t tile_y, TileHeightfield const& heightfield)>;
+
+    /**
+     * Writes outer vertices of all tiles into a raster at the native resolution. Inner vertices are not exported.
+     * Samples of missing tiles are 0 (height_min for UInt16), heights out of range of UInt16 rasters are clamped.
+     * A border sample shared by several tiles is taken from the south-most, then east-most existing tile.
+     * @param path Path of the raster, overwritten if it exists.
+     * @param layout Layout of the raster, samples_x and samples_y must be 0.
+     * @param exists Returns true if a tile exists, called once per tile before exporting.
+     * @param load Loads heights of an existing tile.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return True on success.
+     */
+    static bool Export(std::filesystem::path const& path
+                       , RasterLayout const& layout
+                       , TileExistsFunc const& exists
+                       , TileLoadFunc const& load
+                       , std::size_t n_threads = 0);
+
+    /**
+     * Resamples a raster onto outer and inner vertices of all tiles it covers. The raster spans from the first outer
+     * vertex of the first tile to the last outer vertex of the last tile, whatever its resolution.
+     * @param path Path of the raster.
+     * @param layout Layout of the raster.
+     * @param filter Filter used for resampling.
+     * @param store Receives heights of each tile of the layout, typically stores them into an ADT and writes it.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return True on success.
+     */
+    static bool Import(std::filesystem::path const& path
+                       , RasterLayout const& layout
+                       , RasterFilter filter
+                       , TileStoreFunc const& store
+                       , std::size_t n_threads = 0);
+
+    /**
+     * Resamples a raster in memory onto the vertices of a tile.
+     * @param samples Samples of the raster, Width() * Height() samples in the layout's format.
+     * @param layout Layout of the raster.
+     * @param filter Filter used for resampling.
+     * @param tile_x Horizontal index of the tile in the map.
+     * @param tile_y Vertical index of the tile in the map.
+     * @param heightfield Receives heights of the tile.
+     */
+    static void ResampleTile(void const* samples
+                             , RasterLayout const& layout
+                             , RasterFilter filter
+                             , std::size_t tile_x
+                             , std::size_t tile_y
+                             , TileHeightfield& heightfield);
+  };
+}
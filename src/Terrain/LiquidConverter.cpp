@@ -0,0 +1,201 @@
+#include <Terrain/LiquidConverter.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+using namespace Terrain;
+using namespace IO::ADT;
+
+namespace
+{
+  constexpr std::size_t CHUNK_DIM = 8;
+  constexpr std::size_t VERTEX_DIM = CHUNK_DIM + 1;
+
+  // tiles with this value in the lower nibble have no liquid
+  constexpr std::uint8_t TILE_NO_LIQUID = 0x0F;
+  constexpr std::uint8_t TILE_FATIGUE = 0x80;
+
+  enum class LiquidKind
+  {
+    Water,        ///> MCLQ_SWVert: depth and height.
+    Ocean,        ///> MCLQ_SOVert: depth only.
+    Magma         ///> MCLQ_SMVert: texture coordinates and height, also used by slime.
+  };
+
+  // LiquidType.dbc IDs of the pre-Cataclysm liquids
+  constexpr std::uint16_t LIQUID_TYPE_WATER = 1;
+  constexpr std::uint16_t LIQUID_TYPE_OCEAN = 2;
+  constexpr std::uint16_t LIQUID_TYPE_MAGMA = 3;
+  constexpr std::uint16_t LIQUID_TYPE_SLIME = 4;
+
+  float Height(DataStructures::MCLQ const& mclq, LiquidKind kind, std::size_t vertex)
+  {
+    switch (kind)
+    {
+      case LiquidKind::Water:
+        return mclq.verts[vertex].waterVert.height;
+      case LiquidKind::Magma:
+        return mclq.verts[vertex].magmaVert.height;
+      default:
+        return mclq.height.min;
+    }
+  }
+
+  std::uint8_t Depth(DataStructures::MCLQ const& mclq, LiquidKind kind, std::size_t vertex)
+  {
+    switch (kind)
+    {
+      case LiquidKind::Water:
+        return static_cast<std::uint8_t>(mclq.verts[vertex].waterVert.depth);
+      case LiquidKind::Ocean:
+        return static_cast<std::uint8_t>(mclq.verts[vertex].oceanVert.depth);
+      default:
+        return 0;
+    }
+  }
+}
+
+bool LiquidConverter::ConvertChunk(DataStructures::MCLQ const& mclq
+                                   , DataStructures::SMChunkFlags flags
+                                   , LiquidChunk& chunk)
+{
+  LiquidKind kind;
+  std::uint16_t liquid_type;
+
+  if (flags.lq_river)
+  {
+    kind = LiquidKind::Water;
+    liquid_type = LIQUID_TYPE_WATER;
+  }
+  else if (flags.lq_ocean)
+  {
+    kind = LiquidKind::Ocean;
+    liquid_type = LIQUID_TYPE_OCEAN;
+  }
+  else if (flags.lq_magma)
+  {
+    kind = LiquidKind::Magma;
+    liquid_type = LIQUID_TYPE_MAGMA;
+  }
+  else if (flags.lq_slime)
+  {
+    kind = LiquidKind::Magma;
+    liquid_type = LIQUID_TYPE_SLIME;
+  }
+  else
+  {
+    return false;
+  }
+
+  std::uint64_t exists = 0;
+  std::uint64_t deep = 0;
+
+  for (std::size_t y = 0; y < CHUNK_DIM; ++y)
+  {
+    for (std::size_t x = 0; x < CHUNK_DIM; ++x)
+    {
+      auto const tile = static_cast<std::uint8_t>(mclq.tiles[y][x]);
+
+      if ((tile & 0x0F) == TILE_NO_LIQUID)
+        continue;
+
+      exists |= std::uint64_t{1} << (y * CHUNK_DIM + x);
+
+      if (tile & TILE_FATIGUE)
+      {
+        deep |= std::uint64_t{1} << (y * CHUNK_DIM + x);
+      }
+    }
+  }
+
+  if (!exists)
+    return false;
+
+  LiquidLayer layer {};
+  layer.liquid_type = liquid_type;
+  layer.SetExistsMap(exists);
+
+  // only vertices of the fitted rectangle are stored, find out which members carry information there
+  float min_height = std::numeric_limits<float>::max();
+  float max_height = std::numeric_limits<float>::lowest();
+  bool has_depths = false;
+  bool has_tex_coords = false;
+
+  for (std::size_t y = layer.y_offset; y <= layer.y_offset + layer.height; ++y)
+  {
+    for (std::size_t x = layer.x_offset; x <= layer.x_offset + layer.width; ++x)
+    {
+      std::size_t const vertex = y * VERTEX_DIM + x;
+      float const height = Height(mclq, kind, vertex);
+
+      min_height = std::min(min_height, height);
+      max_height = std::max(max_height, height);
+      has_depths |= Depth(mclq, kind, vertex) != 0;
+      has_tex_coords |= kind == LiquidKind::Magma
+        && (mclq.verts[vertex].magmaVert.s != 0 || mclq.verts[vertex].magmaVert.t != 0);
+    }
+  }
+
+  bool const has_heights = max_height > min_height;
+
+  layer.min_height_level = min_height;
+  layer.max_height_level = max_height;
+
+  if (kind == LiquidKind::Magma)
+  {
+    layer.liquid_vertex_format = LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD;
+  }
+  else if (has_heights)
+  {
+    layer.liquid_vertex_format = LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH;
+  }
+  else
+  {
+    layer.liquid_vertex_format = LiquidLayer::LiquidVertexFormat::DEPTH;
+  }
+
+  if (has_heights || has_depths || has_tex_coords)
+  {
+    layer.AllocateVertexData();
+
+    auto const heights = layer.Heights();
+    auto const depths = layer.Depths();
+    auto const tex_coords = layer.TexCoords();
+
+    std::size_t i = 0;
+
+    for (std::size_t y = layer.y_offset; y <= layer.y_offset + layer.height; ++y)
+    {
+      for (std::size_t x = layer.x_offset; x <= layer.x_offset + layer.width; ++x, ++i)
+      {
+        std::size_t const vertex = y * VERTEX_DIM + x;
+
+        if (!heights.empty())
+        {
+          heights[i] = Height(mclq, kind, vertex);
+        }
+
+        if (!depths.empty())
+        {
+          depths[i] = Depth(mclq, kind, vertex);
+        }
+
+        if (!tex_coords.empty())
+        {
+          auto const& vert = mclq.verts[vertex].magmaVert;
+          tex_coords[i] = {static_cast<std::uint16_t>(vert.s), static_cast<std::uint16_t>(vert.t)};
+        }
+      }
+    }
+  }
+
+  chunk.Layers().push_back(std::move(layer));
+
+  // attributes are per chunk, shared by all of its layers
+  auto& attributes = chunk.Attributes() ? *chunk.Attributes() : chunk.AddAttributes();
+  attributes.fishable |= exists;
+  attributes.deep |= deep;
+
+  return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <IO/Common.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+namespace Terrain
+{
+  /**
+   * Converts pre-Cataclysm liquids (MCLQ, one per MCNK) into the MH2O layer model.
+   * The liquid kind comes from the MCNK flags: river, ocean, magma and slime become LiquidType.dbc 1, 2, 3 and 4.
+   * Quads whose tile flags are 0xF in the lower nibble do not exist, quads with the fatigue flag (0x80) are deep,
+   * and all existing quads are fishable. Each layer's rectangle is fitted to its existing quads, and its vertex
+   * format is the smallest one holding the members that carry information: flat liquids without depths or texture
+   * coordinates store no vertex data at all. Ocean vertices have no heights, ocean is flat at the minimum of the
+   * MCLQ height range. Flow data has no MH2O counterpart and is dropped.
+   */
+  class LiquidConverter
+  {
+  public:
+    template<IO::Common::ClientVersion client_version>
+    using TileLoadFunc = std::function<std::optional<IO::ADT::ADTRoot<client_version>>(std::size_t tile_x
+                                                                                        , std::size_t tile_y)>;
+
+    template<IO::Common::ClientVersion client_version>
+    using TileStoreFunc = std::function<void(std::size_t tile_x
+                                             , std::size_t tile_y
+                                             , IO::ADT::ADTRoot<client_version> const& root)>;
+
+    /**
+     * Converts the MCLQ of a chunk into layers of an MH2O chunk.
+     * @param mclq Liquid of the chunk.
+     * @param flags Flags of the chunk, selecting the kind of liquid.
+     * @param chunk Receives the converted layer, existing layers are kept.
+     * @return True if the chunk has liquid, false if nothing was added.
+     */
+    static bool ConvertChunk(IO::ADT::DataStructures::MCLQ const& mclq
+                             , IO::ADT::DataStructures::SMChunkFlags flags
+                             , IO::ADT::LiquidChunk& chunk);
+
+    /**
+     * Converts liquids of all chunks of a tile into its MH2O chunk. MCLQ chunks, the liquid flags and offsets of
+     * converted MCNKs are cleared.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file, modified in place.
+     * @return Number of MCNKs converted.
+     */
+    template<IO::Common::ClientVersion client_version>
+    static std::size_t Convert(IO::ADT::ADTRoot<client_version>& root);
+
+    /**
+     * Converts liquids of all tiles of a map in parallel, each thread holding a single tile at a time.
+     * Callbacks are invoked concurrently from worker threads.
+     * @tparam client_version Version of the game client.
+     * @param load Loads a tile, returns nothing if the tile does not exist.
+     * @param store Receives each tile that had MCLQ liquids once converted, typically writes it back.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return Number of tiles converted.
+     */
+    template<IO::Common::ClientVersion client_version>
+    static std::size_t ConvertMap(TileLoadFunc<client_version> const& load
+                                  , TileStoreFunc<client_version> const& store
+                                  , std::size_t n_threads = 0);
+  };
+}
+
+#include <Terrain/LiquidConverter.inl>
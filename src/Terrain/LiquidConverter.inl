@@ -0,0 +1,65 @@
+#pragma once
+#include <Terrain/LiquidConverter.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <IO/WorldConstants.hpp>
+
+#include <atomic>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline std::size_t LiquidConverter::Convert(IO::ADT::ADTRoot<client_version>& root)
+  {
+    auto& chunks = root.Chunks();
+    auto& liquids = root.Liquids();
+    std::size_t n_converted = 0;
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      auto& chunk = chunks[i];
+
+      if (!chunk.TBCWater().IsInitialized())
+        continue;
+
+      ConvertChunk(chunk.TBCWater().data, chunk.Header().flags, liquids.chunks()[i]);
+
+      chunk.TBCWater() = {};
+
+      auto& header = chunk.Header();
+      header.flags.lq_river = header.flags.lq_ocean = header.flags.lq_magma = header.flags.lq_slime = 0;
+      header.ofsLiquid = 0;
+      header.sizeLiquid = 0;
+
+      ++n_converted;
+    }
+
+    if (n_converted)
+    {
+      liquids.Initialize();
+    }
+
+    return n_converted;
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline std::size_t LiquidConverter::ConvertMap(TileLoadFunc<client_version> const& load
+                                                 , TileStoreFunc<client_version> const& store
+                                                 , std::size_t n_threads)
+  {
+    using IO::Common::WorldConstants::MAP_DIM;
+    std::atomic<std::size_t> n_converted = 0;
+
+    Utils::Misc::ParallelFor(0, IO::Common::WorldConstants::MAX_TILES_PER_MAP, [&](std::size_t tile) -> void
+    {
+      std::optional<IO::ADT::ADTRoot<client_version>> root = load(tile % MAP_DIM, tile / MAP_DIM);
+
+      if (!root || !Convert(*root))
+        return;
+
+      store(tile % MAP_DIM, tile / MAP_DIM, *root);
+      n_converted.fetch_add(1, std::memory_order_relaxed);
+    }, 1, n_threads);
+
+    return n_converted.load();
+  }
+}
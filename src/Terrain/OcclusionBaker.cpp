@@ -0,0 +1,238 @@
+#include <Terrain/OcclusionBaker.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace Terrain;
+using namespace Utils::Misc::SIMD;
+
+namespace
+{
+  constexpr float VERTEX_SPACING = IO::Common::WorldConstants::CHUNK_SIZE / TileHeightfield::CHUNK_INNER_DIM;
+  constexpr std::size_t ROWS_PER_TASK = 8;
+
+  struct Direction
+  {
+    std::ptrdiff_t x;
+    std::ptrdiff_t y;
+  };
+
+  // axes first, then diagonals, then knight moves, so that the first n directions are evenly spread for n = 4, 8, 16
+  constexpr std::array<Direction, 16> DIRECTIONS
+  {{
+    {1, 0}, {0, 1}, {-1, 0}, {0, -1}
+    , {1, 1}, {-1, 1}, {-1, -1}, {1, -1}
+    , {2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}, {1, -2}, {2, -1}
+  }};
+
+  // grid of a tile extended by a halo of vertices on each side, vertex (x, y) of the tile is at (y + halo) * dim + x + halo
+  struct HaloGrid
+  {
+    std::vector<float> heights;
+    std::size_t dim;
+    std::size_t halo;
+
+    [[nodiscard]]
+    float const* Row(std::ptrdiff_t y) const
+    {
+      return heights.data() + static_cast<std::size_t>(y + static_cast<std::ptrdiff_t>(halo)) * dim + halo;
+    }
+  };
+
+  // scales the color rows of one grid by visibility, dimensions are compile-time so that the SIMD loops are bounded
+  template<bool outer>
+  void ApplyGrid(std::vector<float> const& occlusion, bool multiply, TileVertexColors& colors)
+  {
+    constexpr std::size_t dim = outer ? TileHeightfield::OUTER_DIM : TileHeightfield::INNER_DIM;
+
+    // replaced colors are neutral MCCV gray scaled by visibility
+    constexpr float neutral = 127.f;
+
+    for (std::size_t y = 0; y < dim; ++y)
+    {
+      float const* const visibility = occlusion.data() + y * dim;
+
+      // alpha is kept
+      for (std::size_t c = 0; c < TileVertexColors::N_CHANNELS - 1; ++c)
+      {
+        float* const row = outer ? colors.OuterRow(c, y) : colors.InnerRow(c, y);
+
+        ForRange(0, dim, [&]<typename V>(V, std::size_t i) -> void
+        {
+          V const factor = Load<V>(visibility + i);
+          Store(row + i, (multiply ? Load<V>(row + i) : Broadcast<V>(neutral)) * factor);
+        });
+      }
+    }
+  }
+
+  void BuildHalo(TileHeightfield const& heightfield
+                 , TileNeighbours const& neighbours
+                 , bool outer
+                 , std::size_t halo
+                 , HaloGrid& grid)
+  {
+    std::size_t const tile_dim = outer ? TileHeightfield::OUTER_DIM : TileHeightfield::INNER_DIM;
+    auto const last = static_cast<std::ptrdiff_t>(tile_dim - 1);
+
+    // both grids of neighbouring tiles are offset by INNER_DIM vertices
+    constexpr auto offset = static_cast<std::ptrdiff_t>(TileHeightfield::INNER_DIM);
+
+    auto const tile_of = [&](std::ptrdiff_t v) -> int { return v < 0 ? -1 : (v > last ? 1 : 0); };
+
+    grid.dim = tile_dim + 2 * halo;
+    grid.halo = halo;
+    grid.heights.resize(grid.dim * grid.dim);
+
+    for (std::size_t row = 0; row < grid.dim; ++row)
+    {
+      std::ptrdiff_t const y = static_cast<std::ptrdiff_t>(row) - static_cast<std::ptrdiff_t>(halo);
+      float* dst = grid.heights.data() + row * grid.dim;
+
+      for (std::size_t col = 0; col < grid.dim; ++col)
+      {
+        std::ptrdiff_t const x = static_cast<std::ptrdiff_t>(col) - static_cast<std::ptrdiff_t>(halo);
+
+        int const tile_x = tile_of(x);
+        int const tile_y = tile_of(y);
+
+        TileHeightfield const* tile = (tile_x || tile_y) ? neighbours.Get(tile_x, tile_y) : &heightfield;
+        std::ptrdiff_t local_x = x - tile_x * offset;
+        std::ptrdiff_t local_y = y - tile_y * offset;
+
+        // missing neighbours continue the border of the tile
+        if (!tile)
+        {
+          tile = &heightfield;
+          local_x = std::clamp<std::ptrdiff_t>(x, 0, last);
+          local_y = std::clamp<std::ptrdiff_t>(y, 0, last);
+        }
+
+        dst[col] = outer ? tile->Outer(static_cast<std::size_t>(local_x), static_cast<std::size_t>(local_y))
+                         : tile->Inner(static_cast<std::size_t>(local_x), static_cast<std::size_t>(local_y));
+      }
+    }
+  }
+
+  // traces the horizon of a row of vertices along all directions, visibility = 1 - strength * mean(sin(horizon))
+  void TraceRow(HaloGrid const& grid
+                , std::size_t y
+                , std::size_t n
+                , std::size_t n_directions
+                , std::span<std::vector<float> const> inv_distances
+                , float strength
+                , float* visibility)
+  {
+    float const* center = grid.Row(static_cast<std::ptrdiff_t>(y));
+    float const scale = strength / static_cast<float>(n_directions);
+
+    ForRange(0, n, [&]<typename V>(V, std::size_t i) -> void
+    {
+      V const height = Load<V>(center + i);
+      V sum = Broadcast<V>(0.f);
+
+      for (std::size_t d = 0; d < n_directions; ++d)
+      {
+        Direction const dir = DIRECTIONS[d];
+        std::vector<float> const& inv_distance = inv_distances[d];
+
+        // slopes below the horizontal do not occlude
+        V max_slope = Broadcast<V>(0.f);
+
+        for (std::size_t k = 0; k < inv_distance.size(); ++k)
+        {
+          auto const step = static_cast<std::ptrdiff_t>(k + 1);
+          float const* sample = grid.Row(static_cast<std::ptrdiff_t>(y) + step * dir.y) + step * dir.x;
+
+          max_slope = Max(max_slope, (Load<V>(sample + i) - height) * Broadcast<V>(inv_distance[k]));
+        }
+
+        // sin(atan(slope))
+        sum = sum + max_slope / Sqrt(Broadcast<V>(1.f) + max_slope * max_slope);
+      }
+
+      Store(visibility + i, Max(Broadcast<V>(1.f) - sum * Broadcast<V>(scale), Broadcast<V>(0.f)));
+    });
+  }
+}
+
+OcclusionBaker::OcclusionBaker(OcclusionSettings const& settings)
+: _settings(settings)
+{
+  RequireF(CCodeZones::TERRAIN, settings.n_directions == 4 || settings.n_directions == 8
+           || settings.n_directions == 16, "Number of occlusion directions must be 4, 8 or 16.");
+  RequireF(CCodeZones::TERRAIN, settings.max_distance >= VERTEX_SPACING
+           && settings.max_distance < VERTEX_SPACING * TileHeightfield::INNER_DIM
+           , "Occlusion distance must span at least a vertex and less than a tile.");
+}
+
+void OcclusionBaker::Compute(TileHeightfield const& heightfield
+                             , TileNeighbours const& neighbours
+                             , TileOcclusion& occlusion
+                             , std::size_t n_threads) const
+{
+  // steps of each direction within max_distance, in grid units
+  std::array<std::vector<float>, DIRECTIONS.size()> inv_distances {};
+  std::size_t halo = 0;
+
+  for (std::size_t d = 0; d < _settings.n_directions; ++d)
+  {
+    float const length = std::hypot(static_cast<float>(DIRECTIONS[d].x), static_cast<float>(DIRECTIONS[d].y))
+      * VERTEX_SPACING;
+    auto const n_steps = static_cast<std::size_t>(_settings.max_distance / length);
+
+    for (std::size_t k = 1; k <= n_steps; ++k)
+    {
+      inv_distances[d].push_back(1.f / (static_cast<float>(k) * length));
+    }
+
+    auto const reach = static_cast<std::size_t>(std::max(std::abs(DIRECTIONS[d].x), std::abs(DIRECTIONS[d].y)));
+    halo = std::max(halo, n_steps * reach);
+  }
+
+  HaloGrid outer {};
+  HaloGrid inner {};
+  BuildHalo(heightfield, neighbours, true, halo, outer);
+  BuildHalo(heightfield, neighbours, false, halo, inner);
+
+  occlusion.outer.resize(TileHeightfield::N_OUTER);
+  occlusion.inner.resize(TileHeightfield::N_INNER);
+
+  constexpr std::size_t n_rows = TileHeightfield::OUTER_DIM + TileHeightfield::INNER_DIM;
+  constexpr std::size_t n_tasks = (n_rows + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+
+  Utils::Misc::ParallelFor(0, n_tasks, [&](std::size_t task) -> void
+  {
+    for (std::size_t row = task * ROWS_PER_TASK; row < std::min((task + 1) * ROWS_PER_TASK, n_rows); ++row)
+    {
+      if (row < TileHeightfield::OUTER_DIM)
+      {
+        TraceRow(outer, row, TileHeightfield::OUTER_DIM, _settings.n_directions, inv_distances, _settings.strength
+                 , occlusion.outer.data() + row * TileHeightfield::OUTER_DIM);
+      }
+      else
+      {
+        std::size_t const y = row - TileHeightfield::OUTER_DIM;
+
+        TraceRow(inner, y, TileHeightfield::INNER_DIM, _settings.n_directions, inv_distances, _settings.strength
+                 , occlusion.inner.data() + y * TileHeightfield::INNER_DIM);
+      }
+    }
+  }, 1, n_threads);
+}
+
+void OcclusionBaker::Apply(TileOcclusion const& occlusion, TileVertexColors& colors) const
+{
+  RequireF(CCodeZones::TERRAIN, occlusion.outer.size() == TileHeightfield::N_OUTER
+           && occlusion.inner.size() == TileHeightfield::N_INNER, "Occlusion was not computed.");
+
+  ApplyGrid<true>(occlusion.outer, _settings.multiply, colors);
+  ApplyGrid<false>(occlusion.inner, _settings.multiply, colors);
+
+  colors.DirtyChunks().set();
+}
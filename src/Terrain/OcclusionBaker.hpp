@@ -0,0 +1,112 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+#include <Terrain/TileVertexColors.hpp>
+#include <IO/Common.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Terrain
+{
+  struct OcclusionSettings
+  {
+    std::size_t n_directions = 8;     ///> Number of horizon directions traced per vertex: 4, 8 or 16.
+    float max_distance = 40.f;        ///> Distance up to which terrain occludes a vertex, in yards.
+    float strength = 1.f;             ///> Scale of the occlusion, 0 leaves colors unchanged.
+    bool multiply = true;             ///> Multiply existing vertex colors, replace them with gray otherwise.
+  };
+
+  /**
+   * Visibility of the vertices of a tile, 1 for unoccluded vertices down to 0, laid out like TileHeightfield.
+   */
+  struct TileOcclusion
+  {
+    std::vector<float> outer;
+    std::vector<float> inner;
+  };
+
+  /**
+   * Bakes horizon-based ambient occlusion of terrain into vertex colors (MCCV).
+   * For each vertex, the horizon is traced along n_directions directions of the vertex grid, axes, diagonals and knight
+   * moves, up to max_distance. Samples along those directions fall on vertices of the same grid, so that a row of
+   * vertices is traced with contiguous SIMD loads from a copy of the grid extended by a halo taken from neighbouring
+   * tiles. Occlusion of a vertex is the mean sine of its horizon angles. Missing neighbours are substituted with the
+   * border of the tile.
+   */
+  class OcclusionBaker
+  {
+  public:
+    template<IO::Common::ClientVersion client_version>
+    using TileLoadFunc = std::function<std::optional<IO::ADT::ADTRoot<client_version>>(std::size_t tile_x
+                                                                                        , std::size_t tile_y)>;
+
+    template<IO::Common::ClientVersion client_version>
+    using TileStoreFunc = std::function<void(std::size_t tile_x
+                                             , std::size_t tile_y
+                                             , IO::ADT::ADTRoot<client_version> const& root)>;
+
+    explicit OcclusionBaker(OcclusionSettings const& settings = {});
+
+    /**
+     * Computes visibility of all vertices of a tile, rows are distributed across threads.
+     * @param heightfield Heightfield of the tile.
+     * @param neighbours Heightfields of the surrounding tiles.
+     * @param occlusion Receives visibility of the vertices.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     */
+    void Compute(TileHeightfield const& heightfield
+                 , TileNeighbours const& neighbours
+                 , TileOcclusion& occlusion
+                 , std::size_t n_threads = 0) const;
+
+    /**
+     * Applies visibility to vertex colors according to settings.multiply, alpha is kept. Marks all chunks dirty.
+     * @param occlusion Visibility of the vertices.
+     * @param colors Vertex colors of the tile.
+     */
+    void Apply(TileOcclusion const& occlusion, TileVertexColors& colors) const;
+
+    /**
+     * Bakes occlusion into the vertex colors (MCCV) of all chunks of a tile.
+     * Multiplying bakes accumulate, baking twice darkens colors twice.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param neighbours Heightfields of the surrounding tiles.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Bake(IO::ADT::ADTRoot<client_version>& root
+              , TileNeighbours const& neighbours = {}
+              , std::size_t n_threads = 0) const;
+
+    /**
+     * Bakes occlusion into all tiles of a map in parallel. Heightfields of all tiles are loaded first and kept in
+     * memory (about 130 KB per tile) to provide neighbours, tiles are then loaded a second time to be baked one at a
+     * time per thread. Callbacks are invoked concurrently from worker threads.
+     * @tparam client_version Version of the game client.
+     * @param load Loads a tile, returns nothing if the tile does not exist.
+     * @param store Receives each baked tile, typically writes it back.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return Number of tiles baked.
+     */
+    template<IO::Common::ClientVersion client_version>
+    std::size_t BakeMap(TileLoadFunc<client_version> const& load
+                        , TileStoreFunc<client_version> const& store
+                        , std::size_t n_threads = 0) const;
+
+  // accessors
+  public:
+    [[nodiscard]]
+    OcclusionSettings const& Settings() const { return _settings; };
+
+  private:
+    OcclusionSettings _settings;
+  };
+}
+
+#include <Terrain/OcclusionBaker.inl>
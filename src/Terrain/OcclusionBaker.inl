@@ -0,0 +1,76 @@
+#pragma once
+#include <Terrain/OcclusionBaker.hpp>
+#include <Terrain/SeamReconciler.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <IO/WorldConstants.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline void OcclusionBaker::Bake(IO::ADT::ADTRoot<client_version>& root
+                                   , TileNeighbours const& neighbours
+                                   , std::size_t n_threads) const
+  {
+    TileOcclusion occlusion {};
+    Compute(TileHeightfield{root}, neighbours, occlusion, n_threads);
+
+    TileVertexColors colors {root, VertexColorFormat::MCCV};
+    Apply(occlusion, colors);
+    colors.Store(root, VertexColorFormat::MCCV);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline std::size_t OcclusionBaker::BakeMap(TileLoadFunc<client_version> const& load
+                                             , TileStoreFunc<client_version> const& store
+                                             , std::size_t n_threads) const
+  {
+    using IO::Common::WorldConstants::MAP_DIM;
+    constexpr std::size_t n_tiles = IO::Common::WorldConstants::MAX_TILES_PER_MAP;
+
+    std::vector<std::unique_ptr<TileHeightfield>> heightfields (n_tiles);
+
+    Utils::Misc::ParallelFor(0, n_tiles, [&](std::size_t tile) -> void
+    {
+      if (std::optional<IO::ADT::ADTRoot<client_version>> root = load(tile % MAP_DIM, tile / MAP_DIM))
+      {
+        heightfields[tile] = std::make_unique<TileHeightfield>(*root);
+      }
+    }, 1, n_threads);
+
+    std::array<MapTile, n_tiles> tiles {};
+
+    for (std::size_t tile = 0; tile < n_tiles; ++tile)
+    {
+      tiles[tile].heightfield = heightfields[tile].get();
+    }
+
+    std::atomic<std::size_t> n_baked = 0;
+
+    Utils::Misc::ParallelFor(0, n_tiles, [&](std::size_t tile) -> void
+    {
+      if (!heightfields[tile])
+        return;
+
+      std::optional<IO::ADT::ADTRoot<client_version>> root = load(tile % MAP_DIM, tile / MAP_DIM);
+
+      if (!root)
+        return;
+
+      TileOcclusion occlusion {};
+      Compute(*heightfields[tile], SeamReconciler::Neighbours(tiles, tile % MAP_DIM, tile / MAP_DIM), occlusion, 1);
+
+      TileVertexColors colors {*root, VertexColorFormat::MCCV};
+      Apply(occlusion, colors);
+      colors.Store(*root, VertexColorFormat::MCCV);
+
+      store(tile % MAP_DIM, tile / MAP_DIM, *root);
+      n_baked.fetch_add(1, std::memory_order_relaxed);
+    }, 1, n_threads);
+
+    return n_baked.load();
+  }
+}
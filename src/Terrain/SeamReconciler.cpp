@@ -0,0 +1,281 @@
+#include <Terrain/SeamReconciler.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace Terrain;
+using IO::Common::WorldConstants::MAP_DIM;
+
+namespace
+{
+  constexpr std::size_t LAST = TileHeightfield::OUTER_DIM - 1;
+
+  // outer vertex of a tile
+  struct SharedVertex
+  {
+    std::size_t tile;
+    std::size_t x;
+    std::size_t y;
+  };
+
+  struct PartialReport
+  {
+    std::size_t height_mismatches = 0;
+    std::size_t normal_mismatches = 0;
+    float max_height_error = 0.f;
+  };
+}
+
+SeamReconciler::SeamReconciler(SeamPolicy policy, float height_tolerance, float normal_tolerance)
+: _policy(policy)
+, _height_tolerance(height_tolerance)
+, _normal_tolerance(normal_tolerance)
+{
+  RequireF(CCodeZones::TERRAIN, height_tolerance >= 0.f && normal_tolerance >= 0.f, "Tolerance must not be negative.");
+}
+
+SeamReport SeamReconciler::Check(MapTiles tiles, std::size_t n_threads) const
+{
+  return Process(tiles, false, n_threads);
+}
+
+SeamReport SeamReconciler::Reconcile(MapTiles tiles, std::size_t n_threads) const
+{
+  return Process(tiles, true, n_threads);
+}
+
+TileNeighbours SeamReconciler::Neighbours(MapTiles tiles, std::size_t tile_x, std::size_t tile_y)
+{
+  RequireF(CCodeZones::TERRAIN, tile_x < MAP_DIM && tile_y < MAP_DIM, "Tile index out of bounds.");
+
+  TileNeighbours neighbours {};
+
+  for (int dy = -1; dy <= 1; ++dy)
+  {
+    for (int dx = -1; dx <= 1; ++dx)
+    {
+      auto const x = static_cast<std::ptrdiff_t>(tile_x) + dx;
+      auto const y = static_cast<std::ptrdiff_t>(tile_y) + dy;
+
+      if ((dx || dy) && x >= 0 && y >= 0 && x < static_cast<std::ptrdiff_t>(MAP_DIM)
+          && y < static_cast<std::ptrdiff_t>(MAP_DIM))
+      {
+        neighbours.Set(dx, dy, tiles[y * MAP_DIM + x].heightfield);
+      }
+    }
+  }
+
+  return neighbours;
+}
+
+SeamReport SeamReconciler::Process(MapTiles tiles, bool fix, std::size_t n_threads) const
+{
+  constexpr std::size_t n_tiles = IO::Common::WorldConstants::MAX_TILES_PER_MAP;
+
+  // corners of tiles meet at junctions, (MAP_DIM + 1)^2 of them
+  constexpr std::size_t junction_dim = MAP_DIM + 1;
+
+  std::vector<PartialReport> tile_reports (n_tiles);
+  std::vector<PartialReport> junction_reports (junction_dim * junction_dim);
+  std::vector<std::atomic<bool>> involved (n_tiles);
+
+  auto const resolve = [&](std::span<SharedVertex const> shared, PartialReport& report) -> void
+  {
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+
+    for (auto const& vertex : shared)
+    {
+      float const height = tiles[vertex.tile].heightfield->Outer(vertex.x, vertex.y);
+      min = std::min(min, height);
+      max = std::max(max, height);
+    }
+
+    bool const height_mismatch = max - min > _height_tolerance;
+    bool normal_mismatch = false;
+
+    TileNormals const* reference = nullptr;
+    std::array<float, 3> reference_normal {};
+
+    for (auto const& vertex : shared)
+    {
+      TileNormals const* normals = tiles[vertex.tile].normals;
+
+      if (!normals)
+        continue;
+
+      auto const normal = normals->Outer(vertex.x, vertex.y);
+
+      if (!reference)
+      {
+        reference = normals;
+        reference_normal = normal;
+        continue;
+      }
+
+      for (std::size_t i = 0; i < 3; ++i)
+      {
+        normal_mismatch |= std::abs(normal[i] - reference_normal[i]) > _normal_tolerance;
+      }
+    }
+
+    if (!height_mismatch && !normal_mismatch)
+      return;
+
+    report.height_mismatches += height_mismatch;
+    report.normal_mismatches += normal_mismatch;
+    report.max_height_error = std::max(report.max_height_error, max - min);
+
+    for (auto const& vertex : shared)
+    {
+      involved[vertex.tile] = true;
+    }
+
+    if (!fix || !height_mismatch)
+      return;
+
+    float value = 0.f;
+
+    switch (_policy)
+    {
+      case SeamPolicy::PreferWestNorth:
+      {
+        // shared vertices are listed west to east, then north to south
+        value = tiles[shared[0].tile].heightfield->Outer(shared[0].x, shared[0].y);
+        break;
+      }
+      case SeamPolicy::PreferEdited:
+      case SeamPolicy::Average:
+      {
+        bool const any_edited = _policy == SeamPolicy::PreferEdited
+          && std::any_of(shared.begin(), shared.end(), [&](SharedVertex const& v) { return tiles[v.tile].edited; });
+
+        std::size_t n = 0;
+
+        for (auto const& vertex : shared)
+        {
+          if (!any_edited || tiles[vertex.tile].edited)
+          {
+            value += tiles[vertex.tile].heightfield->Outer(vertex.x, vertex.y);
+            ++n;
+          }
+        }
+
+        value /= static_cast<float>(n);
+        break;
+      }
+    }
+
+    for (auto const& vertex : shared)
+    {
+      tiles[vertex.tile].heightfield->Outer(vertex.x, vertex.y) = value;
+    }
+  };
+
+  // seams to the east and south, without their end points which belong to junctions
+  Utils::Misc::ParallelFor(0, n_tiles, [&](std::size_t tile) -> void
+  {
+    if (!tiles[tile].heightfield)
+      return;
+
+    std::size_t const tile_x = tile % MAP_DIM;
+    std::size_t const tile_y = tile / MAP_DIM;
+
+    if (tile_x + 1 < MAP_DIM && tiles[tile + 1].heightfield)
+    {
+      for (std::size_t i = 1; i < LAST; ++i)
+      {
+        SharedVertex const shared[] = { {tile, LAST, i}, {tile + 1, 0, i} };
+        resolve(shared, tile_reports[tile]);
+      }
+    }
+
+    if (tile_y + 1 < MAP_DIM && tiles[tile + MAP_DIM].heightfield)
+    {
+      for (std::size_t i = 1; i < LAST; ++i)
+      {
+        SharedVertex const shared[] = { {tile, i, LAST}, {tile + MAP_DIM, i, 0} };
+        resolve(shared, tile_reports[tile]);
+      }
+    }
+  }, 16, n_threads);
+
+  Utils::Misc::ParallelFor(0, junction_dim * junction_dim, [&](std::size_t junction) -> void
+  {
+    auto const jx = static_cast<std::ptrdiff_t>(junction % junction_dim);
+    auto const jy = static_cast<std::ptrdiff_t>(junction / junction_dim);
+
+    std::array<SharedVertex, 4> shared {};
+    std::size_t n_shared = 0;
+
+    // north-west, north-east, south-west, south-east tile
+    for (std::ptrdiff_t dy = -1; dy <= 0; ++dy)
+    {
+      for (std::ptrdiff_t dx = -1; dx <= 0; ++dx)
+      {
+        std::ptrdiff_t const x = jx + dx;
+        std::ptrdiff_t const y = jy + dy;
+
+        if (x < 0 || y < 0 || x >= static_cast<std::ptrdiff_t>(MAP_DIM) || y >= static_cast<std::ptrdiff_t>(MAP_DIM))
+          continue;
+
+        std::size_t const tile = static_cast<std::size_t>(y) * MAP_DIM + static_cast<std::size_t>(x);
+
+        if (tiles[tile].heightfield)
+        {
+          shared[n_shared++] = { tile, dx ? LAST : 0, dy ? LAST : 0 };
+        }
+      }
+    }
+
+    if (n_shared > 1)
+    {
+      resolve(std::span<SharedVertex const>{shared.data(), n_shared}, junction_reports[junction]);
+    }
+  }, 64, n_threads);
+
+  SeamReport report {};
+
+  for (auto const& partial : {std::span<PartialReport const>{tile_reports}, std::span<PartialReport const>{junction_reports}})
+  {
+    for (auto const& part : partial)
+    {
+      report.height_mismatches += part.height_mismatches;
+      report.normal_mismatches += part.normal_mismatches;
+      report.max_height_error = std::max(report.max_height_error, part.max_height_error);
+    }
+  }
+
+  for (std::size_t tile = 0; tile < n_tiles; ++tile)
+  {
+    report.modified[tile] = involved[tile];
+  }
+
+  if (!fix)
+    return report;
+
+  // normals along the borders depend on heights of both sides of a seam
+  Utils::Misc::ParallelFor(0, n_tiles, [&](std::size_t tile) -> void
+  {
+    if (!involved[tile] || !tiles[tile].normals)
+      return;
+
+    TileNeighbours const neighbours = Neighbours(tiles, tile % MAP_DIM, tile / MAP_DIM);
+    TileHeightfield const& heightfield = *tiles[tile].heightfield;
+
+    for (VertexRect const& border : { VertexRect{0, 0, LAST, 0}, VertexRect{0, LAST, LAST, LAST}
+                                      , VertexRect{0, 0, 0, LAST}, VertexRect{LAST, 0, LAST, LAST} })
+    {
+      tiles[tile].normals->Compute(heightfield, border, neighbours);
+    }
+  }, 1, n_threads);
+
+  return report;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+#include <Terrain/TileNormals.hpp>
+#include <IO/WorldConstants.hpp>
+
+#include <bitset>
+#include <cstdint>
+#include <span>
+
+namespace Terrain
+{
+  enum class SeamPolicy
+  {
+    Average = 0,            ///> Shared vertices take the average of all tiles.
+    PreferEdited = 1,       ///> Shared vertices take the average of edited tiles, or of all tiles if none was edited.
+    PreferWestNorth = 2     ///> Shared vertices take the value of the west-most, then north-most tile.
+  };
+
+  /**
+   * Tile of a map taking part in seam reconciliation.
+   */
+  struct MapTile
+  {
+    TileHeightfield* heightfield = nullptr;   ///> nullptr if the tile is not loaded or does not exist.
+    TileNormals* normals = nullptr;           ///> Optional, border normals are recomputed when provided.
+    bool edited = false;                      ///> Used by SeamPolicy::PreferEdited.
+  };
+
+  struct SeamReport
+  {
+    std::size_t height_mismatches = 0;                                  ///> Shared vertices with mismatching heights.
+    std::size_t normal_mismatches = 0;                                  ///> Shared vertices with mismatching normals.
+    float max_height_error = 0.f;                                       ///> Largest height difference found.
+    std::bitset<IO::Common::WorldConstants::MAX_TILES_PER_MAP> modified;  ///> Tiles whose heights or normals changed.
+  };
+
+  /**
+   * Detects and fixes mismatches of vertices shared by neighbouring tiles of a map (borders and corners of tiles).
+   * Tiles are indexed as y * 64 + x, x growing toward the east (world -Y) and y toward the south (world -X).
+   * Each tile owns the seams to its east and south neighbours and the corner shared with its south-east neighbour.
+   * Seams of different tiles never share vertices, so tiles are processed in parallel without synchronization.
+   */
+  class SeamReconciler
+  {
+  public:
+
+    using MapTiles = std::span<MapTile const, IO::Common::WorldConstants::MAX_TILES_PER_MAP>;
+
+    /**
+     * @param policy Policy resolving the value of shared vertices.
+     * @param height_tolerance Heights differing by at most this value are considered matching.
+     * @param normal_tolerance Normal components differing by at most this value are considered matching.
+     */
+    explicit SeamReconciler(SeamPolicy policy, float height_tolerance = 0.f, float normal_tolerance = 1e-3f);
+
+    /**
+     * Finds mismatches without modifying tiles.
+     * @param tiles Tiles of the map.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return Found mismatches, modified lists the tiles that Reconcile() would modify.
+     */
+    [[nodiscard]]
+    SeamReport Check(MapTiles tiles, std::size_t n_threads = 0) const;
+
+    /**
+     * Fixes mismatching heights according to the policy, then recomputes border normals of the tiles involved
+     * in any mismatch.
+     * @param tiles Tiles of the map.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return Mismatches found before fixing them.
+     */
+    SeamReport Reconcile(MapTiles tiles, std::size_t n_threads = 0) const;
+
+    /**
+     * Neighbours of a tile within a map.
+     * @param tiles Tiles of the map.
+     * @param tile_x Horizontal index of the tile.
+     * @param tile_y Vertical index of the tile.
+     * @return Heightfields of the surrounding tiles.
+     */
+    [[nodiscard]]
+    static TileNeighbours Neighbours(MapTiles tiles, std::size_t tile_x, std::size_t tile_y);
+
+  private:
+    SeamReport Process(MapTiles tiles, bool fix, std::size_t n_threads) const;
+
+    SeamPolicy _policy;
+    float _height_tolerance;
+    float _normal_tolerance;
+  };
+}
@@ -0,0 +1,276 @@
+#include <Terrain/SoundEmitterIndex.hpp>
+#include <Terrain/Common.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+using namespace Terrain;
+using namespace IO::Common::DataStructures;
+using IO::Common::WorldConstants::MAP_DIM;
+
+namespace
+{
+  FORCEINLINE float SquaredDistance(C3Vector const& lhs, C3Vector const& rhs)
+  {
+    float const dx = lhs.x - rhs.x;
+    float const dy = lhs.y - rhs.y;
+    float const dz = lhs.z - rhs.z;
+
+    return dx * dx + dy * dy + dz * dz;
+  }
+
+  // boxes must not be empty
+  FORCEINLINE float SquaredDistance(CAaBox const& box, C3Vector const& point)
+  {
+    float const dx = std::max({box.min.x - point.x, 0.f, point.x - box.max.x});
+    float const dy = std::max({box.min.y - point.y, 0.f, point.y - box.max.y});
+    float const dz = std::max({box.min.z - point.z, 0.f, point.z - box.max.z});
+
+    return dx * dx + dy * dy + dz * dz;
+  }
+
+  FORCEINLINE bool HitLess(SoundEmitterHit const& lhs, SoundEmitterHit const& rhs)
+  {
+    return lhs.distance < rhs.distance;
+  }
+}
+
+SoundEmitterIndex::TileEmitters::TileEmitters()
+: chunk_begin{}
+, bounds{EMPTY_BOX}
+{
+  chunk_bounds.fill(EMPTY_BOX);
+}
+
+void SoundEmitterIndex::TileEmitters::SetChunk(std::size_t chunk, std::span<SoundEmitter const> chunk_emitters)
+{
+  std::size_t const n_previous = chunk_begin[chunk + 1] - chunk_begin[chunk];
+
+  auto const it = emitters.erase(emitters.begin() + chunk_begin[chunk], emitters.begin() + chunk_begin[chunk + 1]);
+  emitters.insert(it, chunk_emitters.begin(), chunk_emitters.end());
+
+  for (std::size_t i = chunk + 1; i < chunk_begin.size(); ++i)
+  {
+    chunk_begin[i] = static_cast<std::uint32_t>(chunk_begin[i] - n_previous + chunk_emitters.size());
+  }
+
+  chunk_bounds[chunk] = EMPTY_BOX;
+
+  for (SoundEmitter const& emitter : chunk_emitters)
+  {
+    Extend(chunk_bounds[chunk], emitter.data.position);
+  }
+
+  bounds = EMPTY_BOX;
+
+  for (CAaBox const& box : chunk_bounds)
+  {
+    Extend(bounds, box);
+  }
+}
+
+SoundEmitterIndex::SoundEmitterIndex()
+: _tiles{}
+{
+}
+
+template<typename Func>
+void SoundEmitterIndex::Visit(C3Vector center, float const& reach, Func&& func) const
+{
+  std::vector<std::pair<float, std::uint16_t>> tiles;
+
+  // empty boxes are skipped explicitly, an infinite distance would still be within an infinite reach
+  for (std::uint16_t tile : _loaded_tiles)
+  {
+    if (IsEmpty(_tiles[tile]->bounds))
+      continue;
+
+    float const squared_distance = SquaredDistance(_tiles[tile]->bounds, center);
+
+    if (squared_distance <= reach * reach)
+    {
+      tiles.emplace_back(squared_distance, tile);
+    }
+  }
+
+  std::sort(tiles.begin(), tiles.end());
+
+  std::vector<std::pair<float, std::uint16_t>> chunks;
+  chunks.reserve(IO::Common::WorldConstants::CHUNKS_PER_TILE);
+
+  for (auto const& [tile_distance, tile] : tiles)
+  {
+    if (tile_distance > reach * reach)
+      break;
+
+    TileEmitters const& tile_emitters = *_tiles[tile];
+    chunks.clear();
+
+    for (std::size_t chunk = 0; chunk < IO::Common::WorldConstants::CHUNKS_PER_TILE; ++chunk)
+    {
+      if (IsEmpty(tile_emitters.chunk_bounds[chunk]))
+        continue;
+
+      float const squared_distance = SquaredDistance(tile_emitters.chunk_bounds[chunk], center);
+
+      if (squared_distance <= reach * reach)
+      {
+        chunks.emplace_back(squared_distance, static_cast<std::uint16_t>(chunk));
+      }
+    }
+
+    std::sort(chunks.begin(), chunks.end());
+
+    for (auto const& [chunk_distance, chunk] : chunks)
+    {
+      if (chunk_distance > reach * reach)
+        break;
+
+      for (std::size_t i = tile_emitters.chunk_begin[chunk]; i < tile_emitters.chunk_begin[chunk + 1]; ++i)
+      {
+        SoundEmitter const& emitter = tile_emitters.emitters[i];
+        float const squared_distance = SquaredDistance(emitter.data.position, center);
+
+        if (squared_distance <= reach * reach)
+        {
+          func(emitter, squared_distance);
+        }
+      }
+    }
+  }
+}
+
+void SoundEmitterIndex::RemoveTile(std::size_t tile_x, std::size_t tile_y)
+{
+  RequireF(CCodeZones::TERRAIN, tile_x < MAP_DIM && tile_y < MAP_DIM, "Tile index out of bounds.");
+
+  SetTile(tile_y * MAP_DIM + tile_x, nullptr);
+}
+
+void SoundEmitterIndex::SetChunk(std::size_t tile_x
+                                 , std::size_t tile_y
+                                 , std::size_t chunk_x
+                                 , std::size_t chunk_y
+                                 , std::span<IO::ADT::DataStructures::MCSE const> emitters)
+{
+  RequireF(CCodeZones::TERRAIN, tile_x < MAP_DIM && tile_y < MAP_DIM, "Tile index out of bounds.");
+  RequireF(CCodeZones::TERRAIN, chunk_x < CHUNKS_PER_ROW && chunk_y < CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+  std::size_t const tile = tile_y * MAP_DIM + tile_x;
+  std::size_t const chunk = chunk_y * CHUNKS_PER_ROW + chunk_x;
+
+  if (!_tiles[tile])
+  {
+    SetTile(tile, std::make_unique<TileEmitters>());
+  }
+
+  _tiles[tile]->SetChunk(chunk, Tag(tile_x, tile_y, chunk, emitters));
+}
+
+std::vector<SoundEmitterHit> SoundEmitterIndex::FindInRadius(C3Vector center, float radius) const
+{
+  std::vector<SoundEmitterHit> hits;
+
+  Visit(center, radius, [&](SoundEmitter const& emitter, float squared_distance) -> void
+  {
+    hits.push_back({emitter, std::sqrt(squared_distance)});
+  });
+
+  std::sort(hits.begin(), hits.end(), HitLess);
+  return hits;
+}
+
+std::vector<SoundEmitterHit> SoundEmitterIndex::FindNearest(C3Vector center, std::size_t k, float max_distance) const
+{
+  std::vector<SoundEmitterHit> hits;
+
+  if (!k)
+    return hits;
+
+  hits.reserve(k);
+
+  // max-heap of the k nearest emitters, reach shrinks to the farthest of them once k are found
+  float reach = max_distance;
+
+  Visit(center, reach, [&](SoundEmitter const& emitter, float squared_distance) -> void
+  {
+    float const distance = std::sqrt(squared_distance);
+
+    if (hits.size() == k)
+    {
+      if (distance >= hits.front().distance)
+        return;
+
+      std::pop_heap(hits.begin(), hits.end(), HitLess);
+      hits.pop_back();
+    }
+
+    hits.push_back({emitter, distance});
+    std::push_heap(hits.begin(), hits.end(), HitLess);
+
+    if (hits.size() == k)
+    {
+      reach = hits.front().distance;
+    }
+  });
+
+  std::sort_heap(hits.begin(), hits.end(), HitLess);
+  return hits;
+}
+
+std::size_t SoundEmitterIndex::Size() const
+{
+  std::size_t n_emitters = 0;
+
+  for (std::uint16_t tile : _loaded_tiles)
+  {
+    n_emitters += _tiles[tile]->emitters.size();
+  }
+
+  return n_emitters;
+}
+
+std::vector<SoundEmitter> SoundEmitterIndex::Tag(std::size_t tile_x
+                                                 , std::size_t tile_y
+                                                 , std::size_t chunk
+                                                 , std::span<IO::ADT::DataStructures::MCSE const> emitters)
+{
+  RequireF(CCodeZones::TERRAIN, emitters.size() <= std::numeric_limits<std::uint16_t>::max()
+           , "Too many sound emitters in a chunk.");
+
+  std::vector<SoundEmitter> tagged (emitters.size());
+
+  for (std::size_t i = 0; i < emitters.size(); ++i)
+  {
+    tagged[i].data = emitters[i];
+    tagged[i].chunk = { static_cast<std::uint8_t>(tile_x), static_cast<std::uint8_t>(tile_y)
+                        , static_cast<std::uint8_t>(chunk % CHUNKS_PER_ROW)
+                        , static_cast<std::uint8_t>(chunk / CHUNKS_PER_ROW) };
+    tagged[i].index = static_cast<std::uint16_t>(i);
+  }
+
+  return tagged;
+}
+
+void SoundEmitterIndex::SetTile(std::size_t tile, std::unique_ptr<TileEmitters> emitters)
+{
+  bool const was_loaded = static_cast<bool>(_tiles[tile]);
+  _tiles[tile] = std::move(emitters);
+
+  if (was_loaded == static_cast<bool>(_tiles[tile]))
+    return;
+
+  auto const it = std::lower_bound(_loaded_tiles.begin(), _loaded_tiles.end(), tile);
+
+  if (was_loaded)
+  {
+    _loaded_tiles.erase(it);
+  }
+  else
+  {
+    _loaded_tiles.insert(it, static_cast<std::uint16_t>(tile));
+  }
+}
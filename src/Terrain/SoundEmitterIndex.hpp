@@ -0,0 +1,188 @@
+#pragma once
+
+#include <Terrain/ChunkHeaderIndex.hpp>
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Terrain
+{
+  /**
+   * Sound emitter (MCSE entry) of a map, along with the chunk it is stored in.
+   */
+  struct SoundEmitter
+  {
+    IO::ADT::DataStructures::MCSE data;
+    MapChunkRef chunk;
+    std::uint16_t index;              ///> Index of the entry in the MCSE chunk.
+  };
+
+  struct SoundEmitterHit
+  {
+    SoundEmitter emitter;
+    float distance;                   ///> Distance from the query center to the emitter position.
+  };
+
+  /**
+   * Map-wide spatial index of sound emitters (MCSE).
+   * The index is a fixed two-level bounding volume hierarchy following the tile and chunk grid: each tile stores its
+   * emitters grouped by chunk, along with the bounds of the emitters of each chunk and of the whole tile. Queries visit
+   * tiles, then chunks, whose bounds are within reach. Bounds are computed from emitter positions rather than chunk
+   * extents, so emitters lying outside of their chunk are still found.
+   * Editing the emitters of a chunk only regroups the emitters of its tile, and tiles are added and removed
+   * independently as they stream in and out.
+   */
+  class SoundEmitterIndex
+  {
+  public:
+    template<IO::Common::ClientVersion client_version>
+    using TileLoadFunc = std::function<std::optional<IO::ADT::ADTRoot<client_version>>(std::size_t tile_x
+                                                                                        , std::size_t tile_y)>;
+
+    static constexpr std::size_t CHUNKS_PER_ROW = 16;
+
+    SoundEmitterIndex();
+
+    /**
+     * Builds the index from all tiles of a map in parallel, replacing its contents.
+     * Callbacks are invoked concurrently from worker threads.
+     * @tparam client_version Version of the game client.
+     * @param load Loads a tile, returns nothing if the tile does not exist.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return Number of tiles indexed.
+     */
+    template<IO::Common::ClientVersion client_version>
+    std::size_t Build(TileLoadFunc<client_version> const& load, std::size_t n_threads = 0);
+
+    /**
+     * Adds the emitters of a tile, replacing those of the tile if it was already indexed.
+     * @tparam client_version Version of the game client.
+     * @param tile_x Horizontal index of the tile in the map.
+     * @param tile_y Vertical index of the tile in the map.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void AddTile(std::size_t tile_x, std::size_t tile_y, IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Removes the emitters of a tile, e.g. when it streams out.
+     * @param tile_x Horizontal index of the tile in the map.
+     * @param tile_y Vertical index of the tile in the map.
+     */
+    void RemoveTile(std::size_t tile_x, std::size_t tile_y);
+
+    /**
+     * Replaces the emitters of a chunk after it was edited. The tile is added if it was not indexed.
+     * @param tile_x Horizontal index of the tile in the map.
+     * @param tile_y Vertical index of the tile in the map.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param emitters Emitters of the chunk.
+     */
+    void SetChunk(std::size_t tile_x
+                  , std::size_t tile_y
+                  , std::size_t chunk_x
+                  , std::size_t chunk_y
+                  , std::span<IO::ADT::DataStructures::MCSE const> emitters);
+
+    /**
+     * Replaces the emitters of a chunk after it was edited.
+     * @tparam client_version Version of the game client.
+     * @param tile_x Horizontal index of the tile in the map.
+     * @param tile_y Vertical index of the tile in the map.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param chunk Chunk of the ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void SetChunk(std::size_t tile_x
+                  , std::size_t tile_y
+                  , std::size_t chunk_x
+                  , std::size_t chunk_y
+                  , IO::ADT::MCNKRoot<client_version> const& chunk);
+
+    /**
+     * Finds all emitters within a radius.
+     * @param center Center of the query in world coordinates.
+     * @param radius Radius of the query.
+     * @return Emitters sorted by ascending distance.
+     */
+    [[nodiscard]]
+    std::vector<SoundEmitterHit> FindInRadius(IO::Common::DataStructures::C3Vector center, float radius) const;
+
+    /**
+     * Finds the nearest emitters.
+     * @param center Center of the query in world coordinates.
+     * @param k Maximum number of emitters.
+     * @param max_distance Distance beyond which emitters are ignored.
+     * @return Up to k emitters sorted by ascending distance.
+     */
+    [[nodiscard]]
+    std::vector<SoundEmitterHit> FindNearest(IO::Common::DataStructures::C3Vector center
+                                             , std::size_t k
+                                             , float max_distance = std::numeric_limits<float>::infinity()) const;
+
+  // accessors
+  public:
+    [[nodiscard]] FORCEINLINE bool HasTile(std::size_t tile_x, std::size_t tile_y) const
+    {
+      return static_cast<bool>(_tiles[tile_y * IO::Common::WorldConstants::MAP_DIM + tile_x]);
+    };
+
+    [[nodiscard]] FORCEINLINE std::size_t NumTiles() const { return _loaded_tiles.size(); };
+
+    /**
+     * Number of emitters of all indexed tiles.
+     */
+    [[nodiscard]] std::size_t Size() const;
+
+  private:
+    struct TileEmitters
+    {
+      std::vector<SoundEmitter> emitters;                                               ///> Grouped by chunk.
+      std::array<std::uint32_t, IO::Common::WorldConstants::CHUNKS_PER_TILE + 1> chunk_begin;
+      std::array<IO::Common::DataStructures::CAaBox, IO::Common::WorldConstants::CHUNKS_PER_TILE> chunk_bounds;
+      IO::Common::DataStructures::CAaBox bounds;
+
+      TileEmitters();
+
+      // replaces the emitters of a chunk and updates bounds
+      void SetChunk(std::size_t chunk, std::span<SoundEmitter const> chunk_emitters);
+    };
+
+    // emitters of a chunk, tagged with their location
+    static std::vector<SoundEmitter> Tag(std::size_t tile_x
+                                         , std::size_t tile_y
+                                         , std::size_t chunk
+                                         , std::span<IO::ADT::DataStructures::MCSE const> emitters);
+
+    template<IO::Common::ClientVersion client_version>
+    static std::unique_ptr<TileEmitters> LoadTile(std::size_t tile_x
+                                                  , std::size_t tile_y
+                                                  , IO::ADT::ADTRoot<client_version> const& root);
+
+    // replaces the emitters of a tile, removes the tile if emitters is null
+    void SetTile(std::size_t tile, std::unique_ptr<TileEmitters> emitters);
+
+    // visits emitters of chunks whose bounds are within reach, nearest first, reach may shrink while visiting
+    template<typename Func>
+    void Visit(IO::Common::DataStructures::C3Vector center, float const& reach, Func&& func) const;
+
+    std::array<std::unique_ptr<TileEmitters>, IO::Common::WorldConstants::MAX_TILES_PER_MAP> _tiles;
+    std::vector<std::uint16_t> _loaded_tiles;
+  };
+}
+
+#include <Terrain/SoundEmitterIndex.inl>
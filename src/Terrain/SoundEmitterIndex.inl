@@ -0,0 +1,87 @@
+#pragma once
+#include <Terrain/SoundEmitterIndex.hpp>
+#include <Terrain/Common.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline std::size_t SoundEmitterIndex::Build(TileLoadFunc<client_version> const& load, std::size_t n_threads)
+  {
+    constexpr std::size_t n_tiles = IO::Common::WorldConstants::MAX_TILES_PER_MAP;
+
+    std::vector<std::unique_ptr<TileEmitters>> tiles (n_tiles);
+
+    Utils::Misc::ParallelFor(0, n_tiles, [&](std::size_t tile) -> void
+    {
+      std::optional<IO::ADT::ADTRoot<client_version>> root = load(tile % IO::Common::WorldConstants::MAP_DIM, tile / IO::Common::WorldConstants::MAP_DIM);
+
+      if (root)
+      {
+        tiles[tile] = LoadTile(tile % IO::Common::WorldConstants::MAP_DIM, tile / IO::Common::WorldConstants::MAP_DIM, *root);
+      }
+    }, 1, n_threads);
+
+    for (std::size_t tile = 0; tile < n_tiles; ++tile)
+    {
+      SetTile(tile, std::move(tiles[tile]));
+    }
+
+    return NumTiles();
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void SoundEmitterIndex::AddTile(std::size_t tile_x
+                                         , std::size_t tile_y
+                                         , IO::ADT::ADTRoot<client_version> const& root)
+  {
+    SetTile(tile_y * IO::Common::WorldConstants::MAP_DIM + tile_x, LoadTile(tile_x, tile_y, root));
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline auto SoundEmitterIndex::LoadTile(std::size_t tile_x
+                                          , std::size_t tile_y
+                                          , IO::ADT::ADTRoot<client_version> const& root)
+    -> std::unique_ptr<TileEmitters>
+  {
+    RequireF(CCodeZones::TERRAIN, tile_x < IO::Common::WorldConstants::MAP_DIM && tile_y < IO::Common::WorldConstants::MAP_DIM, "Tile index out of bounds.");
+
+    auto const& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    auto emitters = std::make_unique<TileEmitters>();
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      auto const& sound_emitters = chunks[i].SoundEmitters();
+
+      if (sound_emitters.IsInitialized() && sound_emitters.Size())
+      {
+        emitters->SetChunk(i, Tag(tile_x, tile_y, i, {&*sound_emitters.cbegin(), sound_emitters.Size()}));
+      }
+    }
+
+    return emitters;
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void SoundEmitterIndex::SetChunk(std::size_t tile_x
+                                          , std::size_t tile_y
+                                          , std::size_t chunk_x
+                                          , std::size_t chunk_y
+                                          , IO::ADT::MCNKRoot<client_version> const& chunk)
+  {
+    auto const& sound_emitters = chunk.SoundEmitters();
+
+    if (!sound_emitters.IsInitialized() || !sound_emitters.Size())
+    {
+      SetChunk(tile_x, tile_y, chunk_x, chunk_y, {});
+      return;
+    }
+
+    SetChunk(tile_x, tile_y, chunk_x, chunk_y, {&*sound_emitters.cbegin(), sound_emitters.Size()});
+  }
+}
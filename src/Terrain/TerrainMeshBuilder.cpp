@@ -0,0 +1,138 @@
+#include <Terrain/TerrainMeshBuilder.hpp>
+
+#include <cstring>
+
+using namespace Terrain;
+
+namespace
+{
+  constexpr std::size_t QUADS_PER_ROW = IO::Common::WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+  constexpr std::size_t ROW_STRIDE = IO::Common::WorldConstants::N_VERTS_CHUNK_ROW_OUTER + QUADS_PER_ROW;
+  constexpr std::size_t INDICES_PER_QUAD = 12;
+  constexpr float VERTEX_SPACING = IO::Common::WorldConstants::CHUNK_SIZE / QUADS_PER_ROW;
+
+  // indices of a row of quads, relative to the first vertex of the row
+  struct RowPattern
+  {
+    std::uint8_t count;
+    std::uint8_t indices[QUADS_PER_ROW * INDICES_PER_QUAD];
+  };
+
+  // patterns of every combination of holes within a row of quads, bit i set for a hole in quad i
+  constexpr std::array<RowPattern, 256> MakeRowPatterns()
+  {
+    std::array<RowPattern, 256> patterns {};
+
+    for (std::size_t mask = 0; mask < 256; ++mask)
+    {
+      RowPattern& pattern = patterns[mask];
+
+      for (std::size_t quad = 0; quad < QUADS_PER_ROW; ++quad)
+      {
+        if ((mask >> quad) & 1)
+          continue;
+
+        auto const nw = static_cast<std::uint8_t>(quad);
+        auto const ne = static_cast<std::uint8_t>(quad + 1);
+        auto const center = static_cast<std::uint8_t>(quad + IO::Common::WorldConstants::N_VERTS_CHUNK_ROW_OUTER);
+        auto const sw = static_cast<std::uint8_t>(quad + ROW_STRIDE);
+        auto const se = static_cast<std::uint8_t>(quad + ROW_STRIDE + 1);
+
+        // counter-clockwise seen from above: grid x runs along world -Y, grid y along world -X
+        std::uint8_t const quad_indices[INDICES_PER_QUAD] = { center, ne, nw, center, se, ne
+                                                              , center, sw, se, center, nw, sw };
+
+        for (std::uint8_t index : quad_indices)
+        {
+          pattern.indices[pattern.count++] = index;
+        }
+      }
+    }
+
+    return patterns;
+  }
+
+  constexpr std::array<RowPattern, 256> ROW_PATTERNS = MakeRowPatterns();
+}
+
+std::size_t TerrainMeshBuilder::BuildIndices(std::uint64_t holes
+                                             , std::span<std::uint16_t, MAX_INDICES_PER_CHUNK> indices
+                                             , std::uint16_t base_vertex)
+{
+  std::size_t n_indices = 0;
+
+  for (std::size_t row = 0; row < QUADS_PER_ROW; ++row)
+  {
+    RowPattern const& pattern = ROW_PATTERNS[(holes >> (row * 8)) & 0xFF];
+    auto const row_base = static_cast<std::uint16_t>(base_vertex + row * ROW_STRIDE);
+
+    for (std::size_t i = 0; i < pattern.count; ++i)
+    {
+      indices[n_indices + i] = static_cast<std::uint16_t>(row_base + pattern.indices[i]);
+    }
+
+    n_indices += pattern.count;
+  }
+
+  return n_indices;
+}
+
+void TerrainMeshBuilder::BuildVertices(IO::ADT::DataStructures::SMChunk const& header
+                                       , float const* heights
+                                       , IO::ADT::DataStructures::MCNREntry const* normals
+                                       , IO::ADT::DataStructures::MCCVEntry const* colors
+                                       , std::span<TerrainVertex, VERTICES_PER_CHUNK> vertices)
+{
+  constexpr std::size_t outer_dim = IO::Common::WorldConstants::N_VERTS_CHUNK_ROW_OUTER;
+
+  auto const& position = header.position;
+
+  auto const write = [&](std::size_t i, float x, float y) -> void
+  {
+    TerrainVertex& vertex = vertices[i];
+    vertex.position[0] = position.x - y * VERTEX_SPACING;
+    vertex.position[1] = position.y - x * VERTEX_SPACING;
+    vertex.position[2] = position.z + heights[i];
+
+    if (normals)
+    {
+      std::memcpy(vertex.normal, normals[i].normal, sizeof(normals[i].normal));
+      vertex.normal[3] = 0;
+    }
+    else
+    {
+      std::int8_t const up[4] = {0, 0, 127, 0};
+      std::memcpy(vertex.normal, up, sizeof(up));
+    }
+
+    if (colors)
+    {
+      std::uint8_t const color[4] = {colors[i].blue, colors[i].green, colors[i].red, colors[i].alpha};
+      std::memcpy(vertex.color, color, sizeof(color));
+    }
+    else
+    {
+      std::memset(vertex.color, 0x7F, sizeof(vertex.color));
+    }
+  };
+
+  // rows of 9 outer vertices, followed by 8 inner vertices offset by half a quad
+  for (std::size_t row = 0; row < outer_dim; ++row)
+  {
+    std::size_t const base = row * ROW_STRIDE;
+    auto const y = static_cast<float>(row);
+
+    for (std::size_t col = 0; col < outer_dim; ++col)
+    {
+      write(base + col, static_cast<float>(col), y);
+    }
+
+    if (row == QUADS_PER_ROW)
+      break;
+
+    for (std::size_t col = 0; col < QUADS_PER_ROW; ++col)
+    {
+      write(base + outer_dim + col, static_cast<float>(col) + 0.5f, y + 0.5f);
+    }
+  }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <IO/Common.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <IO/ADT/Root/ADTRootMCNK.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Terrain
+{
+  /**
+   * Interleaved terrain vertex.
+   */
+  struct TerrainVertex
+  {
+    float position[3];              ///> World position.
+    std::int8_t normal[4];          ///> MCNR order (world X, world Y, up), 127 == 1.0. Last component is padding.
+    std::uint8_t color[4];          ///> MCCV order (BGRA), 0x7F is neutral.
+  };
+
+  static_assert(sizeof(TerrainVertex) == 20);
+
+  struct TerrainIndexRange
+  {
+    std::uint32_t first;            ///> First index of the range.
+    std::uint32_t count;            ///> Number of indices.
+  };
+
+  /**
+   * Triangle mesh of a tile. Vertices of chunk i start at i * TerrainMeshBuilder::VERTICES_PER_CHUNK and follow the
+   * MCVT order. Indices of each chunk are contiguous and listed in chunks.
+   */
+  struct TerrainMesh
+  {
+    std::vector<TerrainVertex> vertices;
+    std::vector<std::uint16_t> indices;
+    std::array<TerrainIndexRange, IO::Common::WorldConstants::CHUNKS_PER_TILE> chunks;
+  };
+
+  /**
+   * Builds triangle meshes of terrain from MCNK data (MCVT, MCNR, MCCV and holes of the header).
+   * Each quad of a chunk is a fan of 4 triangles around its inner vertex, wound counter-clockwise seen from above.
+   * Index patterns of every combination of holes within a row of quads are precomputed, hence a chunk costs 8 table
+   * copies regardless of its holes.
+   */
+  class TerrainMeshBuilder
+  {
+  public:
+    static constexpr std::size_t VERTICES_PER_CHUNK = IO::Common::WorldConstants::CHUNK_BUF_SIZE;
+    static constexpr std::size_t MAX_INDICES_PER_CHUNK = 8 * 8 * 4 * 3;
+
+    /**
+     * Builds the mesh of a chunk.
+     * Missing normals default to up, missing vertex colors default to neutral.
+     * @tparam client_version Version of the game client.
+     * @param chunk Chunk to build the mesh of.
+     * @param vertices Output vertices, in the MCVT order.
+     * @param indices Output indices, only the first returned count are written.
+     * @param base_vertex Value added to every index.
+     * @return Number of indices written.
+     */
+    template<IO::Common::ClientVersion client_version>
+    static std::size_t BuildChunk(IO::ADT::MCNKRoot<client_version> const& chunk
+                                  , std::span<TerrainVertex, VERTICES_PER_CHUNK> vertices
+                                  , std::span<std::uint16_t, MAX_INDICES_PER_CHUNK> indices
+                                  , std::uint16_t base_vertex = 0);
+
+    /**
+     * Builds the mesh of a tile, chunks are built in parallel.
+     * Storage of the mesh is reused, so building tiles into the same mesh does not allocate past the first one.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param mesh Output mesh.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     */
+    template<IO::Common::ClientVersion client_version>
+    static void BuildTile(IO::ADT::ADTRoot<client_version> const& root, TerrainMesh& mesh, std::size_t n_threads = 0);
+
+    /**
+     * Writes indices of the non-hole quads of a chunk.
+     * @param holes High resolution hole mask (bit row * 8 + column is set for a hole quad).
+     * @param indices Output indices.
+     * @param base_vertex Value added to every index.
+     * @return Number of indices written.
+     */
+    static std::size_t BuildIndices(std::uint64_t holes
+                                    , std::span<std::uint16_t, MAX_INDICES_PER_CHUNK> indices
+                                    , std::uint16_t base_vertex = 0);
+
+    /**
+     * Builds vertices of a chunk from raw MCNK data.
+     * @param header Chunk header (position).
+     * @param heights MCVT heights, relative to the chunk position.
+     * @param normals MCNR normals or nullptr.
+     * @param colors MCCV colors or nullptr.
+     * @param vertices Output vertices.
+     */
+    static void BuildVertices(IO::ADT::DataStructures::SMChunk const& header
+                              , float const* heights
+                              , IO::ADT::DataStructures::MCNREntry const* normals
+                              , IO::ADT::DataStructures::MCCVEntry const* colors
+                              , std::span<TerrainVertex, VERTICES_PER_CHUNK> vertices);
+  };
+}
+
+#include <Terrain/TerrainMeshBuilder.inl>
@@ -0,0 +1,73 @@
+#pragma once
+#include <Terrain/TerrainMeshBuilder.hpp>
+#include <Terrain/Common.hpp>
+#include <Terrain/TileHoles.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline std::size_t TerrainMeshBuilder::BuildChunk(IO::ADT::MCNKRoot<client_version> const& chunk
+                                                    , std::span<TerrainVertex, VERTICES_PER_CHUNK> vertices
+                                                    , std::span<std::uint16_t, MAX_INDICES_PER_CHUNK> indices
+                                                    , std::uint16_t base_vertex)
+  {
+    RequireF(CCodeZones::TERRAIN, chunk.Heightmap().IsInitialized(), "Chunk has no heightmap (MCVT).");
+
+    BuildVertices(chunk.Header()
+                  , &*chunk.Heightmap().cbegin()
+                  , chunk.Normals().IsInitialized() ? chunk.Normals().data.entries : nullptr
+                  , chunk.VertexColor().IsInitialized() ? &*chunk.VertexColor().cbegin() : nullptr
+                  , vertices);
+
+    return BuildIndices(TileHoles::Decode(chunk.Header()), indices, base_vertex);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TerrainMeshBuilder::BuildTile(IO::ADT::ADTRoot<client_version> const& root
+                                            , TerrainMesh& mesh
+                                            , std::size_t n_threads)
+  {
+    auto const& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    // chunks write into fixed slots, indices are compacted afterwards
+    mesh.vertices.resize(chunks.Size() * VERTICES_PER_CHUNK);
+    mesh.indices.resize(chunks.Size() * MAX_INDICES_PER_CHUNK);
+
+    Utils::Misc::ParallelFor(0, chunks.Size(), [&](std::size_t i) -> void
+    {
+      std::size_t const count = BuildChunk
+      (
+        chunks[i]
+        , std::span<TerrainVertex, VERTICES_PER_CHUNK>{mesh.vertices.data() + i * VERTICES_PER_CHUNK, VERTICES_PER_CHUNK}
+        , std::span<std::uint16_t, MAX_INDICES_PER_CHUNK>{mesh.indices.data() + i * MAX_INDICES_PER_CHUNK
+                                                          , MAX_INDICES_PER_CHUNK}
+        , static_cast<std::uint16_t>(i * VERTICES_PER_CHUNK)
+      );
+
+      mesh.chunks[i] = { static_cast<std::uint32_t>(i * MAX_INDICES_PER_CHUNK), static_cast<std::uint32_t>(count) };
+    }, 4, n_threads);
+
+    std::uint32_t n_indices = 0;
+
+    for (auto& range : mesh.chunks)
+    {
+      if (range.first != n_indices)
+      {
+        std::copy(mesh.indices.begin() + range.first, mesh.indices.begin() + range.first + range.count
+                  , mesh.indices.begin() + n_indices);
+      }
+
+      range.first = n_indices;
+      n_indices += range.count;
+    }
+
+    mesh.indices.resize(n_indices);
+  }
+}
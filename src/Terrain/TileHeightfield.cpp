@@ -0,0 +1,128 @@
+#include <Terrain/TileHeightfield.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace Terrain;
+
+namespace
+{
+  // copies a grid of a tile into a grid with a border of 1 vertex, see TileHeightfield::Pad()
+  template<typename Sampler>
+  void PadGrid(std::vector<float>& padded
+               , std::size_t dim
+               , TileHeightfield const& heightfield
+               , TileNeighbours const& neighbours
+               , Sampler&& sample)
+  {
+    constexpr std::ptrdiff_t tile_shift = TileHeightfield::INNER_DIM;
+
+    std::size_t const padded_dim = dim + 2;
+    auto const d = static_cast<std::ptrdiff_t>(dim);
+
+    padded.resize(padded_dim * padded_dim);
+
+    auto const at = [&](std::ptrdiff_t x, std::ptrdiff_t y) -> float&
+    {
+      return padded[(y + 1) * padded_dim + (x + 1)];
+    };
+
+    for (std::ptrdiff_t y = 0; y < d; ++y)
+    {
+      for (std::ptrdiff_t x = 0; x < d; ++x)
+      {
+        at(x, y) = sample(heightfield, x, y);
+      }
+    }
+
+    auto const from_neighbour = [&](std::ptrdiff_t x, std::ptrdiff_t y) -> void
+    {
+      int const dx = x < 0 ? -1 : (x >= d ? 1 : 0);
+      int const dy = y < 0 ? -1 : (y >= d ? 1 : 0);
+
+      TileHeightfield const* tile = neighbours.Get(dx, dy);
+      at(x, y) = tile ? sample(*tile, x - dx * tile_shift, y - dy * tile_shift)
+                      : std::numeric_limits<float>::quiet_NaN();
+    };
+
+    for (std::ptrdiff_t i = -1; i <= d; ++i)
+    {
+      from_neighbour(i, -1);
+      from_neighbour(i, d);
+
+      if (i >= 0 && i < d)
+      {
+        from_neighbour(-1, i);
+        from_neighbour(d, i);
+      }
+    }
+
+    auto const extrapolate = [&](float& value, float edge, float inward) -> void
+    {
+      if (std::isnan(value))
+      {
+        value = 2.f * edge - inward;
+      }
+    };
+
+    // edges first, then corners
+    for (std::ptrdiff_t i = 0; i < d; ++i)
+    {
+      extrapolate(at(i, -1), at(i, 0), at(i, 1));
+      extrapolate(at(i, d), at(i, d - 1), at(i, d - 2));
+      extrapolate(at(-1, i), at(0, i), at(1, i));
+      extrapolate(at(d, i), at(d - 1, i), at(d - 2, i));
+    }
+
+    // a missing diagonal neighbour is extrapolated the way the side neighbours extrapolate it, if loaded, so that
+    // tiles sharing a border agree on it
+    for (std::ptrdiff_t cy : {std::ptrdiff_t{-1}, d})
+    {
+      for (std::ptrdiff_t cx : {std::ptrdiff_t{-1}, d})
+      {
+        int const dx = cx < 0 ? -1 : 1;
+        int const dy = cy < 0 ? -1 : 1;
+
+        std::ptrdiff_t const edge_x = cx < 0 ? 0 : d - 1;
+        std::ptrdiff_t const edge_y = cy < 0 ? 0 : d - 1;
+
+        if (TileHeightfield const* side = neighbours.Get(dx, 0); side && std::isnan(at(cx, cy)))
+        {
+          std::ptrdiff_t const x = cx - dx * tile_shift;
+          at(cx, cy) = 2.f * sample(*side, x, edge_y) - sample(*side, x, edge_y - dy);
+        }
+        else if (TileHeightfield const* side = neighbours.Get(0, dy); side && std::isnan(at(cx, cy)))
+        {
+          std::ptrdiff_t const y = cy - dy * tile_shift;
+          at(cx, cy) = 2.f * sample(*side, edge_x, y) - sample(*side, edge_x - dx, y);
+        }
+
+        extrapolate(at(cx, cy), at(cx - dx, cy), at(cx - 2 * dx, cy));
+      }
+    }
+  }
+}
+
+TileHeightfield::TileHeightfield()
+: _outer(N_OUTER, 0.f)
+, _inner(N_INNER, 0.f)
+{
+}
+
+void TileHeightfield::Fill(float height)
+{
+  std::fill(_outer.begin(), _outer.end(), height);
+  std::fill(_inner.begin(), _inner.end(), height);
+}
+
+void TileHeightfield::Pad(TileNeighbours const& neighbours
+                          , std::vector<float>& padded_outer
+                          , std::vector<float>& padded_inner) const
+{
+  PadGrid(padded_outer, OUTER_DIM, *this, neighbours
+          , [](TileHeightfield const& tile, std::size_t x, std::size_t y) { return tile.Outer(x, y); });
+
+  PadGrid(padded_inner, INNER_DIM, *this, neighbours
+          , [](TileHeightfield const& tile, std::size_t x, std::size_t y) { return tile.Inner(x, y); });
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <IO/Common.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <IO/ADT/Root/ADTRootMCNK.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Terrain
+{
+  struct TileNeighbours;
+
+  /**
+   * Tile-wide heightfield of an ADT.
+   * Heights of all 256 chunks (MCVT) are stored as two contiguous row-major planar grids: outer vertices (9x9 per chunk)
+   * and inner vertices (8x8 per chunk). Border vertices shared by neighbouring chunks are stored once, hence the outer
+   * grid is 129x129 and the inner grid is 128x128. Base heights of chunks (MCNK position) are folded in, all heights
+   * are absolute.
+   */
+  class TileHeightfield
+  {
+  public:
+    static constexpr std::size_t CHUNKS_PER_ROW = 16;
+
+    static constexpr std::size_t CHUNK_OUTER_DIM = IO::Common::WorldConstants::N_VERTS_CHUNK_ROW_OUTER;
+    static constexpr std::size_t CHUNK_INNER_DIM = IO::Common::WorldConstants::N_VERTS_CHUNK_ROW_INNER;
+
+    static constexpr std::size_t OUTER_DIM = CHUNKS_PER_ROW * CHUNK_INNER_DIM + 1;
+    static constexpr std::size_t INNER_DIM = CHUNKS_PER_ROW * CHUNK_INNER_DIM;
+
+    static constexpr std::size_t N_OUTER = OUTER_DIM * OUTER_DIM;
+    static constexpr std::size_t N_INNER = INNER_DIM * INNER_DIM;
+
+    /**
+     * Constructs a flat heightfield at height 0.
+     */
+    TileHeightfield();
+
+    /**
+     * Constructs a heightfield from the chunks of an ADT root file.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    explicit TileHeightfield(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Loads heights of all chunks of an ADT root file.
+     * Shared border vertices are taken from the chunk they are the top / left border of.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Load(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Stores heights into all chunks of an ADT root file. Base heights of chunks are kept.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Store(IO::ADT::ADTRoot<client_version>& root) const;
+
+    /**
+     * Loads heights of a single chunk.
+     * @tparam client_version Version of the game client.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param chunk Chunk to load heights from.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void LoadChunk(std::size_t chunk_x, std::size_t chunk_y, IO::ADT::MCNKRoot<client_version> const& chunk);
+
+    /**
+     * Stores heights of a single chunk. Base height of the chunk is kept.
+     * @tparam client_version Version of the game client.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param chunk Chunk to store heights into.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void StoreChunk(std::size_t chunk_x, std::size_t chunk_y, IO::ADT::MCNKRoot<client_version>& chunk) const;
+
+    /**
+     * Sets all vertices to the given height.
+     * @param height Height in yards.
+     */
+    void Fill(float height);
+
+    /**
+     * Copies both grids into grids with a border of 1 vertex on each side, sampled from neighbouring tiles.
+     * Both grids of neighbouring tiles are offset by INNER_DIM vertices. Border vertices of missing neighbours are
+     * extrapolated linearly from the tile. Padded grids are row-major, vertex (x, y) is at (y + 1) * (dim + 2) + x + 1.
+     * @param neighbours Heightfields of the surrounding tiles.
+     * @param padded_outer Padded outer grid, resized to (OUTER_DIM + 2)^2.
+     * @param padded_inner Padded inner grid, resized to (INNER_DIM + 2)^2.
+     */
+    void Pad(TileNeighbours const& neighbours, std::vector<float>& padded_outer, std::vector<float>& padded_inner) const;
+
+  // accessors
+  public:
+    [[nodiscard]] FORCEINLINE float& Outer(std::size_t x, std::size_t y) { return _outer[y * OUTER_DIM + x]; };
+    [[nodiscard]] FORCEINLINE float Outer(std::size_t x, std::size_t y) const { return _outer[y * OUTER_DIM + x]; };
+
+    [[nodiscard]] FORCEINLINE float& Inner(std::size_t x, std::size_t y) { return _inner[y * INNER_DIM + x]; };
+    [[nodiscard]] FORCEINLINE float Inner(std::size_t x, std::size_t y) const { return _inner[y * INNER_DIM + x]; };
+
+    [[nodiscard]] FORCEINLINE float* OuterRow(std::size_t y) { return _outer.data() + y * OUTER_DIM; };
+    [[nodiscard]] FORCEINLINE float const* OuterRow(std::size_t y) const { return _outer.data() + y * OUTER_DIM; };
+
+    [[nodiscard]] FORCEINLINE float* InnerRow(std::size_t y) { return _inner.data() + y * INNER_DIM; };
+    [[nodiscard]] FORCEINLINE float const* InnerRow(std::size_t y) const { return _inner.data() + y * INNER_DIM; };
+
+    [[nodiscard]] FORCEINLINE std::span<float> OuterGrid() { return _outer; };
+    [[nodiscard]] FORCEINLINE std::span<float const> OuterGrid() const { return _outer; };
+
+    [[nodiscard]] FORCEINLINE std::span<float> InnerGrid() { return _inner; };
+    [[nodiscard]] FORCEINLINE std::span<float const> InnerGrid() const { return _inner; };
+
+  private:
+    std::vector<float> _outer;
+    std::vector<float> _inner;
+  };
+
+  /**
+   * Rectangle of vertices in the outer grid of a tile (TileHeightfield), bounds are inclusive.
+   * Inner vertices adjacent to the rectangle are considered covered by it as well.
+   */
+  struct VertexRect
+  {
+    std::size_t x_min = 0;
+    std::size_t y_min = 0;
+    std::size_t x_max = TileHeightfield::OUTER_DIM - 1;
+    std::size_t y_max = TileHeightfield::OUTER_DIM - 1;
+  };
+
+  /**
+   * Heightfields of the 8 tiles surrounding a tile. nullptr for tiles that are not loaded or do not exist.
+   * Tile offsets are in grid directions: x grows with the column of chunks, y grows with the row of chunks.
+   */
+  struct TileNeighbours
+  {
+    std::array<std::array<TileHeightfield const*, 3>, 3> tiles {};
+
+    /**
+     * @param dx Horizontal offset of the tile (-1, 0 or 1).
+     * @param dy Vertical offset of the tile (-1, 0 or 1).
+     * @return Heightfield of the neighbouring tile or nullptr.
+     */
+    [[nodiscard]]
+    FORCEINLINE TileHeightfield const* Get(int dx, int dy) const { return tiles[dy + 1][dx + 1]; };
+
+    /**
+     * @param dx Horizontal offset of the tile (-1, 0 or 1).
+     * @param dy Vertical offset of the tile (-1, 0 or 1).
+     * @param tile Heightfield of the neighbouring tile or nullptr.
+     */
+    FORCEINLINE void Set(int dx, int dy, TileHeightfield const* tile) { tiles[dy + 1][dx + 1] = tile; };
+  };
+}
+
+#include <Terrain/TileHeightfield.inl>
@@ -0,0 +1,122 @@
+#pragma once
+#include <Terrain/TileHeightfield.hpp>
+#include <Terrain/Common.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline TileHeightfield::TileHeightfield(IO::ADT::ADTRoot<client_version> const& root)
+  : TileHeightfield()
+  {
+    Load(root);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileHeightfield::Load(IO::ADT::ADTRoot<client_version> const& root)
+  {
+    auto const& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      LoadChunk(i % CHUNKS_PER_ROW, i / CHUNKS_PER_ROW, chunks[i]);
+    }
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileHeightfield::Store(IO::ADT::ADTRoot<client_version>& root) const
+  {
+    auto& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      StoreChunk(i % CHUNKS_PER_ROW, i / CHUNKS_PER_ROW, chunks[i]);
+    }
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileHeightfield::LoadChunk(std::size_t chunk_x
+                                         , std::size_t chunk_y
+                                         , IO::ADT::MCNKRoot<client_version> const& chunk)
+  {
+    RequireF(CCodeZones::TERRAIN, chunk_x < CHUNKS_PER_ROW && chunk_y < CHUNKS_PER_ROW, "Chunk index out of bounds.");
+    RequireF(CCodeZones::TERRAIN, chunk.Heightmap().IsInitialized(), "Chunk has no heightmap (MCVT).");
+
+    float const base = chunk.Header().position.z;
+    float const* heights = &*chunk.Heightmap().cbegin();
+
+    std::size_t const x0 = chunk_x * CHUNK_INNER_DIM;
+    std::size_t const y0 = chunk_y * CHUNK_INNER_DIM;
+
+    // MCVT interleaves rows of 9 outer and 8 inner vertices
+    for (std::size_t row = 0; row < CHUNK_OUTER_DIM; ++row)
+    {
+      float const* src_outer = heights + row * (CHUNK_OUTER_DIM + CHUNK_INNER_DIM);
+      float* dst_outer = OuterRow(y0 + row) + x0;
+
+      for (std::size_t col = 0; col < CHUNK_OUTER_DIM; ++col)
+      {
+        dst_outer[col] = src_outer[col] + base;
+      }
+
+      if (row == CHUNK_INNER_DIM)
+        break;
+
+      float const* src_inner = src_outer + CHUNK_OUTER_DIM;
+      float* dst_inner = InnerRow(y0 + row) + x0;
+
+      for (std::size_t col = 0; col < CHUNK_INNER_DIM; ++col)
+      {
+        dst_inner[col] = src_inner[col] + base;
+      }
+    }
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileHeightfield::StoreChunk(std::size_t chunk_x
+                                          , std::size_t chunk_y
+                                          , IO::ADT::MCNKRoot<client_version>& chunk) const
+  {
+    RequireF(CCodeZones::TERRAIN, chunk_x < CHUNKS_PER_ROW && chunk_y < CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+    if (!chunk.Heightmap().IsInitialized())
+    {
+      chunk.Heightmap().Initialize();
+    }
+
+    float const base = chunk.Header().position.z;
+
+    // non-const iterator invalidates the cached hash of the heightmap once
+    float* heights = &*chunk.Heightmap().begin();
+
+    std::size_t const x0 = chunk_x * CHUNK_INNER_DIM;
+    std::size_t const y0 = chunk_y * CHUNK_INNER_DIM;
+
+    for (std::size_t row = 0; row < CHUNK_OUTER_DIM; ++row)
+    {
+      float const* src_outer = OuterRow(y0 + row) + x0;
+      float* dst_outer = heights + row * (CHUNK_OUTER_DIM + CHUNK_INNER_DIM);
+
+      for (std::size_t col = 0; col < CHUNK_OUTER_DIM; ++col)
+      {
+        dst_outer[col] = src_outer[col] - base;
+      }
+
+      if (row == CHUNK_INNER_DIM)
+        break;
+
+      float const* src_inner = InnerRow(y0 + row) + x0;
+      float* dst_inner = dst_outer + CHUNK_OUTER_DIM;
+
+      for (std::size_t col = 0; col < CHUNK_INNER_DIM; ++col)
+      {
+        dst_inner[col] = src_inner[col] - base;
+      }
+    }
+  }
+}
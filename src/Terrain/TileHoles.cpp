@@ -0,0 +1,260 @@
+#include <Terrain/TileHoles.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace Terrain;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr float VERTEX_SPACING = IO::Common::WorldConstants::CHUNK_SIZE / TileHoles::QUADS_PER_CHUNK_ROW;
+  constexpr std::uint64_t BYTE_BROADCAST = 0x0101010101010101;
+
+  // each bit of a low resolution row covers two columns
+  constexpr std::array<std::uint8_t, 16> NIBBLE_EXPANSION
+  {
+    0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F
+    , 0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF
+  };
+
+  // columns first to last of a chunk row, inclusive
+  FORCEINLINE std::uint64_t ColumnMask(std::size_t first, std::size_t last)
+  {
+    return (0xFFu >> (7 - last)) & (0xFFu << first);
+  }
+
+  // rows first to last of a chunk, inclusive
+  FORCEINLINE std::uint64_t RowMask(std::size_t first, std::size_t last)
+  {
+    return (~std::uint64_t{0} >> (56 - last * 8)) & (~std::uint64_t{0} << (first * 8));
+  }
+}
+
+TileHoles::TileHoles()
+: _masks{}
+, _dirty{}
+{
+}
+
+void TileHoles::StoreChunk(std::size_t chunk_x
+                           , std::size_t chunk_y
+                           , IO::ADT::DataStructures::SMChunk& header
+                           , HoleResolution resolution
+                           , HoleReduction reduction) const
+{
+  RequireF(CCodeZones::TERRAIN, chunk_x < CHUNKS_PER_ROW && chunk_y < CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+  std::uint64_t const mask = ChunkMask(chunk_x, chunk_y);
+
+  if (resolution == HoleResolution::High)
+  {
+    header.flags.high_res_holes = 1;
+    header.holes_high_res = mask;
+    header.holes_low_res = 0;
+  }
+  else
+  {
+    header.flags.high_res_holes = 0;
+    header.holes_high_res = 0;
+    header.holes_low_res = Reduce(mask, reduction);
+  }
+}
+
+bool TileHoles::IsHole(C2Vector origin, C2Vector position) const
+{
+  // grid x runs along world -Y, grid y runs along world -X
+  float const grid_x = (origin.y - position.y) / VERTEX_SPACING;
+  float const grid_y = (origin.x - position.x) / VERTEX_SPACING;
+
+  auto const max = static_cast<float>(QUADS_PER_ROW);
+
+  if (!(grid_x >= 0.f && grid_x <= max && grid_y >= 0.f && grid_y <= max))
+    return false;
+
+  return IsHole(std::min(static_cast<std::size_t>(grid_x), QUADS_PER_ROW - 1)
+                , std::min(static_cast<std::size_t>(grid_y), QUADS_PER_ROW - 1));
+}
+
+void TileHoles::SetRect(QuadRect const& rect, bool hole)
+{
+  RequireF(CCodeZones::TERRAIN, rect.x_min <= rect.x_max && rect.y_min <= rect.y_max
+           && rect.x_max < QUADS_PER_ROW && rect.y_max < QUADS_PER_ROW, "Invalid quad rectangle.");
+
+  for (std::size_t chunk_y = rect.y_min / QUADS_PER_CHUNK_ROW; chunk_y <= rect.y_max / QUADS_PER_CHUNK_ROW; ++chunk_y)
+  {
+    std::size_t const base_y = chunk_y * QUADS_PER_CHUNK_ROW;
+    std::uint64_t const rows = RowMask(std::max(rect.y_min, base_y) - base_y
+                                       , std::min(rect.y_max, base_y + QUADS_PER_CHUNK_ROW - 1) - base_y);
+
+    for (std::size_t chunk_x = rect.x_min / QUADS_PER_CHUNK_ROW; chunk_x <= rect.x_max / QUADS_PER_CHUNK_ROW; ++chunk_x)
+    {
+      std::size_t const base_x = chunk_x * QUADS_PER_CHUNK_ROW;
+      std::uint64_t const columns = ColumnMask(std::max(rect.x_min, base_x) - base_x
+                                               , std::min(rect.x_max, base_x + QUADS_PER_CHUNK_ROW - 1) - base_x);
+
+      Update(chunk_y * CHUNKS_PER_ROW + chunk_x, columns * BYTE_BROADCAST & rows, hole);
+    }
+  }
+}
+
+void TileHoles::SetPolygon(std::span<C2Vector const> polygon, C2Vector origin, bool hole)
+{
+  RequireF(CCodeZones::TERRAIN, polygon.size() >= 3, "Polygon must have at least 3 vertices.");
+
+  // polygon in grid space, one unit per quad
+  std::vector<C2Vector> grid (polygon.size());
+  float min_y = std::numeric_limits<float>::max();
+  float max_y = std::numeric_limits<float>::lowest();
+
+  for (std::size_t i = 0; i < polygon.size(); ++i)
+  {
+    grid[i] = { (origin.y - polygon[i].y) / VERTEX_SPACING, (origin.x - polygon[i].x) / VERTEX_SPACING };
+    min_y = std::min(min_y, grid[i].y);
+    max_y = std::max(max_y, grid[i].y);
+  }
+
+  auto const max = static_cast<float>(QUADS_PER_ROW);
+
+  if (max_y < 0.f || min_y > max)
+    return;
+
+  // rows whose quad centers lie within the vertical extent of the polygon
+  auto const first_row = static_cast<std::size_t>(std::max(std::ceil(min_y - 0.5f), 0.f));
+  auto const last_row = static_cast<std::size_t>(std::clamp(std::floor(max_y - 0.5f), -1.f, max - 1.f) + 1.f);
+
+  std::vector<float> crossings;
+  crossings.reserve(polygon.size());
+
+  for (std::size_t y = first_row; y < last_row; ++y)
+  {
+    float const center_y = static_cast<float>(y) + 0.5f;
+    crossings.clear();
+
+    for (std::size_t i = 0, j = grid.size() - 1; i < grid.size(); j = i++)
+    {
+      C2Vector const& a = grid[i];
+      C2Vector const& b = grid[j];
+
+      // half-open rule, so that vertices on the scanline are counted once
+      if ((a.y <= center_y) != (b.y <= center_y))
+      {
+        crossings.push_back(a.x + (center_y - a.y) * (b.x - a.x) / (b.y - a.y));
+      }
+    }
+
+    std::sort(crossings.begin(), crossings.end());
+
+    for (std::size_t k = 0; k + 1 < crossings.size(); k += 2)
+    {
+      // quads whose center lies within [begin, end)
+      float const begin = std::max(std::ceil(crossings[k] - 0.5f), 0.f);
+      float const end = std::min(std::ceil(crossings[k + 1] - 0.5f), max);
+
+      if (begin < end)
+      {
+        SetSpan(y, static_cast<std::size_t>(begin), static_cast<std::size_t>(end) - 1, hole);
+      }
+    }
+  }
+}
+
+void TileHoles::SnapToLowRes(HoleReduction reduction)
+{
+  for (std::size_t i = 0; i < _masks.size(); ++i)
+  {
+    std::uint64_t const snapped = Expand(Reduce(_masks[i], reduction));
+
+    if (snapped != _masks[i])
+    {
+      _masks[i] = snapped;
+      _dirty.set(i);
+    }
+  }
+}
+
+std::size_t TileHoles::CountHoles() const
+{
+  std::size_t n_holes = 0;
+
+  for (std::uint64_t mask : _masks)
+  {
+    n_holes += static_cast<std::size_t>(std::popcount(mask));
+  }
+
+  return n_holes;
+}
+
+std::uint64_t TileHoles::Decode(IO::ADT::DataStructures::SMChunk const& header)
+{
+  return header.flags.high_res_holes ? header.holes_high_res : Expand(header.holes_low_res);
+}
+
+std::uint64_t TileHoles::Expand(std::uint16_t mask)
+{
+  std::uint64_t result = 0;
+
+  // each low resolution row covers two rows
+  for (std::size_t row = 0; row < 4; ++row)
+  {
+    std::uint64_t const byte = NIBBLE_EXPANSION[(mask >> (row * 4)) & 0xF];
+    result |= (byte * 0x0101) << (row * 16);
+  }
+
+  return result;
+}
+
+std::uint16_t TileHoles::Reduce(std::uint64_t mask, HoleReduction reduction)
+{
+  // fold odd rows into even rows, then odd columns into even columns
+  if (reduction == HoleReduction::Any)
+  {
+    mask |= mask >> 8;
+    mask |= mask >> 1;
+  }
+  else
+  {
+    mask &= mask >> 8;
+    mask &= mask >> 1;
+  }
+
+  // gather bits (2 * row, 2 * column) to row * 4 + column
+  mask &= 0x0055005500550055;
+  mask = (mask | mask >> 1) & 0x0033003300330033;
+  mask = (mask | mask >> 2) & 0x000F000F000F000F;
+  mask = (mask | mask >> 12) & 0x000000FF000000FF;
+  mask = (mask | mask >> 24) & 0xFFFF;
+
+  return static_cast<std::uint16_t>(mask);
+}
+
+void TileHoles::SetSpan(std::size_t quad_y, std::size_t x_min, std::size_t x_max, bool hole)
+{
+  std::size_t const chunk_y = quad_y / QUADS_PER_CHUNK_ROW;
+  std::size_t const shift = (quad_y % QUADS_PER_CHUNK_ROW) * QUADS_PER_CHUNK_ROW;
+
+  for (std::size_t chunk_x = x_min / QUADS_PER_CHUNK_ROW; chunk_x <= x_max / QUADS_PER_CHUNK_ROW; ++chunk_x)
+  {
+    std::size_t const base_x = chunk_x * QUADS_PER_CHUNK_ROW;
+    std::uint64_t const columns = ColumnMask(std::max(x_min, base_x) - base_x
+                                             , std::min(x_max, base_x + QUADS_PER_CHUNK_ROW - 1) - base_x);
+
+    Update(chunk_y * CHUNKS_PER_ROW + chunk_x, columns << shift, hole);
+  }
+}
+
+void TileHoles::Update(std::size_t chunk, std::uint64_t mask, bool hole)
+{
+  std::uint64_t const updated = hole ? _masks[chunk] | mask : _masks[chunk] & ~mask;
+
+  if (updated != _masks[chunk])
+  {
+    _masks[chunk] = updated;
+    _dirty.set(chunk);
+  }
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <span>
+
+namespace Terrain
+{
+  enum class HoleResolution
+  {
+    Low = 0,        ///> 4x4 bits per chunk (holes_low_res), a bit per 2x2 quads.
+    High = 1        ///> 8x8 bits per chunk (holes_high_res, flags.high_res_holes), since MoP.
+  };
+
+  enum class HoleReduction
+  {
+    Any = 0,        ///> A low resolution hole covers 2x2 quads of which any is a hole.
+    All = 1         ///> A low resolution hole covers 2x2 quads of which all are holes.
+  };
+
+  /**
+   * Rectangle of quads of a tile, bounds are inclusive. Quad (x, y) lies between outer vertices (x, y) and
+   * (x + 1, y + 1) of TileHeightfield.
+   */
+  struct QuadRect
+  {
+    std::size_t x_min = 0;
+    std::size_t y_min = 0;
+    std::size_t x_max = 127;
+    std::size_t y_max = 127;
+  };
+
+  /**
+   * Tile-wide hole masks of an ADT.
+   * Holes of each chunk are stored expanded to high resolution as a 64-bit word (bit row * 8 + column set for a hole
+   * quad), the layout of SMChunk::holes_high_res. Edits build masks of the rows and columns they cover and update each
+   * chunk they touch with a single word operation. Edits mark the chunks they modify as dirty, and only dirty chunks
+   * are written back on store.
+   */
+  class TileHoles
+  {
+  public:
+    static constexpr std::size_t QUADS_PER_CHUNK_ROW = 8;
+    static constexpr std::size_t CHUNKS_PER_ROW = 16;
+    static constexpr std::size_t QUADS_PER_ROW = CHUNKS_PER_ROW * QUADS_PER_CHUNK_ROW;
+
+    /**
+     * Constructs masks without holes.
+     */
+    TileHoles();
+
+    /**
+     * Constructs masks from the chunk headers of an ADT root file.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    explicit TileHoles(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Loads masks from the chunk headers of an ADT root file and clears dirty chunks.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Load(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Stores masks into the headers of the dirty chunks of an ADT root file and clears dirty chunks. High resolution
+     * is used from MoP on, low resolution before.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param reduction Reduction of masks to low resolution, if used.
+     * @return Number of chunks stored.
+     */
+    template<IO::Common::ClientVersion client_version>
+    std::size_t Store(IO::ADT::ADTRoot<client_version>& root, HoleReduction reduction = HoleReduction::Any);
+
+    /**
+     * Stores masks into the headers of the dirty chunks of an ADT root file and clears dirty chunks.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param resolution Resolution written into the headers, low resolution is lossy.
+     * @param reduction Reduction of masks to low resolution, if used.
+     * @return Number of chunks stored.
+     */
+    template<IO::Common::ClientVersion client_version>
+    std::size_t Store(IO::ADT::ADTRoot<client_version>& root, HoleResolution resolution, HoleReduction reduction);
+
+    /**
+     * Writes the mask of a chunk into its header.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param header Header of the chunk.
+     * @param resolution Resolution written into the header.
+     * @param reduction Reduction of the mask to low resolution, if used.
+     */
+    void StoreChunk(std::size_t chunk_x
+                    , std::size_t chunk_y
+                    , IO::ADT::DataStructures::SMChunk& header
+                    , HoleResolution resolution
+                    , HoleReduction reduction) const;
+
+    /**
+     * Checks whether a point lies in a hole.
+     * @param origin World position of the first outer vertex of the tile (MCNK position of the first chunk).
+     * @param position World position of the point.
+     * @return True if the point lies within a hole quad, false if it lies outside of the tile.
+     */
+    [[nodiscard]]
+    bool IsHole(IO::Common::DataStructures::C2Vector origin, IO::Common::DataStructures::C2Vector position) const;
+
+    /**
+     * Sets or clears holes within a rectangle of quads.
+     * @param rect Rectangle of quads, whole tile by default.
+     * @param hole True to set holes, false to clear them.
+     */
+    void SetRect(QuadRect const& rect, bool hole);
+
+    /**
+     * Sets or clears holes of quads whose center lies within a polygon (even-odd rule).
+     * @param polygon Vertices of the polygon in world coordinates, implicitly closed.
+     * @param origin World position of the first outer vertex of the tile (MCNK position of the first chunk).
+     * @param hole True to set holes, false to clear them.
+     */
+    void SetPolygon(std::span<IO::Common::DataStructures::C2Vector const> polygon
+                    , IO::Common::DataStructures::C2Vector origin
+                    , bool hole);
+
+    /**
+     * Snaps masks of all chunks to low resolution, so that storing them at low resolution is lossless.
+     * @param reduction Reduction of the masks.
+     */
+    void SnapToLowRes(HoleReduction reduction);
+
+    /**
+     * @return Number of hole quads in the tile.
+     */
+    [[nodiscard]]
+    std::size_t CountHoles() const;
+
+    /**
+     * High resolution hole mask of a chunk (bit row * 8 + column is set for a hole quad).
+     * Low resolution masks (a bit per 2x2 quads) are expanded.
+     * @param header Chunk header.
+     * @return Hole mask.
+     */
+    [[nodiscard]]
+    static std::uint64_t Decode(IO::ADT::DataStructures::SMChunk const& header);
+
+    /**
+     * Expands a low resolution mask to high resolution.
+     * @param mask Low resolution mask (bit row * 4 + column).
+     * @return High resolution mask.
+     */
+    [[nodiscard]]
+    static std::uint64_t Expand(std::uint16_t mask);
+
+    /**
+     * Reduces a high resolution mask to low resolution.
+     * @param mask High resolution mask.
+     * @param reduction Whether any or all of 2x2 quads must be holes.
+     * @return Low resolution mask (bit row * 4 + column).
+     */
+    [[nodiscard]]
+    static std::uint16_t Reduce(std::uint64_t mask, HoleReduction reduction);
+
+  // accessors
+  public:
+    [[nodiscard]] FORCEINLINE bool IsHole(std::size_t quad_x, std::size_t quad_y) const
+    {
+      std::size_t const chunk = (quad_y / QUADS_PER_CHUNK_ROW) * CHUNKS_PER_ROW + quad_x / QUADS_PER_CHUNK_ROW;
+      return (_masks[chunk] >> ((quad_y % QUADS_PER_CHUNK_ROW) * QUADS_PER_CHUNK_ROW + quad_x % QUADS_PER_CHUNK_ROW)) & 1;
+    };
+
+    [[nodiscard]] FORCEINLINE std::uint64_t ChunkMask(std::size_t chunk_x, std::size_t chunk_y) const
+    {
+      return _masks[chunk_y * CHUNKS_PER_ROW + chunk_x];
+    };
+
+    /**
+     * Masks of all chunks, chunk (x, y) at y * 16 + x, as expected by TileRaycaster.
+     */
+    [[nodiscard]] FORCEINLINE std::span<std::uint64_t const, IO::Common::WorldConstants::CHUNKS_PER_TILE> Masks() const
+    {
+      return _masks;
+    };
+
+    /**
+     * Chunks modified since the last load or store, chunk (x, y) is bit y * 16 + x. May be set to force a store.
+     */
+    [[nodiscard]] FORCEINLINE auto& DirtyChunks() { return _dirty; };
+    [[nodiscard]] FORCEINLINE auto const& DirtyChunks() const { return _dirty; };
+
+  private:
+    // sets or clears the quads of a row between two columns, inclusive
+    void SetSpan(std::size_t quad_y, std::size_t x_min, std::size_t x_max, bool hole);
+
+    void Update(std::size_t chunk, std::uint64_t mask, bool hole);
+
+    std::array<std::uint64_t, IO::Common::WorldConstants::CHUNKS_PER_TILE> _masks;
+    std::bitset<IO::Common::WorldConstants::CHUNKS_PER_TILE> _dirty;
+  };
+}
+
+#include <Terrain/TileHoles.inl>
@@ -0,0 +1,63 @@
+#pragma once
+#include <Terrain/TileHoles.hpp>
+#include <Terrain/Common.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline TileHoles::TileHoles(IO::ADT::ADTRoot<client_version> const& root)
+  : TileHoles()
+  {
+    Load(root);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileHoles::Load(IO::ADT::ADTRoot<client_version> const& root)
+  {
+    auto const& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      _masks[i] = Decode(chunks[i].Header());
+    }
+
+    _dirty.reset();
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline std::size_t TileHoles::Store(IO::ADT::ADTRoot<client_version>& root, HoleReduction reduction)
+  {
+    constexpr HoleResolution resolution = client_version >= IO::Common::ClientVersion::MOP
+      ? HoleResolution::High : HoleResolution::Low;
+
+    return Store(root, resolution, reduction);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline std::size_t TileHoles::Store(IO::ADT::ADTRoot<client_version>& root
+                                      , HoleResolution resolution
+                                      , HoleReduction reduction)
+  {
+    auto& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    std::size_t n_stored = 0;
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      if (!_dirty.test(i))
+        continue;
+
+      StoreChunk(i % CHUNKS_PER_ROW, i / CHUNKS_PER_ROW, chunks[i].Header(), resolution, reduction);
+      ++n_stored;
+    }
+
+    _dirty.reset();
+    return n_stored;
+  }
+}
@@ -0,0 +1,279 @@
+#include <Terrain/TileLiquidIndex.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+
+using namespace Terrain;
+using namespace Utils::Misc::SIMD;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr float VERTEX_SPACING = IO::Common::WorldConstants::CHUNK_SIZE / TileHeightfield::CHUNK_INNER_DIM;
+  constexpr std::size_t CHUNK_VERTICES = TileLiquidIndex::CHUNK_VERTEX_DIM * TileLiquidIndex::CHUNK_VERTEX_DIM;
+
+  // batches are processed in blocks small enough for their intermediate arrays to stay on the stack
+  constexpr std::size_t BLOCK_SIZE = 64;
+
+  // corners of the quad of each position of a block, in structure of arrays layout for interpolation
+  struct Corners
+  {
+    std::array<float, BLOCK_SIZE> h00;
+    std::array<float, BLOCK_SIZE> h10;
+    std::array<float, BLOCK_SIZE> h01;
+    std::array<float, BLOCK_SIZE> h11;
+    std::array<float, BLOCK_SIZE> d00;
+    std::array<float, BLOCK_SIZE> d10;
+    std::array<float, BLOCK_SIZE> d01;
+    std::array<float, BLOCK_SIZE> d11;
+  };
+
+  template<typename V>
+  FORCEINLINE V Bilinear(V v00, V v10, V v01, V v11, V fx, V fy)
+  {
+    V const v0 = v00 + (v10 - v00) * fx;
+    V const v1 = v01 + (v11 - v01) * fx;
+    return v0 + (v1 - v0) * fy;
+  }
+}
+
+TileLiquidIndex::TileLiquidIndex()
+: _origin{0.f, 0.f}
+{
+}
+
+void TileLiquidIndex::Build(IO::ADT::MH2O const& liquids, C2Vector origin)
+{
+  _origin = origin;
+  _planes.clear();
+
+  if (!liquids.IsInitialized())
+    return;
+
+  auto const& chunks = liquids.chunks();
+
+  for (std::size_t i = 0; i < chunks.size(); ++i)
+  {
+    UpdateChunk(chunks[i], i);
+  }
+}
+
+void TileLiquidIndex::Update(IO::ADT::MH2O const& liquids, std::size_t chunk_x, std::size_t chunk_y)
+{
+  RequireF(CCodeZones::TERRAIN, chunk_x < TileHeightfield::CHUNKS_PER_ROW
+           && chunk_y < TileHeightfield::CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+  std::size_t const chunk_index = chunk_y * TileHeightfield::CHUNKS_PER_ROW + chunk_x;
+
+  if (!liquids.IsInitialized())
+  {
+    UpdateChunk(IO::ADT::LiquidChunk{}, chunk_index);
+    return;
+  }
+
+  UpdateChunk(liquids.chunks()[chunk_index], chunk_index);
+}
+
+void TileLiquidIndex::UpdateChunk(IO::ADT::LiquidChunk const& chunk, std::size_t chunk_index)
+{
+  auto const& layers = chunk.Layers();
+
+  while (_planes.size() < layers.size())
+  {
+    Plane& plane = _planes.emplace_back();
+    plane.exists.fill(0);
+    plane.liquid_types.fill(0);
+    plane.heights.resize(IO::Common::WorldConstants::CHUNKS_PER_TILE * CHUNK_VERTICES);
+    plane.depths.resize(IO::Common::WorldConstants::CHUNKS_PER_TILE * CHUNK_VERTICES);
+  }
+
+  for (std::size_t i = 0; i < _planes.size(); ++i)
+  {
+    Plane& plane = _planes[i];
+
+    if (i >= layers.size())
+    {
+      plane.exists[chunk_index] = 0;
+      continue;
+    }
+
+    IO::ADT::LiquidLayer const& layer = layers[i];
+
+    plane.exists[chunk_index] = layer.ExistsMap();
+    plane.liquid_types[chunk_index] = layer.liquid_type;
+
+    float* heights = plane.heights.data() + chunk_index * CHUNK_VERTICES;
+    std::uint8_t* depths = plane.depths.data() + chunk_index * CHUNK_VERTICES;
+
+    std::fill_n(heights, CHUNK_VERTICES, layer.min_height_level);
+    std::fill_n(depths, CHUNK_VERTICES, std::uint8_t{0});
+
+    auto const layer_heights = layer.Heights();
+    auto const layer_depths = layer.Depths();
+
+    // vertex data covers the liquid rectangle only
+    std::size_t const row_size = layer.width + 1u;
+
+    for (std::size_t y = 0; y <= layer.height; ++y)
+    {
+      std::size_t const dst = (layer.y_offset + y) * CHUNK_VERTEX_DIM + layer.x_offset;
+
+      if (!layer_heights.empty())
+      {
+        std::copy_n(layer_heights.data() + y * row_size, row_size, heights + dst);
+      }
+
+      if (!layer_depths.empty())
+      {
+        std::copy_n(layer_depths.data() + y * row_size, row_size, depths + dst);
+      }
+    }
+  }
+
+  // drop trailing planes that no longer hold any liquid
+  while (!_planes.empty() && std::all_of(_planes.back().exists.begin(), _planes.back().exists.end()
+                                         , [](std::uint64_t mask) { return mask == 0; }))
+  {
+    _planes.pop_back();
+  }
+}
+
+bool TileLiquidIndex::FindCell(std::size_t quad_x, std::size_t quad_y, Cell& cell) const
+{
+  std::size_t const chunk_index = (quad_y / CHUNK_DIM) * TileHeightfield::CHUNKS_PER_ROW + quad_x / CHUNK_DIM;
+  std::size_t const bit = (quad_y % CHUNK_DIM) * CHUNK_DIM + quad_x % CHUNK_DIM;
+
+  for (std::size_t i = 0; i < _planes.size(); ++i)
+  {
+    Plane const& plane = _planes[i];
+
+    if (!((plane.exists[chunk_index] >> bit) & 1))
+      continue;
+
+    cell.plane = static_cast<std::uint32_t>(i);
+    cell.vertex = static_cast<std::uint32_t>(chunk_index * CHUNK_VERTICES
+      + (quad_y % CHUNK_DIM) * CHUNK_VERTEX_DIM + quad_x % CHUNK_DIM);
+    cell.liquid_type = plane.liquid_types[chunk_index];
+    return true;
+  }
+
+  return false;
+}
+
+std::optional<LiquidSample> TileLiquidIndex::Sample(float x, float y) const
+{
+  LiquidSample sample {};
+  Sample({&x, 1}, {&y, 1}, {&sample, 1});
+
+  if (!sample.exists)
+    return std::nullopt;
+
+  return sample;
+}
+
+void TileLiquidIndex::Sample(std::span<float const> x, std::span<float const> y, std::span<LiquidSample> samples) const
+{
+  RequireF(CCodeZones::TERRAIN, x.size() == y.size() && x.size() == samples.size()
+           , "Expected as many samples as positions.");
+
+  auto const max = static_cast<float>(N_QUADS_PER_ROW);
+
+  std::array<float, BLOCK_SIZE> grid_x;
+  std::array<float, BLOCK_SIZE> grid_y;
+  std::array<float, BLOCK_SIZE> heights;
+  std::array<float, BLOCK_SIZE> depths;
+  Corners corners;
+
+  for (std::size_t begin = 0; begin < x.size(); begin += BLOCK_SIZE)
+  {
+    std::size_t const n = std::min(BLOCK_SIZE, x.size() - begin);
+
+    // grid x runs along world -Y, grid y runs along world -X
+    ForRange(0, n, [&]<typename V>(V, std::size_t i) -> void
+    {
+      V const scale = Broadcast<V>(1.f / VERTEX_SPACING);
+      Store(grid_x.data() + i, (Broadcast<V>(_origin.y) - Load<V>(y.data() + begin + i)) * scale);
+      Store(grid_y.data() + i, (Broadcast<V>(_origin.x) - Load<V>(x.data() + begin + i)) * scale);
+    });
+
+    // gather corners of the quad of each position, grid coordinates become offsets within the quad
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      LiquidSample& sample = samples[begin + i];
+      Cell cell {};
+
+      sample.exists = grid_x[i] >= 0.f && grid_x[i] <= max && grid_y[i] >= 0.f && grid_y[i] <= max;
+
+      if (sample.exists)
+      {
+        std::size_t const quad_x = std::min(static_cast<std::size_t>(grid_x[i]), N_QUADS_PER_ROW - 1);
+        std::size_t const quad_y = std::min(static_cast<std::size_t>(grid_y[i]), N_QUADS_PER_ROW - 1);
+
+        grid_x[i] -= static_cast<float>(quad_x);
+        grid_y[i] -= static_cast<float>(quad_y);
+
+        sample.exists = FindCell(quad_x, quad_y, cell);
+      }
+
+      if (!sample.exists)
+      {
+        // output may be reused across queries, a miss must not report the type of a previous hit
+        sample.liquid_type = 0;
+        corners.h00[i] = corners.h10[i] = corners.h01[i] = corners.h11[i] = 0.f;
+        corners.d00[i] = corners.d10[i] = corners.d01[i] = corners.d11[i] = 0.f;
+        continue;
+      }
+
+      Plane const& plane = _planes[cell.plane];
+      float const* h = plane.heights.data() + cell.vertex;
+      std::uint8_t const* d = plane.depths.data() + cell.vertex;
+
+      corners.h00[i] = h[0];
+      corners.h10[i] = h[1];
+      corners.h01[i] = h[CHUNK_VERTEX_DIM];
+      corners.h11[i] = h[CHUNK_VERTEX_DIM + 1];
+      corners.d00[i] = d[0];
+      corners.d10[i] = d[1];
+      corners.d01[i] = d[CHUNK_VERTEX_DIM];
+      corners.d11[i] = d[CHUNK_VERTEX_DIM + 1];
+
+      sample.liquid_type = cell.liquid_type;
+    }
+
+    ForRange(0, n, [&]<typename V>(V, std::size_t i) -> void
+    {
+      V const fx = Load<V>(grid_x.data() + i);
+      V const fy = Load<V>(grid_y.data() + i);
+
+      Store(heights.data() + i, Bilinear(Load<V>(corners.h00.data() + i), Load<V>(corners.h10.data() + i)
+                                         , Load<V>(corners.h01.data() + i), Load<V>(corners.h11.data() + i), fx, fy));
+      Store(depths.data() + i, Bilinear(Load<V>(corners.d00.data() + i), Load<V>(corners.d10.data() + i)
+                                        , Load<V>(corners.d01.data() + i), Load<V>(corners.d11.data() + i), fx, fy));
+    });
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      samples[begin + i].height = heights[i];
+      samples[begin + i].depth = depths[i];
+    }
+  }
+}
+
+std::uint64_t TileLiquidIndex::ChunkMask(std::size_t chunk_x, std::size_t chunk_y) const
+{
+  RequireF(CCodeZones::TERRAIN, chunk_x < TileHeightfield::CHUNKS_PER_ROW
+           && chunk_y < TileHeightfield::CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+  std::size_t const chunk_index = chunk_y * TileHeightfield::CHUNKS_PER_ROW + chunk_x;
+  std::uint64_t mask = 0;
+
+  for (Plane const& plane : _planes)
+  {
+    mask |= plane.exists[chunk_index];
+  }
+
+  return mask;
+}
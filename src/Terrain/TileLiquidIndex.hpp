@@ -0,0 +1,137 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <IO/ADT/Root/MH2O.hpp>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Terrain
+{
+  /**
+   * Liquid at a position of a tile.
+   */
+  struct LiquidSample
+  {
+    float height;                 ///> Height of the liquid surface, interpolated bilinearly within the quad.
+    float depth;                  ///> Depth interpolated bilinearly within the quad, 0 if the layer has no depths.
+    std::uint16_t liquid_type;    ///> LiquidType.dbc ID.
+    bool exists;                  ///> False if there is no liquid at the position, liquid_type is then 0.
+  };
+
+  /**
+   * Query structure answering which liquid covers a position of a tile, and at which height.
+   * Layers of the MH2O chunk are flattened into planes: the n-th layer of every chunk lives in the n-th plane, which
+   * holds a presence bitmask per chunk (bit row * 8 + column is set for an existing quad, as in hole masks), the
+   * liquid type per chunk, and heights and depths of the 9x9 vertices of each chunk. Vertices outside the liquid
+   * rectangle of a layer are never read. Layers without heights are flat at their minimum height level.
+   * If several layers cover a quad, the one coming first in its chunk is reported.
+   */
+  class TileLiquidIndex
+  {
+  public:
+    static constexpr std::size_t N_QUADS_PER_ROW = TileHeightfield::INNER_DIM;
+    static constexpr std::size_t CHUNK_DIM = TileHeightfield::CHUNK_INNER_DIM;
+    static constexpr std::size_t CHUNK_VERTEX_DIM = CHUNK_DIM + 1;
+
+    /**
+     * Constructs an index of a tile without liquids at origin 0.
+     */
+    TileLiquidIndex();
+
+    /**
+     * Constructs an index from an ADT root file.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    explicit TileLiquidIndex(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Builds the index from an ADT root file. Origin of the tile is taken from the first chunk.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Build(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Builds the index from liquids of a tile.
+     * @param liquids Liquids of the tile, an uninitialized chunk has no liquid.
+     * @param origin World position of the first outer vertex (MCNK position of the first chunk).
+     */
+    void Build(IO::ADT::MH2O const& liquids, IO::Common::DataStructures::C2Vector origin);
+
+    /**
+     * Updates the index after liquids of a chunk were edited. Other chunks are left untouched.
+     * @param liquids Liquids of the tile.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     */
+    void Update(IO::ADT::MH2O const& liquids, std::size_t chunk_x, std::size_t chunk_y);
+
+    /**
+     * Samples liquid at a world position.
+     * @param x World X coordinate.
+     * @param y World Y coordinate.
+     * @return Liquid at the position, or nothing if there is none or the position is outside of the tile.
+     */
+    [[nodiscard]]
+    std::optional<LiquidSample> Sample(float x, float y) const;
+
+    /**
+     * Samples liquid at a batch of world positions. Grid coordinates and interpolation are vectorized.
+     * @param x World X coordinates.
+     * @param y World Y coordinates, must be the same size as x.
+     * @param samples Liquid at each position, must be the same size as x. Samples are overwritten, misses included.
+     */
+    void Sample(std::span<float const> x, std::span<float const> y, std::span<LiquidSample> samples) const;
+
+    /**
+     * Presence bitmask of a chunk over all of its layers.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @return Bit row * 8 + column is set if any liquid covers the quad.
+     */
+    [[nodiscard]]
+    std::uint64_t ChunkMask(std::size_t chunk_x, std::size_t chunk_y) const;
+
+  // accessors
+  public:
+    [[nodiscard]]
+    std::size_t NumPlanes() const { return _planes.size(); };
+
+  private:
+    // liquid covering a quad
+    struct Cell
+    {
+      std::uint32_t plane;
+      std::uint32_t vertex;   ///> Index of the first corner in the plane's vertex arrays.
+      std::uint16_t liquid_type;
+    };
+
+    struct Plane
+    {
+      std::array<std::uint64_t, IO::Common::WorldConstants::CHUNKS_PER_TILE> exists;
+      std::array<std::uint16_t, IO::Common::WorldConstants::CHUNKS_PER_TILE> liquid_types;
+      std::vector<float> heights;       ///> 9x9 vertices per chunk, chunks in row-major order.
+      std::vector<std::uint8_t> depths;
+    };
+
+    [[nodiscard]]
+    bool FindCell(std::size_t quad_x, std::size_t quad_y, Cell& cell) const;
+
+    void UpdateChunk(IO::ADT::LiquidChunk const& chunk, std::size_t chunk_index);
+
+    IO::Common::DataStructures::C2Vector _origin;
+    std::vector<Plane> _planes;
+  };
+}
+
+#include <Terrain/TileLiquidIndex.inl>
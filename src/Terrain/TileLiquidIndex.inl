@@ -0,0 +1,26 @@
+#pragma once
+#include <Terrain/TileLiquidIndex.hpp>
+#include <Terrain/Common.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline TileLiquidIndex::TileLiquidIndex(IO::ADT::ADTRoot<client_version> const& root)
+  : TileLiquidIndex()
+  {
+    Build(root);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileLiquidIndex::Build(IO::ADT::ADTRoot<client_version> const& root)
+  {
+    auto const& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    auto const& position = chunks[0].Header().position;
+    Build(root.Liquids(), {position.x, position.y});
+  }
+}
@@ -0,0 +1,381 @@
+#include <Terrain/TileLodGenerator.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace Terrain;
+using IO::Common::WorldConstants::MAP_DIM;
+
+namespace
+{
+  constexpr std::size_t OUTER_DIM = TileHeightfield::OUTER_DIM;
+  constexpr std::size_t MAX_SIZE = TileHeightfield::INNER_DIM;
+
+  // blocks of a single quad, and blocks of a chunk (deepest level of MLND nodes)
+  constexpr std::size_t MAX_DEPTH = 7;
+  constexpr std::size_t CHUNK_DEPTH = 4;
+
+  static_assert(MAX_SIZE == 1 << MAX_DEPTH && TileHeightfield::CHUNK_INNER_DIM == 1 << (MAX_DEPTH - CHUNK_DEPTH));
+
+  constexpr std::size_t N_NODES = ((1 << (2 * (MAX_DEPTH + 1))) - 1) / 3;
+
+  constexpr std::size_t BlockSize(std::size_t depth) { return MAX_SIZE >> depth; }
+
+  // nodes of a complete quadtree, stored level after level
+  constexpr std::size_t NodeIndex(std::size_t depth, std::size_t x, std::size_t y)
+  {
+    return ((1 << (2 * depth)) - 1) / 3 + (y << depth) + x;
+  }
+
+  constexpr std::uint16_t OuterIndex(std::size_t x, std::size_t y)
+  {
+    return static_cast<std::uint16_t>(y * OUTER_DIM + x);
+  }
+
+  constexpr std::uint16_t InnerIndex(std::size_t x, std::size_t y)
+  {
+    return static_cast<std::uint16_t>(TileHeightfield::N_OUTER + y * TileHeightfield::INNER_DIM + x);
+  }
+
+  // vertices of an edge of a block, in order of increasing grid coordinate
+  struct Edge
+  {
+    std::size_t x;
+    std::size_t y;
+    std::size_t step_x;
+    std::size_t step_y;
+  };
+
+  // north, south, west, east
+  std::array<Edge, 4> BlockEdges(std::size_t x0, std::size_t y0, std::size_t size)
+  {
+    return {{ {x0, y0, 1, 0}, {x0, y0 + size, 1, 0}, {x0, y0, 0, 1}, {x0 + size, y0, 0, 1} }};
+  }
+}
+
+TileLodGenerator::TileLodGenerator(LodSettings const& settings)
+: _settings(settings)
+, _split(N_NODES)
+, _used(TileHeightfield::N_OUTER)
+{
+}
+
+void TileLodGenerator::Generate(TileHeightfield const& heightfield, std::size_t tile_x, std::size_t tile_y, TileLod& lod)
+{
+  RequireF(CCodeZones::TERRAIN, tile_x < MAP_DIM && tile_y < MAP_DIM, "Tile index out of bounds.");
+  RequireF(CCodeZones::TERRAIN, _settings.n_levels && _settings.base_tolerance >= 0.f
+           && _settings.tolerance_factor >= 1.f, "Invalid LOD settings.");
+
+  lod.heights.assign(heightfield.OuterGrid().begin(), heightfield.OuterGrid().end());
+  lod.heights.insert(lod.heights.end(), heightfield.InnerGrid().begin(), heightfield.InnerGrid().end());
+  lod.indices.clear();
+  lod.levels.clear();
+  lod.nodes.clear();
+
+  // bounds, the first outer vertex is at the MCNK position of the first chunk
+  auto const [min_height, max_height] = std::minmax_element(lod.heights.begin(), lod.heights.end());
+  constexpr auto half_map = static_cast<float>(MAP_DIM / 2);
+  float const origin_x = (half_map - static_cast<float>(tile_y)) * IO::Common::WorldConstants::TILE_SIZE;
+  float const origin_y = (half_map - static_cast<float>(tile_x)) * IO::Common::WorldConstants::TILE_SIZE;
+
+  lod.header.unknown = 0;
+  lod.header.some_kind_of_bounding[0] = origin_x - IO::Common::WorldConstants::TILE_SIZE;
+  lod.header.some_kind_of_bounding[1] = origin_y - IO::Common::WorldConstants::TILE_SIZE;
+  lod.header.some_kind_of_bounding[2] = *min_height;
+  lod.header.some_kind_of_bounding[3] = origin_x;
+  lod.header.some_kind_of_bounding[4] = origin_y;
+  lod.header.some_kind_of_bounding[5] = *max_height;
+
+  float tolerance = _settings.base_tolerance;
+
+  for (std::size_t level = 0; level < _settings.n_levels; ++level, tolerance *= _settings.tolerance_factor)
+  {
+    Refine(heightfield, tolerance);
+
+    auto const first = static_cast<std::uint32_t>(lod.indices.size());
+    EmitNode(0, 0, 0, lod);
+
+    lod.levels.push_back({ tolerance, static_cast<std::uint32_t>(lod.indices.size()) - first, first, 0, 0 });
+  }
+}
+
+void TileLodGenerator::GenerateMap(TileLoadFunc const& load, TileStoreFunc const& store, std::size_t n_threads) const
+{
+  Utils::Misc::ParallelFor(0, MAP_DIM * MAP_DIM, [&](std::size_t tile) -> void
+  {
+    TileHeightfield heightfield {};
+
+    if (!load(tile % MAP_DIM, tile / MAP_DIM, heightfield))
+      return;
+
+    TileLodGenerator generator {_settings};
+    TileLod lod {};
+
+    generator.Generate(heightfield, tile % MAP_DIM, tile / MAP_DIM, lod);
+    store(tile % MAP_DIM, tile / MAP_DIM, lod);
+  }, 1, n_threads);
+}
+
+void TileLodGenerator::Refine(TileHeightfield const& heightfield, float tolerance)
+{
+  std::fill(_split.begin(), _split.end(), 0);
+  std::fill(_used.begin(), _used.end(), 0);
+
+  // border of the tile is shared with neighbouring tiles
+  for (std::size_t i = 0; i < OUTER_DIM; ++i)
+  {
+    _used[OuterIndex(i, 0)] = _used[OuterIndex(i, OUTER_DIM - 1)] = 1;
+    _used[OuterIndex(0, i)] = _used[OuterIndex(OUTER_DIM - 1, i)] = 1;
+  }
+
+  _blocks.assign(1, Block{0, 0, 0, 0});
+
+  // splitting a block adds vertices to the edges of its neighbours, which are evaluated again
+  for (bool split = true; split;)
+  {
+    split = false;
+    _next_blocks.clear();
+
+    for (Block block : _blocks)
+    {
+      std::uint16_t const n_used = CountUsed(block);
+
+      if (n_used == block.n_used)
+      {
+        _next_blocks.push_back(block);
+        continue;
+      }
+
+      if (block.depth == MAX_DEPTH || Fits(heightfield, block, tolerance))
+      {
+        block.n_used = n_used;
+        _next_blocks.push_back(block);
+        continue;
+      }
+
+      Split(block);
+      split = true;
+
+      auto const depth = static_cast<std::uint8_t>(block.depth + 1);
+      auto const x = static_cast<std::uint8_t>(block.x * 2);
+      auto const y = static_cast<std::uint8_t>(block.y * 2);
+
+      _next_blocks.push_back({depth, x, y, 0});
+      _next_blocks.push_back({depth, static_cast<std::uint8_t>(x + 1), y, 0});
+      _next_blocks.push_back({depth, x, static_cast<std::uint8_t>(y + 1), 0});
+      _next_blocks.push_back({depth, static_cast<std::uint8_t>(x + 1), static_cast<std::uint8_t>(y + 1), 0});
+    }
+
+    std::swap(_blocks, _next_blocks);
+  }
+}
+
+std::uint16_t TileLodGenerator::CountUsed(Block const& block) const
+{
+  std::size_t const size = BlockSize(block.depth);
+  std::uint16_t count = 0;
+
+  for (Edge const& edge : BlockEdges(block.x * size, block.y * size, size))
+  {
+    for (std::size_t k = 0; k <= size; ++k)
+    {
+      count += _used[OuterIndex(edge.x + k * edge.step_x, edge.y + k * edge.step_y)];
+    }
+  }
+
+  return count;
+}
+
+void TileLodGenerator::Split(Block const& block)
+{
+  std::size_t const size = BlockSize(block.depth);
+  std::size_t const half = size / 2;
+  std::size_t const x0 = block.x * size;
+  std::size_t const y0 = block.y * size;
+
+  _split[NodeIndex(block.depth, block.x, block.y)] = 1;
+
+  _used[OuterIndex(x0 + half, y0 + half)] = 1;
+  _used[OuterIndex(x0 + half, y0)] = 1;
+  _used[OuterIndex(x0 + half, y0 + size)] = 1;
+  _used[OuterIndex(x0, y0 + half)] = 1;
+  _used[OuterIndex(x0 + size, y0 + half)] = 1;
+}
+
+bool TileLodGenerator::Fits(TileHeightfield const& heightfield, Block const& block, float tolerance) const
+{
+  std::size_t const size = BlockSize(block.depth);
+  std::size_t const x0 = block.x * size;
+  std::size_t const y0 = block.y * size;
+
+  // heights along the edges of the block as rendered: linear between used vertices
+  std::array<std::array<float, MAX_SIZE + 1>, 4> edge_heights;
+  std::array<Edge, 4> const edges = BlockEdges(x0, y0, size);
+
+  for (std::size_t e = 0; e < 4; ++e)
+  {
+    Edge const& edge = edges[e];
+    auto& heights = edge_heights[e];
+    std::size_t last = 0;
+
+    heights[0] = heightfield.Outer(edge.x, edge.y);
+
+    for (std::size_t k = 1; k <= size; ++k)
+    {
+      std::size_t const x = edge.x + k * edge.step_x;
+      std::size_t const y = edge.y + k * edge.step_y;
+
+      if (!_used[OuterIndex(x, y)] && k != size)
+        continue;
+
+      heights[k] = heightfield.Outer(x, y);
+
+      for (std::size_t i = last + 1; i < k; ++i)
+      {
+        float const t = static_cast<float>(i - last) / static_cast<float>(k - last);
+        heights[i] = heights[last] + (heights[k] - heights[last]) * t;
+      }
+
+      last = k;
+    }
+  }
+
+  auto const half = static_cast<float>(size) / 2.f;
+  float const center_x = static_cast<float>(x0) + half;
+  float const center_y = static_cast<float>(y0) + half;
+  float const center = heightfield.Outer(x0 + size / 2, y0 + size / 2);
+
+  // the triangle containing a point joins the center to the edge hit by the ray from the center through the point
+  auto const fits = [&](float x, float y, float height) -> bool
+  {
+    float const dx = x - center_x;
+    float const dy = y - center_y;
+    float const ax = std::abs(dx);
+    float const ay = std::abs(dy);
+
+    if (ax == 0.f && ay == 0.f)
+      return std::abs(height - center) <= tolerance;
+
+    float t;
+    float along;
+    std::size_t e;
+
+    if (ay >= ax)
+    {
+      t = ay / half;
+      along = dx / t + half;
+      e = dy < 0.f ? 0 : 1;
+    }
+    else
+    {
+      t = ax / half;
+      along = dy / t + half;
+      e = dx < 0.f ? 2 : 3;
+    }
+
+    auto const i = std::min(static_cast<std::size_t>(along), size - 1);
+    float const f = along - static_cast<float>(i);
+    float const edge_height = edge_heights[e][i] + (edge_heights[e][i + 1] - edge_heights[e][i]) * f;
+
+    return std::abs(height - (center + (edge_height - center) * t)) <= tolerance;
+  };
+
+  for (std::size_t y = y0; y <= y0 + size; ++y)
+  {
+    for (std::size_t x = x0; x <= x0 + size; ++x)
+    {
+      if (!fits(static_cast<float>(x), static_cast<float>(y), heightfield.Outer(x, y)))
+        return false;
+    }
+  }
+
+  for (std::size_t y = y0; y < y0 + size; ++y)
+  {
+    for (std::size_t x = x0; x < x0 + size; ++x)
+    {
+      if (!fits(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, heightfield.Inner(x, y)))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+std::uint16_t TileLodGenerator::EmitNode(std::size_t depth, std::size_t x, std::size_t y, TileLod& lod) const
+{
+  auto const index = static_cast<std::uint16_t>(lod.nodes.size());
+  auto const first = static_cast<std::uint32_t>(lod.indices.size());
+
+  lod.nodes.push_back({});
+
+  IO::ADT::DataStructures::MLND node {};
+  node.index = first;
+
+  if (_split[NodeIndex(depth, x, y)] && depth < CHUNK_DEPTH)
+  {
+    for (std::size_t child = 0; child < 4; ++child)
+    {
+      node.indices[child] = EmitNode(depth + 1, x * 2 + child % 2, y * 2 + child / 2, lod);
+    }
+  }
+  else
+  {
+    EmitBlocks(depth, x, y, lod);
+  }
+
+  node.length = static_cast<std::uint32_t>(lod.indices.size()) - first;
+  lod.nodes[index] = node;
+
+  return index;
+}
+
+void TileLodGenerator::EmitBlocks(std::size_t depth, std::size_t x, std::size_t y, TileLod& lod) const
+{
+  if (!_split[NodeIndex(depth, x, y)])
+  {
+    EmitFan(depth, x, y, lod);
+    return;
+  }
+
+  // north-west, north-east, south-west, south-east
+  for (std::size_t child = 0; child < 4; ++child)
+  {
+    EmitBlocks(depth + 1, x * 2 + child % 2, y * 2 + child / 2, lod);
+  }
+}
+
+void TileLodGenerator::EmitFan(std::size_t depth, std::size_t x, std::size_t y, TileLod& lod) const
+{
+  std::size_t const size = BlockSize(depth);
+  std::size_t const x0 = x * size;
+  std::size_t const y0 = y * size;
+
+  std::uint16_t const center = size == 1 ? InnerIndex(x0, y0) : OuterIndex(x0 + size / 2, y0 + size / 2);
+
+  // used vertices around the block, counter-clockwise seen from above: grid x runs along world -Y, grid y along
+  // world -X, so north-east, north-west, south-west, south-east
+  std::array<std::uint16_t, 4 * MAX_SIZE> ring;
+  std::size_t n_ring = 0;
+
+  auto const add = [&](std::size_t vx, std::size_t vy) -> void
+  {
+    if (_used[OuterIndex(vx, vy)])
+    {
+      ring[n_ring++] = OuterIndex(vx, vy);
+    }
+  };
+
+  for (std::size_t k = 0; k < size; ++k) add(x0 + size - k, y0);
+  for (std::size_t k = 0; k < size; ++k) add(x0, y0 + k);
+  for (std::size_t k = 0; k < size; ++k) add(x0 + k, y0 + size);
+  for (std::size_t k = 0; k < size; ++k) add(x0 + size, y0 + size - k);
+
+  for (std::size_t i = 0; i < n_ring; ++i)
+  {
+    lod.indices.insert(lod.indices.end(), { center, ring[i], ring[(i + 1) % n_ring] });
+  }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+#include <IO/ADT/DataStructures.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Terrain
+{
+  struct LodSettings
+  {
+    std::size_t n_levels = 4;           ///> Number of levels of detail, the first one being the most detailed.
+    float base_tolerance = 0.25f;       ///> Maximum vertical error of the first level, in yards.
+    float tolerance_factor = 4.f;       ///> Ratio of the tolerances of two successive levels.
+  };
+
+  /**
+   * Contents of the terrain chunks of a _lod.adt file, as produced by TileLodGenerator.
+   * Vertices are all outer vertices of the tile, followed by all inner vertices, in TileHeightfield order. Their
+   * position in the horizontal plane is implied by their index.
+   * MLND nodes of each level are stored depth-first after the ones of the previous level, the root node of a level
+   * spans the same MLVI range as its MLLL entry. Children are indices into nodes, 0 for none.
+   */
+  struct TileLod
+  {
+    IO::ADT::DataStructures::MLHD header;                   ///> Bounding box of the tile (minimum, then maximum).
+    std::vector<float> heights;                             ///> MLVH, absolute heights.
+    std::vector<std::uint16_t> indices;                     ///> MLVI, triangle list, counter-clockwise seen from above.
+    std::vector<IO::ADT::DataStructures::MLLL> levels;      ///> MLLL, lod holds the error tolerance of the level.
+    std::vector<IO::ADT::DataStructures::MLND> nodes;       ///> MLND, quadtree of each level down to chunks.
+  };
+
+  /**
+   * Builds simplified meshes of tiles for every level of detail.
+   * Each level is a quadtree of square blocks of quads refined until every vertex of the tile lies within the level's
+   * tolerance of the mesh. A block is a fan of triangles around its center, connecting every vertex used by neighbour
+   * blocks along its edges, so meshes have no T-junctions. Vertices on the border of the tile are always kept, so
+   * meshes of neighbouring tiles match regardless of their level. Output only depends on heights.
+   */
+  class TileLodGenerator
+  {
+  public:
+    using TileLoadFunc = std::function<bool(std::size_t tile_x, std::size_t tile_y, TileHeightfield& heightfield)>;
+    using TileStoreFunc = std::function<void(std::size_t tile_x, std::size_t tile_y, TileLod const& lod)>;
+
+    explicit TileLodGenerator(LodSettings const& settings = {});
+
+    /**
+     * Generates levels of detail of a tile.
+     * @param heightfield Heightfield of the tile.
+     * @param tile_x Horizontal index of the tile in the map.
+     * @param tile_y Vertical index of the tile in the map.
+     * @param lod Output, storage is reused.
+     */
+    void Generate(TileHeightfield const& heightfield, std::size_t tile_x, std::size_t tile_y, TileLod& lod);
+
+    /**
+     * Generates levels of detail of all tiles of a map in parallel, each thread holding a single tile at a time.
+     * Callbacks are invoked concurrently from worker threads.
+     * @param load Loads heights of a tile, returns false if the tile does not exist.
+     * @param store Receives levels of detail of each existing tile.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     */
+    void GenerateMap(TileLoadFunc const& load, TileStoreFunc const& store, std::size_t n_threads = 0) const;
+
+  // accessors
+  public:
+    [[nodiscard]]
+    LodSettings const& Settings() const { return _settings; };
+
+    [[nodiscard]]
+    LodSettings& Settings() { return _settings; };
+
+  private:
+    // square block of quads, size is 1 << (MAX_DEPTH - depth)
+    struct Block
+    {
+      std::uint8_t depth;
+      std::uint8_t x;
+      std::uint8_t y;
+      std::uint16_t n_used;    ///> Used vertices along the edges at the last evaluation, 0 if not evaluated.
+    };
+
+    void Refine(TileHeightfield const& heightfield, float tolerance);
+    bool Fits(TileHeightfield const& heightfield, Block const& block, float tolerance) const;
+    std::uint16_t CountUsed(Block const& block) const;
+    void Split(Block const& block);
+
+    std::uint16_t EmitNode(std::size_t depth, std::size_t x, std::size_t y, TileLod& lod) const;
+    void EmitBlocks(std::size_t depth, std::size_t x, std::size_t y, TileLod& lod) const;
+    void EmitFan(std::size_t depth, std::size_t x, std::size_t y, TileLod& lod) const;
+
+    LodSettings _settings;
+
+    std::vector<std::uint8_t> _split;   ///> Per quadtree node, set if the block is split.
+    std::vector<std::uint8_t> _used;    ///> Per outer vertex, set if the vertex is used by the mesh.
+    std::vector<Block> _blocks;
+    std::vector<Block> _next_blocks;
+  };
+}
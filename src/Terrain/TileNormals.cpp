@@ -0,0 +1,170 @@
+#include <Terrain/TileNormals.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Terrain;
+using namespace Utils::Misc::SIMD;
+
+namespace
+{
+  constexpr float VERTEX_SPACING = IO::Common::WorldConstants::CHUNK_SIZE / TileHeightfield::CHUNK_INNER_DIM;
+
+  struct NormalRows
+  {
+    float* x;
+    float* y;
+    float* up;
+  };
+
+  template<typename V>
+  FORCEINLINE void Normalize(V gx, V gy, V up, NormalRows const& dst, std::size_t i)
+  {
+    V const inv_len = Broadcast<V>(1.f) / Sqrt(gx * gx + gy * gy + up * up);
+
+    Store(dst.x + i, gx * inv_len);
+    Store(dst.y + i, gy * inv_len);
+    Store(dst.up + i, up * inv_len);
+  }
+
+  /*
+   * Normal of an outer vertex: sum of the face normals of the 4 triangles of the fan within each of the 4 surrounding
+   * quads, each triangle being formed by two outer neighbours (W, N, E, S) and an inner diagonal neighbour
+   * (NW, NE, SW, SE). Height of the vertex itself cancels out.
+   * Rows of the padded outer grid (o_*) and the padded inner grid (i_*) are offset so that index i addresses the vertex.
+   */
+  template<typename V>
+  FORCEINLINE void OuterKernel(float const* o_n, float const* o_c, float const* o_s
+                               , float const* i_n, float const* i_s
+                               , NormalRows const& dst, std::size_t i)
+  {
+    V const w = Load<V>(o_c + i - 1);
+    V const e = Load<V>(o_c + i + 1);
+    V const n = Load<V>(o_n + i);
+    V const s = Load<V>(o_s + i);
+    V const nw = Load<V>(i_n + i - 1);
+    V const ne = Load<V>(i_n + i);
+    V const sw = Load<V>(i_s + i - 1);
+    V const se = Load<V>(i_s + i);
+
+    V const gx = (w - e) + (nw - ne) + (sw - se);
+    V const gy = (n - s) + (nw - sw) + (ne - se);
+
+    Normalize(gx, gy, Broadcast<V>(4.f * VERTEX_SPACING), dst, i);
+  }
+
+  /*
+   * Normal of an inner vertex: sum of the face normals of the 4 triangles of its quad. Only the 4 outer corners
+   * contribute.
+   */
+  template<typename V>
+  FORCEINLINE void InnerKernel(float const* o_n, float const* o_s, NormalRows const& dst, std::size_t i)
+  {
+    V const nw = Load<V>(o_n + i);
+    V const ne = Load<V>(o_n + i + 1);
+    V const sw = Load<V>(o_s + i);
+    V const se = Load<V>(o_s + i + 1);
+
+    V const gx = (nw + sw) - (ne + se);
+    V const gy = (nw + ne) - (sw + se);
+
+    Normalize(gx, gy, Broadcast<V>(2.f * VERTEX_SPACING), dst, i);
+  }
+}
+
+TileNormals::TileNormals()
+{
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    _outer[i].assign(TileHeightfield::N_OUTER, i == 2 ? 1.f : 0.f);
+    _inner[i].assign(TileHeightfield::N_INNER, i == 2 ? 1.f : 0.f);
+  }
+}
+
+void TileNormals::Compute(TileHeightfield const& heightfield, TileNeighbours const& neighbours)
+{
+  Compute(heightfield, VertexRect{}, neighbours);
+}
+
+VertexRect TileNormals::AffectedRect(VertexRect const& dirty)
+{
+  return { dirty.x_min ? dirty.x_min - 1 : 0
+           , dirty.y_min ? dirty.y_min - 1 : 0
+           , std::min(dirty.x_max + 1, TileHeightfield::OUTER_DIM - 1)
+           , std::min(dirty.y_max + 1, TileHeightfield::OUTER_DIM - 1) };
+}
+
+void TileNormals::Compute(TileHeightfield const& heightfield, VertexRect const& dirty, TileNeighbours const& neighbours)
+{
+  RequireF(CCodeZones::TERRAIN, dirty.x_min <= dirty.x_max && dirty.y_min <= dirty.y_max
+           && dirty.x_max < TileHeightfield::OUTER_DIM && dirty.y_max < TileHeightfield::OUTER_DIM
+           , "Invalid vertex rectangle.");
+
+  heightfield.Pad(neighbours, _padded_outer, _padded_inner);
+
+  constexpr std::size_t outer_dim = TileHeightfield::OUTER_DIM;
+  constexpr std::size_t inner_dim = TileHeightfield::INNER_DIM;
+  constexpr std::size_t padded_outer_dim = outer_dim + 2;
+  constexpr std::size_t padded_inner_dim = inner_dim + 2;
+
+  // outer vertex normals depend on the ring of vertices around them
+  VertexRect const outer = AffectedRect(dirty);
+
+  // padded row of a grid vertex, offset so that index x addresses vertex x
+  auto const padded_outer_row = [this](std::size_t y) -> float const*
+  {
+    return _padded_outer.data() + (y + 1) * padded_outer_dim + 1;
+  };
+
+  auto const padded_inner_row = [this](std::ptrdiff_t y) -> float const*
+  {
+    return _padded_inner.data() + (y + 1) * padded_inner_dim + 1;
+  };
+
+  for (std::size_t y = outer.y_min; y <= outer.y_max; ++y)
+  {
+    float const* o_c = padded_outer_row(y);
+    float const* o_n = o_c - padded_outer_dim;
+    float const* o_s = o_c + padded_outer_dim;
+
+    // inner vertices north of the outer row are the row above it
+    float const* i_n = padded_inner_row(static_cast<std::ptrdiff_t>(y) - 1);
+    float const* i_s = i_n + padded_inner_dim;
+
+    std::size_t const offset = y * outer_dim;
+    NormalRows const dst { _outer[0].data() + offset, _outer[1].data() + offset, _outer[2].data() + offset };
+
+    ForRange(outer.x_min, outer.x_max + 1, [&]<typename V>(V, std::size_t x) -> void
+    {
+      OuterKernel<V>(o_n, o_c, o_s, i_n, i_s, dst, x);
+    });
+  }
+
+  // inner vertex (x, y) lies within the quad of outer vertices (x, y) - (x + 1, y + 1)
+  std::size_t const inner_x_min = dirty.x_min ? dirty.x_min - 1 : 0;
+  std::size_t const inner_y_min = dirty.y_min ? dirty.y_min - 1 : 0;
+  std::size_t const inner_x_max = std::min(dirty.x_max, inner_dim - 1);
+  std::size_t const inner_y_max = std::min(dirty.y_max, inner_dim - 1);
+
+  for (std::size_t y = inner_y_min; y <= inner_y_max; ++y)
+  {
+    float const* o_n = heightfield.OuterRow(y);
+    float const* o_s = heightfield.OuterRow(y + 1);
+
+    std::size_t const offset = y * inner_dim;
+    NormalRows const dst { _inner[0].data() + offset, _inner[1].data() + offset, _inner[2].data() + offset };
+
+    ForRange(inner_x_min, inner_x_max + 1, [&]<typename V>(V, std::size_t x) -> void
+    {
+      InnerKernel<V>(o_n, o_s, dst, x);
+    });
+  }
+}
+
+std::int8_t TileNormals::Quantize(float value)
+{
+  return static_cast<std::int8_t>(std::clamp(std::lround(value * 127.f), -127l, 127l));
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+#include <IO/Common.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <IO/ADT/Root/ADTRootMCNK.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Terrain
+{
+  /**
+   * Vertex normals of a tile, computed from a TileHeightfield.
+   * Normals are stored as planar grids of components in grid space (x along the grid columns, y along the grid rows,
+   * up), matching the layout of TileHeightfield. Vertices on the borders of chunks share normals with the neighbouring
+   * chunks, and vertices on the borders of the tile take neighbouring tiles into account when those are provided, so
+   * that lighting is continuous across seams. Missing neighbours are substituted with a linear extrapolation of the
+   * tile border.
+   */
+  class TileNormals
+  {
+  public:
+    /**
+     * Constructs normals of a flat tile.
+     */
+    TileNormals();
+
+    /**
+     * Computes normals of all vertices of a tile.
+     * @param heightfield Heightfield of the tile.
+     * @param neighbours Heightfields of the surrounding tiles.
+     */
+    void Compute(TileHeightfield const& heightfield, TileNeighbours const& neighbours = {});
+
+    /**
+     * Recomputes normals affected by a change of heights within a rectangle of vertices.
+     * Normals of neighbouring tiles are not updated, edits touching the tile border should recompute those as well.
+     * @param heightfield Heightfield of the tile.
+     * @param dirty Rectangle of vertices whose heights have changed.
+     * @param neighbours Heightfields of the surrounding tiles.
+     */
+    void Compute(TileHeightfield const& heightfield, VertexRect const& dirty, TileNeighbours const& neighbours = {});
+
+    /**
+     * Rectangle of outer vertices whose normals are affected by a change of heights within a rectangle of vertices.
+     * @param dirty Rectangle of vertices whose heights have changed.
+     * @return Affected rectangle, clamped to the tile.
+     */
+    [[nodiscard]]
+    static VertexRect AffectedRect(VertexRect const& dirty);
+
+    /**
+     * Stores normals into all chunks of an ADT root file (MCNR).
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Store(IO::ADT::ADTRoot<client_version>& root) const;
+
+    /**
+     * Stores normals into the chunks of an ADT root file (MCNR) that intersect a rectangle of vertices.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param rect Rectangle of outer vertices, usually the result of AffectedRect().
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Store(IO::ADT::ADTRoot<client_version>& root, VertexRect const& rect) const;
+
+    /**
+     * Stores normals of a single chunk (MCNR). Padding of MCNR is kept.
+     * Components are quantized to [-127, 127] and written in the order of the file format: world X, world Y, up.
+     * @tparam client_version Version of the game client.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param chunk Chunk to store normals into.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void StoreChunk(std::size_t chunk_x, std::size_t chunk_y, IO::ADT::MCNKRoot<client_version>& chunk) const;
+
+  // accessors
+  public:
+    /**
+     * @return Normal of an outer vertex in grid space (x, y, up).
+     */
+    [[nodiscard]]
+    FORCEINLINE std::array<float, 3> Outer(std::size_t x, std::size_t y) const
+    {
+      std::size_t const i = y * TileHeightfield::OUTER_DIM + x;
+      return { _outer[0][i], _outer[1][i], _outer[2][i] };
+    };
+
+    /**
+     * @return Normal of an inner vertex in grid space (x, y, up).
+     */
+    [[nodiscard]]
+    FORCEINLINE std::array<float, 3> Inner(std::size_t x, std::size_t y) const
+    {
+      std::size_t const i = y * TileHeightfield::INNER_DIM + x;
+      return { _inner[0][i], _inner[1][i], _inner[2][i] };
+    };
+
+  private:
+    static std::int8_t Quantize(float value);
+
+    std::array<std::vector<float>, 3> _outer;
+    std::array<std::vector<float>, 3> _inner;
+
+    // heights of both grids with a border of 1 vertex, see TileHeightfield::Pad()
+    std::vector<float> _padded_outer;
+    std::vector<float> _padded_inner;
+  };
+}
+
+#include <Terrain/TileNormals.inl>
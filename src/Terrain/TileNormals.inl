@@ -0,0 +1,92 @@
+#pragma once
+#include <Terrain/TileNormals.hpp>
+#include <Terrain/Common.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline void TileNormals::Store(IO::ADT::ADTRoot<client_version>& root) const
+  {
+    Store(root, VertexRect{});
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileNormals::Store(IO::ADT::ADTRoot<client_version>& root, VertexRect const& rect) const
+  {
+    auto& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+    RequireF(CCodeZones::TERRAIN, rect.x_min <= rect.x_max && rect.y_min <= rect.y_max
+             && rect.x_max < TileHeightfield::OUTER_DIM && rect.y_max < TileHeightfield::OUTER_DIM
+             , "Invalid vertex rectangle.");
+
+    constexpr std::size_t dim = TileHeightfield::CHUNK_INNER_DIM;
+
+    // vertices on chunk borders belong to both chunks
+    auto const first_chunk = [](std::size_t v) { return v ? (v - 1) / dim : 0; };
+    auto const last_chunk = [](std::size_t v) { return std::min(v / dim, TileHeightfield::CHUNKS_PER_ROW - 1); };
+
+    for (std::size_t cy = first_chunk(rect.y_min); cy <= last_chunk(rect.y_max); ++cy)
+    {
+      for (std::size_t cx = first_chunk(rect.x_min); cx <= last_chunk(rect.x_max); ++cx)
+      {
+        StoreChunk(cx, cy, chunks[cy * TileHeightfield::CHUNKS_PER_ROW + cx]);
+      }
+    }
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileNormals::StoreChunk(std::size_t chunk_x
+                                      , std::size_t chunk_y
+                                      , IO::ADT::MCNKRoot<client_version>& chunk) const
+  {
+    RequireF(CCodeZones::TERRAIN, chunk_x < TileHeightfield::CHUNKS_PER_ROW
+             && chunk_y < TileHeightfield::CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+    if (!chunk.Normals().IsInitialized())
+    {
+      chunk.Normals().Initialize(IO::ADT::DataStructures::MCNR{});
+    }
+
+    auto& entries = chunk.Normals().data.entries;
+
+    constexpr std::size_t outer_dim = TileHeightfield::CHUNK_OUTER_DIM;
+    constexpr std::size_t inner_dim = TileHeightfield::CHUNK_INNER_DIM;
+
+    std::size_t const x0 = chunk_x * inner_dim;
+    std::size_t const y0 = chunk_y * inner_dim;
+
+    // grid x runs along world -Y, grid y runs along world -X
+    auto const store = [](IO::ADT::DataStructures::MCNREntry& entry, std::array<float, 3> const& normal) -> void
+    {
+      entry.normal[0] = Quantize(-normal[1]);
+      entry.normal[1] = Quantize(-normal[0]);
+      entry.normal[2] = Quantize(normal[2]);
+    };
+
+    // MCNR interleaves rows of 9 outer and 8 inner vertices, same as MCVT
+    for (std::size_t row = 0; row < outer_dim; ++row)
+    {
+      auto* dst_outer = entries + row * (outer_dim + inner_dim);
+
+      for (std::size_t col = 0; col < outer_dim; ++col)
+      {
+        store(dst_outer[col], Outer(x0 + col, y0 + row));
+      }
+
+      if (row == inner_dim)
+        break;
+
+      auto* dst_inner = dst_outer + outer_dim;
+
+      for (std::size_t col = 0; col < inner_dim; ++col)
+      {
+        store(dst_inner[col], Inner(x0 + col, y0 + row));
+      }
+    }
+  }
+}
@@ -0,0 +1,133 @@
+#include <Terrain/TileProbe.hpp>
+#include <Terrain/Common.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Log.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+using namespace Terrain;
+using namespace IO::Common;
+using namespace IO::Common::DataStructures;
+using namespace Utils::Misc::SIMD;
+using WorldConstants::MAP_DIM;
+
+namespace
+{
+  constexpr float INF = std::numeric_limits<float>::infinity();
+
+  // walks the subchunks following the header of an MCNK chunk, only MCVT is read
+  bool ProbeChunk(ByteBuffer const& buf, std::size_t begin, std::size_t end, ChunkSummary& summary)
+  {
+    constexpr std::size_t mcvt_size = WorldConstants::CHUNK_BUF_SIZE * sizeof(float);
+
+    bool valid = true;
+
+    bool const complete = ScanChunks(buf, begin, end, [&](ChunkHeader const& chunk_header
+                                                        , std::size_t pos) -> void
+    {
+      if (chunk_header.fourcc != IO::ADT::ChunkIdentifiers::ADTRootMCNKSubchunks::MCVT)
+        return;
+
+      // heights are reduced straight from the buffer, the payload must be checked in release builds too
+      if (chunk_header.size != mcvt_size || pos + mcvt_size > buf.Size())
+      {
+        valid = false;
+        return;
+      }
+
+      float min = INF;
+      float max = -INF;
+      MinMax(reinterpret_cast<float const*>(buf.Data() + pos), WorldConstants::CHUNK_BUF_SIZE, min, max);
+
+      summary.height_min = summary.header.position.z + min;
+      summary.height_max = summary.header.position.z + max;
+    });
+
+    return complete && valid;
+  }
+}
+
+bool TileProbe::Probe(ByteBuffer const& buf, TileSummary& summary)
+{
+  summary.header.reset();
+  summary.bounds = EMPTY_BOX;
+
+  std::size_t n_chunks = 0;
+  bool valid = true;
+
+  bool const complete = ScanChunks(buf, 0, buf.Size(), [&](ChunkHeader const& chunk_header
+                                                         , std::size_t pos) -> void
+  {
+    if (!valid)
+      return;
+
+    if (chunk_header.fourcc == IO::ADT::ChunkIdentifiers::ADTRootChunks::MHDR
+        && chunk_header.size >= sizeof(IO::ADT::DataStructures::MHDR))
+    {
+      summary.header.emplace();
+      buf.Read(*summary.header, pos);
+    }
+    else if (chunk_header.fourcc == IO::ADT::ChunkIdentifiers::ADTRootChunks::MCNK)
+    {
+      if (n_chunks == WorldConstants::CHUNKS_PER_TILE || chunk_header.size < sizeof(IO::ADT::DataStructures::SMChunk))
+      {
+        valid = false;
+        return;
+      }
+
+      ChunkSummary& chunk = summary.chunks[n_chunks++];
+      buf.Read(chunk.header, pos);
+      chunk.height_min = INF;
+      chunk.height_max = -INF;
+
+      if (!ProbeChunk(buf, pos + sizeof(IO::ADT::DataStructures::SMChunk), pos + chunk_header.size, chunk))
+      {
+        valid = false;
+        return;
+      }
+
+      // chunks extend from their position towards -X and -Y
+      auto const& position = chunk.header.position;
+      CAaBox& bounds = summary.bounds;
+
+      bounds.min.x = std::min(bounds.min.x, position.x - WorldConstants::CHUNK_SIZE);
+      bounds.min.y = std::min(bounds.min.y, position.y - WorldConstants::CHUNK_SIZE);
+      bounds.max.x = std::max(bounds.max.x, position.x);
+      bounds.max.y = std::max(bounds.max.y, position.y);
+      bounds.min.z = std::min(bounds.min.z, chunk.height_min);
+      bounds.max.z = std::max(bounds.max.z, chunk.height_max);
+    }
+  });
+
+  return complete && valid && n_chunks == WorldConstants::CHUNKS_PER_TILE;
+}
+
+std::size_t TileProbe::ProbeMap(TileReadFunc const& read, TileSummaryFunc const& receive, std::size_t n_threads)
+{
+  std::atomic<std::size_t> n_probed = 0;
+
+  Utils::Misc::ParallelFor(0, WorldConstants::MAX_TILES_PER_MAP, [&](std::size_t tile) -> void
+  {
+    std::optional<ByteBuffer> buf = read(tile % MAP_DIM, tile / MAP_DIM);
+
+    if (!buf)
+      return;
+
+    TileSummary summary {};
+
+    if (!Probe(*buf, summary))
+    {
+      LogError("Probing tile %zu_%zu failed. Malformed root ADT.", tile % MAP_DIM, tile / MAP_DIM);
+      return;
+    }
+
+    receive(tile % MAP_DIM, tile / MAP_DIM, summary);
+    n_probed.fetch_add(1, std::memory_order_relaxed);
+  }, 1, n_threads);
+
+  return n_probed.load();
+}
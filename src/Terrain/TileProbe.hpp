@@ -0,0 +1,64 @@
+#pragma once
+
+#include <IO/ByteBuffer.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/DataStructures.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+
+namespace Terrain
+{
+  /**
+   * Summary of a chunk (MCNK) of a root ADT.
+   */
+  struct ChunkSummary
+  {
+    IO::ADT::DataStructures::SMChunk header;
+    float height_min = std::numeric_limits<float>::infinity();      ///> Lowest vertex (MCVT) incl. header.position.z.
+    float height_max = -std::numeric_limits<float>::infinity();     ///> Highest vertex, both infinite without MCVT.
+  };
+
+  /**
+   * Summary of a root ADT: headers of the file and of its chunks, and height ranges.
+   */
+  struct TileSummary
+  {
+    std::optional<IO::ADT::DataStructures::MHDR> header;
+    std::array<ChunkSummary, IO::Common::WorldConstants::CHUNKS_PER_TILE> chunks;
+    IO::Common::DataStructures::CAaBox bounds;                       ///> World bounds of all chunks and heights.
+  };
+
+  /**
+   * Extracts tile summaries straight from raw root ADT buffers, for map overviews, bounds and scheduling.
+   * Top-level chunks and MCNK subchunks are skipped by size, only MHDR, MCNK headers and MCVT are read. Height ranges
+   * are reduced with SIMD directly on the MCVT payload in the buffer, without copying or parsing the tile.
+   */
+  class TileProbe
+  {
+  public:
+    using TileReadFunc = std::function<std::optional<IO::Common::ByteBuffer>(std::size_t tile_x, std::size_t tile_y)>;
+    using TileSummaryFunc = std::function<void(std::size_t tile_x, std::size_t tile_y, TileSummary const& summary)>;
+
+    /**
+     * Probes a raw root ADT. Chunk sizes are validated against the buffer in all builds.
+     * @param buf Raw root ADT, its position is left unchanged.
+     * @param summary Receives the summary of the tile, partially filled on failure.
+     * @return False if the buffer is malformed or does not contain exactly 256 chunks.
+     */
+    static bool Probe(IO::Common::ByteBuffer const& buf, TileSummary& summary);
+
+    /**
+     * Probes all tiles of a map in parallel. Callbacks are invoked concurrently from worker threads.
+     * @param read Reads the raw root ADT of a tile, returns nothing if the tile does not exist.
+     * @param receive Receives the summary of each existing tile. Malformed tiles are logged and skipped.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     * @return Number of tiles probed successfully.
+     */
+    static std::size_t ProbeMap(TileReadFunc const& read, TileSummaryFunc const& receive, std::size_t n_threads = 0);
+  };
+}
@@ -0,0 +1,382 @@
+#include <Terrain/TileRaycaster.hpp>
+#include <Utils/Misc/ParallelFor.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Terrain;
+using namespace IO::Common::DataStructures;
+
+namespace
+{
+  constexpr float VERTEX_SPACING = IO::Common::WorldConstants::CHUNK_SIZE / TileHeightfield::CHUNK_INNER_DIM;
+
+  // rays are traversed in grid space: x along grid columns, y along grid rows, z up, one unit per quad
+  struct Vec3
+  {
+    float x;
+    float y;
+    float z;
+  };
+
+  FORCEINLINE Vec3 operator-(Vec3 const& lhs, Vec3 const& rhs) { return {lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z}; }
+  FORCEINLINE float Dot(Vec3 const& lhs, Vec3 const& rhs) { return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z; }
+
+  FORCEINLINE Vec3 Cross(Vec3 const& lhs, Vec3 const& rhs)
+  {
+    return {lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x};
+  }
+
+  // avoids NaN in slab tests for axis-parallel rays
+  FORCEINLINE float SafeInverse(float value)
+  {
+    constexpr float epsilon = 1e-30f;
+    return 1.f / (std::abs(value) > epsilon ? value : std::copysign(epsilon, value));
+  }
+
+  FORCEINLINE bool IntersectSlabs(Vec3 const& origin, Vec3 const& inv_dir
+                                  , float x0, float x1, float y0, float y1, float z0, float z1
+                                  , float t_max, float& t_enter)
+  {
+    float tx0 = (x0 - origin.x) * inv_dir.x;
+    float tx1 = (x1 - origin.x) * inv_dir.x;
+    float ty0 = (y0 - origin.y) * inv_dir.y;
+    float ty1 = (y1 - origin.y) * inv_dir.y;
+    float tz0 = (z0 - origin.z) * inv_dir.z;
+    float tz1 = (z1 - origin.z) * inv_dir.z;
+
+    if (tx0 > tx1) std::swap(tx0, tx1);
+    if (ty0 > ty1) std::swap(ty0, ty1);
+    if (tz0 > tz1) std::swap(tz0, tz1);
+
+    t_enter = std::max(std::max(tx0, ty0), std::max(tz0, 0.f));
+    float const t_exit = std::min(std::min(tx1, ty1), std::min(tz1, t_max));
+
+    return t_enter <= t_exit;
+  }
+
+  // Moller-Trumbore, two-sided, slightly tolerant on edges so that rays do not slip between triangles
+  FORCEINLINE bool IntersectTriangle(Vec3 const& origin, Vec3 const& dir
+                                     , Vec3 const& a, Vec3 const& b, Vec3 const& c
+                                     , float& t)
+  {
+    constexpr float epsilon = 1e-6f;
+
+    Vec3 const e1 = b - a;
+    Vec3 const e2 = c - a;
+    Vec3 const p = Cross(dir, e2);
+    float const det = Dot(e1, p);
+
+    if (det == 0.f)
+      return false;
+
+    float const inv_det = 1.f / det;
+    Vec3 const s = origin - a;
+    float const u = Dot(s, p) * inv_det;
+
+    if (u < -epsilon || u > 1.f + epsilon)
+      return false;
+
+    Vec3 const q = Cross(s, e1);
+    float const v = Dot(dir, q) * inv_det;
+
+    if (v < -epsilon || u + v > 1.f + epsilon)
+      return false;
+
+    t = Dot(e2, q) * inv_det;
+    return t >= 0.f;
+  }
+
+  // height of the plane through a, b, c at (x, y)
+  FORCEINLINE float PlaneHeight(Vec3 const& a, Vec3 const& b, Vec3 const& c, float x, float y)
+  {
+    Vec3 const n = Cross(b - a, c - a);
+    return a.z - (n.x * (x - a.x) + n.y * (y - a.y)) / n.z;
+  }
+}
+
+TileRaycaster::TileRaycaster()
+: _heightfield()
+, _origin{0.f, 0.f}
+, _holes{}
+{
+  for (std::size_t level = 0; level < N_LEVELS; ++level)
+  {
+    _levels[level].assign(LevelDim(level) * LevelDim(level), NodeBounds{0.f, 0.f});
+  }
+}
+
+void TileRaycaster::Build(TileHeightfield const& heightfield
+                          , C2Vector origin
+                          , std::span<std::uint64_t const, IO::Common::WorldConstants::CHUNKS_PER_TILE> holes)
+{
+  _heightfield = heightfield;
+  _origin = origin;
+  std::copy(holes.begin(), holes.end(), _holes.begin());
+
+  UpdateLevels(0, 0, N_QUADS_PER_ROW - 1, N_QUADS_PER_ROW - 1);
+}
+
+void TileRaycaster::Refit(TileHeightfield const& heightfield, VertexRect const& dirty)
+{
+  RequireF(CCodeZones::TERRAIN, dirty.x_min <= dirty.x_max && dirty.y_min <= dirty.y_max
+           && dirty.x_max < TileHeightfield::OUTER_DIM && dirty.y_max < TileHeightfield::OUTER_DIM
+           , "Invalid vertex rectangle.");
+
+  // quads touching the rectangle, inner vertices adjacent to it included
+  std::size_t const quad_x_min = dirty.x_min ? dirty.x_min - 1 : 0;
+  std::size_t const quad_y_min = dirty.y_min ? dirty.y_min - 1 : 0;
+  std::size_t const quad_x_max = std::min(dirty.x_max, N_QUADS_PER_ROW - 1);
+  std::size_t const quad_y_max = std::min(dirty.y_max, N_QUADS_PER_ROW - 1);
+
+  for (std::size_t y = dirty.y_min; y <= dirty.y_max; ++y)
+  {
+    std::copy(heightfield.OuterRow(y) + dirty.x_min, heightfield.OuterRow(y) + dirty.x_max + 1
+              , _heightfield.OuterRow(y) + dirty.x_min);
+  }
+
+  for (std::size_t y = quad_y_min; y <= quad_y_max; ++y)
+  {
+    std::copy(heightfield.InnerRow(y) + quad_x_min, heightfield.InnerRow(y) + quad_x_max + 1
+              , _heightfield.InnerRow(y) + quad_x_min);
+  }
+
+  UpdateLevels(quad_x_min, quad_y_min, quad_x_max, quad_y_max);
+}
+
+void TileRaycaster::SetHoles(std::size_t chunk_x, std::size_t chunk_y, std::uint64_t holes)
+{
+  RequireF(CCodeZones::TERRAIN, chunk_x < TileHeightfield::CHUNKS_PER_ROW
+           && chunk_y < TileHeightfield::CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+  _holes[chunk_y * TileHeightfield::CHUNKS_PER_ROW + chunk_x] = holes;
+}
+
+void TileRaycaster::UpdateLevels(std::size_t quad_x_min
+                                 , std::size_t quad_y_min
+                                 , std::size_t quad_x_max
+                                 , std::size_t quad_y_max)
+{
+  auto& quads = _levels[0];
+
+  for (std::size_t y = quad_y_min; y <= quad_y_max; ++y)
+  {
+    for (std::size_t x = quad_x_min; x <= quad_x_max; ++x)
+    {
+      float const corners[] = { _heightfield.Outer(x, y), _heightfield.Outer(x + 1, y)
+                                , _heightfield.Outer(x, y + 1), _heightfield.Outer(x + 1, y + 1)
+                                , _heightfield.Inner(x, y) };
+
+      auto const [min, max] = std::minmax_element(std::begin(corners), std::end(corners));
+      quads[y * N_QUADS_PER_ROW + x] = {*min, *max};
+    }
+  }
+
+  for (std::size_t level = 1; level < N_LEVELS; ++level)
+  {
+    quad_x_min >>= 1;
+    quad_y_min >>= 1;
+    quad_x_max >>= 1;
+    quad_y_max >>= 1;
+
+    auto const& children = _levels[level - 1];
+    auto& nodes = _levels[level];
+    std::size_t const dim = LevelDim(level);
+    std::size_t const child_dim = dim * 2;
+
+    for (std::size_t y = quad_y_min; y <= quad_y_max; ++y)
+    {
+      for (std::size_t x = quad_x_min; x <= quad_x_max; ++x)
+      {
+        NodeBounds const& c00 = children[(y * 2) * child_dim + x * 2];
+        NodeBounds const& c10 = children[(y * 2) * child_dim + x * 2 + 1];
+        NodeBounds const& c01 = children[(y * 2 + 1) * child_dim + x * 2];
+        NodeBounds const& c11 = children[(y * 2 + 1) * child_dim + x * 2 + 1];
+
+        nodes[y * dim + x] = { std::min(std::min(c00.min, c10.min), std::min(c01.min, c11.min))
+                               , std::max(std::max(c00.max, c10.max), std::max(c01.max, c11.max)) };
+      }
+    }
+  }
+}
+
+std::optional<RayHit> TileRaycaster::Cast(Ray const& ray) const
+{
+  constexpr float inv_spacing = 1.f / VERTEX_SPACING;
+
+  Vec3 const origin { (_origin.y - ray.origin.y) * inv_spacing
+                      , (_origin.x - ray.origin.x) * inv_spacing
+                      , ray.origin.z };
+
+  Vec3 const dir { -ray.direction.y * inv_spacing, -ray.direction.x * inv_spacing, ray.direction.z };
+  Vec3 const inv_dir { SafeInverse(dir.x), SafeInverse(dir.y), SafeInverse(dir.z) };
+
+  struct Node
+  {
+    std::uint32_t level;
+    std::uint32_t x;
+    std::uint32_t y;
+    float t_enter;
+  };
+
+  // each level pushes at most 4 children and pops 1
+  std::array<Node, 3 * N_LEVELS + 1> stack;
+  std::size_t stack_size = 0;
+
+  float t_best = ray.t_max;
+  std::optional<std::pair<std::size_t, std::size_t>> best_quad {};
+
+  auto const try_push = [&](std::size_t level, std::size_t x, std::size_t y) -> void
+  {
+    std::size_t const size = std::size_t{1} << level;
+    NodeBounds const& bounds = _levels[level][y * LevelDim(level) + x];
+
+    float t_enter;
+    if (IntersectSlabs(origin, inv_dir
+                       , static_cast<float>(x * size), static_cast<float>((x + 1) * size)
+                       , static_cast<float>(y * size), static_cast<float>((y + 1) * size)
+                       , bounds.min, bounds.max, t_best, t_enter))
+    {
+      stack[stack_size++] = { static_cast<std::uint32_t>(level), static_cast<std::uint32_t>(x)
+                              , static_cast<std::uint32_t>(y), t_enter };
+    }
+  };
+
+  // children closer to the ray origin are pushed last to be visited first
+  std::size_t const near_x = dir.x < 0.f ? 1 : 0;
+  std::size_t const near_y = dir.y < 0.f ? 1 : 0;
+
+  try_push(N_LEVELS - 1, 0, 0);
+
+  while (stack_size)
+  {
+    Node const node = stack[--stack_size];
+
+    if (node.t_enter > t_best)
+      continue;
+
+    if (node.level)
+    {
+      std::size_t const level = node.level - 1;
+
+      try_push(level, node.x * 2 + (1 - near_x), node.y * 2 + (1 - near_y));
+      try_push(level, node.x * 2 + near_x, node.y * 2 + (1 - near_y));
+      try_push(level, node.x * 2 + (1 - near_x), node.y * 2 + near_y);
+      try_push(level, node.x * 2 + near_x, node.y * 2 + near_y);
+      continue;
+    }
+
+    if (IsHole(node.x, node.y))
+      continue;
+
+    auto const fx = static_cast<float>(node.x);
+    auto const fy = static_cast<float>(node.y);
+
+    Vec3 const nw {fx, fy, _heightfield.Outer(node.x, node.y)};
+    Vec3 const ne {fx + 1.f, fy, _heightfield.Outer(node.x + 1, node.y)};
+    Vec3 const sw {fx, fy + 1.f, _heightfield.Outer(node.x, node.y + 1)};
+    Vec3 const se {fx + 1.f, fy + 1.f, _heightfield.Outer(node.x + 1, node.y + 1)};
+    Vec3 const center {fx + 0.5f, fy + 0.5f, _heightfield.Inner(node.x, node.y)};
+
+    Vec3 const* const triangles[4][2] = { {&nw, &ne}, {&ne, &se}, {&se, &sw}, {&sw, &nw} };
+
+    for (auto const& triangle : triangles)
+    {
+      float t;
+      if (IntersectTriangle(origin, dir, *triangle[0], *triangle[1], center, t) && t <= t_best)
+      {
+        t_best = t;
+        best_quad = {node.x, node.y};
+      }
+    }
+  }
+
+  if (!best_quad)
+    return std::nullopt;
+
+  return RayHit{ t_best
+                 , { ray.origin.x + ray.direction.x * t_best
+                     , ray.origin.y + ray.direction.y * t_best
+                     , ray.origin.z + ray.direction.z * t_best }
+                 , static_cast<std::uint8_t>(best_quad->first / TileHeightfield::CHUNK_INNER_DIM)
+                 , static_cast<std::uint8_t>(best_quad->second / TileHeightfield::CHUNK_INNER_DIM) };
+}
+
+void TileRaycaster::Cast(std::span<Ray const> rays, std::span<std::optional<RayHit>> hits, std::size_t n_threads) const
+{
+  RequireF(CCodeZones::TERRAIN, rays.size() == hits.size(), "Number of rays and hits mismatch.");
+
+  constexpr std::size_t grain = 256;
+
+  Utils::Misc::ParallelFor(0, rays.size(), [&](std::size_t i) { hits[i] = Cast(rays[i]); }, grain, n_threads);
+}
+
+std::optional<float> TileRaycaster::Height(float x, float y) const
+{
+  float const grid_x = (_origin.y - y) / VERTEX_SPACING;
+  float const grid_y = (_origin.x - x) / VERTEX_SPACING;
+
+  auto const max = static_cast<float>(N_QUADS_PER_ROW);
+
+  if (!(grid_x >= 0.f && grid_x <= max && grid_y >= 0.f && grid_y <= max))
+    return std::nullopt;
+
+  std::size_t const quad_x = std::min(static_cast<std::size_t>(grid_x), N_QUADS_PER_ROW - 1);
+  std::size_t const quad_y = std::min(static_cast<std::size_t>(grid_y), N_QUADS_PER_ROW - 1);
+
+  if (IsHole(quad_x, quad_y))
+    return std::nullopt;
+
+  auto const fx = static_cast<float>(quad_x);
+  auto const fy = static_cast<float>(quad_y);
+
+  Vec3 const center {fx + 0.5f, fy + 0.5f, _heightfield.Inner(quad_x, quad_y)};
+
+  auto const corner = [&](std::size_t dx, std::size_t dy) -> Vec3
+  {
+    return {fx + dx, fy + dy, _heightfield.Outer(quad_x + dx, quad_y + dy)};
+  };
+
+  // pick the triangle of the quad containing the point by its offset from the center
+  float const dx = grid_x - center.x;
+  float const dy = grid_y - center.y;
+
+  if (std::abs(dy) >= std::abs(dx))
+  {
+    return dy < 0.f ? PlaneHeight(corner(0, 0), corner(1, 0), center, grid_x, grid_y)
+                    : PlaneHeight(corner(1, 1), corner(0, 1), center, grid_x, grid_y);
+  }
+
+  return dx > 0.f ? PlaneHeight(corner(1, 0), corner(1, 1), center, grid_x, grid_y)
+                  : PlaneHeight(corner(0, 1), corner(0, 0), center, grid_x, grid_y);
+}
+
+CAaBox TileRaycaster::GridToWorld(std::size_t level, std::size_t x, std::size_t y) const
+{
+  float const size = static_cast<float>(std::size_t{1} << level) * VERTEX_SPACING;
+  NodeBounds const& bounds = _levels[level][y * LevelDim(level) + x];
+
+  // grid x runs along world -Y, grid y runs along world -X
+  return { { _origin.x - (y + 1) * size, _origin.y - (x + 1) * size, bounds.min }
+           , { _origin.x - y * size, _origin.y - x * size, bounds.max } };
+}
+
+CAaBox TileRaycaster::ChunkBounds(std::size_t chunk_x, std::size_t chunk_y) const
+{
+  RequireF(CCodeZones::TERRAIN, chunk_x < TileHeightfield::CHUNKS_PER_ROW
+           && chunk_y < TileHeightfield::CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+  return GridToWorld(CHUNK_LEVEL, chunk_x, chunk_y);
+}
+
+CAaBox TileRaycaster::Bounds() const
+{
+  return GridToWorld(N_LEVELS - 1, 0, 0);
+}
+
+std::uint64_t TileRaycaster::HoleMask(IO::ADT::DataStructures::SMChunk const& header)
+{
+  return TileHoles::Decode(header);
+}
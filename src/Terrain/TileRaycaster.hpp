@@ -0,0 +1,181 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+#include <Terrain/TileNormals.hpp>
+#include <Terrain/TileHoles.hpp>
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/ADT/DataStructures.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Terrain
+{
+  /**
+   * Ray in world coordinates (same frame as MCNK positions).
+   */
+  struct Ray
+  {
+    IO::Common::DataStructures::C3Vector origin;
+    IO::Common::DataStructures::C3Vector direction;                   ///> Does not need to be normalized.
+    float t_max = std::numeric_limits<float>::infinity();          ///> Maximum distance in units of direction.
+  };
+
+  /**
+   * Intersection of a ray with terrain.
+   */
+  struct RayHit
+  {
+    float t;                                                        ///> Distance along the ray in units of direction.
+    IO::Common::DataStructures::C3Vector position;                  ///> Intersection point in world coordinates.
+    std::uint8_t chunk_x;                                           ///> Horizontal index of the chunk hit.
+    std::uint8_t chunk_y;                                           ///> Vertical index of the chunk hit.
+  };
+
+  /**
+   * Ray-cast acceleration structure of a tile.
+   * Heights are organized as an implicit quadtree of min / max bounds over the 128x128 quads of the tile: the levels
+   * are the whole tile, chunks (MCNK), patches of 2x2 quads, and single quads. Rays are traversed front to back and
+   * intersected exactly with the 4 triangles of each quad, quads masked as holes (SMChunk holes) are skipped.
+   */
+  class TileRaycaster
+  {
+  public:
+    static constexpr std::size_t N_QUADS_PER_ROW = TileHeightfield::INNER_DIM;
+
+    // level 0 are single quads, level 7 is the whole tile
+    static constexpr std::size_t N_LEVELS = 8;
+    static constexpr std::size_t CHUNK_LEVEL = 3;
+
+    /**
+     * Constructs a raycaster of a flat tile at height 0 and origin 0.
+     */
+    TileRaycaster();
+
+    /**
+     * Constructs a raycaster from an ADT root file.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    explicit TileRaycaster(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Builds the raycaster from an ADT root file. Origin of the tile is taken from the first chunk.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Build(IO::ADT::ADTRoot<client_version> const& root);
+
+    /**
+     * Builds the raycaster from a heightfield.
+     * @param heightfield Heightfield of the tile.
+     * @param origin World position of the first outer vertex (MCNK position of the first chunk).
+     * @param holes High resolution hole masks of the chunks, see HoleMask().
+     */
+    void Build(TileHeightfield const& heightfield
+               , IO::Common::DataStructures::C2Vector origin
+               , std::span<std::uint64_t const, IO::Common::WorldConstants::CHUNKS_PER_TILE> holes);
+
+    /**
+     * Updates the raycaster after heights changed within a rectangle of vertices.
+     * @param heightfield Heightfield of the tile.
+     * @param dirty Rectangle of vertices whose heights have changed.
+     */
+    void Refit(TileHeightfield const& heightfield, VertexRect const& dirty);
+
+    /**
+     * Sets the hole mask of a chunk.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param holes High resolution hole mask, see HoleMask().
+     */
+    void SetHoles(std::size_t chunk_x, std::size_t chunk_y, std::uint64_t holes);
+
+    /**
+     * Finds the closest intersection of a ray with the terrain.
+     * @param ray Ray to cast.
+     * @return Closest intersection within ray.t_max, if any.
+     */
+    [[nodiscard]]
+    std::optional<RayHit> Cast(Ray const& ray) const;
+
+    /**
+     * Casts a batch of rays in parallel.
+     * @param rays Rays to cast.
+     * @param hits Closest intersection of each ray, must be the same size as rays.
+     * @param n_threads Maximum number of threads, 0 for all hardware threads.
+     */
+    void Cast(std::span<Ray const> rays, std::span<std::optional<RayHit>> hits, std::size_t n_threads = 0) const;
+
+    /**
+     * Exact height of the terrain surface at a world position.
+     * @param x World X coordinate.
+     * @param y World Y coordinate.
+     * @return Height, or nothing if the position is outside of the tile or within a hole.
+     */
+    [[nodiscard]]
+    std::optional<float> Height(float x, float y) const;
+
+    /**
+     * World space bounds of a chunk.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @return Bounding box.
+     */
+    [[nodiscard]]
+    IO::Common::DataStructures::CAaBox ChunkBounds(std::size_t chunk_x, std::size_t chunk_y) const;
+
+    /**
+     * World space bounds of the tile.
+     * @return Bounding box.
+     */
+    [[nodiscard]]
+    IO::Common::DataStructures::CAaBox Bounds() const;
+
+    /**
+     * High resolution hole mask of a chunk (bit row * 8 + column is set for a hole quad).
+     * Low resolution masks (a bit per 2x2 quads) are expanded, see TileHoles::Decode().
+     * @param header Chunk header.
+     * @return Hole mask.
+     */
+    [[nodiscard]]
+    static std::uint64_t HoleMask(IO::ADT::DataStructures::SMChunk const& header);
+
+  private:
+    struct NodeBounds
+    {
+      float min;
+      float max;
+    };
+
+    [[nodiscard]]
+    FORCEINLINE static std::size_t LevelDim(std::size_t level) { return N_QUADS_PER_ROW >> level; };
+
+    [[nodiscard]]
+    FORCEINLINE bool IsHole(std::size_t quad_x, std::size_t quad_y) const
+    {
+      std::size_t const chunk = (quad_y / 8) * TileHeightfield::CHUNKS_PER_ROW + quad_x / 8;
+      return (_holes[chunk] >> ((quad_y % 8) * 8 + quad_x % 8)) & 1;
+    };
+
+    [[nodiscard]]
+    IO::Common::DataStructures::CAaBox GridToWorld(std::size_t level, std::size_t x, std::size_t y) const;
+
+    void UpdateLevels(std::size_t quad_x_min, std::size_t quad_y_min, std::size_t quad_x_max, std::size_t quad_y_max);
+
+    TileHeightfield _heightfield;
+    IO::Common::DataStructures::C2Vector _origin;
+    std::array<std::uint64_t, IO::Common::WorldConstants::CHUNKS_PER_TILE> _holes;
+    std::array<std::vector<NodeBounds>, N_LEVELS> _levels;
+  };
+}
+
+#include <Terrain/TileRaycaster.inl>
@@ -0,0 +1,26 @@
+#pragma once
+#include <Terrain/TileRaycaster.hpp>
+#include <Terrain/Common.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline TileRaycaster::TileRaycaster(IO::ADT::ADTRoot<client_version> const& root)
+  : TileRaycaster()
+  {
+    Build(root);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileRaycaster::Build(IO::ADT::ADTRoot<client_version> const& root)
+  {
+    auto const& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    auto const& position = chunks[0].Header().position;
+    Build(TileHeightfield{root}, {position.x, position.y}, TileHoles{root}.Masks());
+  }
+}
@@ -0,0 +1,404 @@
+#include <Terrain/TileVertexColors.hpp>
+#include <Utils/Misc/SIMD.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Terrain;
+using namespace Utils::Misc::SIMD;
+using namespace IO::Common::DataStructures;
+
+// members Load / Store hide the SIMD functions of the same name
+namespace SIMD = Utils::Misc::SIMD;
+
+namespace
+{
+  constexpr float VERTEX_SPACING = IO::Common::WorldConstants::CHUNK_SIZE / TileHeightfield::CHUNK_INNER_DIM;
+
+  constexpr std::size_t CHUNK_OUTER_DIM = TileHeightfield::CHUNK_OUTER_DIM;
+  constexpr std::size_t CHUNK_INNER_DIM = TileHeightfield::CHUNK_INNER_DIM;
+  constexpr std::size_t CHUNK_ROW_STRIDE = (CHUNK_OUTER_DIM + CHUNK_INNER_DIM) * TileVertexColors::N_CHANNELS;
+
+  // channel (r, g, b, a) of each byte of a packed pixel
+  constexpr std::array<std::size_t, TileVertexColors::N_CHANNELS> MCCV_ORDER {2, 1, 0, 3};
+  constexpr std::array<std::size_t, TileVertexColors::N_CHANNELS> MCLV_ORDER {0, 1, 2, 3};
+
+  constexpr std::array<std::size_t, TileVertexColors::N_CHANNELS> const& ChannelOrder(VertexColorFormat format)
+  {
+    return format == VertexColorFormat::MCCV ? MCCV_ORDER : MCLV_ORDER;
+  }
+
+  constexpr std::array<float, TileVertexColors::N_CHANNELS> Channels(VertexColor const& color)
+  {
+    return {color.r, color.g, color.b, color.a};
+  }
+
+  void RequireValidRect([[maybe_unused]] VertexRect const& rect)
+  {
+    RequireF(CCodeZones::TERRAIN, rect.x_min <= rect.x_max && rect.y_min <= rect.y_max
+             && rect.x_max < TileHeightfield::OUTER_DIM && rect.y_max < TileHeightfield::OUTER_DIM
+             , "Invalid vertex rectangle.");
+  }
+
+  // chunks containing a span of a row of vertices, outer vertices on chunk borders belong to both chunks
+  void MarkChunks(std::bitset<IO::Common::WorldConstants::CHUNKS_PER_TILE>& chunks
+                  , bool outer
+                  , std::size_t y
+                  , std::size_t x_min
+                  , std::size_t x_max)
+  {
+    constexpr std::size_t last_chunk = TileHeightfield::CHUNKS_PER_ROW - 1;
+
+    std::size_t const chunk_x_min = outer && x_min ? (x_min - 1) / CHUNK_INNER_DIM : x_min / CHUNK_INNER_DIM;
+    std::size_t const chunk_y_min = outer && y ? (y - 1) / CHUNK_INNER_DIM : y / CHUNK_INNER_DIM;
+    std::size_t const chunk_x_max = std::min(x_max / CHUNK_INNER_DIM, last_chunk);
+    std::size_t const chunk_y_max = std::min(y / CHUNK_INNER_DIM, last_chunk);
+
+    for (std::size_t cy = chunk_y_min; cy <= chunk_y_max; ++cy)
+    {
+      for (std::size_t cx = chunk_x_min; cx <= chunk_x_max; ++cx)
+      {
+        chunks.set(cy * TileHeightfield::CHUNKS_PER_ROW + cx);
+      }
+    }
+  }
+
+  // splits a row of packed pixels into rows of channels, starting at the given vertex
+  void UnpackRow(std::uint8_t const* pixels
+                 , std::array<float*, TileVertexColors::N_CHANNELS> const& rows
+                 , std::size_t x0
+                 , std::size_t n)
+  {
+    ForRange(0, n, [&]<typename V>(V, std::size_t i) -> void
+    {
+      V lanes[TileVertexColors::N_CHANNELS];
+      LoadInterleaved(pixels + i * TileVertexColors::N_CHANNELS, lanes);
+
+      for (std::size_t c = 0; c < TileVertexColors::N_CHANNELS; ++c)
+      {
+        Store(rows[c] + x0 + i, lanes[c]);
+      }
+    });
+  }
+
+  void PackRow(std::uint8_t* pixels
+               , std::array<float const*, TileVertexColors::N_CHANNELS> const& rows
+               , std::size_t x0
+               , std::size_t n)
+  {
+    ForRange(0, n, [&]<typename V>(V, std::size_t i) -> void
+    {
+      V lanes[TileVertexColors::N_CHANNELS];
+
+      for (std::size_t c = 0; c < TileVertexColors::N_CHANNELS; ++c)
+      {
+        lanes[c] = Load<V>(rows[c] + x0 + i);
+      }
+
+      StoreInterleaved(pixels + i * TileVertexColors::N_CHANNELS, lanes);
+    });
+  }
+}
+
+TileVertexColors::TileVertexColors()
+: TileVertexColors(VertexColor{127.f, 127.f, 127.f, 127.f})
+{
+}
+
+TileVertexColors::TileVertexColors(VertexColor const& color)
+{
+  for (std::size_t c = 0; c < N_CHANNELS; ++c)
+  {
+    _outer[c].resize(OUTER_DIM * OUTER_DIM);
+    _inner[c].resize(INNER_DIM * INNER_DIM);
+  }
+
+  Fill(color);
+  _dirty.reset();
+}
+
+template<typename Kernel>
+void TileVertexColors::ForRect(VertexRect const& rect, Kernel&& kernel)
+{
+  RequireValidRect(rect);
+
+  for (std::size_t y = rect.y_min; y <= rect.y_max; ++y)
+  {
+    Rows const rows {OuterRow(0, y), OuterRow(1, y), OuterRow(2, y), OuterRow(3, y)};
+
+    ForRange(rect.x_min, rect.x_max + 1, [&]<typename V>(V, std::size_t i) -> void
+    {
+      kernel(V{}, rows, true, y, i);
+    });
+
+    MarkChunks(_dirty, true, y, rect.x_min, rect.x_max);
+  }
+
+  // inner vertex (x, y) lies within the quad of outer vertices (x, y) - (x + 1, y + 1)
+  std::size_t const inner_x_min = rect.x_min ? rect.x_min - 1 : 0;
+  std::size_t const inner_y_min = rect.y_min ? rect.y_min - 1 : 0;
+  std::size_t const inner_x_max = std::min(rect.x_max, INNER_DIM - 1);
+  std::size_t const inner_y_max = std::min(rect.y_max, INNER_DIM - 1);
+
+  for (std::size_t y = inner_y_min; y <= inner_y_max; ++y)
+  {
+    Rows const rows {InnerRow(0, y), InnerRow(1, y), InnerRow(2, y), InnerRow(3, y)};
+
+    ForRange(inner_x_min, inner_x_max + 1, [&]<typename V>(V, std::size_t i) -> void
+    {
+      kernel(V{}, rows, false, y, i);
+    });
+
+    MarkChunks(_dirty, false, y, inner_x_min, inner_x_max);
+  }
+}
+
+void TileVertexColors::LoadChunk(std::size_t chunk_x
+                                 , std::size_t chunk_y
+                                 , std::uint8_t const* pixels
+                                 , VertexColorFormat format)
+{
+  RequireF(CCodeZones::TERRAIN, chunk_x < TileHeightfield::CHUNKS_PER_ROW
+           && chunk_y < TileHeightfield::CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+  auto const& order = ChannelOrder(format);
+
+  std::size_t const x0 = chunk_x * CHUNK_INNER_DIM;
+  std::size_t const y0 = chunk_y * CHUNK_INNER_DIM;
+
+  // chunks interleave rows of 9 outer and 8 inner vertices, same as MCVT
+  for (std::size_t row = 0; row < CHUNK_OUTER_DIM; ++row)
+  {
+    std::uint8_t const* src_outer = pixels + row * CHUNK_ROW_STRIDE;
+
+    UnpackRow(src_outer, {OuterRow(order[0], y0 + row), OuterRow(order[1], y0 + row)
+                          , OuterRow(order[2], y0 + row), OuterRow(order[3], y0 + row)}, x0, CHUNK_OUTER_DIM);
+
+    if (row == CHUNK_INNER_DIM)
+      break;
+
+    UnpackRow(src_outer + CHUNK_OUTER_DIM * N_CHANNELS
+              , {InnerRow(order[0], y0 + row), InnerRow(order[1], y0 + row)
+                 , InnerRow(order[2], y0 + row), InnerRow(order[3], y0 + row)}, x0, CHUNK_INNER_DIM);
+  }
+}
+
+void TileVertexColors::StoreChunk(std::size_t chunk_x
+                                  , std::size_t chunk_y
+                                  , std::uint8_t* pixels
+                                  , VertexColorFormat format) const
+{
+  RequireF(CCodeZones::TERRAIN, chunk_x < TileHeightfield::CHUNKS_PER_ROW
+           && chunk_y < TileHeightfield::CHUNKS_PER_ROW, "Chunk index out of bounds.");
+
+  auto const& order = ChannelOrder(format);
+
+  std::size_t const x0 = chunk_x * CHUNK_INNER_DIM;
+  std::size_t const y0 = chunk_y * CHUNK_INNER_DIM;
+
+  for (std::size_t row = 0; row < CHUNK_OUTER_DIM; ++row)
+  {
+    std::uint8_t* dst_outer = pixels + row * CHUNK_ROW_STRIDE;
+
+    PackRow(dst_outer, {OuterRow(order[0], y0 + row), OuterRow(order[1], y0 + row)
+                        , OuterRow(order[2], y0 + row), OuterRow(order[3], y0 + row)}, x0, CHUNK_OUTER_DIM);
+
+    if (row == CHUNK_INNER_DIM)
+      break;
+
+    PackRow(dst_outer + CHUNK_OUTER_DIM * N_CHANNELS
+            , {InnerRow(order[0], y0 + row), InnerRow(order[1], y0 + row)
+               , InnerRow(order[2], y0 + row), InnerRow(order[3], y0 + row)}, x0, CHUNK_INNER_DIM);
+  }
+}
+
+void TileVertexColors::Fill(VertexColor const& color, VertexRect const& rect)
+{
+  auto const values = Channels(color);
+
+  ForRect(rect, [&]<typename V>(V, Rows const& rows, bool, std::size_t, std::size_t i) -> void
+  {
+    for (std::size_t c = 0; c < N_CHANNELS; ++c)
+    {
+      SIMD::Store(rows[c] + i, Broadcast<V>(values[c]));
+    }
+  });
+}
+
+void TileVertexColors::Multiply(VertexColor const& factor, VertexRect const& rect)
+{
+  auto const values = Channels(factor);
+
+  ForRect(rect, [&]<typename V>(V, Rows const& rows, bool, std::size_t, std::size_t i) -> void
+  {
+    for (std::size_t c = 0; c < N_CHANNELS; ++c)
+    {
+      SIMD::Store(rows[c] + i, SIMD::Load<V>(rows[c] + i) * Broadcast<V>(values[c]));
+    }
+  });
+}
+
+void TileVertexColors::Lerp(VertexColor const& color, float t, VertexRect const& rect)
+{
+  auto const values = Channels(color);
+
+  ForRect(rect, [&]<typename V>(V, Rows const& rows, bool, std::size_t, std::size_t i) -> void
+  {
+    for (std::size_t c = 0; c < N_CHANNELS; ++c)
+    {
+      V const value = SIMD::Load<V>(rows[c] + i);
+      SIMD::Store(rows[c] + i, value + (Broadcast<V>(values[c]) - value) * Broadcast<V>(t));
+    }
+  });
+}
+
+void TileVertexColors::Blend(TileVertexColors const& source, float t, VertexRect const& rect)
+{
+  ForRect(rect, [&]<typename V>(V, Rows const& rows, bool outer, std::size_t y, std::size_t i) -> void
+  {
+    for (std::size_t c = 0; c < N_CHANNELS; ++c)
+    {
+      float const* src = outer ? source.OuterRow(c, y) : source.InnerRow(c, y);
+
+      V const value = SIMD::Load<V>(rows[c] + i);
+      SIMD::Store(rows[c] + i, value + (SIMD::Load<V>(src + i) - value) * Broadcast<V>(t));
+    }
+  });
+}
+
+void TileVertexColors::FadeByHeight(TileHeightfield const& heightfield
+                                    , VertexColor const& color
+                                    , float height_min
+                                    , float height_max
+                                    , VertexRect const& rect)
+{
+  RequireF(CCodeZones::TERRAIN, height_max > height_min, "Fade height range is empty.");
+
+  auto const values = Channels(color);
+  float const inv_range = 1.f / (height_max - height_min);
+
+  ForRect(rect, [&]<typename V>(V, Rows const& rows, bool outer, std::size_t y, std::size_t i) -> void
+  {
+    float const* heights = outer ? heightfield.OuterRow(y) : heightfield.InnerRow(y);
+
+    V const t = Min(Max((SIMD::Load<V>(heights + i) - Broadcast<V>(height_min)) * Broadcast<V>(inv_range)
+                        , Broadcast<V>(0.f)), Broadcast<V>(1.f));
+
+    for (std::size_t c = 0; c < N_CHANNELS; ++c)
+    {
+      V const value = SIMD::Load<V>(rows[c] + i);
+      SIMD::Store(rows[c] + i, value + (Broadcast<V>(values[c]) - value) * t);
+    }
+  });
+}
+
+void TileVertexColors::Clamp(VertexColor const& min, VertexColor const& max, VertexRect const& rect)
+{
+  auto const lo = Channels(min);
+  auto const hi = Channels(max);
+
+  ForRect(rect, [&]<typename V>(V, Rows const& rows, bool, std::size_t, std::size_t i) -> void
+  {
+    for (std::size_t c = 0; c < N_CHANNELS; ++c)
+    {
+      SIMD::Store(rows[c] + i, Min(Max(SIMD::Load<V>(rows[c] + i), Broadcast<V>(lo[c])), Broadcast<V>(hi[c])));
+    }
+  });
+}
+
+BrushDirtyRegion TileVertexColors::Paint(ColorBrushSettings const& settings, C2Vector origin, C2Vector center)
+{
+  RequireF(CCodeZones::TERRAIN, settings.radius > 0.f, "Brush radius must be positive.");
+
+  BrushDirtyRegion dirty {};
+  auto const values = Channels(settings.color);
+
+  // grid space: x along grid columns (world -Y), y along grid rows (world -X), one unit per vertex
+  float const center_x = (origin.y - center.y) / VERTEX_SPACING;
+  float const center_y = (origin.x - center.x) / VERTEX_SPACING;
+  float const radius = settings.radius / VERTEX_SPACING;
+
+  auto const paint_grid = [&](bool outer) -> void
+  {
+    std::size_t const dim = outer ? OUTER_DIM : INNER_DIM;
+    float const offset = outer ? 0.f : 0.5f;
+    auto const last = static_cast<float>(dim - 1);
+
+    float const y_lo = std::max(std::ceil(center_y - radius - offset), 0.f);
+    float const y_hi = std::min(std::floor(center_y + radius - offset), last);
+
+    for (float fy = y_lo; fy <= y_hi; fy += 1.f)
+    {
+      float const dy = fy + offset - center_y;
+      float const half_width_sq = radius * radius - dy * dy;
+
+      if (half_width_sq <= 0.f)
+        continue;
+
+      float const half_width = std::sqrt(half_width_sq);
+      float const x_lo = std::max(std::ceil(center_x - half_width - offset), 0.f);
+      float const x_hi = std::min(std::floor(center_x + half_width - offset), last);
+
+      if (x_lo > x_hi)
+        continue;
+
+      auto const y = static_cast<std::size_t>(fy);
+      auto const x_min = static_cast<std::size_t>(x_lo);
+      auto const x_max = static_cast<std::size_t>(x_hi);
+
+      ForRange(x_min, x_max + 1, [&]<typename V>(V, std::size_t i) -> void
+      {
+        V const t = Min(BrushWeight<V>(Ramp<V>(static_cast<float>(i) + offset), Broadcast<V>(dy * dy)
+                                       , Broadcast<V>(center_x), Broadcast<V>(1.f / radius), settings.falloff)
+                        * Broadcast<V>(settings.strength), Broadcast<V>(1.f));
+
+        for (std::size_t c = 0; c < N_CHANNELS; ++c)
+        {
+          float* row = outer ? OuterRow(c, y) : InnerRow(c, y);
+
+          V const value = SIMD::Load<V>(row + i);
+          SIMD::Store(row + i, value + (Broadcast<V>(values[c]) - value) * t);
+        }
+      });
+
+      // dirty rectangle is in outer vertices, inner vertex (x, y) lies within outer (x, y) - (x + 1, y + 1)
+      std::size_t const rect_x_max = outer ? x_max : x_max + 1;
+      std::size_t const rect_y_max = outer ? y : y + 1;
+
+      if (!dirty.touched)
+      {
+        dirty.touched = true;
+        dirty.vertices = {x_min, y, rect_x_max, rect_y_max};
+      }
+      else
+      {
+        dirty.vertices.x_min = std::min(dirty.vertices.x_min, x_min);
+        dirty.vertices.y_min = std::min(dirty.vertices.y_min, y);
+        dirty.vertices.x_max = std::max(dirty.vertices.x_max, rect_x_max);
+        dirty.vertices.y_max = std::max(dirty.vertices.y_max, rect_y_max);
+      }
+
+      MarkChunks(dirty.chunks, outer, y, x_min, x_max);
+    }
+  };
+
+  paint_grid(true);
+  paint_grid(false);
+
+  _dirty |= dirty.chunks;
+  return dirty;
+}
+
+VertexColor TileVertexColors::Outer(std::size_t x, std::size_t y) const
+{
+  std::size_t const i = y * OUTER_DIM + x;
+  return {_outer[0][i], _outer[1][i], _outer[2][i], _outer[3][i]};
+}
+
+VertexColor TileVertexColors::Inner(std::size_t x, std::size_t y) const
+{
+  std::size_t const i = y * INNER_DIM + x;
+  return {_inner[0][i], _inner[1][i], _inner[2][i], _inner[3][i]};
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <Terrain/TileHeightfield.hpp>
+#include <Terrain/HeightBrush.hpp>
+#include <IO/Common.hpp>
+#include <IO/CommonDataStructures.hpp>
+#include <IO/WorldConstants.hpp>
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <IO/ADT/Root/ADTRootMCNK.hpp>
+#include <Utils/Misc/ForceInline.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Terrain
+{
+  enum class VertexColorFormat
+  {
+    MCCV = 0,       ///> Vertex colors (MCCVEntry, BGRA), multiplied with the terrain color, 0x7F is neutral.
+    MCLV = 1        ///> Vertex lighting (CArgb, RGBA).
+  };
+
+  /**
+   * Color of a vertex, channels are in 8-bit units (0 to 255).
+   */
+  struct VertexColor
+  {
+    float r = 0.f;
+    float g = 0.f;
+    float b = 0.f;
+    float a = 0.f;
+  };
+
+  struct ColorBrushSettings
+  {
+    BrushFalloff falloff = BrushFalloff::Smooth;
+    float radius = 10.f;                          ///> Radius in yards.
+    float strength = 1.f;                         ///> Blend factor toward color at the center.
+    VertexColor color;
+  };
+
+  /**
+   * Tile-wide vertex colors (MCCV) or vertex lighting (MCLV) of an ADT.
+   * Each channel of all 256 chunks is stored as a float in two contiguous row-major planar grids, laid out like
+   * TileHeightfield: outer vertices (129x129) and inner vertices (128x128). Edits run as SIMD kernels over rows of
+   * these grids, packed chunk data is converted with SIMD transposes on load and store.
+   * Edits mark the chunks they touch as dirty, and only dirty chunks are written back on store.
+   */
+  class TileVertexColors
+  {
+  public:
+    static constexpr std::size_t N_CHANNELS = 4;
+
+    static constexpr std::size_t OUTER_DIM = TileHeightfield::OUTER_DIM;
+    static constexpr std::size_t INNER_DIM = TileHeightfield::INNER_DIM;
+
+    /**
+     * Constructs vertex colors filled with neutral MCCV color (0x7F).
+     */
+    TileVertexColors();
+
+    /**
+     * Constructs vertex colors filled with a color.
+     * @param color Color of all vertices.
+     */
+    explicit TileVertexColors(VertexColor const& color);
+
+    /**
+     * Constructs vertex colors from the chunks of an ADT root file.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param format Colors to load.
+     */
+    template<IO::Common::ClientVersion client_version>
+    TileVertexColors(IO::ADT::ADTRoot<client_version> const& root, VertexColorFormat format);
+
+    /**
+     * Loads colors of all chunks of an ADT root file and clears dirty chunks.
+     * Chunks without colors are filled with neutral MCCV color (0x7F) or black MCLV.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param format Colors to load.
+     */
+    template<IO::Common::ClientVersion client_version>
+    void Load(IO::ADT::ADTRoot<client_version> const& root, VertexColorFormat format);
+
+    /**
+     * Stores colors into the dirty chunks of an ADT root file and clears dirty chunks.
+     * Stored chunks are initialized if needed, MCCV also sets the has_mccv flag of their header.
+     * @tparam client_version Version of the game client.
+     * @param root ADT root file.
+     * @param format Colors to store.
+     * @return Number of chunks stored.
+     */
+    template<IO::Common::ClientVersion client_version>
+    std::size_t Store(IO::ADT::ADTRoot<client_version>& root, VertexColorFormat format);
+
+    /**
+     * Loads colors of a single chunk from packed pixels.
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param pixels 145 pixels of 4 bytes, interleaved rows of 9 outer and 8 inner vertices.
+     * @param format Order of channels.
+     */
+    void LoadChunk(std::size_t chunk_x, std::size_t chunk_y, std::uint8_t const* pixels, VertexColorFormat format);
+
+    /**
+     * Stores colors of a single chunk into packed pixels, rounded and clamped to [0, 255].
+     * @param chunk_x Horizontal index of the chunk in the tile.
+     * @param chunk_y Vertical index of the chunk in the tile.
+     * @param pixels 145 pixels of 4 bytes, interleaved rows of 9 outer and 8 inner vertices.
+     * @param format Order of channels.
+     */
+    void StoreChunk(std::size_t chunk_x, std::size_t chunk_y, std::uint8_t* pixels, VertexColorFormat format) const;
+
+    /**
+     * Sets colors of vertices within a rectangle.
+     * @param color New color.
+     * @param rect Rectangle of vertices, whole tile by default.
+     */
+    void Fill(VertexColor const& color, VertexRect const& rect = {});
+
+    /**
+     * Multiplies colors of vertices within a rectangle, per channel (tint).
+     * @param factor Factor of each channel.
+     * @param rect Rectangle of vertices, whole tile by default.
+     */
+    void Multiply(VertexColor const& factor, VertexRect const& rect = {});
+
+    /**
+     * Blends colors of vertices within a rectangle toward a color.
+     * @param color Target color.
+     * @param t Blend factor, 0 keeps colors, 1 replaces them.
+     * @param rect Rectangle of vertices, whole tile by default.
+     */
+    void Lerp(VertexColor const& color, float t, VertexRect const& rect = {});
+
+    /**
+     * Blends colors of vertices within a rectangle toward colors of the same vertices of another tile.
+     * @param source Colors to blend toward, may be a different tile.
+     * @param t Blend factor, 0 keeps colors, 1 copies source.
+     * @param rect Rectangle of vertices, whole tile by default.
+     */
+    void Blend(TileVertexColors const& source, float t, VertexRect const& rect = {});
+
+    /**
+     * Blends colors of vertices within a rectangle toward a color depending on their height. The blend factor rises
+     * linearly from 0 at height_min to 1 at height_max.
+     * @param heightfield Heightfield of the tile.
+     * @param color Target color.
+     * @param height_min Height below which colors are kept.
+     * @param height_max Height above which colors are replaced, must be greater than height_min.
+     * @param rect Rectangle of vertices, whole tile by default.
+     */
+    void FadeByHeight(TileHeightfield const& heightfield
+                      , VertexColor const& color
+                      , float height_min
+                      , float height_max
+                      , VertexRect const& rect = {});
+
+    /**
+     * Clamps colors of vertices within a rectangle, per channel.
+     * @param min Lower bound of each channel.
+     * @param max Upper bound of each channel.
+     * @param rect Rectangle of vertices, whole tile by default.
+     */
+    void Clamp(VertexColor const& min, VertexColor const& max, VertexRect const& rect = {});
+
+    /**
+     * Blends colors toward the color of a radial brush, weighted by its falloff. Weights depend on world positions
+     * only, so vertices shared by neighbouring tiles receive the same color when the brush is applied to all of them.
+     * @param settings Brush settings.
+     * @param origin World position of the first outer vertex of the tile (MCNK position of the first chunk).
+     * @param center World position of the brush center.
+     * @return Modified part of the tile.
+     */
+    BrushDirtyRegion Paint(ColorBrushSettings const& settings
+                           , IO::Common::DataStructures::C2Vector origin
+                           , IO::Common::DataStructures::C2Vector center);
+
+  // accessors
+  public:
+    [[nodiscard]] FORCEINLINE float* OuterRow(std::size_t channel, std::size_t y)
+    {
+      return _outer[channel].data() + y * OUTER_DIM;
+    };
+
+    [[nodiscard]] FORCEINLINE float const* OuterRow(std::size_t channel, std::size_t y) const
+    {
+      return _outer[channel].data() + y * OUTER_DIM;
+    };
+
+    [[nodiscard]] FORCEINLINE float* InnerRow(std::size_t channel, std::size_t y)
+    {
+      return _inner[channel].data() + y * INNER_DIM;
+    };
+
+    [[nodiscard]] FORCEINLINE float const* InnerRow(std::size_t channel, std::size_t y) const
+    {
+      return _inner[channel].data() + y * INNER_DIM;
+    };
+
+    [[nodiscard]] VertexColor Outer(std::size_t x, std::size_t y) const;
+    [[nodiscard]] VertexColor Inner(std::size_t x, std::size_t y) const;
+
+    /**
+     * Chunks modified since the last load or store, chunk (x, y) is bit y * 16 + x. May be set to force a store.
+     */
+    [[nodiscard]] FORCEINLINE auto& DirtyChunks() { return _dirty; };
+    [[nodiscard]] FORCEINLINE auto const& DirtyChunks() const { return _dirty; };
+
+  private:
+    // rows of all channels of a grid, index x addresses vertex x
+    using Rows = std::array<float*, N_CHANNELS>;
+
+    template<typename Kernel>
+    void ForRect(VertexRect const& rect, Kernel&& kernel);
+
+    std::array<std::vector<float>, N_CHANNELS> _outer;
+    std::array<std::vector<float>, N_CHANNELS> _inner;
+    std::bitset<IO::Common::WorldConstants::CHUNKS_PER_TILE> _dirty;
+  };
+}
+
+#include <Terrain/TileVertexColors.inl>
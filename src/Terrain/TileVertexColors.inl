@@ -0,0 +1,107 @@
+#pragma once
+#include <Terrain/TileVertexColors.hpp>
+#include <Terrain/Common.hpp>
+#include <Validation/Contracts.hpp>
+#include <Config/CodeZones.hpp>
+
+namespace Terrain
+{
+  template<IO::Common::ClientVersion client_version>
+  inline TileVertexColors::TileVertexColors(IO::ADT::ADTRoot<client_version> const& root, VertexColorFormat format)
+  : TileVertexColors()
+  {
+    Load(root, format);
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline void TileVertexColors::Load(IO::ADT::ADTRoot<client_version> const& root, VertexColorFormat format)
+  {
+    static_assert(sizeof(IO::ADT::DataStructures::MCCVEntry) == N_CHANNELS
+                  && sizeof(IO::Common::DataStructures::CArgb) == N_CHANNELS);
+
+    auto const& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    auto const pixels = [&](std::size_t i) -> std::uint8_t const*
+    {
+      auto const& chunk = chunks[i];
+
+      if (format == VertexColorFormat::MCCV)
+        return chunk.VertexColor().IsInitialized()
+          ? reinterpret_cast<std::uint8_t const*>(&*chunk.VertexColor().cbegin()) : nullptr;
+
+      return chunk.VertexLighting().IsInitialized()
+        ? reinterpret_cast<std::uint8_t const*>(&*chunk.VertexLighting().cbegin()) : nullptr;
+    };
+
+    // chunks without colors first, so that border vertices they share with other chunks are overwritten by those
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      if (pixels(i))
+        continue;
+
+      std::size_t const x0 = i % TileHeightfield::CHUNKS_PER_ROW * TileHeightfield::CHUNK_INNER_DIM;
+      std::size_t const y0 = i / TileHeightfield::CHUNKS_PER_ROW * TileHeightfield::CHUNK_INNER_DIM;
+
+      Fill(format == VertexColorFormat::MCCV ? VertexColor{127.f, 127.f, 127.f, 127.f} : VertexColor{}
+           , {x0, y0, x0 + TileHeightfield::CHUNK_INNER_DIM, y0 + TileHeightfield::CHUNK_INNER_DIM});
+    }
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      if (std::uint8_t const* chunk_pixels = pixels(i))
+      {
+        LoadChunk(i % TileHeightfield::CHUNKS_PER_ROW, i / TileHeightfield::CHUNKS_PER_ROW, chunk_pixels, format);
+      }
+    }
+
+    _dirty.reset();
+  }
+
+  template<IO::Common::ClientVersion client_version>
+  inline std::size_t TileVertexColors::Store(IO::ADT::ADTRoot<client_version>& root, VertexColorFormat format)
+  {
+    auto& chunks = root.Chunks();
+
+    RequireTileChunks(chunks);
+
+    std::size_t n_stored = 0;
+
+    for (std::size_t i = 0; i < chunks.Size(); ++i)
+    {
+      if (!_dirty.test(i))
+        continue;
+
+      auto& chunk = chunks[i];
+      std::uint8_t* pixels;
+
+      // non-const iterators invalidate the cached hash of the chunk
+      if (format == VertexColorFormat::MCCV)
+      {
+        if (!chunk.VertexColor().IsInitialized())
+        {
+          chunk.VertexColor().Initialize();
+        }
+
+        chunk.Header().flags.has_mccv = 1;
+        pixels = reinterpret_cast<std::uint8_t*>(&*chunk.VertexColor().begin());
+      }
+      else
+      {
+        if (!chunk.VertexLighting().IsInitialized())
+        {
+          chunk.VertexLighting().Initialize();
+        }
+
+        pixels = reinterpret_cast<std::uint8_t*>(&*chunk.VertexLighting().begin());
+      }
+
+      StoreChunk(i % TileHeightfield::CHUNKS_PER_ROW, i / TileHeightfield::CHUNKS_PER_ROW, pixels, format);
+      ++n_stored;
+    }
+
+    _dirty.reset();
+    return n_stored;
+  }
+}
@@ -28,6 +28,16 @@ namespace Utils::Meta::Concepts
   template<typename T>
   concept PODType = std::is_standard_layout_v<T> && std::is_trivial_v<T>;
 
+  /**
+   * Checks if the object representation of type T has no padding bytes, so that hashing its bytes is equivalent to
+   * hashing it field-wise. Types aligned to 1 byte (packed structs) have none, floating point types are accepted
+   * although signed zeros and NaNs have several representations.
+   * @tparam T Any type.
+   */
+  template<typename T>
+  concept PaddingFreeType = std::has_unique_object_representations_v<T> || alignof(T) == 1
+    || std::is_floating_point_v<T>;
+
   /**
    * Checks if type T is one of the provided pack of types.
    * @tparam T Candidate type.
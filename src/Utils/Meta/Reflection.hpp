@@ -131,7 +131,6 @@ namespace Utils::Meta::Reflection
               return;
             else
             {
-              using MemberType = Traits::TypeOfMemberObject_T<decltype(cur_mem_ptr)>;
               PrettyPrintMember(log_func, instance.*cur_mem_ptr, NAMEOF_MEMBER(cur_mem_ptr));
             }
           };
@@ -152,7 +151,6 @@ namespace Utils::Meta::Reflection
               return;
             else
             {
-              using MemberType = Traits::TypeOfMemberObject_T<decltype(cur_mem_ptr)>;
               PrettyPrintMember(log_func, instance.*cur_mem_ptr, NAMEOF_MEMBER(cur_mem_ptr));
             }
           };
@@ -2,6 +2,7 @@
 #include <Utils/Meta/Templates.hpp>
 #include <Utils/Meta/Concepts.hpp>
 #include <Config/CodeZones.hpp>
+#include <Validation/Contracts.hpp>
 
 #include <cstring>
 
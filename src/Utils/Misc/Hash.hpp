@@ -0,0 +1,148 @@
+#pragma once
+#include <Utils/Misc/ForceInline.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace Utils::Misc
+{
+  namespace details
+  {
+    inline constexpr std::uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+    inline constexpr std::uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+    inline constexpr std::uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+    inline constexpr std::uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+    inline constexpr std::uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+    FORCEINLINE std::uint64_t RotL64(std::uint64_t x, int r)
+    {
+      return (x << r) | (x >> (64 - r));
+    }
+
+    FORCEINLINE std::uint64_t Read64(const unsigned char* ptr)
+    {
+      std::uint64_t value;
+      std::memcpy(&value, ptr, sizeof(value));
+      return value;
+    }
+
+    FORCEINLINE std::uint32_t Read32(const unsigned char* ptr)
+    {
+      std::uint32_t value;
+      std::memcpy(&value, ptr, sizeof(value));
+      return value;
+    }
+
+    FORCEINLINE std::uint64_t XXH64Round(std::uint64_t acc, std::uint64_t input)
+    {
+      acc += input * XXH_PRIME64_2;
+      acc = RotL64(acc, 31);
+      return acc * XXH_PRIME64_1;
+    }
+
+    FORCEINLINE std::uint64_t XXH64MergeRound(std::uint64_t acc, std::uint64_t value)
+    {
+      acc ^= XXH64Round(0, value);
+      return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+  }
+
+  /**
+   * Computes a 64-bit non-cryptographic hash of a memory block (XXH64).
+   * Intended for content addressing and change detection of file data, not for security purposes.
+   * The result is stable across runs and platforms of the same endianness.
+   * @param data Pointer to the memory block.
+   * @param size Size of the memory block in bytes.
+   * @param seed Optional seed.
+   * @return 64-bit hash value.
+   */
+  inline std::uint64_t Hash64(const void* data, std::size_t size, std::uint64_t seed = 0)
+  {
+    using namespace details;
+
+    auto ptr = static_cast<const unsigned char*>(data);
+    const unsigned char* const end = ptr + size;
+    std::uint64_t hash;
+
+    if (size >= 32)
+    {
+      const unsigned char* const limit = end - 32;
+      std::uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+      std::uint64_t v2 = seed + XXH_PRIME64_2;
+      std::uint64_t v3 = seed;
+      std::uint64_t v4 = seed - XXH_PRIME64_1;
+
+      do
+      {
+        v1 = XXH64Round(v1, Read64(ptr)); ptr += 8;
+        v2 = XXH64Round(v2, Read64(ptr)); ptr += 8;
+        v3 = XXH64Round(v3, Read64(ptr)); ptr += 8;
+        v4 = XXH64Round(v4, Read64(ptr)); ptr += 8;
+      } while (ptr <= limit);
+
+      hash = RotL64(v1, 1) + RotL64(v2, 7) + RotL64(v3, 12) + RotL64(v4, 18);
+      hash = XXH64MergeRound(hash, v1);
+      hash = XXH64MergeRound(hash, v2);
+      hash = XXH64MergeRound(hash, v3);
+      hash = XXH64MergeRound(hash, v4);
+    }
+    else
+    {
+      hash = seed + XXH_PRIME64_5;
+    }
+
+    hash += static_cast<std::uint64_t>(size);
+
+    while (ptr + 8 <= end)
+    {
+      hash ^= XXH64Round(0, Read64(ptr));
+      hash = RotL64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+      ptr += 8;
+    }
+
+    if (ptr + 4 <= end)
+    {
+      hash ^= static_cast<std::uint64_t>(Read32(ptr)) * XXH_PRIME64_1;
+      hash = RotL64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+      ptr += 4;
+    }
+
+    while (ptr < end)
+    {
+      hash ^= static_cast<std::uint64_t>(*ptr) * XXH_PRIME64_5;
+      hash = RotL64(hash, 11) * XXH_PRIME64_1;
+      ++ptr;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+
+    return hash;
+  }
+
+  /**
+   * Computes a 64-bit hash of a string.
+   * @param string Any string.
+   * @param seed Optional seed.
+   * @return 64-bit hash value.
+   */
+  inline std::uint64_t Hash64(std::string_view string, std::uint64_t seed = 0)
+  {
+    return Hash64(string.data(), string.size(), seed);
+  }
+
+  /**
+   * Mixes a hash value into an accumulated seed. Order-dependent.
+   * @param seed Accumulated hash value.
+   * @param value Hash value to mix in.
+   * @return New accumulated hash value.
+   */
+  FORCEINLINE constexpr std::uint64_t HashCombine(std::uint64_t seed, std::uint64_t value)
+  {
+    return seed ^ (value + 0x9E3779B97F4A7C15ULL + (seed << 12) + (seed >> 4));
+  }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils::Misc
+{
+  /**
+   * Number of worker threads used by default.
+   * @return Hardware concurrency, at least 1.
+   */
+  [[nodiscard]]
+  inline std::size_t DefaultThreadCount()
+  {
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }
+
+  /**
+   * Invokes func(i) for every i in [begin, end), distributing indices across threads.
+   * Indices are handed out in blocks of grain consecutive indices, the calling thread participates in the work.
+   * Order of invocations is unspecified, func must only write to state owned by index i. The first exception thrown
+   * by func is rethrown on the calling thread once all threads have finished.
+   * @tparam F Callable of signature void(std::size_t).
+   * @param begin First index.
+   * @param end One past the last index.
+   * @param func Callable invoked for each index.
+   * @param grain Number of consecutive indices processed by a thread at once.
+   * @param n_threads Maximum number of threads, 0 for DefaultThreadCount().
+   */
+  template<typename F>
+  void ParallelFor(std::size_t begin, std::size_t end, F&& func, std::size_t grain = 1, std::size_t n_threads = 0)
+  {
+    if (begin >= end)
+      return;
+
+    grain = std::max<std::size_t>(grain, 1);
+
+    std::size_t const n_blocks = (end - begin + grain - 1) / grain;
+    n_threads = std::min(n_threads ? n_threads : DefaultThreadCount(), n_blocks);
+
+    std::atomic<std::size_t> next_block {0};
+    std::exception_ptr exception {};
+    std::mutex exception_mutex {};
+
+    auto const worker = [&]() -> void
+    {
+      for (std::size_t block = next_block++; block < n_blocks; block = next_block++)
+      {
+        std::size_t const block_begin = begin + block * grain;
+        std::size_t const block_end = std::min(block_begin + grain, end);
+
+        try
+        {
+          for (std::size_t i = block_begin; i < block_end; ++i)
+          {
+            func(i);
+          }
+        }
+        catch (...)
+        {
+          std::lock_guard const lock {exception_mutex};
+
+          if (!exception)
+            exception = std::current_exception();
+
+          // stop handing out work
+          next_block = n_blocks;
+        }
+      }
+    };
+
+    std::vector<std::thread> threads {};
+    threads.reserve(n_threads - 1);
+
+    for (std::size_t i = 1; i < n_threads; ++i)
+    {
+      threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    if (exception)
+      std::rethrow_exception(exception);
+  }
+}
@@ -0,0 +1,247 @@
+#pragma once
+#include <Utils/Misc/ForceInline.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define UTILS_SIMD_SSE2 1
+#  include <emmintrin.h>
+#endif
+
+/*
+ * Minimal portable SIMD layer for data-parallel kernels.
+ * Kernels are written once as templates over the lane type, and instantiated with Float4 for the bulk of a row and
+ * with plain float for the remainder. Float4 maps to SSE2 when available, and falls back to scalar code otherwise.
+ */
+namespace Utils::Misc::SIMD
+{
+  /**
+   * Pack of 4 single precision floats.
+   */
+  struct Float4
+  {
+    static constexpr std::size_t WIDTH = 4;
+
+#ifdef UTILS_SIMD_SSE2
+    __m128 v;
+#else
+    float v[4];
+#endif
+  };
+
+  // scalar lane, used for remainders
+  FORCEINLINE float Load(float const* ptr, float) { return *ptr; }
+  FORCEINLINE void Store(float* ptr, float value) { *ptr = value; }
+  FORCEINLINE float Broadcast(float value, float) { return value; }
+  FORCEINLINE float Ramp(float start, float) { return start; }
+  FORCEINLINE float Sqrt(float value) { return std::sqrt(value); }
+  FORCEINLINE float Min(float lhs, float rhs) { return lhs < rhs ? lhs : rhs; }
+  FORCEINLINE float Max(float lhs, float rhs) { return lhs > rhs ? lhs : rhs; }
+
+  // 8-bit pixels of 4 interleaved channels, one pixel per element of the lane, split into a lane per channel.
+  // Stores round to nearest and clamp to [0, 255].
+  FORCEINLINE void LoadInterleaved(std::uint8_t const* ptr, float (&lanes)[4])
+  {
+    for (std::size_t i = 0; i < 4; ++i)
+      lanes[i] = static_cast<float>(ptr[i]);
+  }
+
+  FORCEINLINE void StoreInterleaved(std::uint8_t* ptr, float const (&lanes)[4])
+  {
+    // adding 2^23 drops the fraction with the rounding mode of the FPU (nearest even), same as the Float4 version
+    constexpr float round = 8388608.f;
+
+    for (std::size_t i = 0; i < 4; ++i)
+      ptr[i] = static_cast<std::uint8_t>((Min(Max(lanes[i], 0.f), 255.f) + round) - round);
+  }
+
+#ifdef UTILS_SIMD_SSE2
+  FORCEINLINE Float4 Load(float const* ptr, Float4) { return {_mm_loadu_ps(ptr)}; }
+  FORCEINLINE void Store(float* ptr, Float4 value) { _mm_storeu_ps(ptr, value.v); }
+  FORCEINLINE Float4 Broadcast(float value, Float4) { return {_mm_set1_ps(value)}; }
+  FORCEINLINE Float4 Ramp(float start, Float4) { return {_mm_add_ps(_mm_set1_ps(start), _mm_setr_ps(0.f, 1.f, 2.f, 3.f))}; }
+  FORCEINLINE Float4 Sqrt(Float4 value) { return {_mm_sqrt_ps(value.v)}; }
+  FORCEINLINE Float4 Min(Float4 lhs, Float4 rhs) { return {_mm_min_ps(lhs.v, rhs.v)}; }
+  FORCEINLINE Float4 Max(Float4 lhs, Float4 rhs) { return {_mm_max_ps(lhs.v, rhs.v)}; }
+
+  FORCEINLINE Float4 operator+(Float4 lhs, Float4 rhs) { return {_mm_add_ps(lhs.v, rhs.v)}; }
+  FORCEINLINE Float4 operator-(Float4 lhs, Float4 rhs) { return {_mm_sub_ps(lhs.v, rhs.v)}; }
+  FORCEINLINE Float4 operator*(Float4 lhs, Float4 rhs) { return {_mm_mul_ps(lhs.v, rhs.v)}; }
+  FORCEINLINE Float4 operator/(Float4 lhs, Float4 rhs) { return {_mm_div_ps(lhs.v, rhs.v)}; }
+
+  FORCEINLINE void LoadInterleaved(std::uint8_t const* ptr, Float4 (&lanes)[4])
+  {
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(ptr));
+    __m128i const lo = _mm_unpacklo_epi8(bytes, zero);
+    __m128i const hi = _mm_unpackhi_epi8(bytes, zero);
+
+    // one pixel per register, transposed into one channel per register
+    __m128 p0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+    __m128 p1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+    __m128 p2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+    __m128 p3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+    lanes[0] = {p0};
+    lanes[1] = {p1};
+    lanes[2] = {p2};
+    lanes[3] = {p3};
+  }
+
+  FORCEINLINE void StoreInterleaved(std::uint8_t* ptr, Float4 const (&lanes)[4])
+  {
+    __m128 p0 = lanes[0].v;
+    __m128 p1 = lanes[1].v;
+    __m128 p2 = lanes[2].v;
+    __m128 p3 = lanes[3].v;
+    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+    // round to nearest, saturating packs clamp to [0, 255]
+    __m128i const lo = _mm_packs_epi32(_mm_cvtps_epi32(p0), _mm_cvtps_epi32(p1));
+    __m128i const hi = _mm_packs_epi32(_mm_cvtps_epi32(p2), _mm_cvtps_epi32(p3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), _mm_packus_epi16(lo, hi));
+  }
+#else
+  namespace details
+  {
+    template<typename F>
+    FORCEINLINE Float4 Apply(Float4 lhs, Float4 rhs, F&& f)
+    {
+      return {{f(lhs.v[0], rhs.v[0]), f(lhs.v[1], rhs.v[1]), f(lhs.v[2], rhs.v[2]), f(lhs.v[3], rhs.v[3])}};
+    }
+  }
+
+  FORCEINLINE Float4 Load(float const* ptr, Float4) { return {{ptr[0], ptr[1], ptr[2], ptr[3]}}; }
+  FORCEINLINE void Store(float* ptr, Float4 value) { for (std::size_t i = 0; i < 4; ++i) ptr[i] = value.v[i]; }
+  FORCEINLINE Float4 Broadcast(float value, Float4) { return {{value, value, value, value}}; }
+  FORCEINLINE Float4 Ramp(float start, Float4) { return {{start, start + 1.f, start + 2.f, start + 3.f}}; }
+
+  FORCEINLINE Float4 Sqrt(Float4 value)
+  {
+    return {{std::sqrt(value.v[0]), std::sqrt(value.v[1]), std::sqrt(value.v[2]), std::sqrt(value.v[3])}};
+  }
+
+  FORCEINLINE Float4 Min(Float4 lhs, Float4 rhs) { return details::Apply(lhs, rhs, [](float a, float b) { return a < b ? a : b; }); }
+  FORCEINLINE Float4 Max(Float4 lhs, Float4 rhs) { return details::Apply(lhs, rhs, [](float a, float b) { return a > b ? a : b; }); }
+
+  FORCEINLINE Float4 operator+(Float4 lhs, Float4 rhs) { return details::Apply(lhs, rhs, [](float a, float b) { return a + b; }); }
+  FORCEINLINE Float4 operator-(Float4 lhs, Float4 rhs) { return details::Apply(lhs, rhs, [](float a, float b) { return a - b; }); }
+  FORCEINLINE Float4 operator*(Float4 lhs, Float4 rhs) { return details::Apply(lhs, rhs, [](float a, float b) { return a * b; }); }
+  FORCEINLINE Float4 operator/(Float4 lhs, Float4 rhs) { return details::Apply(lhs, rhs, [](float a, float b) { return a / b; }); }
+
+  FORCEINLINE void LoadInterleaved(std::uint8_t const* ptr, Float4 (&lanes)[4])
+  {
+    for (std::size_t pixel = 0; pixel < 4; ++pixel)
+      for (std::size_t channel = 0; channel < 4; ++channel)
+        lanes[channel].v[pixel] = static_cast<float>(ptr[pixel * 4 + channel]);
+  }
+
+  FORCEINLINE void StoreInterleaved(std::uint8_t* ptr, Float4 const (&lanes)[4])
+  {
+    for (std::size_t pixel = 0; pixel < 4; ++pixel)
+      StoreInterleaved(ptr + pixel * 4, {lanes[0].v[pixel], lanes[1].v[pixel], lanes[2].v[pixel], lanes[3].v[pixel]});
+  }
+#endif
+
+  /**
+   * Loads a lane of type V from memory (unaligned).
+   * @tparam V Lane type (float or Float4).
+   * @param ptr Source address.
+   * @return Loaded lane.
+   */
+  template<typename V>
+  FORCEINLINE V Load(float const* ptr) { return Load(ptr, V{}); }
+
+  /**
+   * Broadcasts a scalar to all elements of a lane of type V.
+   * @tparam V Lane type (float or Float4).
+   * @param value Scalar value.
+   * @return Lane filled with value.
+   */
+  template<typename V>
+  FORCEINLINE V Broadcast(float value) { return Broadcast(value, V{}); }
+
+  /**
+   * Lane of type V holding consecutive values start, start + 1, ...
+   * @tparam V Lane type (float or Float4).
+   * @param start Value of the first element.
+   * @return Lane filled with the ramp.
+   */
+  template<typename V>
+  FORCEINLINE V Ramp(float start) { return Ramp(start, V{}); }
+
+  /**
+   * Number of floats processed at once by a lane of type V.
+   * @tparam V Lane type (float or Float4).
+   */
+  template<typename V>
+  inline constexpr std::size_t WIDTH = sizeof(V) / sizeof(float);
+
+  /**
+   * Invokes kernel(V{}, i) over a range of indices, i advancing by the width of V: Float4 lanes for the bulk of the
+   * range and float lanes for the remainder.
+   * @tparam Kernel Generic callable of signature void(V, std::size_t).
+   * @param begin First index.
+   * @param end One past the last index.
+   * @param kernel Callable invoked for each lane.
+   */
+  template<typename Kernel>
+  FORCEINLINE void ForRange(std::size_t begin, std::size_t end, Kernel&& kernel)
+  {
+    std::size_t i = begin;
+
+    for (; i + Float4::WIDTH <= end; i += Float4::WIDTH)
+    {
+      kernel(Float4{}, i);
+    }
+
+    for (; i < end; ++i)
+    {
+      kernel(float{}, i);
+    }
+  }
+
+  /**
+   * Extends a range by the extremes of a contiguous run of floats, the bulk is reduced in Float4 lanes.
+   * @param values First value.
+   * @param n Number of values.
+   * @param min Lowest value, updated in place.
+   * @param max Highest value, updated in place.
+   */
+  FORCEINLINE void MinMax(float const* values, std::size_t n, float& min, float& max)
+  {
+    Float4 lanes_min = Broadcast<Float4>(min);
+    Float4 lanes_max = Broadcast<Float4>(max);
+
+    ForRange(0, n, [&]<typename V>(V, std::size_t i) -> void
+    {
+      V const value = Load<V>(values + i);
+
+      if constexpr (std::is_same_v<V, Float4>)
+      {
+        lanes_min = Min(lanes_min, value);
+        lanes_max = Max(lanes_max, value);
+      }
+      else
+      {
+        min = Min(min, value);
+        max = Max(max, value);
+      }
+    });
+
+    float mins[Float4::WIDTH];
+    float maxs[Float4::WIDTH];
+    Store(mins, lanes_min);
+    Store(maxs, lanes_max);
+
+    for (std::size_t i = 0; i < Float4::WIDTH; ++i)
+    {
+      min = Min(min, mins[i]);
+      max = Max(max, maxs[i]);
+    }
+  }
+}
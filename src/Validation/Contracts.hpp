@@ -1,7 +1,6 @@
 #pragma once
 #include <Utils/Misc/ForceInline.hpp>
 #include <Utils/Misc/CurrentFunction.hpp>
-#include <Utils/Meta/Templates.hpp>
 #include <Validation/Log.hpp>
 
 #include <iostream>
@@ -223,4 +222,7 @@ namespace Validation::Contracts
   #define InvariantMFE(FLAGS, EXPR, ...) \
     (CONTRACT_FLAGS & FLAGS ? Validation::Contracts::RaiseAbort(Validation::Contracts::ResolveContract(Utils::Meta::Templates::MakeArray<bool> EXPR, #EXPR, __FILE__, __LINE__, CURRENT_FUNCTION, "Invariant", __VA_ARGS__)) :  static_cast<void>(0));
 
-#endif
\ No newline at end of file
+#endif
+
+// Included last: Utils/Meta/Templates.inl validates with the macros above.
+#include <Utils/Meta/Templates.hpp>
@@ -0,0 +1,196 @@
+#include <IO/Storage/DerivedDataCache.hpp>
+#include <IO/Common.hpp>
+#include <IO/CommonTraits.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <Validation/Contracts.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace IO::Common;
+using namespace IO::Common::Traits;
+using namespace IO::Storage;
+namespace fs = std::filesystem;
+
+namespace
+{
+  constexpr std::uint32_t FILE_DATA_ID = 777;
+
+  struct TestFile : public AutoIOTraitInterface<TestFile, TraitType::File>
+  {
+    AutoIOTraitInterfaceUser;
+
+  public:
+    [[nodiscard]]
+    auto& Version() { return _version; };
+
+    [[nodiscard]]
+    auto& Heights() { return _heights; };
+
+    [[nodiscard]]
+    auto& Textures() { return _textures; };
+
+  private:
+    DataChunk<std::uint32_t, IO::ADT::ChunkIdentifiers::ADTCommonChunks::MVER> _version;
+    DataArrayChunk<float, IO::ADT::ChunkIdentifiers::ADTRootMCNKSubchunks::MCVT> _heights;
+    StringBlockChunk<StringBlockChunkType::NORMAL, IO::ADT::ChunkIdentifiers::ADTTexChunks::MTEX> _textures;
+
+    static constexpr
+    AutoIOTrait
+    <
+      TraitEntry<&TestFile::_version>
+      , TraitEntry<&TestFile::_heights>
+      , TraitEntry<&TestFile::_textures>
+    > _auto_trait {};
+  };
+
+  struct VersionFile : public AutoIOTraitInterface<VersionFile, TraitType::File>
+  {
+    AutoIOTraitInterfaceUser;
+
+  public:
+    [[nodiscard]]
+    auto& Version() { return _version; };
+
+  private:
+    DataChunk<std::uint32_t, IO::ADT::ChunkIdentifiers::ADTCommonChunks::MVER> _version;
+
+    static constexpr
+    AutoIOTrait
+    <
+      TraitEntry<&VersionFile::_version>
+    > _auto_trait {};
+  };
+
+  // state of a VersionFile followed by trailing bytes, as left behind by a type whose state layout grew
+  struct PaddedVersionFile
+  {
+    VersionFile file;
+
+    void SaveState(ByteBuffer& buf) const
+    {
+      file.SaveState(buf);
+
+      std::uint32_t const padding = 0;
+      buf.Write(padding);
+    };
+  };
+
+  std::vector<char> WriteBytes(TestFile const& file)
+  {
+    ByteBuffer buf {};
+    file.Write(buf);
+    return {buf.Data(), buf.Data() + buf.Size()};
+  }
+
+  TestFile MakeFile()
+  {
+    std::vector<float> heights (145, 1.5f);
+    heights[7] = 3.f;
+
+    TestFile file {};
+    file.Version().Initialize(18);
+    file.Heights().Initialize(heights);
+    file.Textures().Initialize({"tileset/a.blp", "tileset/b.blp"});
+    return file;
+  }
+}
+
+void TestRoundTrip(DerivedDataCache const& cache)
+{
+  TestFile const file = MakeFile();
+
+  DerivedDataKey const key = DerivedDataCache::MakeKey<TestFile>(FILE_DATA_ID, ClientVersion::SL, {1024, 0xAB});
+
+  TestFile missed {};
+  Ensure(cache.Load(key, missed) == DerivedDataCache::CacheReadStatus::NOT_CACHED, "Empty cache should miss.");
+
+  Ensure(cache.Store(key, file) == DerivedDataCache::CacheWriteStatus::SUCCESS, "Store failed.");
+
+  TestFile loaded {};
+  Ensure(cache.Load(key, loaded) == DerivedDataCache::CacheReadStatus::SUCCESS, "Stored entry should hit.");
+  Ensure(WriteBytes(loaded) == WriteBytes(file), "Loaded object does not write the same bytes.");
+  Ensure(*(loaded.Heights().begin() + 7) == 3.f && loaded.Textures().Size() == 2, "Chunks do not round-trip.");
+
+  // state of uninitialized chunks is restored too
+  TestFile const empty {};
+  Ensure(cache.Store(key, empty) == DerivedDataCache::CacheWriteStatus::SUCCESS, "Store failed.");
+
+  TestFile loaded_empty = MakeFile();
+  Ensure(cache.Load(key, loaded_empty) == DerivedDataCache::CacheReadStatus::SUCCESS, "Stored entry should hit.");
+  Ensure(WriteBytes(loaded_empty).empty() && !loaded_empty.Heights().IsInitialized()
+         , "Loading should replace the state of the object.");
+}
+
+void TestInvalidation(DerivedDataCache const& cache)
+{
+  TestFile const file = MakeFile();
+
+  DerivedDataKey const key = DerivedDataCache::MakeKey<TestFile>(FILE_DATA_ID, ClientVersion::SL, {1024, 0x01});
+  DerivedDataKey const other_version_key = DerivedDataCache::MakeKey<TestFile>(FILE_DATA_ID
+                                                                               , ClientVersion::DF
+                                                                               , {1024, 0x01});
+  DerivedDataKey const patched_key = DerivedDataCache::MakeKey<TestFile>(FILE_DATA_ID, ClientVersion::SL, {1024, 0x02});
+
+  Ensure(cache.Store(key, file) == DerivedDataCache::CacheWriteStatus::SUCCESS, "Store failed.");
+  Ensure(cache.Store(other_version_key, file) == DerivedDataCache::CacheWriteStatus::SUCCESS, "Store failed.");
+
+  TestFile loaded {};
+  Ensure(cache.Load(patched_key, loaded) == DerivedDataCache::CacheReadStatus::NOT_CACHED
+         , "Changed source identity should miss.");
+
+  // storing the patched file prunes the entry of its previous content only
+  Ensure(cache.Store(patched_key, file) == DerivedDataCache::CacheWriteStatus::SUCCESS, "Store failed.");
+  Ensure(cache.Load(key, loaded) == DerivedDataCache::CacheReadStatus::NOT_CACHED, "Stale entry was not pruned.");
+  Ensure(cache.Load(other_version_key, loaded) == DerivedDataCache::CacheReadStatus::SUCCESS
+         , "Entry of another client version was pruned.");
+  Ensure(cache.Load(patched_key, loaded) == DerivedDataCache::CacheReadStatus::SUCCESS, "New entry should hit.");
+
+  // damaged payload
+  fs::path const entry_dir = cache.Path() / std::to_string(FILE_DATA_ID);
+
+  for (auto const& entry : fs::directory_iterator(entry_dir))
+  {
+    std::fstream strm {entry.path(), std::fstream::binary | std::fstream::in | std::fstream::out};
+    strm.seekp(-1, std::ios::end);
+    strm.put('\x7F');
+  }
+
+  Ensure(cache.Load(patched_key, loaded) == DerivedDataCache::CacheReadStatus::CORRUPT, "Damaged entry was loaded.");
+  Ensure(cache.Load(patched_key, loaded) == DerivedDataCache::CacheReadStatus::NOT_CACHED
+         , "Damaged entry was not removed.");
+
+  // payload not fully consumed by the type, the object is not left half-loaded
+  DerivedDataKey const version_key = DerivedDataCache::MakeKey<VersionFile>(FILE_DATA_ID, ClientVersion::SL
+                                                                            , {1024, 0x03});
+  PaddedVersionFile padded {};
+  padded.file.Version().Initialize(18);
+  Ensure(cache.Store(version_key, padded) == DerivedDataCache::CacheWriteStatus::SUCCESS, "Store failed.");
+
+  VersionFile version_file {};
+  Ensure(cache.Load(version_key, version_file) == DerivedDataCache::CacheReadStatus::CORRUPT
+         && !version_file.Version().IsInitialized(), "Mismatching entry was partially loaded.");
+  Ensure(cache.Load(version_key, version_file) == DerivedDataCache::CacheReadStatus::NOT_CACHED
+         , "Mismatching entry was not removed.");
+
+  cache.Invalidate(FILE_DATA_ID);
+  Ensure(cache.Load(patched_key, loaded) == DerivedDataCache::CacheReadStatus::NOT_CACHED
+         && cache.Load(other_version_key, loaded) == DerivedDataCache::CacheReadStatus::NOT_CACHED
+         , "Invalidated entries should miss.");
+}
+
+int main()
+{
+  DerivedDataCache const cache {fs::temp_directory_path() / "wowlib_derived_data_cache_test"};
+  cache.Clear();
+
+  TestRoundTrip(cache);
+  cache.Clear();
+  TestInvalidation(cache);
+
+  fs::remove_all(cache.Path());
+  return 0;
+}
@@ -0,0 +1,379 @@
+#include <IO/ADT/Root/MH2O.hpp>
+#include <IO/ByteBuffer.hpp>
+#include <Terrain/LiquidConverter.hpp>
+#include <Terrain/TileLiquidIndex.hpp>
+#include <Validation/Contracts.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace IO::Common;
+using namespace IO::ADT;
+
+namespace
+{
+  LiquidLayer& AddLayer(LiquidChunk& chunk, LiquidLayer::LiquidVertexFormat format)
+  {
+    LiquidLayer& layer = chunk.Layers().emplace_back();
+    layer.liquid_type = 2;
+    layer.liquid_vertex_format = format;
+    layer.min_height_level = 0.f;
+    layer.max_height_level = 0.f;
+    layer.AllocateVertexData();
+    return layer;
+  }
+}
+
+void TestLiquidLayer()
+{
+  LiquidLayer layer {};
+  layer.liquid_vertex_format = LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH_TEXCOORD;
+  layer.AllocateVertexData();
+
+  Ensure(layer.vertex_data.size() == 81 * (4 + 4 + 1), "Wrong vertex data size.");
+  Ensure(layer.Heights().size() == 81 && layer.TexCoords().size() == 81 && layer.Depths().size() == 81
+         , "Wrong vertex member sizes.");
+
+  // vertex (3, 2) of the chunk
+  layer.Heights()[2 * 9 + 3] = 5.f;
+  layer.Depths()[2 * 9 + 3] = 7;
+
+  // quads (2, 1), (3, 2) and (4, 2)
+  layer.SetExistsMap(std::uint64_t{1} << (1 * 8 + 2) | std::uint64_t{1} << (2 * 8 + 3) | std::uint64_t{1} << (2 * 8 + 4));
+
+  Ensure(layer.x_offset == 2 && layer.y_offset == 1 && layer.width == 3 && layer.height == 2, "Wrong rectangle.");
+  Ensure(layer.exists_bitmap == 0b110'001, "Wrong exists bitmap.");
+  Ensure(layer.Exists(3, 2) && !layer.Exists(3, 1) && !layer.Exists(0, 0), "Wrong existing quads.");
+  Ensure(layer.ExistsMap() == (std::uint64_t{1} << 10 | std::uint64_t{1} << 19 | std::uint64_t{1} << 20)
+         , "Exists map does not round-trip.");
+
+  Ensure(layer.vertex_data.size() == 4 * 3 * 9, "Vertex data should shrink to the rectangle.");
+  Ensure(layer.Heights()[1 * 4 + 1] == 5.f && layer.Depths()[1 * 4 + 1] == 7, "Vertex data was not kept.");
+}
+
+void TestMH2ORoundTrip()
+{
+  MH2O liquids {};
+  liquids.Initialize();
+
+  auto& chunks = liquids.chunks();
+
+  // open sea: identical flat chunks
+  for (std::size_t i = 0; i < 200; ++i)
+  {
+    AddLayer(chunks[i], LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH);
+    chunks[i].AddAttributes(0, ~std::uint64_t{0});
+  }
+
+  // shore: partial layer with a height gradient
+  LiquidLayer& shore = AddLayer(chunks[200], LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD);
+  shore.SetExistsMap(0x0000'0000'00FF'0F0Full);
+
+  for (std::size_t i = 0; i < shore.Heights().size(); ++i)
+  {
+    shore.Heights()[i] = static_cast<float>(i);
+  }
+
+  // two layers, the second one without vertex data
+  AddLayer(chunks[201], LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH_TEXCOORD).Depths()[40] = 3;
+  AddLayer(chunks[201], LiquidLayer::LiquidVertexFormat::DEPTH).vertex_data.clear();
+
+  ByteBuffer buf {};
+  liquids.Write(buf);
+
+  ByteBuffer sizing_buf {};
+  Ensure(buf.Size() == liquids.WriteSize(sizing_buf), "Computed size does not match the written size.");
+
+  // without deduplication, every flat chunk would store its own instance, attributes and vertex data
+  std::size_t const flat_chunk_size = sizeof(IO::ADT::DataStructures::SMLiquidInstance)
+    + sizeof(IO::ADT::DataStructures::SMLiquidChunkAttributes) + 81 * 5;
+  Ensure(buf.Size() < sizeof(ChunkHeader) + 256 * sizeof(IO::ADT::DataStructures::SMLiquidChunk) + 2 * flat_chunk_size + 1024
+         , "Identical blocks were not deduplicated.");
+
+  buf.Seek(sizeof(ChunkHeader));
+
+  MH2O read {};
+  read.Read(buf, buf.Size() - sizeof(ChunkHeader));
+
+  Ensure(read.Hash() == liquids.Hash(), "MH2O does not round-trip.");
+  Ensure(buf.Tell() == buf.Size(), "Read should move past the chunk.");
+
+  LiquidLayer const& read_shore = read.chunks()[200].Layers()[0];
+  Ensure(read_shore.ExistsMap() == 0x0000'0000'00FF'0F0Full && read_shore.Heights()[3] == 3.f
+         , "Partial layer does not round-trip.");
+  Ensure(read.chunks()[201].Layers()[0].Depths()[40] == 3 && !read.chunks()[201].Layers()[1].HasVertexData()
+         , "Layers of a chunk do not round-trip.");
+  Ensure(read.chunks()[5].Attributes()->deep.all() && read.chunks()[255].Layers().empty()
+         , "Chunk attributes do not round-trip.");
+}
+
+void TestMH2OMalformed()
+{
+  using IO::ADT::DataStructures::SMLiquidChunk;
+  using IO::ADT::DataStructures::SMLiquidInstance;
+
+  MH2O liquids {};
+  liquids.Initialize();
+
+  // distinct liquid types, so that instances are not shared
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    AddLayer(liquids.chunks()[i], LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH).liquid_type
+      = static_cast<std::uint16_t>(i + 1);
+  }
+
+  ByteBuffer buf {};
+  liquids.Write(buf);
+
+  std::size_t const size = buf.Size() - sizeof(ChunkHeader);
+  auto* headers = reinterpret_cast<SMLiquidChunk*>(buf.Data() + sizeof(ChunkHeader));
+  auto const instance_of = [&](std::size_t i) -> SMLiquidInstance*
+  {
+    return reinterpret_cast<SMLiquidInstance*>(buf.Data() + sizeof(ChunkHeader) + headers[i].offset_instances);
+  };
+
+  // rectangle crossing the chunk, instances past the end, vertex data crossing the end
+  instance_of(1)->x_offset = 4;
+  instance_of(3)->offset_vertex_data = static_cast<std::uint32_t>(size - 1);
+  headers[2].offset_instances = static_cast<std::uint32_t>(size);
+
+  buf.Seek(sizeof(ChunkHeader));
+
+  MH2O read {};
+  read.Read(buf, size);
+
+  Ensure(buf.Tell() == buf.Size(), "Read should move past the chunk.");
+  Ensure(read.chunks()[0].Layers().size() == 1 && read.chunks()[0].Layers()[0].liquid_type == 1
+         , "Valid layer was not read.");
+  Ensure(read.chunks()[1].Layers().empty() && read.chunks()[2].Layers().empty() && read.chunks()[3].Layers().empty()
+         , "Malformed layers were not skipped.");
+}
+
+void TestLiquidIndex()
+{
+  constexpr float spacing = WorldConstants::CHUNK_SIZE / 8.f;
+  constexpr IO::Common::DataStructures::C2Vector origin {1000.f, 2000.f};
+
+  // grid x runs along world -Y, grid y runs along world -X
+  auto const world_x = [&](float grid_y) { return origin.x - grid_y * spacing; };
+  auto const world_y = [&](float grid_x) { return origin.y - grid_x * spacing; };
+
+  MH2O liquids {};
+  liquids.Initialize();
+
+  // chunk (1, 2): sloped water over the whole chunk, lava over its first quad
+  LiquidChunk& chunk = liquids.chunks()[2 * 16 + 1];
+  LiquidLayer& water = AddLayer(chunk, LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH);
+
+  for (std::size_t y = 0; y < 9; ++y)
+  {
+    for (std::size_t x = 0; x < 9; ++x)
+    {
+      water.Heights()[y * 9 + x] = static_cast<float>(x) + 10.f * static_cast<float>(y);
+      water.Depths()[y * 9 + x] = static_cast<std::uint8_t>(2 * x);
+    }
+  }
+
+  water.SetExistsMap(~std::uint64_t{1});
+
+  LiquidLayer& lava = AddLayer(chunk, LiquidLayer::LiquidVertexFormat::DEPTH);
+  lava.liquid_type = 6;
+  lava.min_height_level = 50.f;
+  lava.SetExistsMap(1);
+
+  Terrain::TileLiquidIndex index {};
+  index.Build(liquids, origin);
+
+  Ensure(index.NumPlanes() == 2 && index.ChunkMask(1, 2) == ~std::uint64_t{0} && !index.ChunkMask(2, 1)
+         , "Wrong presence masks.");
+
+  // quad (3, 5) of the chunk, a quarter into it
+  auto sample = index.Sample(world_x(16.f + 5.25f), world_y(8.f + 3.75f));
+  Ensure(sample && sample->liquid_type == 2, "Expected water.");
+  Ensure(std::abs(sample->height - (3.75f + 52.5f)) < 1e-3f && std::abs(sample->depth - 7.5f) < 1e-3f
+         , "Wrong interpolation.");
+
+  sample = index.Sample(world_x(16.5f), world_y(8.5f));
+  Ensure(sample && sample->liquid_type == 6 && sample->height == 50.f, "Expected flat lava.");
+
+  Ensure(!index.Sample(world_x(0.5f), world_y(0.5f)) && !index.Sample(world_x(-1.f), world_y(8.5f))
+         , "Expected no liquid.");
+
+  // batch queries match single queries, including blocks with a remainder
+  std::mt19937 rng {42};
+  std::uniform_real_distribution<float> grid {-2.f, 40.f};
+
+  std::vector<float> xs(1000);
+  std::vector<float> ys(1000);
+
+  for (std::size_t i = 0; i < xs.size(); ++i)
+  {
+    xs[i] = world_x(grid(rng));
+    ys[i] = world_y(grid(rng));
+  }
+
+  std::vector<Terrain::LiquidSample> samples(xs.size());
+  index.Sample(xs, ys, samples);
+
+  for (std::size_t i = 0; i < xs.size(); ++i)
+  {
+    auto const single = index.Sample(xs[i], ys[i]);
+    Ensure(single.has_value() == samples[i].exists, "Batch presence does not match.");
+    Ensure(!single || (single->height == samples[i].height && single->liquid_type == samples[i].liquid_type)
+           , "Batch sample does not match.");
+  }
+
+  // reused output does not keep the type of a previous hit on a miss
+  std::vector<float> miss_xs(xs.size(), world_x(0.5f));
+  std::vector<float> miss_ys(ys.size(), world_y(0.5f));
+  index.Sample(miss_xs, miss_ys, samples);
+
+  Ensure(std::all_of(samples.begin(), samples.end()
+                     , [](Terrain::LiquidSample const& sample) { return !sample.exists && !sample.liquid_type; })
+         , "Missed samples kept a stale liquid type.");
+
+  // incremental refresh after removing the lava
+  chunk.Layers().pop_back();
+  index.Update(liquids, 1, 2);
+
+  Ensure(index.NumPlanes() == 1 && index.ChunkMask(1, 2) == ~std::uint64_t{1}, "Chunk was not refreshed.");
+  Ensure(!index.Sample(world_x(16.5f), world_y(8.5f)), "Expected no liquid after removal.");
+}
+
+void TestLiquidConverter()
+{
+  using IO::ADT::DataStructures::MCLQ;
+
+  ADTRoot<ClientVersion::CATA> root {0};
+  auto& chunks = root.Chunks();
+
+  // chunk 0: sloped river over quads (2, 1) to (4, 3), the last one causing fatigue
+  {
+    MCLQ mclq {};
+    std::memset(mclq.tiles, 0x0F, sizeof(mclq.tiles));
+
+    for (std::size_t y = 1; y <= 3; ++y)
+    {
+      for (std::size_t x = 2; x <= 4; ++x)
+      {
+        mclq.tiles[y][x] = 0x04;
+      }
+    }
+
+    mclq.tiles[3][4] = static_cast<char>(0x84);
+
+    for (std::size_t i = 0; i < 81; ++i)
+    {
+      mclq.verts[i].waterVert.height = static_cast<float>(i);
+      mclq.verts[i].waterVert.depth = 5;
+    }
+
+    chunks[0].TBCWater().Initialize(mclq);
+    chunks[0].Header().flags.lq_river = 1;
+  }
+
+  // chunk 1: flat ocean without depths
+  {
+    MCLQ mclq {};
+    mclq.height = {-5.f, -5.f};
+
+    chunks[1].TBCWater().Initialize(mclq);
+    chunks[1].Header().flags.lq_ocean = 1;
+  }
+
+  // chunk 2: flat magma with texture coordinates
+  {
+    MCLQ mclq {};
+
+    for (std::size_t i = 0; i < 81; ++i)
+    {
+      mclq.verts[i].magmaVert = {static_cast<std::int16_t>(i), -1, 20.f};
+    }
+
+    chunks[2].TBCWater().Initialize(mclq);
+    chunks[2].Header().flags.lq_magma = 1;
+  }
+
+  Ensure(Terrain::LiquidConverter::Convert(root) == 3, "Expected 3 converted chunks.");
+  Ensure(root.Liquids().IsInitialized(), "MH2O should be initialized.");
+
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    Ensure(!chunks[i].TBCWater().IsInitialized() && !chunks[i].Header().flags.lq_river
+           && !chunks[i].Header().flags.lq_ocean && !chunks[i].Header().flags.lq_magma, "MCLQ was not cleared.");
+  }
+
+  auto const& liquid_chunks = root.Liquids().chunks();
+
+  LiquidLayer const& river = liquid_chunks[0].Layers()[0];
+  Ensure(river.liquid_type == 1 && river.liquid_vertex_format == LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH
+         , "Wrong river type.");
+  Ensure(river.x_offset == 2 && river.y_offset == 1 && river.width == 3 && river.height == 3
+         , "River rectangle is not tight.");
+  Ensure(river.Heights().size() == 16 && river.Heights()[0] == 11.f && river.Heights()[15] == 41.f
+         && river.Depths()[7] == 5, "Wrong river vertices.");
+  Ensure(river.min_height_level == 11.f && river.max_height_level == 41.f, "Wrong river height levels.");
+  Ensure(liquid_chunks[0].Attributes()->deep == std::uint64_t{1} << 28, "Wrong deep quads.");
+
+  LiquidLayer const& ocean = liquid_chunks[1].Layers()[0];
+  Ensure(ocean.liquid_type == 2 && !ocean.HasVertexData() && ocean.min_height_level == -5.f
+         && ocean.ExistsMap() == ~std::uint64_t{0}, "Flat ocean should not store vertex data.");
+
+  LiquidLayer const& magma = liquid_chunks[2].Layers()[0];
+  Ensure(magma.liquid_type == 3 && magma.liquid_vertex_format == LiquidLayer::LiquidVertexFormat::HEIGHT_TEXCOORD
+         && magma.TexCoords()[80].x == 80 && magma.TexCoords()[80].y == 0xFFFF && magma.Heights()[40] == 20.f
+         , "Wrong magma vertices.");
+
+  Ensure(liquid_chunks[3].Layers().empty(), "Chunk without MCLQ should have no liquid.");
+
+  // converted tiles are written and read back like any other
+  ByteBuffer buf {};
+  root.Write(buf);
+  buf.Seek(0);
+
+  ADTRoot<ClientVersion::CATA> read {0, buf};
+  Ensure(read.Liquids().Hash() == root.Liquids().Hash(), "Converted liquids do not round-trip.");
+
+  // map-wide conversion only stores tiles that had MCLQ liquids
+  std::atomic<std::size_t> n_stored = 0;
+
+  std::size_t const n_converted = Terrain::LiquidConverter::ConvertMap<ClientVersion::CATA>(
+    [](std::size_t tile_x, std::size_t tile_y) -> std::optional<ADTRoot<ClientVersion::CATA>>
+    {
+      if (tile_y != 2 || tile_x > 1)
+        return std::nullopt;
+
+      ADTRoot<ClientVersion::CATA> tile {0};
+
+      if (tile_x == 1)
+      {
+        tile.Chunks()[0].TBCWater().Initialize(MCLQ{});
+        tile.Chunks()[0].Header().flags.lq_ocean = 1;
+      }
+
+      return tile;
+    }
+    , [&](std::size_t tile_x, std::size_t tile_y, ADTRoot<ClientVersion::CATA> const& tile) -> void
+    {
+      Ensure(tile_x == 1 && tile_y == 2 && tile.Liquids().chunks()[0].Layers().size() == 1, "Wrong tile stored.");
+      ++n_stored;
+    });
+
+  Ensure(n_converted == 1 && n_stored == 1, "Expected a single converted tile.");
+}
+
+int main()
+{
+  TestLiquidLayer();
+  TestMH2ORoundTrip();
+  TestMH2OMalformed();
+  TestLiquidIndex();
+  TestLiquidConverter();
+
+  return 0;
+}
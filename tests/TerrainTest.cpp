@@ -0,0 +1,1680 @@
+#include <IO/ADT/Root/ADTRoot.hpp>
+#include <IO/ADT/ChunkIdentifiers.hpp>
+#include <Terrain/TileHeightfield.hpp>
+#include <Terrain/TileNormals.hpp>
+#include <Terrain/TileRaycaster.hpp>
+#include <Terrain/HeightBrush.hpp>
+#include <Terrain/SeamReconciler.hpp>
+#include <Terrain/TerrainMeshBuilder.hpp>
+#include <Terrain/HeightmapRaster.hpp>
+#include <Terrain/TileLodGenerator.hpp>
+#include <Terrain/FlightBoundsGenerator.hpp>
+#include <Terrain/BlendMeshIndex.hpp>
+#include <Terrain/TileVertexColors.hpp>
+#include <Terrain/OcclusionBaker.hpp>
+#include <Terrain/TileHoles.hpp>
+#include <Terrain/ChunkHeaderIndex.hpp>
+#include <Terrain/SoundEmitterIndex.hpp>
+#include <Terrain/TileProbe.hpp>
+#include <Terrain/CollisionMeshExporter.hpp>
+#include <Validation/Contracts.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace IO::Common;
+using namespace IO::ADT;
+using namespace Terrain;
+
+void TestHeightfieldSync()
+{
+  ADTRoot<ClientVersion::SL> root {1};
+
+  // chunk (1, 0): base 100, outer vertex (0, 0) at +5, inner vertex (2, 3) at -2
+  auto& chunk = root.Chunks()[1];
+  chunk.Header().position.z = 100.f;
+  chunk.Heightmap()[0] = 5.f;
+  chunk.Heightmap()[3 * 17 + 9 + 2] = -2.f;
+
+  // chunk (15, 15): last outer vertex, not shared with any other chunk
+  root.Chunks()[255].Heightmap()[144] = 7.f;
+
+  // chunk (0, 1): last outer vertex, shared with chunk (1, 2) which takes precedence
+  root.Chunks()[16].Heightmap()[144] = 3.f;
+
+  TileHeightfield heightfield {root};
+
+  Ensure(heightfield.Outer(8, 0) == 105.f, "Chunk base height was not folded in.");
+  Ensure(heightfield.Inner(8 + 2, 3) == 98.f, "Inner vertex was not de-interleaved.");
+  Ensure(heightfield.Outer(128, 128) == 7.f, "Last outer vertex of a chunk was not loaded.");
+  Ensure(heightfield.Outer(8, 16) == 0.f, "Shared vertex was not taken from the chunk it is the top-left of.");
+
+  heightfield.Outer(128, 128) = 12.f;
+
+  ADTRoot<ClientVersion::SL> out_root {1};
+  out_root.Chunks()[255].Header().position.z = 10.f;
+  heightfield.Store(out_root);
+
+  Ensure(out_root.Chunks()[255].Heightmap()[144] == 2.f, "Height was not stored relative to the base.");
+  Ensure(out_root.Chunks()[1].Heightmap()[0] == 105.f, "Height was not stored relative to the base.");
+
+  ByteBuffer buf {};
+  out_root.Write(buf);
+  buf.Seek(0);
+
+  ADTRoot<ClientVersion::SL> read_root {1, buf};
+  TileHeightfield read_heightfield {read_root};
+
+  Ensure(std::equal(heightfield.OuterGrid().begin(), heightfield.OuterGrid().end()
+                    , read_heightfield.OuterGrid().begin()), "Outer grid mismatch after write.");
+  Ensure(std::equal(heightfield.InnerGrid().begin(), heightfield.InnerGrid().end()
+                    , read_heightfield.InnerGrid().begin()), "Inner grid mismatch after write.");
+
+  // chunk hashes ignore placement and layout, so that identical chunks are found across tiles
+  auto& lhs = read_root.Chunks()[2];
+  auto& rhs = read_root.Chunks()[3];
+  rhs.Header().position = {1.f, 2.f, 0.f};
+  rhs.Header().ofsLiquid = 1234;
+  Ensure(lhs.Hash() == rhs.Hash(), "Chunks differing only by placement and layout hash differently.");
+
+  rhs.Header().areaid = 5;
+  Ensure(lhs.Hash() != rhs.Hash(), "Chunks with different contents hash identically.");
+}
+
+namespace
+{
+  bool NearlyEqual(std::array<float, 3> const& lhs, std::array<float, 3> const& rhs, float eps = 1e-5f)
+  {
+    return std::abs(lhs[0] - rhs[0]) < eps && std::abs(lhs[1] - rhs[1]) < eps && std::abs(lhs[2] - rhs[2]) < eps;
+  }
+
+  // smooth terrain in global vertex coordinates, tiles are offset by 128 vertices
+  void FillWaves(TileHeightfield& heightfield, int tile_x, int tile_y)
+  {
+    auto const f = [](float x, float y) { return 10.f * std::sin(x * 0.1f) * std::cos(y * 0.07f) + 0.02f * x * y; };
+
+    for (std::size_t y = 0; y < TileHeightfield::OUTER_DIM; ++y)
+      for (std::size_t x = 0; x < TileHeightfield::OUTER_DIM; ++x)
+        heightfield.Outer(x, y) = f(tile_x * 128.f + x, tile_y * 128.f + y);
+
+    for (std::size_t y = 0; y < TileHeightfield::INNER_DIM; ++y)
+      for (std::size_t x = 0; x < TileHeightfield::INNER_DIM; ++x)
+        heightfield.Inner(x, y) = f(tile_x * 128.f + x + 0.5f, tile_y * 128.f + y + 0.5f);
+  }
+}
+
+void TestNormals()
+{
+  constexpr float spacing = WorldConstants::CHUNK_SIZE / 8.f;
+
+  // plane sloping along grid x, linear extrapolation of missing neighbours keeps border normals exact
+  TileHeightfield slope {};
+  float const k = 2.f;
+
+  for (std::size_t y = 0; y < TileHeightfield::OUTER_DIM; ++y)
+    for (std::size_t x = 0; x < TileHeightfield::OUTER_DIM; ++x)
+      slope.Outer(x, y) = k * x;
+
+  for (std::size_t y = 0; y < TileHeightfield::INNER_DIM; ++y)
+    for (std::size_t x = 0; x < TileHeightfield::INNER_DIM; ++x)
+      slope.Inner(x, y) = k * (x + 0.5f);
+
+  TileNormals normals {};
+  Ensure(NearlyEqual(normals.Outer(5, 5), {0.f, 0.f, 1.f}), "Default normals are not flat.");
+
+  normals.Compute(slope);
+
+  float const len = std::sqrt(k * k + spacing * spacing);
+  std::array<float, 3> const expected { -k / len, 0.f, spacing / len };
+
+  Ensure(NearlyEqual(normals.Outer(0, 0), expected), "Wrong normal at tile corner.");
+  Ensure(NearlyEqual(normals.Outer(64, 77), expected), "Wrong outer normal.");
+  Ensure(NearlyEqual(normals.Outer(128, 128), expected), "Wrong normal at tile corner.");
+  Ensure(NearlyEqual(normals.Inner(0, 127), expected), "Wrong inner normal at tile border.");
+  Ensure(NearlyEqual(normals.Inner(63, 13), expected), "Wrong inner normal.");
+
+  ADTRoot<ClientVersion::SL> root {1};
+  normals.Store(root);
+
+  auto const& entry = root.Chunks()[17].Normals().data.entries[9 + 3];
+  Ensure(entry.normal[0] == 0 && entry.normal[1] == std::lround(k / len * 127.f)
+         && entry.normal[2] == std::lround(spacing / len * 127.f), "Wrong quantized normal.");
+
+  // seams between tiles
+  TileHeightfield left {};
+  TileHeightfield right {};
+  FillWaves(left, 0, 0);
+  FillWaves(right, 1, 0);
+
+  TileNeighbours left_neighbours {};
+  left_neighbours.Set(1, 0, &right);
+
+  TileNeighbours right_neighbours {};
+  right_neighbours.Set(-1, 0, &left);
+
+  TileNormals left_normals {};
+  TileNormals right_normals {};
+  left_normals.Compute(left, left_neighbours);
+  right_normals.Compute(right, right_neighbours);
+
+  for (std::size_t y = 1; y < TileHeightfield::OUTER_DIM - 1; ++y)
+  {
+    Ensure(NearlyEqual(left_normals.Outer(128, y), right_normals.Outer(0, y)), "Normals differ across tile seam.");
+  }
+
+  // dirty rectangle update matches a full recompute
+  TileHeightfield edited = left;
+
+  for (std::size_t y = 30; y <= 40; ++y)
+    for (std::size_t x = 120; x <= 128; ++x)
+      edited.Outer(x, y) += 5.f;
+
+  for (std::size_t y = 29; y <= 40; ++y)
+    for (std::size_t x = 119; x <= 127; ++x)
+      edited.Inner(x, y) -= 3.f;
+
+  TileNormals full {};
+  full.Compute(edited, left_neighbours);
+  left_normals.Compute(edited, VertexRect {120, 30, 128, 40}, left_neighbours);
+
+  for (std::size_t y = 0; y < TileHeightfield::OUTER_DIM; ++y)
+    for (std::size_t x = 0; x < TileHeightfield::OUTER_DIM; ++x)
+      Ensure(left_normals.Outer(x, y) == full.Outer(x, y), "Dirty update of outer normals differs.");
+
+  for (std::size_t y = 0; y < TileHeightfield::INNER_DIM; ++y)
+    for (std::size_t x = 0; x < TileHeightfield::INNER_DIM; ++x)
+      Ensure(left_normals.Inner(x, y) == full.Inner(x, y), "Dirty update of inner normals differs.");
+}
+
+void TestRaycast()
+{
+  constexpr float spacing = WorldConstants::CHUNK_SIZE / 8.f;
+  constexpr float origin_x = 1000.f;
+  constexpr float origin_y = 2000.f;
+
+  ADTRoot<ClientVersion::SL> root {1};
+
+  for (std::size_t i = 0; i < 256; ++i)
+  {
+    auto& header = root.Chunks()[i].Header();
+    header.position = { origin_x - (i / 16) * WorldConstants::CHUNK_SIZE
+                        , origin_y - (i % 16) * WorldConstants::CHUNK_SIZE, 50.f };
+  }
+
+  // plane rising along grid x (world -Y), hole in the first 2x2 quads of chunk (0, 0)
+  TileHeightfield slope {};
+
+  for (std::size_t y = 0; y < TileHeightfield::OUTER_DIM; ++y)
+    for (std::size_t x = 0; x < TileHeightfield::OUTER_DIM; ++x)
+      slope.Outer(x, y) = 0.5f * x;
+
+  for (std::size_t y = 0; y < TileHeightfield::INNER_DIM; ++y)
+    for (std::size_t x = 0; x < TileHeightfield::INNER_DIM; ++x)
+      slope.Inner(x, y) = 0.5f * (x + 0.5f);
+
+  slope.Store(root);
+  root.Chunks()[0].Header().holes_low_res = 0x1;
+
+  TileRaycaster raycaster {root};
+
+  auto const expected_height = [&](float y) { return 0.5f * (origin_y - y) / spacing; };
+
+  auto const height = raycaster.Height(origin_x - 110.f, origin_y - 310.f);
+  Ensure(height && std::abs(*height - expected_height(origin_y - 310.f)) < 1e-3f, "Wrong terrain height.");
+  Ensure(!raycaster.Height(origin_x + 1.f, origin_y - 310.f), "Height outside of the tile.");
+  Ensure(!raycaster.Height(origin_x - 1.f, origin_y - 1.f), "Height within a hole.");
+
+  Ray const down { {origin_x - 110.f, origin_y - 310.f, 1000.f}, {0.f, 0.f, -1.f} };
+  auto const hit = raycaster.Cast(down);
+  Ensure(hit && std::abs(hit->position.z - *height) < 1e-3f, "Vertical ray missed the surface.");
+  Ensure(hit->chunk_x == static_cast<int>(310.f / WorldConstants::CHUNK_SIZE)
+         && hit->chunk_y == static_cast<int>(110.f / WorldConstants::CHUNK_SIZE)
+         , "Wrong chunk hit.");
+
+  Ray const short_ray { down.origin, down.direction, 10.f };
+  Ensure(!raycaster.Cast(short_ray), "Ray hit beyond its maximum distance.");
+
+  Ray const into_hole { {origin_x - 1.f, origin_y - 1.f, 100.f}, {0.f, 0.f, -1.f} };
+  Ensure(!raycaster.Cast(into_hole), "Ray hit a hole.");
+
+  // oblique rays, batched
+  std::vector<Ray> rays {};
+
+  for (std::size_t i = 0; i < 1000; ++i)
+  {
+    float const x = origin_x - 5.f - (i % 40) * 12.f;
+    float const y = origin_y - 5.f - (i / 40) * 20.f;
+    rays.push_back({ {x, y, 400.f}, {0.3f, -0.2f, -1.f} });
+  }
+
+  std::vector<std::optional<RayHit>> hits (rays.size());
+  raycaster.Cast(rays, hits);
+
+  for (std::size_t i = 0; i < rays.size(); ++i)
+  {
+    auto const single = raycaster.Cast(rays[i]);
+    Ensure(single.has_value() == hits[i].has_value() && (!single || single->t == hits[i]->t)
+           , "Batch result differs from a single cast.");
+
+    if (single)
+    {
+      auto const surface = raycaster.Height(single->position.x, single->position.y);
+      Ensure(surface && std::abs(*surface - single->position.z) < 1e-2f, "Hit is not on the surface.");
+    }
+  }
+
+  auto const bounds = raycaster.ChunkBounds(1, 0);
+  Ensure(bounds.max.y == origin_y - WorldConstants::CHUNK_SIZE && bounds.max.x == origin_x
+         && bounds.min.z == 4.f && bounds.max.z == 8.f, "Wrong chunk bounds.");
+}
+
+void TestBrush()
+{
+  constexpr float spacing = WorldConstants::CHUNK_SIZE / 8.f;
+
+  TileHeightfield left {};
+  TileHeightfield right {};
+  TileHeightfield const left_before = left;
+
+  // right tile continues the grid of the left one along grid x (world -Y)
+  std::array<BrushTile, 2> tiles { BrushTile{ &left, {0.f, 0.f}, {} }
+                                   , BrushTile{ &right, {0.f, -128.f * spacing}, {} } };
+
+  tiles[0].neighbours.Set(1, 0, &right);
+  tiles[1].neighbours.Set(-1, 0, &left);
+
+  // raise centered on outer vertex (126, 40) of the left tile, crossing into the right tile
+  HeightBrush brush {{ BrushMode::Raise, BrushFalloff::Smooth, 20.f, 3.f }};
+  IO::Common::DataStructures::C2Vector const center { -40.f * spacing, -126.f * spacing };
+
+  std::array<BrushDirtyRegion, 2> dirty {};
+  brush.Apply(tiles, center, dirty);
+
+  Ensure(std::abs(left.Outer(126, 40) - 3.f) < 1e-5f, "Brush center was not raised by its strength.");
+  Ensure(left.Outer(126, 40 + 20.f / spacing + 1) == 0.f, "Vertex outside of the radius was modified.");
+  Ensure(dirty[0].touched && dirty[1].touched, "Both tiles should be touched.");
+
+  for (std::size_t y = 0; y < TileHeightfield::OUTER_DIM; ++y)
+  {
+    Ensure(std::abs(left.Outer(128, y) - right.Outer(0, y)) < 1e-4f, "Shared vertices diverged across tiles.");
+  }
+
+  // dirty chunks are exactly the chunks with modified vertices
+  for (std::size_t chunk = 0; chunk < 256; ++chunk)
+  {
+    std::size_t const cx = chunk % 16;
+    std::size_t const cy = chunk / 16;
+    bool modified = false;
+
+    for (std::size_t y = cy * 8; y <= cy * 8 + 8; ++y)
+      for (std::size_t x = cx * 8; x <= cx * 8 + 8; ++x)
+        modified |= left.Outer(x, y) != left_before.Outer(x, y)
+          || (x < cx * 8 + 8 && y < cy * 8 + 8 && left.Inner(x, y) != left_before.Inner(x, y));
+
+    Ensure(modified == dirty[0].chunks.test(chunk), "Dirty chunk set is not exact.");
+  }
+
+  Ensure(dirty[0].vertices.x_max == 128 && dirty[1].vertices.x_min == 0, "Dirty rectangles do not meet at the seam.");
+
+  // smoothing pulls a spike down, flatten pulls heights toward the target
+  TileHeightfield spike {};
+  spike.Outer(64, 64) = 8.f;
+
+  HeightBrush smooth {{ BrushMode::Smooth, BrushFalloff::Linear, 10.f, 1.f }};
+  auto const smooth_dirty = smooth.Apply({ &spike, {0.f, 0.f}, {} }, { -64.f * spacing, -64.f * spacing });
+
+  Ensure(smooth_dirty.touched && spike.Outer(64, 64) == 0.f, "Spike was not smoothed.");
+  Ensure(spike.Inner(63, 63) > 0.f, "Smoothing did not spread the spike.");
+
+  HeightBrush flatten {{ BrushMode::Flatten, BrushFalloff::Linear, 10.f, 1.f, 5.f }};
+  flatten.Apply({ &spike, {0.f, 0.f}, {} }, { -64.f * spacing, -64.f * spacing });
+
+  Ensure(spike.Outer(64, 64) == 5.f, "Flatten did not reach the target at the center.");
+  Ensure(spike.Outer(65, 64) > 0.f && spike.Outer(65, 64) < 5.f, "Flatten should blend away from the center.");
+}
+
+void TestSeams()
+{
+  // 2x2 tiles at (10, 20) - (11, 21), each at a different constant height
+  std::vector<MapTile> map (WorldConstants::MAX_TILES_PER_MAP);
+  std::array<TileHeightfield, 4> heightfields {};
+  std::array<TileNormals, 4> normals {};
+
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    heightfields[i].Fill(static_cast<float>(i));
+    normals[i].Compute(heightfields[i]);
+    map[(20 + i / 2) * 64 + 10 + i % 2] = { &heightfields[i], &normals[i], i == 3 };
+  }
+
+  SeamReconciler::MapTiles const tiles {map.data(), map.size()};
+
+  SeamReconciler const reconciler {SeamPolicy::PreferEdited};
+  SeamReport const check = reconciler.Check(tiles);
+
+  // 4 seams of 127 inner vertices, 4 junctions on the outline shared by 2 tiles, 1 junction shared by 4 tiles
+  Ensure(check.height_mismatches == 4 * 127 + 4 + 1, "Wrong number of height mismatches.");
+  Ensure(check.max_height_error == 3.f && check.modified.count() == 4, "Wrong mismatch report.");
+  Ensure(heightfields[0].Outer(128, 5) == 0.f, "Check must not modify tiles.");
+
+  SeamReport const report = reconciler.Reconcile(tiles);
+  Ensure(report.height_mismatches == check.height_mismatches, "Reconcile should report mismatches found.");
+
+  // seams touching the edited tile take its height, others are averaged
+  Ensure(heightfields[0].Outer(128, 5) == 0.5f && heightfields[1].Outer(0, 5) == 0.5f, "Seam was not averaged.");
+  Ensure(heightfields[1].Outer(5, 128) == 3.f && heightfields[3].Outer(5, 0) == 3.f, "Edited tile was not preferred.");
+  Ensure(heightfields[0].Outer(128, 128) == 3.f && heightfields[2].Outer(128, 0) == 3.f, "Junction was not fixed.");
+
+  SeamReport const after = reconciler.Check(tiles);
+  Ensure(after.height_mismatches == 0 && after.normal_mismatches == 0 && after.modified.none()
+         , "Seams still mismatch after reconciliation.");
+}
+
+void TestMeshBuilder()
+{
+  constexpr float spacing = WorldConstants::CHUNK_SIZE / 8.f;
+
+  ADTRoot<ClientVersion::SL> root {1};
+
+  for (std::size_t i = 0; i < 256; ++i)
+  {
+    root.Chunks()[i].Header().position = { -static_cast<float>(i / 16) * WorldConstants::CHUNK_SIZE
+                                           , -static_cast<float>(i % 16) * WorldConstants::CHUNK_SIZE, 10.f };
+  }
+
+  root.Chunks()[0].Header().holes_low_res = 0x1;
+  root.Chunks()[1].Heightmap()[9] = 2.f;
+
+  TerrainMesh mesh {};
+  TerrainMeshBuilder::BuildTile(root, mesh);
+
+  Ensure(mesh.vertices.size() == 256 * 145, "Wrong number of vertices.");
+  Ensure(mesh.indices.size() == 256 * 768 - 4 * 12, "Holes were not skipped.");
+  Ensure(mesh.chunks[0].count == 768 - 4 * 12 && mesh.chunks[1].first == mesh.chunks[0].count
+         , "Chunk index ranges are not contiguous.");
+
+  TerrainVertex const& inner = mesh.vertices[145 + 9];
+  Ensure(std::abs(inner.position[0] + 0.5f * spacing) < 1e-4f
+         && std::abs(inner.position[1] + WorldConstants::CHUNK_SIZE + 0.5f * spacing) < 1e-4f
+         && inner.position[2] == 12.f, "Wrong inner vertex position.");
+  Ensure(inner.normal[2] == root.Chunks()[1].Normals().data.entries[9].normal[2], "Normal was not copied.");
+  Ensure(root.Chunks()[1].VertexColor().IsInitialized() || inner.color[0] == 0x7F, "Wrong default color.");
+
+  for (std::size_t i = 0; i < mesh.indices.size(); i += 3)
+  {
+    auto const& a = mesh.vertices[mesh.indices[i]].position;
+    auto const& b = mesh.vertices[mesh.indices[i + 1]].position;
+    auto const& c = mesh.vertices[mesh.indices[i + 2]].position;
+
+    float const cross_z = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+    Ensure(cross_z > 0.f, "Triangle is not counter-clockwise seen from above.");
+  }
+
+  // hole quad (0, 0) of chunk 0 is skipped, the first triangle belongs to quad (2, 0)
+  Ensure(mesh.indices[0] == 9 + 2, "First triangle should belong to the first non-hole quad.");
+
+  TerrainVertex const* storage = mesh.vertices.data();
+  TerrainMeshBuilder::BuildTile(root, mesh);
+  Ensure(mesh.vertices.data() == storage, "Mesh storage was not reused.");
+}
+
+void TestHeightmapRaster()
+{
+  // 2x2 tiles at (10, 20) - (11, 21) sampling a plane, tile (11, 21) is missing
+  auto const plane = [](float x, float y) -> float { return 0.25f * x - 0.5f * y + 100.f; };
+
+  RasterLayout layout {};
+  layout.tile_x = 10;
+  layout.tile_y = 20;
+  layout.n_tiles_x = 2;
+  layout.n_tiles_y = 2;
+
+  auto const exists = [](std::size_t x, std::size_t y) -> bool { return x != 11 || y != 21; };
+  auto const load = [&](std::size_t x, std::size_t y, TileHeightfield& heightfield) -> void
+  {
+    for (std::size_t v = 0; v < TileHeightfield::OUTER_DIM; ++v)
+    {
+      for (std::size_t u = 0; u < TileHeightfield::OUTER_DIM; ++u)
+      {
+        heightfield.Outer(u, v) = plane(static_cast<float>((x - 10) * 128 + u), static_cast<float>((y - 20) * 128 + v));
+      }
+    }
+  };
+
+  std::filesystem::path const path = std::filesystem::temp_directory_path() / "terrain_test_raster.raw";
+
+  Ensure(HeightmapRaster::Export(path, layout, exists, load), "Export failed.");
+  Ensure(std::filesystem::file_size(path) == 257 * 257 * sizeof(float), "Wrong raster size.");
+
+  std::array<TileHeightfield, 4> imported {};
+  auto const store = [&](std::size_t x, std::size_t y, TileHeightfield const& heightfield) -> void
+  {
+    imported[(y - 20) * 2 + x - 10] = heightfield;
+  };
+
+  Ensure(HeightmapRaster::Import(path, layout, RasterFilter::Bicubic, store), "Import failed.");
+
+  // outer vertices round-trip exactly, inner vertices are interpolated from them
+  Ensure(imported[1].Outer(128, 128) == plane(256.f, 128.f) && imported[2].Outer(0, 128) == plane(0.f, 256.f)
+         , "Outer vertices did not round-trip.");
+  Ensure(std::abs(imported[0].Inner(64, 64) - plane(64.5f, 64.5f)) < 1e-3f
+         && std::abs(imported[2].Inner(10, 3) - plane(10.5f, 131.5f)) < 1e-3f, "Wrong bicubic interpolation.");
+  Ensure(imported[3].Outer(5, 5) == 0.f && imported[3].Outer(0, 0) == plane(128.f, 128.f)
+         , "Missing tile should only keep samples of existing tiles.");
+
+  // half resolution, 16-bit raster
+  layout.format = RasterFormat::UInt16;
+  layout.height_min = 0.f;
+  layout.height_max = 200.f;
+
+  Ensure(HeightmapRaster::Export(path, layout, [](std::size_t, std::size_t) { return true; }, load), "Export failed.");
+
+  std::vector<std::uint16_t> samples (257 * 257);
+  {
+    std::ifstream strm {path, std::ifstream::binary};
+    strm.read(reinterpret_cast<char*>(samples.data()), static_cast<std::streamsize>(samples.size() * 2));
+  }
+
+  std::vector<std::uint16_t> half (129 * 129);
+
+  for (std::size_t y = 0; y < 129; ++y)
+  {
+    for (std::size_t x = 0; x < 129; ++x)
+    {
+      half[y * 129 + x] = samples[y * 2 * 257 + x * 2];
+    }
+  }
+
+  layout.samples_x = 129;
+  layout.samples_y = 129;
+
+  TileHeightfield heightfield {};
+  HeightmapRaster::ResampleTile(half.data(), layout, RasterFilter::Bilinear, 11, 21, heightfield);
+
+  float const step = 200.f / 65535.f;
+  Ensure(std::abs(heightfield.Outer(7, 9) - plane(135.f, 137.f)) < 2.f * step
+         && std::abs(heightfield.Inner(127, 127) - plane(255.5f, 255.5f)) < 2.f * step, "Wrong bilinear resampling.");
+
+  std::filesystem::remove(path);
+}
+
+void TestLodGenerator()
+{
+  // slope with waves along grid y and a spike at outer vertex (40, 70)
+  auto const height = [](float x, float y) -> float { return 0.1f * x + 4.f * std::sin(y / 10.f); };
+
+  TileHeightfield heightfield {};
+
+  for (std::size_t y = 0; y < TileHeightfield::OUTER_DIM; ++y)
+  {
+    for (std::size_t x = 0; x < TileHeightfield::OUTER_DIM; ++x)
+    {
+      heightfield.Outer(x, y) = height(static_cast<float>(x), static_cast<float>(y));
+    }
+  }
+
+  for (std::size_t y = 0; y < TileHeightfield::INNER_DIM; ++y)
+  {
+    for (std::size_t x = 0; x < TileHeightfield::INNER_DIM; ++x)
+    {
+      heightfield.Inner(x, y) = height(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f);
+    }
+  }
+
+  heightfield.Outer(40, 70) = 30.f;
+
+  TileLodGenerator generator {LodSettings{3, 0.5f, 4.f}};
+  TileLod lod {};
+  generator.Generate(heightfield, 31, 33, lod);
+
+  Ensure(lod.levels.size() == 3 && lod.heights.size() == TileHeightfield::N_OUTER + TileHeightfield::N_INNER
+         , "Wrong number of levels or vertices.");
+  Ensure(lod.header.some_kind_of_bounding[5] == 30.f
+         && lod.header.some_kind_of_bounding[3] == -WorldConstants::TILE_SIZE
+         && lod.header.some_kind_of_bounding[4] == WorldConstants::TILE_SIZE, "Wrong bounds.");
+
+  std::size_t previous_count = ~std::size_t{0};
+
+  for (auto const& level : lod.levels)
+  {
+    Ensure(level.height_length % 3 == 0 && level.height_length < previous_count
+           , "Coarser levels should have fewer triangles.");
+    previous_count = level.height_length;
+
+    // triangles cover the tile exactly once and every interior edge is shared by two triangles in opposite directions
+    std::map<std::pair<std::uint16_t, std::uint16_t>, int> edges {};
+    bool spike = false;
+    float area = 0.f;
+
+    auto const position = [](std::uint16_t i) -> std::array<float, 2>
+    {
+      if (i < TileHeightfield::N_OUTER)
+        return { static_cast<float>(i % 129), static_cast<float>(i / 129) };
+
+      i -= TileHeightfield::N_OUTER;
+      return { static_cast<float>(i % 128) + 0.5f, static_cast<float>(i / 128) + 0.5f };
+    };
+
+    for (std::size_t i = level.height_index; i < level.height_index + level.height_length; i += 3)
+    {
+      std::array<std::uint16_t, 3> const triangle { lod.indices[i], lod.indices[i + 1], lod.indices[i + 2] };
+
+      // grid axes are mirrored relative to world axes, counter-clockwise in the world is clockwise on the grid
+      auto const a = position(triangle[0]);
+      auto const b = position(triangle[1]);
+      auto const c = position(triangle[2]);
+      float const cross = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+
+      Ensure(cross < 0.f, "Triangle is degenerate or wrongly wound.");
+      area -= cross / 2.f;
+
+      for (std::size_t k = 0; k < 3; ++k)
+      {
+        ++edges[{triangle[k], triangle[(k + 1) % 3]}];
+        spike |= triangle[k] == 70 * 129 + 40;
+      }
+    }
+
+    Ensure(area == 128.f * 128.f, "Triangles do not cover the tile.");
+    Ensure(spike, "Spike vertex should be kept.");
+
+    for (auto const& [edge, count] : edges)
+    {
+      auto const a = position(edge.first);
+      auto const b = position(edge.second);
+      bool const border = (a[0] == b[0] && (a[0] == 0.f || a[0] == 128.f))
+                          || (a[1] == b[1] && (a[1] == 0.f || a[1] == 128.f));
+
+      Ensure(count == 1 && (border || edges.count({edge.second, edge.first})), "Mesh has a T-junction.");
+    }
+
+    Ensure(std::any_of(lod.nodes.begin(), lod.nodes.end(), [&](auto const& node)
+           {
+             return node.index == level.height_index && node.length == level.height_length;
+           }), "Level has no root node.");
+  }
+
+  // map-wide generation does not depend on the number of threads
+  auto const load = [&](std::size_t x, std::size_t y, TileHeightfield& tile) -> bool
+  {
+    if (x > 1 || y > 1)
+      return false;
+
+    tile = heightfield;
+    tile.Outer(64, 64) = static_cast<float>(x + y * 2);
+    return true;
+  };
+
+  std::array<TileLod, 4> single {};
+  std::array<TileLod, 4> multi {};
+
+  generator.GenerateMap(load, [&](std::size_t x, std::size_t y, TileLod const& tile) { single[y * 2 + x] = tile; }, 1);
+  generator.GenerateMap(load, [&](std::size_t x, std::size_t y, TileLod const& tile) { multi[y * 2 + x] = tile; }, 4);
+
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    Ensure(single[i].indices == multi[i].indices && single[i].heights == multi[i].heights
+           && single[i].nodes.size() == multi[i].nodes.size(), "Generation is not deterministic.");
+  }
+}
+
+void TestFlightBounds()
+{
+  ADTRoot<ClientVersion::SL> root {1};
+  TileHeightfield heightfield {};
+
+  // slope along grid x, a peak in the quarter (1, 0) and a pit in the quarter (0, 1)
+  for (std::size_t y = 0; y < TileHeightfield::OUTER_DIM; ++y)
+  {
+    for (std::size_t x = 0; x < TileHeightfield::OUTER_DIM; ++x)
+    {
+      heightfield.Outer(x, y) = static_cast<float>(x);
+    }
+  }
+
+  for (std::size_t y = 0; y < TileHeightfield::INNER_DIM; ++y)
+  {
+    for (std::size_t x = 0; x < TileHeightfield::INNER_DIM; ++x)
+    {
+      heightfield.Inner(x, y) = static_cast<float>(x) + 0.5f;
+    }
+  }
+
+  heightfield.Inner(100, 10) = 1000.f;
+  heightfield.Outer(3, 101) = -300.5f;
+  heightfield.Store(root);
+
+  FlightBoundsGenerator generator {{.ceiling_margin = 10.f, .floor_margin = 20.f, .include_liquids = true}};
+
+  Ensure(generator.Update(root), "Flight bounds should be created.");
+  Ensure(root.FlightBounds().IsInitialized(), "Flight bounds were not initialized.");
+  Ensure(!generator.Update(root), "Flight bounds should not change.");
+
+  auto const& bounds = root.FlightBounds().data;
+
+  // points touching the peak, then the pit
+  Ensure(bounds.maximum.height[0][1] == 1010 && bounds.maximum.height[0][2] == 1010
+         && bounds.maximum.height[1][1] == 1010 && bounds.maximum.height[1][2] == 1010, "Peak is not covered.");
+  Ensure(bounds.maximum.height[0][0] == 74 && bounds.maximum.height[2][2] == 138, "Wrong maximum plane.");
+  Ensure(bounds.minimum.height[1][0] == -321 && bounds.minimum.height[2][1] == -321
+         && bounds.minimum.height[0][0] == -20 && bounds.minimum.height[1][2] == 44, "Wrong minimum plane.");
+
+  // planes interpolated between points bound every vertex
+  auto const plane = [](IO::ADT::DataStructures::MFBOPlane const& p, float x, float y) -> float
+  {
+    float const u = x / 64.f;
+    float const v = y / 64.f;
+    auto const c = static_cast<std::size_t>(std::min(u, 1.f));
+    auto const r = static_cast<std::size_t>(std::min(v, 1.f));
+    float const fu = u - static_cast<float>(c);
+    float const fv = v - static_cast<float>(r);
+    float const h0 = p.height[r][c] + (p.height[r][c + 1] - p.height[r][c]) * fu;
+    float const h1 = p.height[r + 1][c] + (p.height[r + 1][c + 1] - p.height[r + 1][c]) * fu;
+    return h0 + (h1 - h0) * fv;
+  };
+
+  for (std::size_t y = 0; y < TileHeightfield::OUTER_DIM; ++y)
+  {
+    for (std::size_t x = 0; x < TileHeightfield::OUTER_DIM; ++x)
+    {
+      float const h = heightfield.Outer(x, y);
+      Ensure(plane(bounds.maximum, x, y) >= h && plane(bounds.minimum, x, y) <= h, "Vertex out of flight bounds.");
+    }
+  }
+
+  // liquids raise the maximum plane
+  auto& liquids = root.Liquids();
+  liquids.Initialize();
+
+  LiquidLayer& layer = liquids.chunks()[15 * 16 + 15].Layers().emplace_back();
+  layer.liquid_type = 2;
+  layer.liquid_vertex_format = LiquidLayer::LiquidVertexFormat::DEPTH;
+  layer.min_height_level = layer.max_height_level = 500.f;
+
+  Ensure(generator.Update(root, &heightfield), "Liquids should raise the maximum plane.");
+  Ensure(root.FlightBounds().data.maximum.height[2][2] == 510 && root.FlightBounds().data.maximum.height[0][0] == 74
+         , "Wrong maximum plane with liquids.");
+
+  // saving leaves flight bounds of unchanged tiles alone, even hand-authored ones
+  IO::ADT::DataStructures::MFBO custom = root.FlightBounds().data;
+  custom.maximum.height[1][1] = 4321;
+  root.FlightBounds().data = custom;
+
+  ByteBuffer buf_unchanged {};
+  Ensure(!generator.Write(root, buf_unchanged, {}), "Saving an unchanged tile should keep flight bounds.");
+
+  buf_unchanged.Seek(0);
+  ADTRoot<ClientVersion::SL> saved_unchanged {1, buf_unchanged};
+  Ensure(saved_unchanged.FlightBounds().IsInitialized()
+         && !std::memcmp(&saved_unchanged.FlightBounds().data, &custom, sizeof(custom))
+         , "Custom flight bounds were overwritten on save.");
+
+  // and refreshes flight bounds of tiles whose heights changed
+  heightfield.Inner(100, 10) = 2000.f;
+  heightfield.Store(root);
+
+  std::bitset<WorldConstants::CHUNKS_PER_TILE> dirty_chunks {};
+  dirty_chunks.set(1 * 16 + 12);
+
+  ByteBuffer buf {};
+  Ensure(generator.Write(root, buf, dirty_chunks), "Saving should refresh flight bounds.");
+
+  buf.Seek(0);
+  ADTRoot<ClientVersion::SL> saved {1, buf};
+  Ensure(saved.FlightBounds().IsInitialized() && saved.FlightBounds().data.maximum.height[0][1] == 2010
+         , "Saved flight bounds were not refreshed.");
+
+  // and leaves tiles without them alone
+  root.FlightBounds() = {};
+
+  ByteBuffer buf_no_bounds {};
+  Ensure(!generator.Write(root, buf_no_bounds, dirty_chunks), "Saving should not create flight bounds.");
+
+  buf_no_bounds.Seek(0);
+  ADTRoot<ClientVersion::SL> saved_no_bounds {1, buf_no_bounds};
+  Ensure(!root.FlightBounds().IsInitialized() && !saved_no_bounds.FlightBounds().IsInitialized()
+         , "Flight bounds were created on save.");
+}
+
+void TestBlendMeshIndex()
+{
+  constexpr float chunk_size = WorldConstants::CHUNK_SIZE;
+
+  ADTRoot<ClientVersion::SL> root {1};
+  root.Chunks()[0].Header().position = {1000.f, 2000.f, 0.f};
+
+  std::vector<IO::ADT::DataStructures::MBMH> headers;
+  std::vector<IO::ADT::DataStructures::MBBB> boxes;
+  std::vector<IO::ADT::DataStructures::MBNV> vertices;
+  std::vector<std::uint16_t> indices;
+
+  // grid position (in chunks) to world position
+  auto const vertex = [&](float grid_x, float grid_y, float z) -> void
+  {
+    IO::ADT::DataStructures::MBNV& v = vertices.emplace_back();
+    v = {};
+    v.pos = {1000.f - grid_y * chunk_size, 2000.f - grid_x * chunk_size, z};
+  };
+
+  // mesh 0: strip at height 10 along grid x over chunks (0, 0) to (2, 0), triangles out of chunk order
+  headers.push_back({100, 0, 0, 18, 8, 0, 0});
+
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    vertex(0.9f * static_cast<float>(i), 0.25f, 10.f);
+    vertex(0.9f * static_cast<float>(i), 0.75f, 10.f);
+  }
+
+  for (std::uint16_t quad : {2, 0, 1})
+  {
+    auto const base = static_cast<std::uint16_t>(quad * 2);
+    indices.insert(indices.end(), {base, static_cast<std::uint16_t>(base + 1), static_cast<std::uint16_t>(base + 2)
+                                   , static_cast<std::uint16_t>(base + 1), static_cast<std::uint16_t>(base + 3)
+                                   , static_cast<std::uint16_t>(base + 2)});
+  }
+
+  boxes.push_back({100, {{1000.f - 0.75f * chunk_size, 2000.f - 2.7f * chunk_size, 10.f}
+                         , {1000.f - 0.25f * chunk_size, 2000.f, 10.f}}});
+
+  // mesh 1: triangle in chunk (15, 15), without a bounding box
+  headers.push_back({200, 0, 0, 3, 3, 18, 8});
+  vertex(15.2f, 15.2f, 50.f);
+  vertex(15.8f, 15.2f, 50.f);
+  vertex(15.2f, 15.8f, 50.f);
+  indices.insert(indices.end(), {0, 1, 2});
+
+  root.BlendMeshHeaders().Initialize(headers);
+  root.BlendMeshBoundingBoxes().Initialize(boxes);
+  root.BlendMeshVertices().Initialize(vertices);
+  root.BlendMeshIndices().Initialize(indices);
+
+  BlendMeshIndex index {root};
+  Ensure(index.NumMeshes() == 2, "Expected 2 meshes.");
+
+  std::vector<std::uint32_t> meshes;
+
+  index.QueryChunk(1, 0, meshes);
+  Ensure(meshes == std::vector<std::uint32_t>{0}, "Expected mesh 0 in chunk (1, 0).");
+
+  index.QueryChunk(15, 15, meshes);
+  Ensure(meshes == std::vector<std::uint32_t>{1}, "Expected mesh 1 in chunk (15, 15).");
+
+  index.QueryChunk(0, 1, meshes);
+  Ensure(meshes.empty(), "Expected no mesh in chunk (0, 1).");
+
+  index.Query({{0.f, 0.f, -100.f}, {2000.f, 3000.f, 100.f}}, meshes);
+  Ensure((meshes == std::vector<std::uint32_t>{0, 1}), "Expected both meshes.");
+
+  // rays straight down
+  auto hit = index.Cast({{1000.f - 0.5f * chunk_size, 2000.f - 1.5f * chunk_size, 100.f}, {0.f, 0.f, -1.f}});
+  Ensure(hit && hit->mesh == 0 && std::abs(hit->t - 90.f) < 1e-3f, "Expected a hit on mesh 0.");
+
+  hit = index.Cast({{1000.f - 15.3f * chunk_size, 2000.f - 15.3f * chunk_size, 100.f}, {0.f, 0.f, -1.f}});
+  Ensure(hit && hit->mesh == 1 && std::abs(hit->position.z - 50.f) < 1e-3f, "Expected a hit on mesh 1.");
+
+  Ensure(!index.Cast({{1000.f - 0.5f * chunk_size, 2000.f - 1.5f * chunk_size, 100.f}, {0.f, 0.f, -1.f}, 50.f})
+         , "Hit beyond t_max.");
+
+  index.RegenerateBatches(root, 2);
+
+  // each quad of the strip has the centroids of both of its triangles in a different chunk
+  auto const& batches_0 = root.Chunks()[0].BlendBatches();
+  auto const& batches_1 = root.Chunks()[1].BlendBatches();
+  auto const& batches_2 = root.Chunks()[2].BlendBatches();
+  auto const& batches_255 = root.Chunks()[255].BlendBatches();
+
+  Ensure(batches_0.IsInitialized() && batches_0.Size() == 1 && batches_1.Size() == 1 && batches_2.Size() == 1
+         && batches_255.Size() == 1 && !root.Chunks()[16].BlendBatches().IsInitialized(), "Wrong batches.");
+
+  std::size_t n_indices = 0;
+
+  for (std::size_t chunk : {0, 1, 2})
+  {
+    IO::ADT::DataStructures::MCBB const& batch = root.Chunks()[chunk].BlendBatches()[0];
+    Ensure(batch.mbmh_index == 0, "Wrong batch mesh.");
+    Ensure(batch.indexFirst == n_indices, "Batches should be contiguous.");
+
+    n_indices += batch.indexCount;
+
+    for (std::size_t i = batch.indexFirst; i < batch.indexFirst + batch.indexCount; i += 3)
+    {
+      float grid_x = 0.f;
+
+      for (std::size_t corner = 0; corner < 3; ++corner)
+      {
+        std::uint16_t const v = root.BlendMeshIndices()[i + corner];
+        Ensure(v >= batch.vertexFirst && v < batch.vertexFirst + batch.vertexCount, "Vertex out of batch range.");
+        grid_x += (2000.f - vertices[v].pos.y) / chunk_size / 3.f;
+      }
+
+      Ensure(static_cast<std::size_t>(grid_x) == chunk, "Triangle in the wrong chunk.");
+    }
+  }
+
+  Ensure(n_indices == 18 && batches_255[0].mbmh_index == 1 && batches_255[0].indexCount == 3
+         , "Wrong batch ranges.");
+
+  // mesh 2 without vertices, mesh 3 sharing the indices of mesh 1: neither gets batches, the others are unchanged
+  headers.push_back({300, 0, 0, 3, 0, 21, 0});
+  headers.push_back({400, 0, 0, 3, 3, 18, 8});
+  indices.assign(root.BlendMeshIndices().begin(), root.BlendMeshIndices().end());
+  indices.insert(indices.end(), {0, 1, 2});
+
+  root.BlendMeshHeaders() = {};
+  root.BlendMeshHeaders().Initialize(headers);
+  root.BlendMeshIndices() = {};
+  root.BlendMeshIndices().Initialize(indices);
+
+  BlendMeshIndex malformed_index {root};
+  malformed_index.RegenerateBatches(root, 2);
+
+  Ensure(root.Chunks()[255].BlendBatches().Size() == 1 && root.Chunks()[255].BlendBatches()[0].mbmh_index == 1
+         && root.Chunks()[0].BlendBatches().Size() == 1, "Malformed meshes were batched.");
+}
+
+void TestVertexColors()
+{
+  ADTRoot<ClientVersion::SL> root {1};
+  root.Chunks()[0].Header().position = {1000.f, 2000.f, 0.f};
+
+  // chunk (1, 0) has colors, pixel i is (b, g, r, a) = (i, 1, 2, 3), its neighbours have none
+  std::array<IO::ADT::DataStructures::MCCVEntry, IO::Common::WorldConstants::CHUNK_BUF_SIZE> entries {};
+
+  for (std::size_t i = 0; i < entries.size(); ++i)
+  {
+    entries[i] = {static_cast<std::uint8_t>(i), 1, 2, 3};
+  }
+
+  root.Chunks()[1].VertexColor().Initialize(entries);
+
+  TileVertexColors colors {root, VertexColorFormat::MCCV};
+  Ensure(colors.DirtyChunks().none(), "Loading should not dirty chunks.");
+
+  // second outer row of chunk (1, 0) starts at pixel 17, last inner vertex is pixel 16 * 17 - 1
+  VertexColor color = colors.Outer(8 + 2, 1);
+  Ensure(color.r == 2.f && color.g == 1.f && color.b == 19.f && color.a == 3.f, "Wrong channel order.");
+  Ensure(colors.Inner(15, 7).b == 135.f, "Wrong inner vertex.");
+  Ensure(colors.Outer(8, 0).b == 0.f && colors.Outer(16, 0).b == 8.f, "Borders should come from chunk (1, 0).");
+  Ensure(colors.Outer(7, 0).b == 127.f && colors.Outer(17, 9).b == 127.f, "Missing chunks should be neutral.");
+
+  // round trip of the chunk
+  colors.DirtyChunks().set(1);
+  Ensure(colors.Store(root, VertexColorFormat::MCCV) == 1, "Expected a single chunk stored.");
+  Ensure(!std::memcmp(&*root.Chunks()[1].VertexColor().cbegin(), entries.data(), entries.size() * 4)
+         , "Round trip of vertex colors failed.");
+  Ensure(root.Chunks()[1].Header().flags.has_mccv && !root.Chunks()[0].Header().flags.has_mccv
+         , "Only stored chunks should have MCCV.");
+
+  // tint a rectangle within chunk (0, 0), saturating on store
+  colors.Multiply({4.f, 1.f, 0.5f, 1.f}, {2, 2, 4, 3});
+  Ensure(colors.DirtyChunks().count() == 1 && colors.DirtyChunks().test(0), "Expected chunk 0 dirty.");
+  Ensure(colors.Outer(2, 2).r == 508.f && colors.Inner(1, 1).b == 63.5f && colors.Inner(4, 3).r == 508.f
+         && colors.Outer(1, 2).r == 127.f && colors.Inner(0, 0).r == 127.f, "Wrong tinted vertices.");
+
+  Ensure(colors.Store(root, VertexColorFormat::MCCV) == 1 && colors.DirtyChunks().none(), "Expected chunk 0 stored.");
+
+  auto const& mccv = root.Chunks()[0].VertexColor();
+  Ensure(mccv[2 * 17 + 2].red == 255 && mccv[2 * 17 + 2].blue == 64 && mccv[0].red == 127, "Wrong packed MCCV.");
+
+  // rectangle touching a chunk border dirties both chunks, borders of the tile do not wrap around
+  colors.Clamp({0.f, 0.f, 0.f, 0.f}, {255.f, 255.f, 255.f, 255.f}, {8, 0, 8, 0});
+  Ensure(colors.DirtyChunks().count() == 2 && colors.DirtyChunks().test(0) && colors.DirtyChunks().test(1)
+         , "Expected chunks 0 and 1 dirty.");
+
+  // fade by height, then copy a part of the tile into another one
+  TileHeightfield heightfield {};
+
+  for (std::size_t x = 0; x < TileHeightfield::OUTER_DIM; ++x)
+  {
+    heightfield.Outer(x, 50) = static_cast<float>(x);
+  }
+
+  colors.FadeByHeight(heightfield, {255.f, 255.f, 255.f, 255.f}, 10.f, 20.f);
+  Ensure(colors.Outer(5, 50).g == 127.f && colors.Outer(15, 50).g == 191.f && colors.Outer(25, 50).g == 255.f
+         && colors.Outer(25, 51).g == 127.f, "Wrong faded colors.");
+
+  TileVertexColors other {};
+  other.Blend(colors, 1.f, {0, 50, TileHeightfield::OUTER_DIM - 1, 50});
+  Ensure(other.Outer(25, 50).g == 255.f && other.Outer(25, 49).g == 127.f, "Wrong copied colors.");
+
+  other.Lerp({0.f, 0.f, 0.f, 0.f}, 0.5f);
+  Ensure(other.Outer(25, 50).g == 127.5f && other.DirtyChunks().all(), "Wrong blended colors.");
+
+  // brush centered on outer vertex (20, 30) of a fresh tile
+  TileVertexColors painted {};
+  constexpr float spacing = WorldConstants::CHUNK_SIZE / 8.f;
+
+  BrushDirtyRegion const dirty = painted.Paint({.falloff = BrushFalloff::Linear, .radius = 4.f * spacing
+                                                , .strength = 1.f, .color = {255.f, 0.f, 0.f, 255.f}}
+                                               , {1000.f, 2000.f}, {1000.f - 30.f * spacing, 2000.f - 20.f * spacing});
+
+  // span ends on the radius may be dropped by rounding of the world positions
+  Ensure(dirty.touched && dirty.vertices.x_min >= 16 && dirty.vertices.x_min <= 17 && dirty.vertices.x_max >= 23
+         && dirty.vertices.x_max <= 24 && dirty.vertices.y_min == 26 && dirty.vertices.y_max == 34
+         , "Wrong brush region.");
+  Ensure(dirty.chunks == painted.DirtyChunks() && dirty.chunks.test(2 + 3 * 16) && dirty.chunks.test(2 + 4 * 16)
+         && dirty.chunks.count() <= 6, "Wrong brush chunks.");
+  Ensure(std::abs(painted.Outer(20, 30).r - 255.f) < 1e-2f && std::abs(painted.Outer(20, 30).g) < 1e-2f
+         , "Brush center should take the color.");
+  Ensure(std::abs(painted.Outer(22, 30).g - 63.5f) < 1e-2f, "Wrong brush falloff.");
+  Ensure(std::abs(painted.Outer(24, 30).g - 127.f) < 1e-2f && painted.Outer(20, 35).g == 127.f, "Brush should not reach the radius.");
+
+  // vertex lighting uses RGBA order
+  painted.Store(root, VertexColorFormat::MCLV);
+  Ensure(root.Chunks()[2 + 3 * 16].VertexLighting().IsInitialized()
+         && !root.Chunks()[5 + 3 * 16].VertexLighting().IsInitialized(), "Expected MCLV of dirty chunks only.");
+
+  auto const& mclv = root.Chunks()[3 * 16 + 2].VertexLighting();
+  Ensure(mclv[(30 - 24) * 17 + 4].r == 255 && mclv[(30 - 24) * 17 + 4].g == 0, "Wrong packed MCLV.");
+}
+
+void TestOcclusion()
+{
+  // wall of outer vertices from x = 64 on, inner vertices from x = 64 on as well
+  auto const make_wall = [](TileHeightfield& heightfield, std::size_t wall_x) -> void
+  {
+    for (std::size_t y = 0; y < TileHeightfield::OUTER_DIM; ++y)
+    {
+      for (std::size_t x = wall_x; x < TileHeightfield::OUTER_DIM; ++x)
+      {
+        heightfield.Outer(x, y) = 1000.f;
+      }
+    }
+
+    for (std::size_t y = 0; y < TileHeightfield::INNER_DIM; ++y)
+    {
+      for (std::size_t x = wall_x; x < TileHeightfield::INNER_DIM; ++x)
+      {
+        heightfield.Inner(x, y) = 1000.f;
+      }
+    }
+  };
+
+  OcclusionBaker baker {{.n_directions = 8, .max_distance = 40.f, .strength = 1.f, .multiply = true}};
+  TileOcclusion occlusion {};
+
+  TileHeightfield flat {};
+  baker.Compute(flat, {}, occlusion, 2);
+  Ensure(std::all_of(occlusion.outer.begin(), occlusion.outer.end(), [](float v) { return v == 1.f; })
+         && std::all_of(occlusion.inner.begin(), occlusion.inner.end(), [](float v) { return v == 1.f; })
+         , "Flat terrain should not be occluded.");
+
+  // vertices at the foot of the wall see it along 3 of 8 directions
+  TileHeightfield wall {};
+  make_wall(wall, 64);
+  baker.Compute(wall, {}, occlusion, 2);
+
+  float const foot = occlusion.outer[50 * TileHeightfield::OUTER_DIM + 63];
+  Ensure(std::abs(foot - 0.625f) < 1e-3f, "Wrong occlusion at the foot of the wall.");
+  Ensure(occlusion.outer[50 * TileHeightfield::OUTER_DIM + 20] == 1.f, "Wall is out of reach.");
+  Ensure(occlusion.outer[50 * TileHeightfield::OUTER_DIM + 80] == 1.f, "Top of the wall should not be occluded.");
+  Ensure(occlusion.inner[50 * TileHeightfield::INNER_DIM + 63] < 1.f
+         && occlusion.outer[50 * TileHeightfield::OUTER_DIM + 60] > foot, "Occlusion should fade with distance.");
+
+  // wall of the eastern neighbour occludes the eastern border through the halo
+  TileHeightfield east {};
+  make_wall(east, 2);
+
+  TileNeighbours neighbours {};
+  neighbours.Set(1, 0, &east);
+
+  baker.Compute(flat, neighbours, occlusion, 2);
+  Ensure(occlusion.outer[50 * TileHeightfield::OUTER_DIM + 128] < 1.f
+         && occlusion.outer[50 * TileHeightfield::OUTER_DIM + 100] == 1.f, "Neighbours should occlude the border.");
+
+  // bake into MCCV, alpha is kept
+  ADTRoot<ClientVersion::SL> root {1};
+  wall.Store(root);
+  baker.Bake(root, {}, 2);
+
+  auto const& mccv = root.Chunks()[6 * 16 + 7].VertexColor();
+  Ensure(root.Chunks()[0].Header().flags.has_mccv && mccv.IsInitialized(), "MCCV should be written.");
+  Ensure(mccv[2 * 17 + 7].red == 79 && mccv[2 * 17 + 7].alpha == 127
+         && root.Chunks()[6 * 16 + 2].VertexColor()[2 * 17].red == 127
+         , "Wrong baked colors.");
+
+  // replacing writes gray regardless of previous colors
+  OcclusionBaker replacer {{.n_directions = 16, .max_distance = 40.f, .strength = 1.f, .multiply = false}};
+  TileVertexColors colors {VertexColor{10.f, 20.f, 30.f, 40.f}};
+  replacer.Compute(flat, {}, occlusion, 1);
+  replacer.Apply(occlusion, colors);
+  Ensure(colors.Outer(5, 5).r == 127.f && colors.Outer(5, 5).b == 127.f && colors.Outer(5, 5).a == 40.f
+         && colors.DirtyChunks().all(), "Wrong replaced colors.");
+
+  // whole map: the wall of tile (11, 10) occludes the eastern border of tile (10, 10)
+  std::mutex mutex;
+  std::map<std::size_t, std::uint8_t> border_red;
+
+  std::size_t const n_baked = baker.BakeMap<ClientVersion::SL>([&](std::size_t x, std::size_t y)
+  -> std::optional<ADTRoot<ClientVersion::SL>>
+  {
+    if (y != 10 || (x != 10 && x != 11))
+      return std::nullopt;
+
+    ADTRoot<ClientVersion::SL> tile {1};
+    TileHeightfield heightfield {};
+
+    if (x == 11)
+    {
+      make_wall(heightfield, 2);
+    }
+
+    heightfield.Store(tile);
+    return tile;
+  }
+  , [&](std::size_t x, std::size_t, ADTRoot<ClientVersion::SL> const& tile) -> void
+  {
+    std::lock_guard const lock {mutex};
+    border_red[x] = tile.Chunks()[6 * 16 + 15].VertexColor()[2 * 17 + 8].red;
+  }, 2);
+
+  Ensure(n_baked == 2 && border_red.size() == 2 && border_red[10] < 127, "Wrong map bake.");
+}
+
+void TestHoles()
+{
+  // low resolution bit (1, 2) covers quads (2..3, 4..5)
+  Ensure(TileHoles::Expand(1 << (2 * 4 + 1)) == ((std::uint64_t{0x0C} << 32) | (std::uint64_t{0x0C} << 40))
+         , "Wrong expansion of a low resolution mask.");
+
+  for (std::uint32_t mask = 0; mask < 0x10000; mask += 0x0123)
+  {
+    auto const low = static_cast<std::uint16_t>(mask);
+    Ensure(TileHoles::Reduce(TileHoles::Expand(low), HoleReduction::Any) == low
+           && TileHoles::Reduce(TileHoles::Expand(low), HoleReduction::All) == low
+           , "Low resolution masks should survive a round trip.");
+  }
+
+  // a single quad (3, 5) reduces to bit (1, 2) with any, to nothing with all
+  std::uint64_t const single = std::uint64_t{1} << (5 * 8 + 3);
+  Ensure(TileHoles::Reduce(single, HoleReduction::Any) == 1 << (2 * 4 + 1)
+         && TileHoles::Reduce(single, HoleReduction::All) == 0, "Wrong reduction of a high resolution mask.");
+
+  // rectangle across the border of chunks (0, 0), (1, 0), (0, 1) and (1, 1)
+  TileHoles holes {};
+  holes.SetRect({.x_min = 6, .y_min = 7, .x_max = 9, .y_max = 8}, true);
+
+  Ensure(holes.CountHoles() == 8 && holes.DirtyChunks().count() == 4, "Wrong holes set by a rectangle.");
+  Ensure(holes.ChunkMask(0, 0) == (std::uint64_t{0xC0} << 56) && holes.ChunkMask(1, 1) == 0x03
+         && holes.IsHole(9, 8) && !holes.IsHole(10, 8) && !holes.IsHole(6, 9), "Wrong chunk masks of a rectangle.");
+
+  holes.DirtyChunks().reset();
+  holes.SetRect({.x_min = 0, .y_min = 0, .x_max = 7, .y_max = 7}, false);
+  Ensure(holes.CountHoles() == 6 && holes.DirtyChunks().count() == 1 && holes.ChunkMask(0, 0) == 0
+         , "Wrong holes cleared by a rectangle.");
+
+  // clearing what is already clear leaves chunks clean
+  holes.DirtyChunks().reset();
+  holes.SetRect({.x_min = 20, .y_min = 20, .x_max = 30, .y_max = 30}, false);
+  Ensure(holes.DirtyChunks().none(), "Unchanged chunks should not be dirty.");
+
+  holes.SetRect({}, true);
+  Ensure(holes.CountHoles() == 128 * 128, "Default rectangle should cover the tile.");
+  holes.SetRect({}, false);
+
+  // triangle in world coordinates with origin (0, 0): grid x along -Y, grid y along -X
+  constexpr float spacing = WorldConstants::CHUNK_SIZE / 8.f;
+  std::array<IO::Common::DataStructures::C2Vector, 3> const triangle
+  {{
+    {-10.f * spacing, -10.f * spacing}, {-10.f * spacing, -30.f * spacing}, {-30.f * spacing, -10.f * spacing}
+  }};
+
+  holes.SetPolygon(triangle, {0.f, 0.f}, true);
+
+  // right triangle with legs of 20 quads, quad centers within it
+  Ensure(holes.IsHole(10, 10) && holes.IsHole(28, 10) && holes.IsHole(10, 28) && holes.IsHole(19, 19)
+         && !holes.IsHole(20, 20) && !holes.IsHole(29, 10) && !holes.IsHole(9, 15) && !holes.IsHole(15, 30), "Wrong polygon rasterization.");
+  Ensure(holes.CountHoles() == 190, "Wrong number of quads within the polygon.");
+
+  Ensure(holes.IsHole({0.f, 0.f}, {-12.f * spacing, -15.f * spacing})
+         && !holes.IsHole({0.f, 0.f}, {-25.f * spacing, -25.f * spacing})
+         && !holes.IsHole({0.f, 0.f}, {1.f, 1.f}), "Wrong point queries.");
+
+  // polygon partially outside of the tile is clipped
+  std::array<IO::Common::DataStructures::C2Vector, 4> const square
+  {{
+    {spacing * 4.f, spacing * 4.f}, {spacing * 4.f, -spacing * 2.f}, {-spacing * 2.f, -spacing * 2.f}
+    , {-spacing * 2.f, spacing * 4.f}
+  }};
+
+  holes.SetPolygon(square, {0.f, 0.f}, true);
+  Ensure(holes.IsHole(0, 0) && holes.IsHole(1, 1) && !holes.IsHole(2, 0) && holes.CountHoles() == 194
+         , "Polygon should be clipped to the tile.");
+
+  // store at high resolution, then at low resolution
+  ADTRoot<ClientVersion::SL> root {1};
+  holes.Load(root);
+  holes.SetRect({.x_min = 3, .y_min = 5, .x_max = 3, .y_max = 5}, true);
+
+  Ensure(holes.Store(root) == 1 && root.Chunks()[0].Header().flags.high_res_holes
+         && root.Chunks()[0].Header().holes_high_res == single && holes.DirtyChunks().none()
+         , "Wrong high resolution store.");
+
+  holes.DirtyChunks().set();
+  Ensure(holes.Store(root, HoleResolution::Low, HoleReduction::Any) == 256
+         && !root.Chunks()[0].Header().flags.high_res_holes
+         && root.Chunks()[0].Header().holes_low_res == 1 << (2 * 4 + 1)
+         && root.Chunks()[0].Header().holes_high_res == 0, "Wrong low resolution store.");
+
+  TileHoles loaded {root};
+  Ensure(loaded.ChunkMask(0, 0) == TileHoles::Expand(1 << (2 * 4 + 1)) && loaded.DirtyChunks().none()
+         , "Low resolution holes were not expanded on load.");
+
+  Ensure(TileRaycaster::HoleMask(root.Chunks()[0].Header()) == loaded.ChunkMask(0, 0)
+         , "Raycaster should decode holes like TileHoles.");
+
+  holes.SnapToLowRes(HoleReduction::Any);
+  Ensure(holes.ChunkMask(0, 0) == loaded.ChunkMask(0, 0) && holes.DirtyChunks().count() == 1
+         , "Wrong snapping to low resolution.");
+
+  // pre-MoP clients store low resolution
+  ADTRoot<ClientVersion::CATA> cata_root {1};
+  holes.DirtyChunks().set();
+  holes.Store(cata_root);
+  Ensure(!cata_root.Chunks()[0].Header().flags.high_res_holes
+         && cata_root.Chunks()[0].Header().holes_low_res == 1 << (2 * 4 + 1), "Pre-MoP clients store low resolution.");
+}
+
+void TestChunkHeaderIndex()
+{
+  // tiles (3, 4) and (5, 4): area 10 everywhere but the first row of chunks of tile (5, 4), which is area 20
+  std::map<std::size_t, ByteBuffer> files;
+
+  for (std::size_t tile_x : {3, 5})
+  {
+    ADTRoot<ClientVersion::SL> root {1};
+
+    for (std::size_t i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+    {
+      root.Chunks()[i].Header().areaid = (tile_x == 5 && i < 16) ? 20 : 10;
+      root.Chunks()[i].Header().nLayers = 1;
+    }
+
+    root.Chunks()[17].Header().flags.impass = 1;
+    root.Chunks()[17].Header().holes_low_res = 1;
+
+    ByteBuffer buf {};
+    root.Write(buf);
+    files.emplace(4 * 64 + tile_x, std::move(buf));
+  }
+
+  auto const read = [&](std::size_t x, std::size_t y) -> std::optional<ByteBuffer>
+  {
+    auto const it = files.find(y * 64 + x);
+    return it == files.end() ? std::nullopt : std::optional<ByteBuffer>{ByteBuffer{it->second}};
+  };
+
+  ChunkHeaderIndex index {};
+  Ensure(index.Build(read, 2) == 2 && index.Size() == 512, "Wrong number of indexed tiles.");
+
+  std::span<std::uint32_t const> const area_20 = index.FindArea(20);
+  Ensure(area_20.size() == 16 && index.FindArea(10).size() == 496 && index.FindArea(30).empty()
+         , "Wrong area lookups.");
+  Ensure(index.Ref(area_20[3]).tile_x == 5 && index.Ref(area_20[3]).tile_y == 4
+         && index.Ref(area_20[3]).chunk_x == 3 && index.Ref(area_20[3]).chunk_y == 0, "Wrong chunk location.");
+
+  IO::ADT::DataStructures::SMChunkFlags impass {};
+  impass.impass = 1;
+  std::vector<std::uint32_t> const impassable = index.FindFlags(std::bit_cast<std::uint32_t>(impass));
+
+  Ensure(impassable.size() == 2 && index.Holes()[impassable[0]] == 0x0303 && index.NumLayers()[impassable[1]] == 1
+         , "Wrong header attributes.");
+  Ensure(index.Entry({5, 4, 1, 1}) == impassable[1] && !index.Entry({0, 0, 0, 0}), "Wrong chunk entries.");
+
+  // rename area 10 to 30 across the map, then move a single chunk back to area 10
+  Ensure(index.RetagArea(10, 30) == 496 && index.FindArea(10).empty() && index.FindArea(30).size() == 496
+         && std::is_sorted(index.FindArea(30).begin(), index.FindArea(30).end()), "Wrong map-wide retag.");
+  Ensure(index.RetagArea(20, 5) == 16 && index.FindArea(5).size() == 16, "Wrong retag to a lower area.");
+
+  std::array<std::uint32_t, 2> const entries {*index.Entry({3, 4, 2, 2}), *index.Entry({3, 4, 2, 3})};
+  Ensure(index.Retag(entries, 10) == 2 && index.FindArea(10).size() == 2 && index.NumDirtyChunks() == 512
+         , "Wrong retag of single chunks.");
+
+  // patch raw buffers, only area IDs change
+  std::mutex mutex;
+  std::map<std::size_t, ByteBuffer> patched_files;
+
+  std::size_t const n_patched = index.PatchMap(read, [&](std::size_t x, std::size_t y, ByteBuffer const& buf)
+  {
+    std::lock_guard const lock {mutex};
+    patched_files.emplace(y * 64 + x, buf);
+  }, 2);
+
+  Ensure(n_patched == 2 && patched_files.size() == 2 && index.NumDirtyChunks() == 0
+         , "Wrong number of patched tiles.");
+
+  for (auto const& [tile, buf] : patched_files)
+  {
+    ByteBuffer const& original = files.at(tile);
+    std::size_t n_changed = 0;
+
+    for (std::size_t i = 0; i < buf.Size(); ++i)
+    {
+      n_changed += buf.Data()[i] != original.Data()[i];
+    }
+
+    // a byte per area ID, the two chunks moved back to area 10 are unchanged
+    Ensure(buf.Size() == original.Size() && n_changed == (tile == 4 * 64 + 3 ? 254 : 256)
+           , "Patching should only change area IDs.");
+  }
+
+  ByteBuffer& patched = patched_files.at(4 * 64 + 3);
+  patched.Seek(0);
+  ADTRoot<ClientVersion::SL> root {1, patched};
+
+  Ensure(root.Chunks()[0].Header().areaid == 30 && root.Chunks()[2 * 16 + 2].Header().areaid == 10
+         && root.Chunks()[17].Header().flags.impass, "Wrong patched headers.");
+
+  // malformed tiles are rejected in all builds: a tile cut in the middle of its last chunk, and a 257th MCNK
+  ByteBuffer const& original = files.at(4 * 64 + 5);
+
+  ByteBuffer truncated {};
+  truncated.Write(original.Data(), original.Size() - 100);
+
+  ByteBuffer extra_chunk {};
+  extra_chunk.Write(original.Data(), original.Size());
+  extra_chunk.Write(ChunkHeader{IO::ADT::ChunkIdentifiers::ADTRootChunks::MCNK, sizeof(IO::ADT::DataStructures::SMChunk)});
+  extra_chunk.Write(IO::ADT::DataStructures::SMChunk{});
+
+  Ensure(!index.AddTile(0, 0, truncated) && !index.AddTile(0, 0, extra_chunk) && !index.Entry({0, 0, 0, 0})
+         && index.NumTiles() == 2, "Malformed tiles were indexed.");
+
+  // buffers that no longer match the index are left untouched, chunks stay dirty
+  Ensure(index.Retag(std::array<std::uint32_t, 1>{*index.Entry({5, 4, 0, 0})}, 40) == 1, "Wrong retag.");
+
+  ByteBuffer zeros {};
+  zeros.WriteFill(char{0}, original.Size());
+
+  ByteBuffer empty {};
+
+  Ensure(!index.PatchTile(5, 4, zeros) && !index.PatchTile(5, 4, empty) && index.NumDirtyChunks() == 1
+         && std::all_of(zeros.Data(), zeros.Data() + zeros.Size(), [](char c) { return !c; })
+         , "Mismatching buffer was patched.");
+}
+
+void TestSoundEmitterIndex()
+{
+  using IO::ADT::DataStructures::MCSE;
+
+  auto const emitter = [](std::uint32_t entry_id, float x, float y) -> MCSE
+  {
+    return {entry_id, {x, y, 0.f}, {1.f, 1.f, 1.f}};
+  };
+
+  // tile (10, 10): two emitters in chunk (0, 0), one in chunk (1, 1); tile (11, 10): one in chunk (5, 0)
+  auto const load = [&](std::size_t x, std::size_t y) -> std::optional<ADTRoot<ClientVersion::SL>>
+  {
+    if (y != 10 || (x != 10 && x != 11))
+      return std::nullopt;
+
+    ADTRoot<ClientVersion::SL> root {1};
+
+    if (x == 10)
+    {
+      root.Chunks()[0].SoundEmitters().Initialize(MCSE{}, 2);
+      root.Chunks()[0].SoundEmitters()[0] = emitter(1, 0.f, 0.f);
+      root.Chunks()[0].SoundEmitters()[1] = emitter(2, 10.f, 0.f);
+      root.Chunks()[17].SoundEmitters().Initialize(emitter(3, 100.f, 100.f), 1);
+    }
+    else
+    {
+      root.Chunks()[5].SoundEmitters().Initialize(emitter(4, 200.f, 0.f), 1);
+    }
+
+    return root;
+  };
+
+  SoundEmitterIndex index {};
+  Ensure(index.Build<ClientVersion::SL>(load, 2) == 2 && index.Size() == 4 && index.HasTile(11, 10)
+         , "Wrong number of indexed emitters.");
+
+  std::vector<SoundEmitterHit> hits = index.FindInRadius({1.f, 0.f, 0.f}, 15.f);
+  Ensure(hits.size() == 2 && hits[0].emitter.data.entry_id == 1 && hits[0].distance == 1.f
+         && hits[1].emitter.data.entry_id == 2 && hits[1].emitter.index == 1, "Wrong radius query.");
+  Ensure(index.FindInRadius({0.f, 0.f, 0.f}, 1000.f).size() == 4, "Radius query should find all emitters.");
+
+  hits = index.FindNearest({190.f, 0.f, 0.f}, 2);
+  Ensure(hits.size() == 2 && hits[0].emitter.data.entry_id == 4 && hits[0].emitter.chunk.tile_x == 11
+         && hits[0].emitter.chunk.chunk_x == 5 && hits[1].emitter.data.entry_id == 3, "Wrong nearest emitters.");
+  Ensure(index.FindNearest({190.f, 0.f, 0.f}, 3, 50.f).size() == 1, "Nearest emitters beyond reach.");
+
+  // editing a chunk and streaming a tile out
+  index.SetChunk(10, 10, 0, 0, std::span<MCSE const>{});
+  Ensure(index.FindInRadius({1.f, 0.f, 0.f}, 15.f).empty() && index.Size() == 2, "Chunk edit was not applied.");
+
+  index.RemoveTile(11, 10);
+  Ensure(index.NumTiles() == 1 && index.FindNearest({190.f, 0.f, 0.f}, 1)[0].emitter.data.entry_id == 3
+         , "Tile was not removed.");
+
+  // nearest emitters against brute force, emitters spread over chunks of several tiles
+  std::vector<MCSE> all;
+  std::uint32_t seed = 12345;
+
+  auto const random = [&]() -> float
+  {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<float>(seed >> 8) / static_cast<float>(1 << 24);
+  };
+
+  index.RemoveTile(10, 10);
+
+  for (std::size_t i = 0; i < 64; ++i)
+  {
+    std::array<MCSE, 8> chunk_emitters {};
+
+    for (std::size_t j = 0; j < chunk_emitters.size(); ++j)
+    {
+      chunk_emitters[j] = emitter(static_cast<std::uint32_t>(i * 8 + j), random() * 2000.f, random() * 2000.f);
+      all.push_back(chunk_emitters[j]);
+    }
+
+    index.SetChunk(i % 4, i / 16, (i / 4) % 16, i % 16, chunk_emitters);
+  }
+
+  IO::Common::DataStructures::C3Vector const center {1000.f, 900.f, 5.f};
+  hits = index.FindNearest(center, 10);
+
+  std::sort(all.begin(), all.end(), [&](MCSE const& lhs, MCSE const& rhs)
+  {
+    auto const distance = [&](MCSE const& e)
+    {
+      return std::hypot(e.position.x - center.x, e.position.y - center.y, e.position.z - center.z);
+    };
+
+    return distance(lhs) < distance(rhs);
+  });
+
+  Ensure(index.Size() == 512 && hits.size() == 10, "Wrong number of nearest emitters.");
+
+  for (std::size_t i = 0; i < hits.size(); ++i)
+  {
+    Ensure(hits[i].emitter.data.entry_id == all[i].entry_id, "Nearest emitters differ from brute force.");
+  }
+}
+
+void TestTileProbe()
+{
+  // chunk i at base height i, with a peak of +50 and a pit of -30 in chunk 37
+  ADTRoot<ClientVersion::SL> root {1};
+
+  for (std::size_t i = 0; i < WorldConstants::CHUNKS_PER_TILE; ++i)
+  {
+    auto& header = root.Chunks()[i].Header();
+    header.position = {1000.f - (i / 16) * WorldConstants::CHUNK_SIZE, 2000.f - (i % 16) * WorldConstants::CHUNK_SIZE
+                       , static_cast<float>(i)};
+    header.areaid = static_cast<std::uint32_t>(i % 7);
+    header.nLayers = 2;
+
+    for (std::size_t v = 0; v < WorldConstants::CHUNK_BUF_SIZE; ++v)
+    {
+      root.Chunks()[i].Heightmap()[v] = 0.f;
+    }
+  }
+
+  root.Chunks()[37].Heightmap()[100] = 50.f;
+  root.Chunks()[37].Heightmap()[3] = -30.f;
+
+  ByteBuffer buf {};
+  root.Write(buf);
+
+  TileSummary summary {};
+  Ensure(TileProbe::Probe(buf, summary), "Probing a valid tile failed.");
+
+  Ensure(summary.header.has_value(), "MHDR was not probed.");
+  Ensure(summary.chunks[37].height_min == 7.f && summary.chunks[37].height_max == 87.f
+         && summary.chunks[36].height_min == 36.f && summary.chunks[36].height_max == 36.f, "Wrong height ranges.");
+  Ensure(summary.chunks[20].header.areaid == 6 && summary.chunks[20].header.nLayers == 2
+         && summary.chunks[255].header.position.z == 255.f, "Wrong chunk headers.");
+
+  float const extent = 16.f * WorldConstants::CHUNK_SIZE;
+  Ensure(std::abs(summary.bounds.max.x - 1000.f) < 1e-3f && std::abs(summary.bounds.min.x - (1000.f - extent)) < 1e-2f
+         && std::abs(summary.bounds.max.y - 2000.f) < 1e-3f && std::abs(summary.bounds.min.y - (2000.f - extent)) < 1e-2f
+         && summary.bounds.min.z == 0.f && summary.bounds.max.z == 255.f, "Wrong tile bounds.");
+
+  std::mutex mutex;
+  std::map<std::size_t, float> maxima;
+
+  std::size_t const n_probed = TileProbe::ProbeMap([&](std::size_t x, std::size_t y) -> std::optional<ByteBuffer>
+  {
+    if (y != 3 || x > 2)
+      return std::nullopt;
+
+    return ByteBuffer{buf};
+  }
+  , [&](std::size_t x, std::size_t, TileSummary const& tile) -> void
+  {
+    std::lock_guard const lock {mutex};
+    maxima[x] = tile.bounds.max.z;
+  }, 2);
+
+  Ensure(n_probed == 3 && maxima.size() == 3 && maxima[2] == 255.f, "Wrong map probe.");
+
+  // malformed tiles fail in all builds: an oversized MCVT, and a tile cut in the middle of its last chunk
+  std::uint32_t const mcvt = IO::ADT::ChunkIdentifiers::ADTRootMCNKSubchunks::MCVT;
+  std::size_t mcvt_pos = 0;
+
+  while (std::memcmp(buf.Data() + mcvt_pos, &mcvt, sizeof(mcvt)) != 0)
+  {
+    ++mcvt_pos;
+  }
+
+  ByteBuffer oversized {buf};
+  std::uint32_t const mcvt_size = 146 * sizeof(float);
+  oversized.Write(mcvt_size, mcvt_pos + sizeof(mcvt));
+
+  ByteBuffer truncated {};
+  truncated.Write(buf.Data(), buf.Size() - 100);
+
+  Ensure(!TileProbe::Probe(oversized, summary) && !TileProbe::Probe(truncated, summary), "Malformed tiles were probed.");
+}
+
+void TestCollisionMeshExporter()
+{
+  namespace fs = std::filesystem;
+
+  ADTRoot<ClientVersion::SL> root {1};
+
+  for (std::size_t i = 0; i < 256; ++i)
+  {
+    root.Chunks()[i].Header().position = { -static_cast<float>(i / 16) * WorldConstants::CHUNK_SIZE
+                                           , -static_cast<float>(i % 16) * WorldConstants::CHUNK_SIZE, 10.f };
+
+    for (std::size_t v = 0; v < WorldConstants::CHUNK_BUF_SIZE; ++v)
+    {
+      root.Chunks()[i].Heightmap()[v] = 0.f;
+    }
+  }
+
+  // 2x2 hole quads in chunk 0, 2x1 quads of liquid at height 5 in chunk 17
+  root.Chunks()[0].Header().holes_low_res = 0x1;
+
+  auto& liquids = root.Liquids();
+  liquids.Initialize();
+
+  LiquidLayer& layer = liquids.chunks()[17].Layers().emplace_back();
+  layer.liquid_type = 2;
+  layer.liquid_vertex_format = LiquidLayer::LiquidVertexFormat::HEIGHT_DEPTH;
+  layer.min_height_level = layer.max_height_level = 5.f;
+  layer.SetRect(2, 3, 2, 1);
+  layer.AllocateVertexData();
+  std::fill(layer.Heights().begin(), layer.Heights().end(), 5.f);
+
+  CollisionMesh mesh {};
+  CollisionMeshExporter::BuildTile(root, mesh);
+
+  // hole quads leave 4 outer and 4 inner vertices unreferenced
+  constexpr std::size_t n_vertices = 256 * 145 - 8 + 6;
+  constexpr std::size_t n_triangles = 256 * 256 - 16 + 4;
+
+  Ensure(mesh.vertices.size() == n_vertices && mesh.NumTriangles() == n_triangles
+         && mesh.indices.size() == 3 * n_triangles, "Wrong collision mesh size.");
+  Ensure(std::count(mesh.surfaces.begin(), mesh.surfaces.end(), std::uint16_t{2}) == 4, "Liquid was not exported.");
+
+  for (std::size_t i = 0; i < mesh.NumTriangles(); ++i)
+  {
+    auto const& a = mesh.vertices[mesh.indices[i * 3]];
+    auto const& b = mesh.vertices[mesh.indices[i * 3 + 1]];
+    auto const& c = mesh.vertices[mesh.indices[i * 3 + 2]];
+
+    float const cross_z = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    Ensure(cross_z > 0.f, "Triangle is not counter-clockwise seen from above.");
+    Ensure(mesh.surfaces[i] ? a.z == 5.f : a.z == 10.f, "Wrong surface height.");
+  }
+
+  // liquid quad (2, 3) of chunk (1, 1)
+  auto const& liquid = mesh.vertices[mesh.indices[(n_triangles - 4) * 3]];
+  Ensure(std::abs(liquid.x + WorldConstants::CHUNK_SIZE * (1.f + 3.f / 8.f)) < 1e-3f
+         && std::abs(liquid.y + WorldConstants::CHUNK_SIZE * (1.f + 2.f / 8.f)) < 1e-3f, "Wrong liquid position.");
+
+  // 3 tiles streamed through a buffer smaller than a tile
+  auto const load = [&](std::size_t x, std::size_t y) -> std::optional<ADTRoot<ClientVersion::SL>>
+  {
+    if (!((x == 3 || x == 4) && y == 5) && !(x == 10 && y == 10))
+      return std::nullopt;
+
+    return root;
+  };
+
+  fs::path const directory = fs::temp_directory_path() / "terrain_test_collision";
+  fs::remove_all(directory);
+  fs::create_directories(directory);
+
+  auto const read = [](fs::path const& path) -> std::string
+  {
+    std::ifstream strm {path, std::ifstream::binary};
+    return {std::istreambuf_iterator<char>{strm}, std::istreambuf_iterator<char>{}};
+  };
+
+  Ensure(CollisionMeshExporter::ExportMap<ClientVersion::SL>(directory / "map.wcol", CollisionMeshFormat::Binary, load
+                                                             , 4, 1), "Binary export failed.");
+  {
+    std::string const data = read(directory / "map.wcol");
+    CollisionFileHeader header {};
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    Ensure(header.magic == CollisionMeshExporter::FILE_MAGIC && header.n_tiles == 3, "Wrong binary header.");
+
+    std::size_t offset = sizeof(header);
+    std::size_t n_records = 0;
+
+    while (offset < data.size())
+    {
+      CollisionTileHeader tile {};
+      std::memcpy(&tile, data.data() + offset, sizeof(tile));
+      offset += sizeof(tile);
+
+      Ensure(tile.n_vertices == n_vertices && tile.n_triangles == n_triangles, "Wrong binary tile record.");
+      Ensure(std::memcmp(data.data() + offset, mesh.vertices.data(), n_vertices * 12) == 0, "Wrong binary vertices.");
+
+      offset += n_vertices * 12 + n_triangles * 14;
+      ++n_records;
+    }
+
+    Ensure(offset == data.size() && n_records == 3, "Wrong binary tile records.");
+  }
+
+  Ensure(CollisionMeshExporter::ExportMap<ClientVersion::SL>(directory / "map.ply", CollisionMeshFormat::PLY, load
+                                                             , 4, 1), "PLY export failed.");
+  {
+    std::string const data = read(directory / "map.ply");
+    std::string const end_header = "end_header\n";
+    std::size_t const body = data.find(end_header) + end_header.size();
+
+    Ensure(data.find("element vertex " + std::to_string(10000000000 + 3 * n_vertices).substr(1)) != std::string::npos
+           && data.size() == body + 3 * (n_vertices * 12 + n_triangles * 15), "Wrong PLY layout.");
+    Ensure(!fs::exists(directory / "map.ply.faces.tmp"), "Temporary PLY faces were not removed.");
+
+    // faces of the last tile reference its own vertices
+    std::uint32_t last_face[3];
+    std::memcpy(last_face, data.data() + data.size() - 14, sizeof(last_face));
+    Ensure(last_face[0] >= 2 * n_vertices && last_face[0] < 3 * n_vertices, "PLY faces were not rebased.");
+  }
+
+  Ensure(CollisionMeshExporter::ExportMap<ClientVersion::SL>(directory / "map.obj", CollisionMeshFormat::OBJ, load)
+         , "OBJ export failed.");
+  {
+    std::ifstream strm {directory / "map.obj"};
+    std::size_t n_v = 0;
+    std::size_t n_f = 0;
+    std::size_t n_liquid_groups = 0;
+
+    for (std::string line; std::getline(strm, line);)
+    {
+      n_v += line.starts_with("v ");
+      n_f += line.starts_with("f -");
+      n_liquid_groups += line == "g liquid_2";
+    }
+
+    Ensure(n_v == 3 * n_vertices && n_f == 3 * n_triangles && n_liquid_groups == 3, "Wrong OBJ contents.");
+  }
+
+  Ensure(CollisionMeshExporter::ExportTiles<ClientVersion::SL>(directory, CollisionMeshFormat::PLY, load, 2)
+         , "Tile export failed.");
+  Ensure(fs::exists(directory / "3_5.ply") && fs::exists(directory / "10_10.ply") && !fs::exists(directory / "5_3.ply")
+         && fs::file_size(directory / "4_5.ply") == fs::file_size(directory / "map.ply") - 2 * (n_vertices * 12
+                                                                                              + n_triangles * 15)
+         , "Wrong tile files.");
+
+  Ensure(!CollisionMeshExporter::ExportTiles<ClientVersion::SL>(directory / "missing", CollisionMeshFormat::OBJ, load)
+         , "Export into a missing directory should fail.");
+
+  // failed exports do not leave truncated files behind
+  bool thrown = false;
+
+  try
+  {
+    CollisionMeshExporter::ExportMap(directory / "failed.ply", CollisionMeshFormat::PLY
+                                     , [&](std::size_t x, std::size_t y, CollisionMesh& tile_mesh) -> bool
+                                     {
+                                       if (x == 10 && y == 10)
+                                         throw std::runtime_error("Tile failed.");
+
+                                       tile_mesh = mesh;
+                                       return x == 3 && y == 5;
+                                     }, 1);
+  }
+  catch (std::runtime_error const&)
+  {
+    thrown = true;
+  }
+
+  Ensure(thrown && !fs::exists(directory / "failed.ply") && !fs::exists(directory / "failed.ply.faces.tmp")
+         , "Failed export left files behind.");
+
+  fs::remove_all(directory);
+}
+
+int main()
+{
+  TestHeightfieldSync();
+  TestNormals();
+  TestRaycast();
+  TestBrush();
+  TestSeams();
+  TestMeshBuilder();
+  TestHeightmapRaster();
+  TestLodGenerator();
+  TestFlightBounds();
+  TestBlendMeshIndex();
+  TestVertexColors();
+  TestOcclusion();
+  TestHoles();
+  TestChunkHeaderIndex();
+  TestSoundEmitterIndex();
+  TestTileProbe();
+  TestCollisionMeshExporter();
+
+  return 0;
+}
@@ -4,7 +4,11 @@
 #include <IO/ADT/ChunkIdentifiers.hpp>
 #include <IO/WDT/WDTRoot.hpp>
 
+#include <algorithm>
 #include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace IO::Common;
 using namespace IO::Common::Traits;
@@ -120,6 +124,38 @@ void PrepareFile(ByteBuffer& buf)
   buf.Seek(0);
 }
 
+void PrepareFileWithUnknownChunks(ByteBuffer& buf)
+{
+  buf.Write(IO::ADT::ChunkIdentifiers::ADTCommonChunks::MVER);
+  buf.Write(static_cast<std::uint32_t>(sizeof(std::uint32_t)));
+  buf.Write(static_cast<std::uint32_t>(0));
+
+  // unknown chunk between known ones
+  buf.Write(FourCC<"UNK0">);
+  buf.Write(static_cast<std::uint32_t>(3));
+  buf.Write("abc", 3);
+
+  // complex chunk with an unknown empty sub-chunk
+  buf.Write(IO::ADT::ChunkIdentifiers::ADTRootChunks::MCNK);
+  buf.Write(static_cast<std::uint32_t>(sizeof(std::uint32_t) + 2 * sizeof(ChunkHeader)));
+  buf.Write(FourCC<"UNK1">);
+  buf.Write(static_cast<std::uint32_t>(0));
+  buf.Write(IO::ADT::ChunkIdentifiers::ADTRootChunks::MHDR);
+  buf.Write(static_cast<std::uint32_t>(sizeof(std::uint32_t)));
+  buf.Write(static_cast<std::uint32_t>(1));
+
+  buf.Write(IO::ADT::ChunkIdentifiers::ADTRootChunks::MFBO);
+  buf.Write(static_cast<std::uint32_t>(sizeof(std::uint32_t)));
+  buf.Write(static_cast<std::uint32_t>(2));
+
+  // trailing unknown chunk
+  buf.Write(FourCC<"UNK2">);
+  buf.Write(static_cast<std::uint32_t>(5));
+  buf.Write("defgh", 5);
+
+  buf.Seek(0);
+}
+
 int main()
 {
   ByteBuffer bb {};
@@ -144,10 +180,121 @@ int main()
   Ensure(bb == w_bb, "Read and Write do not match");
   Ensure(bb1 == w_bb1, "Read and Write do not match");
 
+  // exact sizing, writing into a borrowed buffer of that size
+  Ensure(t.ByteSize() == w_bb.Size(), "Computed size does not match the written size.");
+  Ensure(t1.ByteSize() == w_bb1.Size(), "Computed size does not match the written size.");
+
+  std::vector<char> mapped (t1.ByteSize());
+  ByteBuffer mapped_bb {mapped.data(), mapped.size()};
+  t1.Write(mapped_bb);
+  Ensure(mapped_bb.Tell() == mapped.size() && bb1 == mapped_bb, "Write into a borrowed buffer does not match");
+
   LogDebug("First: %d", t.GetHeader().data);
   LogDebug("Second: %d", t.GetComplexChunk().GetHeader().data);
   LogDebug("Trait: %d:", t1.GetTraitHeader().data);
 
+  // in-memory state is restored without parsing
+  {
+    ByteBuffer state_bb {};
+    t1.SaveState(state_bb);
+    state_bb.Seek(0);
+
+    TestFile<ClientVersion::SL> t_state;
+    t_state.LoadState(state_bb);
+    Ensure(state_bb.Tell() == state_bb.Size(), "State was not fully restored.");
+
+    ByteBuffer state_w_bb {};
+    t_state.Write(state_w_bb);
+    Ensure(bb1 == state_w_bb, "State does not round-trip.");
+  }
+
+  // unknown chunks are written back verbatim
+  {
+    ByteBuffer unk_bb {};
+    PrepareFileWithUnknownChunks(unk_bb);
+
+    TestFile<ClientVersion::SL> t_unk;
+
+    {
+      ByteBuffer source_bb {};
+      PrepareFileWithUnknownChunks(source_bb);
+
+      t_unk.Read(source_bb);
+      Ensure(t_unk.UnknownChunks().size() == 2, "Unknown chunks were not kept.");
+      Ensure(t_unk.GetComplexChunk().UnknownChunks().size() == 1, "Unknown sub-chunks were not kept.");
+
+      ByteBuffer unk_w_bb {};
+      t_unk.Write(unk_w_bb);
+      Ensure(unk_bb == unk_w_bb, "Unknown chunks were not written back verbatim.");
+
+      std::vector<char> unk_mapped (t_unk.ByteSize());
+      ByteBuffer unk_mapped_bb {unk_mapped.data(), unk_mapped.size()};
+      t_unk.Write(unk_mapped_bb);
+      Ensure(unk_mapped_bb.Tell() == unk_mapped.size() && unk_bb == unk_mapped_bb
+             , "Unknown chunks were not written verbatim into a borrowed buffer.");
+
+      t_unk.DetachUnknownChunks();
+      Ensure(!t_unk.UnknownChunks().front().IsBorrowed(), "Unknown chunk is still borrowed after detaching.");
+      Ensure(!t_unk.GetComplexChunk().UnknownChunks().front().IsBorrowed()
+             , "Unknown sub-chunk is still borrowed after detaching.");
+    }
+
+    // the source buffer is gone, detached chunks are still written back
+    ByteBuffer detached_w_bb {};
+    t_unk.Write(detached_w_bb);
+    Ensure(unk_bb == detached_w_bb, "Detached unknown chunks were not written back verbatim.");
+
+    // unknown chunks are part of the in-memory state
+    ByteBuffer state_bb {};
+    t_unk.SaveState(state_bb);
+    state_bb.Seek(0);
+
+    TestFile<ClientVersion::SL> t_state;
+    t_state.LoadState(state_bb);
+    Ensure(state_bb.Tell() == state_bb.Size(), "State was not fully restored.");
+
+    ByteBuffer state_w_bb {};
+    t_state.Write(state_w_bb);
+    Ensure(unk_bb == state_w_bb && t_state.Hash() == t_unk.Hash(), "State does not round-trip.");
+  }
+
+  // structural hashing
+  TestFile<ClientVersion::LEGION> t_copy;
+  bb.Seek(0);
+  t_copy.Read(bb);
+
+  Ensure(t.Hash() == t_copy.Hash(), "Identical files hash differently.");
+  Ensure(t.Hash() != t1.Hash(), "Different files hash identically.");
+  Ensure(t.GetComplexChunk().Hash() == t_copy.GetComplexChunk().Hash(), "Identical chunks hash differently.");
+
+  DataArrayChunk<std::uint32_t, IO::ADT::ChunkIdentifiers::ADTRootMCNKSubchunks::MCVT
+                 , FourCCEndian::Little, 4, 4> array_chunk;
+  array_chunk.Initialize(0, 4);
+  std::uint64_t array_hash = array_chunk.Hash();
+  array_chunk[2] = 5;
+  Ensure(array_hash != array_chunk.Hash(), "Mutation did not invalidate the cached hash.");
+  array_chunk[2] = 0;
+  Ensure(array_hash == array_chunk.Hash(), "Hash is not structural.");
+
+  // the cached hash may be computed from several threads at once
+  array_chunk[2] = 7;
+  std::vector<std::uint64_t> hashes (8);
+  {
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < hashes.size(); ++i)
+    {
+      threads.emplace_back([&array_chunk, &hashes, i]() { hashes[i] = std::as_const(array_chunk).Hash(); });
+    }
+
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+  }
+  Ensure(static_cast<std::size_t>(std::count(hashes.begin(), hashes.end(), hashes[0])) == hashes.size() && hashes[0] != array_hash
+         , "Concurrent hashing is inconsistent.");
+
   IO::WDT::WDTRoot<ClientVersion::BFA> wdt{};
 
   std::fstream stream {};